@@ -153,6 +153,8 @@ ComputationNetworkPtr GetModelFromConfig(const ConfigRecordType& config, const w
     DEVICEID_TYPE deviceId = DeviceFromConfig(config);
 
     ConfigArray outputNodeNames = config(outputNodeNamesConfig.c_str(), ConfigArray(""));
+    bool fuseRecurrentCells = config(L"fuseRecurrentCells", false); // replace LSTM cells composed of elementary operations by fused LSTMCell nodes
+    bool optimizeForInference = config(L"optimizeForInference", false); // fold BatchNormalization and constants, merge common subexpressions, etc.
 
     ComputationNetworkPtr net;
 
@@ -163,10 +165,12 @@ ComputationNetworkPtr GetModelFromConfig(const ConfigRecordType& config, const w
     {
         // We have several ways to create a network.
         net = createNetworkFn(deviceId);
-        if (outputNodeNames.size() > 0)
+        if (outputNodeNames.size() > 0 || fuseRecurrentCells)
         {
             net->InvalidateCompiledNetwork();
-            PatchOutputNodes(net, outputNodeNames, outputNodeNamesVector);
+            net->SetFuseRecurrentCells(fuseRecurrentCells);
+            if (outputNodeNames.size() > 0)
+                PatchOutputNodes(net, outputNodeNames, outputNodeNamesVector);
             net->CompileNetwork();
             // BUGBUG: This will generate double Validation output in the log
         }
@@ -179,12 +183,18 @@ ComputationNetworkPtr GetModelFromConfig(const ConfigRecordType& config, const w
         // By not compiling the network before patching, we avoid double log output for validation.
         net = make_shared<ComputationNetwork>(deviceId);
         net->SetTraceLevel(config(L"traceLevel", 0));
+        net->SetMemoryMappedLoading(config(L"memoryMapModel", false)); // share page-aligned parameters with the OS page cache instead of copying them
+        net->SetFuseRecurrentCells(fuseRecurrentCells);
         net->Read<ElemType>(modelPath);
         if (outputNodeNames.size() > 0)
             PatchOutputNodes(net, outputNodeNames, outputNodeNamesVector);
         net->CompileNetwork();
     }
 
+    // the network is only used for inference from here on, unless it is further modified by the caller
+    if (optimizeForInference)
+        net->OptimizeForInference(vector<ComputationNodeBasePtr>()); // (keeps whatever the node groups need, e.g. criteria for evaluation)
+
     return net;
 }
 
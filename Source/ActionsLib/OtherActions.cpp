@@ -14,6 +14,7 @@
 #include "ComputationNetwork.h"
 #include "ComputationNode.h"
 #include "Config.h"
+#include "BestGpu.h"
 #include "ScriptableObjects.h"
 #include "BrainScriptEvaluator.h"
 
@@ -203,6 +204,47 @@ void DoParameterSVD(const ConfigParameters& config)
 template void DoParameterSVD<float>(const ConfigParameters& config);
 template void DoParameterSVD<double>(const ConfigParameters& config);
 
+// ===========================================================================
+// DoOptimizeForInference() - implements CNTK "optimizeForInference" command
+// ===========================================================================
+
+//////////////////////////////////////////////////////////////////////////
+//  for action optimizeForInference
+//      Rewrites a trained model into an equivalent one that is cheaper to evaluate (see ComputationNetwork::OptimizeForInference()):
+//      BatchNormalization is folded into the preceding Times/Convolution, Dropout and StopGradient are removed,
+//      common subexpressions are merged, constant subgraphs are precomputed, and unused nodes are deleted.
+//      The resulting model can no longer be trained meaningfully.
+//
+//      To use this command,
+//          user need to specify:
+//                  1)  modelPath           -- path to the existing model
+//                  2)  outputModelPath     -- where to write the optimized model
+//                  3)  outputNodeNames     -- (optional) nodes to keep; if not given, everything the node groups refer to is kept
+//
+//////////////////////////////////////////////////////////////////////////
+template <typename ElemType>
+void DoOptimizeForInference(const ConfigParameters& config)
+{
+    DEVICEID_TYPE deviceId = DeviceFromConfig(config);
+    wstring modelPath = config(L"modelPath");
+    wstring outputModelPath = config(L"outputModelPath");
+    ConfigArray outputNodeNames = config(L"outputNodeNames", ConfigArray(""));
+
+    ComputationNetwork net(deviceId);
+    net.SetTraceLevel(config(L"traceLevel", 1));
+    net.Load<ElemType>(modelPath);
+
+    vector<ComputationNodeBasePtr> outputNodes;
+    for (wstring name : outputNodeNames)
+        outputNodes.push_back(net.GetNodeFromName(name));
+    net.OptimizeForInference(outputNodes);
+
+    net.Save(outputModelPath);
+}
+
+template void DoOptimizeForInference<float>(const ConfigParameters& config);
+template void DoOptimizeForInference<double>(const ConfigParameters& config);
+
 // ===========================================================================
 // DoWriteWordAndClassInfo() - implements CNTK "writeWordAndClass" command
 // ===========================================================================
@@ -249,7 +249,9 @@ void DoEdit(const ConfigParameters& config)
         DEVICEID_TYPE deviceId = DeviceFromConfig(config);
         let createNetworkFn = GetNetworkFactory<ConfigParameters, ElemType>(config);
         let net = createNetworkFn(deviceId);
-        net->Save(outputPathname);
+        // page-aligned parameters can be memory-mapped when loading the model for evaluation (memoryMapModel=true)
+        bool pageAlignParameters = config(L"pageAlignParameters", false);
+        net->Save(outputPathname, pageAlignParameters ? (FileOptions)(FileOptions::fileOptionsBinary | FileOptions::fileOptionsAlignedPayloads) : FileOptions::fileOptionsBinary);
         LOGPRINTF(stderr, "\nModel with %d nodes saved as '%ls'.\n", (int)net->GetTotalNumberOfNodes(), outputPathname.c_str());
         return;
     }
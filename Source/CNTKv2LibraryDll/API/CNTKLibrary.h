@@ -661,6 +661,7 @@ namespace CNTK
         friend class BlockMomentumDistributedLearner;
         friend class Internal::VariableResolver;
         friend class Trainer;
+        friend class BeamSearchDecoder;
 
         template <typename T, typename ...CtorArgTypes>
         friend inline std::shared_ptr<T> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
@@ -1830,6 +1831,13 @@ namespace CNTK
         CNTK_API void Save(const std::wstring& filename);
         CNTK_API static Dictionary Load(const std::wstring& filename);
 
+        ///
+        /// Save this Dictionary such that the protobuf only holds the metadata, and the contents of all NDArrayViews
+        /// are stored as aligned raw bytes after it. This is not subject to the 2GB protobuf message size limit,
+        /// and loading is a bulk copy instead of protobuf parsing. Load() and operator>> accept either format.
+        ///
+        CNTK_API void SaveWithRawTensors(const std::wstring& filename);
+
     private:
         std::shared_ptr<std::unordered_map<std::wstring, DictionaryValue>> m_dictionaryData;
         static const size_t s_version;
@@ -3144,6 +3152,12 @@ namespace CNTK
         /// ONNX support limited subset of CNTK.
         ///
         ONNX,
+
+        ///
+        /// CNTK version 2 format with parameter values stored as aligned raw bytes outside of the protobuf message.
+        /// Use for models close to or above 2GB, or where load time matters. Loadable as CNTKv2.
+        ///
+        CNTKv2RawTensors,
     };
 
 
@@ -5425,6 +5439,16 @@ namespace CNTK
         ///
         CNTK_API double TestMinibatch(const std::unordered_map<Variable, ValuePtr>& arguments, std::unordered_map<Variable, ValuePtr>& outputsToFetch, const DeviceDescriptor& computeDevice = DeviceDescriptor::UseDefaultDevice(), bool distributed = false);
 
+        ///
+        /// Makes TestMinibatch split each CPU minibatch by sequence into 'numShards' parts that are evaluated concurrently, each by its own
+        /// replica of the evaluation network on its own worker thread, and then merges the criterion values and sample counts.
+        /// The workers are spread round-robin over the NUMA nodes of the host and pinned to the cores of their node, among whose workers these
+        /// cores are divided for OpenMP/BLAS; so their activations and workspaces are allocated in node-local memory. Parameters are shared.
+        /// 0 creates one shard per NUMA node; 1 (the default) evaluates each minibatch with a single Forward call.
+        /// Minibatches that cannot be split (GPU evaluation, outputs to fetch, fewer than 2 sequences) are evaluated as a whole.
+        ///
+        CNTK_API void SetNumTestShards(size_t numShards);
+
         ///
         /// Evaluation Function that is used as for the criterion for evaluating the trained model's quality.
         ///
@@ -5465,6 +5489,9 @@ namespace CNTK
 
         void UpdateTestProgress(size_t numSamples, const ValuePtr& evalCriterion, const DeviceDescriptor& computeDevice);
 
+        class ShardedTest;
+        std::shared_ptr<ShardedTest> m_shardedTest;
+
     protected:
         Evaluator(const FunctionPtr& evaluationFunction, const std::vector<ProgressWriterPtr>& progressWriters = {}, bool initializeCombined = true);
 
@@ -5510,6 +5537,82 @@ namespace CNTK
     ///
     CNTK_API EvaluatorPtr CreateEvaluator(const FunctionPtr& evaluationFunction, const std::vector<ProgressWriterPtr>& progressWriters = {});
 
+    ///
+    /// A decoding result of BeamSearchDecoder: the decoded tokens (without the start token, with the end token if one was produced)
+    /// and the sum of their scores.
+    ///
+    struct BeamSearchHypothesis
+    {
+        std::vector<size_t> m_tokens;
+        double m_score;
+    };
+
+    ///
+    /// BeamSearchDecoder decodes many sequences at once with an autoregressive step Function, keeping the 'beamWidth' best hypotheses
+    /// of every sequence. All hypotheses of all sequences are evaluated in a single batched Forward() call per step.
+    ///
+    /// The step Function computes one step for a batch of hypotheses; its inputs and outputs have a batch axis but no sequence axis:
+    ///  - 'tokenInput' is the previous token, one-hot encoded (dense or sparse);
+    ///  - 'scoreOutput' is the log-probability of each possible next token;
+    ///  - each pair in 'states' is a recurrent state input and the output that computes its value for the next step. This takes the place
+    ///    of the PastValue operations of the trained model, e.g. by cloning the model with the PastValue outputs replaced by these inputs;
+    ///  - 'contexts' are inputs that are constant during decoding, e.g. an encoder summary.
+    /// After each step, finished hypotheses (those that produced 'endToken') are set aside, and the recurrent state and contexts of the
+    /// surviving hypotheses are gathered from their parents' columns on the device, without a round trip to the host.
+    /// A sequence stops when 'beamWidth' finished hypotheses score at least as high as its best active one, or after 'maxLength' steps.
+    ///
+    class BeamSearchDecoder : public std::enable_shared_from_this<BeamSearchDecoder>
+    {
+    public:
+        ///
+        /// Decodes a batch of sequences. 'initialValues' provides the initial value of every state input and every context input,
+        /// as a Value with one sample per sequence. Returns for each sequence up to 'beamWidth' hypotheses, best first.
+        ///
+        CNTK_API std::vector<std::vector<BeamSearchHypothesis>> Decode(const std::vector<size_t>& startTokens,
+                                                                        const std::unordered_map<Variable, ValuePtr>& initialValues,
+                                                                        const DeviceDescriptor& computeDevice = DeviceDescriptor::UseDefaultDevice());
+
+        size_t BeamWidth() const { return m_beamWidth; }
+        size_t MaxLength() const { return m_maxLength; }
+
+        CNTK_API virtual ~BeamSearchDecoder() {}
+
+    private:
+        template <typename T1, typename ...CtorArgTypes>
+        friend std::shared_ptr<T1> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
+
+        BeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoreOutput,
+                          const std::vector<std::pair<Variable, Variable>>& states, const std::vector<Variable>& contexts,
+                          size_t beamWidth, size_t endToken, size_t maxLength);
+
+        template <typename ElementType>
+        std::vector<std::vector<BeamSearchHypothesis>> Decode(const std::vector<size_t>& startTokens,
+                                                              const std::unordered_map<Variable, ValuePtr>& initialValues,
+                                                              const DeviceDescriptor& computeDevice);
+
+        template <typename ElementType>
+        ValuePtr OneHotTokens(const std::vector<size_t>& tokens, const DeviceDescriptor& computeDevice) const;
+
+        template <typename ElementType>
+        static ValuePtr GatherSamples(const ValuePtr& value, const NDShape& sampleShape, const std::vector<size_t>& sampleIndices, const DeviceDescriptor& computeDevice);
+
+        FunctionPtr m_stepFunction;
+        Variable m_tokenInput;
+        Variable m_scoreOutput;
+        std::vector<std::pair<Variable, Variable>> m_states;
+        std::vector<Variable> m_contexts;
+        size_t m_beamWidth;
+        size_t m_endToken;
+        size_t m_maxLength;
+    };
+
+    ///
+    /// Construct a BeamSearchDecoder for the specified step Function.
+    ///
+    CNTK_API BeamSearchDecoderPtr CreateBeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoreOutput,
+                                                          const std::vector<std::pair<Variable, Variable>>& states, const std::vector<Variable>& contexts,
+                                                          size_t beamWidth, size_t endToken, size_t maxLength);
+
     enum class DataUnit : unsigned int
     {
         ///Indiciate that the frequency of action is counted by sweep.
@@ -5558,6 +5661,18 @@ namespace CNTK
         ///
         CNTK_API void SaveCheckpoint(const std::wstring& filePath, Dictionary externalState = Dictionary());
 
+        ///
+        /// Checkpoint the model and other Trainer state like SaveCheckpoint, but only take a snapshot of the state on the calling thread
+        /// and write the files on a background thread. At most one checkpoint is written at a time; errors of the write are reported
+        /// by the next checkpoint or by WaitForCheckpointWrites. In distributed training the checkpoint is saved synchronously.
+        ///
+        CNTK_API void SaveCheckpointInBackground(const std::wstring& filePath, Dictionary externalState = Dictionary());
+
+        ///
+        /// Wait until the checkpoint written in the background is on disk.
+        ///
+        CNTK_API void WaitForCheckpointWrites();
+
         ///
         /// Restore the model and trainer state from a previously saved model and checkpoint from the specified file location
         ///
@@ -5635,6 +5750,8 @@ namespace CNTK
 
         void Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState,
             const Dictionary& externalState, const Dictionary& distributedState = {});
+        static Dictionary CheckpointState(const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState);
+        static void WriteCheckpoint(const std::wstring& modelFilePath, const Dictionary& model, Dictionary state);
 
         void UpdateTrainingProgress(size_t numSamples, const ValuePtr& loss, const ValuePtr& evalCriterion, const DeviceDescriptor& computeDevice);
         void AddProgressWriters(const std::vector<ProgressWriterPtr>& progressWriters);
@@ -5658,6 +5775,9 @@ namespace CNTK
         AccumulatorPtr m_aggregatedTrainingEvalCriterionValue;
 
         size_t m_prevDistributedTotalNumSamples;
+
+        // Checkpoint being written in the background.
+        std::future<void> m_checkpointWrite;
     };
 
     ///
@@ -6204,19 +6324,22 @@ namespace CNTK
         /// checkpointFrequencyInSamples: frequency in samples when to perform checkpointing.
         /// restoreFromCheckpointIfExists: if flag is set, the training session will try to restore before training.
         /// preserveAllCheckpoints: if flag is set, all checkpoints will be preserved.
+        /// writeInBackground: if flag is set, checkpoint files are written on a background thread (see Trainer::SaveCheckpointInBackground).
         ///
         CNTK_API CheckpointConfig(
             const std::wstring& checkPointFileName,
             size_t checkpointFrequency = std::numeric_limits<size_t>::max(),
             DataUnit checkpointFrequencyUnit = DataUnit::Sample,
             bool restoreFromCheckpointIfExists = true,
-            bool preserveAllCheckpoints = false);
+            bool preserveAllCheckpoints = false,
+            bool writeInBackground = false);
 
     private:
         friend class TrainingSession;
         const std::wstring m_fileName;
         const bool m_restore;
         const bool m_preserveAll;
+        const bool m_writeInBackground;
         const size_t m_frequency;
         const DataUnit m_frequencyUnit;
     };
@@ -6289,6 +6412,24 @@ namespace CNTK
         ///
         CNTK_API void RestoreFromCheckpoint(const std::wstring& checkpointFileName);
 
+        ///
+        /// Sets the number of training minibatches that are read ahead of the trainer (0 by default).
+        /// With a non-zero depth, Train() reads the minibatches on a background thread and copies them into a ring of
+        /// pre-allocated values, so that reading and the input copy overlap with training on the previous minibatch.
+        ///
+        CNTK_API void SetMinibatchPrefetchDepth(size_t depth);
+
+        ///
+        /// Returns how long the current training step waited for its minibatch data, in milliseconds.
+        /// Can be queried from OnMinibatchStart/OnMinibatchEnd.
+        ///
+        double MinibatchDataWaitTimeInMilliseconds() const { return m_lastDataWaitTime; }
+
+        ///
+        /// Returns the total time the training steps waited for minibatch data, in milliseconds.
+        ///
+        double TotalDataWaitTimeInMilliseconds() const { return m_totalDataWaitTime; }
+
         CNTK_API virtual ~TrainingSession() {}
 
     public:
@@ -6354,6 +6495,7 @@ namespace CNTK
             size_t maxMbSize, size_t workerRank, size_t numberOfWorkers, const DeviceDescriptor& computeDevice);
         void GetTrainingMinibatch(std::unordered_map<Variable, ValuePtr>& minibatch, bool* pIsMinibatchAtSweepEnd, size_t maxMbSize, const DeviceDescriptor& computeDevice);
         void GetCrossValidationMinibatch(std::unordered_map<Variable, ValuePtr>& minibatch, bool* pIsMinibatchAtSweepEnd, size_t maxMbSize, const DeviceDescriptor& computeDevice);
+        void StopPrefetching();
 
         void RestoreFromCheckpoint();
         void SaveCheckpoint(size_t currentIndex);
@@ -6370,6 +6512,13 @@ namespace CNTK
         // Scaler for the minibatch size in distributed mode.
         size_t m_mbSizeScaleFactor;
 
+        // Reading of training minibatches ahead of the trainer.
+        class MinibatchPrefetcher;
+        std::shared_ptr<MinibatchPrefetcher> m_prefetcher;
+        size_t m_prefetchDepth;
+        double m_lastDataWaitTime;
+        double m_totalDataWaitTime;
+
         std::vector<PeriodicAction> m_actions;
 
         // Training.
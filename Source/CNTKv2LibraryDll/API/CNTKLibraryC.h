@@ -109,6 +109,27 @@ CNTK_API CNTK_StatusCode CNTK_LoadModel(
     /*[in]*/ const CNTK_DeviceDescriptor* device,
     /*[out]*/ CNTK_ModelHandle* model);
 
+//
+// Loads a model like CNTK_LoadModel, but returns a model that batches concurrent requests:
+// CNTK_EvaluateSequence calls made on it from different threads are queued and evaluated
+// together, as a single minibatch of sequences. A call waits at most maxLatencyMicroseconds
+// for other calls to join its minibatch. Only sequences that start with a reset are accepted,
+// because the minibatch mixes the sequences of different callers.
+//
+// Parameters:
+//     modelFilePath [in]: a null-terminated path to a CNTK model file
+//     device [in]: device descriptor.
+//     maxBatchSize [in]: maximum number of sequences evaluated together, should be positive
+//     maxLatencyMicroseconds [in]: maximum time a call waits for the minibatch to fill up
+//     model [out]: the resulting loaded model
+//
+CNTK_API CNTK_StatusCode CNTK_LoadBatchingModel(
+    /*[in]*/ const wchar_t* modelFilePath,
+    /*[in]*/ const CNTK_DeviceDescriptor* device,
+    /*[in]*/ uint32_t maxBatchSize,
+    /*[in]*/ uint32_t maxLatencyMicroseconds,
+    /*[out]*/ CNTK_ModelHandle* model);
+
 enum CNTK_ParameterCloningMethod
 {
     ///
@@ -31,6 +31,11 @@
 #include <stdarg.h>
 #include <assert.h>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <type_traits>
 #include <unordered_set>
 #include <unordered_map>
@@ -214,6 +219,9 @@ namespace CNTK
     class Evaluator;
     typedef std::shared_ptr<Evaluator> EvaluatorPtr;
 
+    class BeamSearchDecoder;
+    typedef std::shared_ptr<BeamSearchDecoder> BeamSearchDecoderPtr;
+
     class Trainer;
     typedef std::shared_ptr<Trainer> TrainerPtr;
 
@@ -306,6 +314,9 @@ namespace CNTK
         CNTK_API void EnableGradientAccumulationOptimization();
         CNTK_API void DisableGradientAccumulationOptimization();
 
+        CNTK_API void EnableActivationRecomputation();
+        CNTK_API void DisableActivationRecomputation();
+
         static const uint64_t DefaultProfilerBufferSize = 32 * 1024 * 1024;
         CNTK_API void StartProfiler(const std::wstring& profilerDir = L"profiler", bool profilerSyncGpu = false, size_t profilerBufferSize = DefaultProfilerBufferSize);
         CNTK_API void EnableProfiler();
@@ -359,7 +370,8 @@ namespace CNTK
         /// TensorBoardFileWriter allows collecting various metrics (e.g. loss/error etc.) as the training progresses,
         /// so that they can be analyzed in TensorBoard.
         /// It also provides an option to serialize the model being trained, so that it can also be visualized.
-        /// The class is NOT thread-safe: it is assumed that only one thread is using each instance.
+        /// The class is NOT thread-safe: it is assumed that only one thread is using each instance. The writer can however
+        /// build and write its records on a background thread of its own (see WriteInBackground).
         ///
         class TensorBoardFileWriter final
         {
@@ -389,6 +401,29 @@ namespace CNTK
             ///
             CNTK_API void WriteValue(const std::wstring& name, float value, uint64_t step);
 
+            ///
+            /// Record a histogram of the values of a tensor (e.g. a parameter or its gradient) at a particular step.
+            /// Only the copy of the values to the CPU happens on the calling thread in background mode.
+            ///
+            CNTK_API void WriteHistogram(const std::wstring& name, NDArrayViewPtr values, uint64_t step);
+
+            ///
+            /// Build, checksum and write the records on a background thread, so that the calling thread only queues them.
+            /// When 'maxQueuedRecords' records are waiting to be written, further ones are dropped instead of blocking
+            /// the caller. Flush() then only requests the records queued so far to be flushed.
+            ///
+            CNTK_API void WriteInBackground(size_t maxQueuedRecords = 1024);
+
+            ///
+            /// Record values, histograms and images only for every 'interval'-th step (1 by default: all steps).
+            ///
+            CNTK_API void SetStepSamplingInterval(size_t interval);
+
+            ///
+            /// Returns the number of records dropped because the background queue was full.
+            ///
+            size_t NumDroppedRecords() const { return m_numDroppedRecords; }
+
 #ifndef CNTK_UWP // doesn't support UWP due to compatibablity of opencv libs
             ///
             /// Record an image for a CNTK NDArrayViewPtr at a particular step.
@@ -412,6 +447,16 @@ namespace CNTK
             void WriteModel();
             void WriteRecord(const std::string& data);
             void WriteVersion(time_t time);
+            bool FlushFile();
+            bool CloseFile();
+
+            // Writes the record built by 'createRecord', on the background thread if there is one.
+            void PostRecord(std::function<std::string()>&& createRecord);
+            void WriteQueuedRecords();
+            void StopBackgroundWriting();
+#ifndef CNTK_UWP
+            static std::string EncodeImages(const std::wstring& name, const NDArrayViewPtr& imageData, uint64_t step, double wallTime);
+#endif
 
             // Disable copy-construction and assignment.
             TensorBoardFileWriter(const TensorBoardFileWriter& other) = delete;
@@ -421,6 +466,18 @@ namespace CNTK
             const std::wstring m_dir;
             FILE* m_file;
             std::wstring m_fileName;
+            size_t m_stepSamplingInterval;
+
+            // Background writing.
+            bool m_writeInBackground;
+            size_t m_maxQueuedRecords;
+            std::atomic<size_t> m_numDroppedRecords;
+            std::mutex m_queueMutex;
+            std::condition_variable m_queueNotEmpty;
+            std::deque<std::function<std::string()>> m_queue;
+            bool m_flushRequested;
+            bool m_stopRequested;
+            std::thread m_writer;
         };
 
         // SWIG callback wrapper for the UDF deserialization.
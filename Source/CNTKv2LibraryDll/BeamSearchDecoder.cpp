@@ -0,0 +1,318 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Utils.h"
+#include "Matrix.h"
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace CNTK
+{
+    BeamSearchDecoderPtr CreateBeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoreOutput,
+                                                 const std::vector<std::pair<Variable, Variable>>& states, const std::vector<Variable>& contexts,
+                                                 size_t beamWidth, size_t endToken, size_t maxLength)
+    {
+        return MakeSharedObject<BeamSearchDecoder>(stepFunction, tokenInput, scoreOutput, states, contexts, beamWidth, endToken, maxLength);
+    }
+
+    static bool HasOnlyBatchAxis(const Variable& var)
+    {
+        return var.DynamicAxes().size() == 1 && var.DynamicAxes()[0] == Axis::DefaultBatchAxis();
+    }
+
+    BeamSearchDecoder::BeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoreOutput,
+                                         const std::vector<std::pair<Variable, Variable>>& states, const std::vector<Variable>& contexts,
+                                         size_t beamWidth, size_t endToken, size_t maxLength)
+        : m_stepFunction(stepFunction), m_tokenInput(tokenInput), m_scoreOutput(scoreOutput), m_states(states), m_contexts(contexts),
+          m_beamWidth(beamWidth), m_endToken(endToken), m_maxLength(maxLength)
+    {
+        if (!m_stepFunction)
+            InvalidArgument("BeamSearchDecoder: the step function must not be null.");
+        if (m_beamWidth == 0 || m_maxLength == 0)
+            InvalidArgument("BeamSearchDecoder: beamWidth (%d) and maxLength (%d) must be positive.", (int)m_beamWidth, (int)m_maxLength);
+
+        auto arguments = m_stepFunction->Arguments();
+        auto outputs = m_stepFunction->Outputs();
+        auto checkArgument = [&](const Variable& var, const wchar_t* what)
+        {
+            if (std::find(arguments.begin(), arguments.end(), var) == arguments.end())
+                InvalidArgument("BeamSearchDecoder: the %S '%S' is not an argument of the step function.", what, var.AsString().c_str());
+            if (!HasOnlyBatchAxis(var))
+                InvalidArgument("BeamSearchDecoder: the %S '%S' must have the batch axis as its only dynamic axis.", what, var.AsString().c_str());
+        };
+        auto checkOutput = [&](const Variable& var, const wchar_t* what)
+        {
+            if (std::find(outputs.begin(), outputs.end(), var) == outputs.end())
+                InvalidArgument("BeamSearchDecoder: the %S '%S' is not an output of the step function.", what, var.AsString().c_str());
+            if (!HasOnlyBatchAxis(var))
+                InvalidArgument("BeamSearchDecoder: the %S '%S' must have the batch axis as its only dynamic axis.", what, var.AsString().c_str());
+            if (var.IsSparse())
+                InvalidArgument("BeamSearchDecoder: the %S '%S' must be dense.", what, var.AsString().c_str());
+        };
+
+        checkArgument(m_tokenInput, L"token input");
+        checkOutput(m_scoreOutput, L"score output");
+        if (m_scoreOutput.GetDataType() != DataType::Float && m_scoreOutput.GetDataType() != DataType::Double)
+            InvalidArgument("BeamSearchDecoder: the score output must be of type float or double.");
+        if (m_tokenInput.Shape().TotalSize() != m_scoreOutput.Shape().TotalSize())
+            InvalidArgument("BeamSearchDecoder: the token input '%S' and the score output '%S' must have the same vocabulary size.",
+                            m_tokenInput.AsString().c_str(), m_scoreOutput.AsString().c_str());
+        if (m_endToken >= m_scoreOutput.Shape().TotalSize())
+            InvalidArgument("BeamSearchDecoder: the end token (%d) is out of the vocabulary range (%d).", (int)m_endToken, (int)m_scoreOutput.Shape().TotalSize());
+
+        for (const auto& state : m_states)
+        {
+            checkArgument(state.first, L"state input");
+            checkOutput(state.second, L"state output");
+            if (state.first.Shape() != state.second.Shape() || state.first.GetDataType() != m_scoreOutput.GetDataType())
+                InvalidArgument("BeamSearchDecoder: the state input '%S' and the state output '%S' must have the same shape, and the data type of the score output.",
+                                state.first.AsString().c_str(), state.second.AsString().c_str());
+        }
+        for (const auto& context : m_contexts)
+        {
+            checkArgument(context, L"context input");
+            if (context.IsSparse() || context.GetDataType() != m_scoreOutput.GetDataType())
+                InvalidArgument("BeamSearchDecoder: the context input '%S' must be dense and have the data type of the score output.", context.AsString().c_str());
+        }
+        if (arguments.size() != 1 + m_states.size() + m_contexts.size())
+            InvalidArgument("BeamSearchDecoder: every argument of the step function must be the token input, a state input or a context input.");
+    }
+
+    std::vector<std::vector<BeamSearchHypothesis>> BeamSearchDecoder::Decode(const std::vector<size_t>& startTokens,
+                                                                             const std::unordered_map<Variable, ValuePtr>& initialValues,
+                                                                             const DeviceDescriptor& computeDevice)
+    {
+        if (m_scoreOutput.GetDataType() == DataType::Float)
+            return Decode<float>(startTokens, initialValues, computeDevice);
+        else
+            return Decode<double>(startTokens, initialValues, computeDevice);
+    }
+
+    // Returns the one-hot encoding of 'tokens' as a batch, sparse or dense depending on the token input.
+    template <typename ElementType>
+    ValuePtr BeamSearchDecoder::OneHotTokens(const std::vector<size_t>& tokens, const DeviceDescriptor& computeDevice) const
+    {
+        size_t vocabularySize = m_tokenInput.Shape().TotalSize();
+        if (m_tokenInput.IsSparse())
+        {
+            std::vector<SparseIndexType> colStarts(tokens.size() + 1);
+            std::vector<SparseIndexType> rowIndices(tokens.size());
+            std::vector<ElementType> nonZeroValues(tokens.size(), 1);
+            for (size_t i = 0; i < tokens.size(); i++)
+            {
+                colStarts[i] = (SparseIndexType)i;
+                rowIndices[i] = (SparseIndexType)tokens[i];
+            }
+            colStarts[tokens.size()] = (SparseIndexType)tokens.size();
+            auto data = MakeSharedObject<NDArrayView>(AsDataType<ElementType>(), m_tokenInput.Shape().AppendShape({ tokens.size() }),
+                                                      colStarts.data(), rowIndices.data(), nonZeroValues.data(), tokens.size(), computeDevice, true);
+            return MakeSharedObject<Value>(data);
+        }
+
+        std::vector<ElementType> batchData(vocabularySize * tokens.size(), 0);
+        for (size_t i = 0; i < tokens.size(); i++)
+            batchData[i * vocabularySize + tokens[i]] = 1;
+        return Value::CreateBatch(m_tokenInput.Shape(), batchData, computeDevice, true);
+    }
+
+    // Returns a batch whose i-th sample is the 'sampleIndices[i]'-th sample of 'value'. The copy is done by a single
+    // column gather on the compute device.
+    template <typename ElementType>
+    /*static*/ ValuePtr BeamSearchDecoder::GatherSamples(const ValuePtr& value, const NDShape& sampleShape, const std::vector<size_t>& sampleIndices, const DeviceDescriptor& computeDevice)
+    {
+        NDArrayViewPtr source = value->Device() == computeDevice ? value->Data() : value->Data()->DeepClone(computeDevice, true);
+        std::vector<ElementType> indices(sampleIndices.begin(), sampleIndices.end());
+        Matrix<ElementType> indexMatrix(1, indices.size(), indices.data(), AsCNTKImplDeviceId(computeDevice));
+
+        NDArrayViewPtr result = MakeSharedObject<NDArrayView>(AsDataType<ElementType>(), sampleShape.AppendShape({ sampleIndices.size() }), computeDevice);
+        result->GetWritableMatrix<ElementType>(sampleShape.Rank())->DoGatherColumnsOf(0, indexMatrix, *source->GetMatrix<ElementType>(sampleShape.Rank()), 1);
+        return MakeSharedObject<Value>(result);
+    }
+
+    template <typename ElementType>
+    std::vector<std::vector<BeamSearchHypothesis>> BeamSearchDecoder::Decode(const std::vector<size_t>& startTokens,
+                                                                             const std::unordered_map<Variable, ValuePtr>& initialValues,
+                                                                             const DeviceDescriptor& computeDevice)
+    {
+        const size_t numSequences = startTokens.size();
+        const size_t vocabularySize = m_scoreOutput.Shape().TotalSize();
+        const size_t noParent = SIZE_MAX;
+
+        // A node in the history tree: the token chosen at this step and the node it extends.
+        struct HistoryNode
+        {
+            size_t m_parent;
+            size_t m_token;
+        };
+        // An active hypothesis; its state and context are the corresponding column of the state and context values.
+        struct ActiveHypothesis
+        {
+            size_t m_sequence;
+            size_t m_node;
+            size_t m_token;
+            double m_score;
+        };
+        struct FinishedHypothesis
+        {
+            size_t m_node;
+            double m_score;
+        };
+
+        std::vector<HistoryNode> history;
+        std::vector<std::vector<FinishedHypothesis>> finished(numSequences);
+        std::vector<ActiveHypothesis> active;
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            if (startTokens[s] >= vocabularySize)
+                InvalidArgument("BeamSearchDecoder::Decode: the start token (%d) of sequence %d is out of the vocabulary range (%d).", (int)startTokens[s], (int)s, (int)vocabularySize);
+            active.push_back({ s, noParent, startTokens[s], 0.0 });
+        }
+
+        auto initialValue = [&](const Variable& var)
+        {
+            auto iter = initialValues.find(var);
+            if (iter == initialValues.end() || !iter->second)
+                InvalidArgument("BeamSearchDecoder::Decode: no initial value was given for '%S'.", var.AsString().c_str());
+            if (iter->second->Shape().TotalSize() != var.Shape().TotalSize() * numSequences)
+                InvalidArgument("BeamSearchDecoder::Decode: the initial value of '%S' must have one sample per sequence (%d).", var.AsString().c_str(), (int)numSequences);
+            return iter->second;
+        };
+        std::vector<ValuePtr> stateValues, contextValues;
+        for (const auto& state : m_states)
+            stateValues.push_back(initialValue(state.first));
+        for (const auto& context : m_contexts)
+            contextValues.push_back(initialValue(context));
+
+        // a candidate extension of an active hypothesis: (score, active hypothesis, token)
+        typedef std::tuple<double, size_t, size_t> Candidate;
+        std::vector<Candidate> candidates;
+        candidates.reserve(m_beamWidth);
+        std::vector<size_t> parentColumns;
+        std::vector<ActiveHypothesis> nextActive;
+
+        for (size_t step = 1; step <= m_maxLength && !active.empty(); step++)
+        {
+            std::vector<size_t> tokens(active.size());
+            for (size_t i = 0; i < active.size(); i++)
+                tokens[i] = active[i].m_token;
+
+            std::unordered_map<Variable, ValuePtr> arguments = { { m_tokenInput, OneHotTokens<ElementType>(tokens, computeDevice) } };
+            for (size_t k = 0; k < m_states.size(); k++)
+                arguments[m_states[k].first] = stateValues[k];
+            for (size_t k = 0; k < m_contexts.size(); k++)
+                arguments[m_contexts[k]] = contextValues[k];
+            std::unordered_map<Variable, ValuePtr> outputs = { { m_scoreOutput, nullptr } };
+            for (const auto& state : m_states)
+                outputs[state.second] = nullptr;
+            m_stepFunction->Forward(arguments, outputs, computeDevice);
+
+            auto scoreData = outputs[m_scoreOutput]->Data();
+            if (scoreData->Device() != DeviceDescriptor::CPUDevice())
+                scoreData = scoreData->DeepClone(DeviceDescriptor::CPUDevice(), true);
+            const ElementType* scores = scoreData->DataBuffer<ElementType>();
+
+            nextActive.clear();
+            parentColumns.clear();
+            for (size_t begin = 0, end; begin < active.size(); begin = end)
+            {
+                const size_t s = active[begin].m_sequence;
+                for (end = begin; end < active.size() && active[end].m_sequence == s; end++)
+                    ;
+
+                // top 'beamWidth' extensions of all active hypotheses of this sequence, kept in a min-heap
+                candidates.clear();
+                for (size_t i = begin; i < end; i++)
+                {
+                    const ElementType* logProbabilities = scores + i * vocabularySize;
+                    for (size_t v = 0; v < vocabularySize; v++)
+                    {
+                        double score = active[i].m_score + logProbabilities[v];
+                        if (candidates.size() < m_beamWidth)
+                        {
+                            candidates.emplace_back(score, i, v);
+                            std::push_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+                        }
+                        else if (score > std::get<0>(candidates.front()))
+                        {
+                            std::pop_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+                            candidates.back() = Candidate(score, i, v);
+                            std::push_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+                        }
+                    }
+                }
+                std::sort_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+
+                size_t firstActive = nextActive.size();
+                for (const auto& candidate : candidates)
+                {
+                    double score = std::get<0>(candidate);
+                    size_t i = std::get<1>(candidate), v = std::get<2>(candidate);
+                    history.push_back({ active[i].m_node, v });
+                    if (v == m_endToken || step == m_maxLength)
+                        finished[s].push_back({ history.size() - 1, score });
+                    else
+                    {
+                        nextActive.push_back({ s, history.size() - 1, v, score });
+                        parentColumns.push_back(i);
+                    }
+                }
+
+                // Scores only decrease as hypotheses grow, so once 'beamWidth' finished hypotheses beat the best active one,
+                // no active hypothesis can make it into the result anymore.
+                if (nextActive.size() > firstActive && finished[s].size() >= m_beamWidth)
+                {
+                    std::nth_element(finished[s].begin(), finished[s].begin() + m_beamWidth - 1, finished[s].end(),
+                                     [](const FinishedHypothesis& a, const FinishedHypothesis& b) { return a.m_score > b.m_score; });
+                    if (finished[s][m_beamWidth - 1].m_score >= nextActive[firstActive].m_score)
+                    {
+                        nextActive.resize(firstActive);
+                        parentColumns.resize(firstActive);
+                    }
+                }
+            }
+
+            if (!nextActive.empty())
+            {
+                for (size_t k = 0; k < m_states.size(); k++)
+                    stateValues[k] = GatherSamples<ElementType>(outputs[m_states[k].second], m_states[k].second.Shape(), parentColumns, computeDevice);
+
+                // contexts only need to be reordered when the hypotheses' origins change
+                bool identity = parentColumns.size() == active.size();
+                for (size_t i = 0; identity && i < parentColumns.size(); i++)
+                    identity = parentColumns[i] == i;
+                if (!identity)
+                {
+                    for (size_t k = 0; k < m_contexts.size(); k++)
+                        contextValues[k] = GatherSamples<ElementType>(contextValues[k], m_contexts[k].Shape(), parentColumns, computeDevice);
+                }
+            }
+            active.swap(nextActive);
+        }
+
+        std::vector<std::vector<BeamSearchHypothesis>> results(numSequences);
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            auto& hypotheses = finished[s];
+            std::stable_sort(hypotheses.begin(), hypotheses.end(), [](const FinishedHypothesis& a, const FinishedHypothesis& b) { return a.m_score > b.m_score; });
+            if (hypotheses.size() > m_beamWidth)
+                hypotheses.resize(m_beamWidth);
+            for (const auto& hypothesis : hypotheses)
+            {
+                BeamSearchHypothesis result;
+                result.m_score = hypothesis.m_score;
+                for (size_t node = hypothesis.m_node; node != noParent; node = history[node].m_parent)
+                    result.m_tokens.push_back(history[node].m_token);
+                std::reverse(result.m_tokens.begin(), result.m_tokens.end());
+                results[s].push_back(std::move(result));
+            }
+        }
+        return results;
+    }
+}
@@ -105,6 +105,25 @@ CNTK_StatusCode CNTK_LoadModel(const wchar_t* modelFilePath, const CNTK_DeviceDe
     return ExceptionCatcher::Call([&]() { *handle = new CNTKEvaluatorWrapper(modelFilePath, device); });
 }
 
+CNTK_StatusCode CNTK_LoadBatchingModel(const wchar_t* modelFilePath, const CNTK_DeviceDescriptor* device,
+    uint32_t maxBatchSize, uint32_t maxLatencyMicroseconds, CNTK_ModelHandle* handle)
+{
+    if (!handle)
+        return StatusCode(CNTK_ERROR_NULL_POINTER, "'handle' parameter is not allowed to be null");
+
+    if (!modelFilePath)
+        return StatusCode(CNTK_ERROR_NULL_POINTER, "'modelFilePath' parameter is not allowed to be null");
+
+    if (maxBatchSize == 0)
+        return StatusCode(CNTK_ERROR_INVALID_INPUT, "'maxBatchSize' parameter should be positive");
+
+    *handle = nullptr;
+    return ExceptionCatcher::Call([&]()
+    {
+        *handle = new BatchingEvaluatorWrapper(modelFilePath, device, maxBatchSize, chrono::microseconds(maxLatencyMicroseconds));
+    });
+}
+
 CNTK_StatusCode CNTK_CloneModel(CNTK_ModelHandle model, CNTK_ParameterCloningMethod method, bool flatten, CNTK_ModelHandle* cloned)
 {
     if (model == CNTK_INVALID_MODEL_HANDLE)
@@ -171,6 +171,16 @@ namespace CNTK
             Microsoft::MSR::CNTK::Globals::SetGradientAccumulationOptimization(/* enable = */ false);
         }
 
+        void EnableActivationRecomputation()
+        {
+            Microsoft::MSR::CNTK::Globals::SetActivationRecomputation(/* enable = */ true);
+        }
+
+        void DisableActivationRecomputation()
+        {
+            Microsoft::MSR::CNTK::Globals::SetActivationRecomputation(/* enable = */ false);
+        }
+
         void StartProfiler(const wstring& profilerDir, bool profilerSyncGpu, size_t profilerBufferSize)
         {
 #ifndef CNTK_UWP
@@ -1779,7 +1779,7 @@ namespace CNTK
     }
 
     template <typename ElementType>
-    /*static*/ void CompositeFunction::PopulateComputationNodeValue(const std::pair<Variable, ValuePtr>& variableValue, ComputationNodeBasePtr& computationNode, std::unordered_map<MBLayoutPtr, Variable>& layoutsPopulated)
+    /*static*/ bool CompositeFunction::PopulateComputationNodeValue(const std::pair<Variable, ValuePtr>& variableValue, ComputationNodeBasePtr& computationNode, std::unordered_map<MBLayoutPtr, Variable>& layoutsPopulated, bool bindValueStorage /*= false*/)
     {
         NDShape inferredVariableShape;
         std::pair<std::shared_ptr<const Matrix<ElementType>>, MBLayoutPtr> CNTKMatrixAndMBLayout = Utils::GetCNTKImplMatrixAndMBLayoutFromValueObject<ElementType>(variableValue.first, variableValue.second, &inferredVariableShape);
@@ -1787,9 +1787,16 @@ namespace CNTK
             CNTK::LogicError("CompositeFunction::Forward: Inferred shape '%S' of Variable '%S' does not match the corresponding computation node shape '%s'.",
                              inferredVariableShape.AsString().c_str(), variableValue.first.AsString().c_str(), ((std::string)computationNode->GetSampleLayout()).c_str());
 
-        // Switch the node matrix to the right matrix type
+        // Dense data in a caller-owned buffer on the node's device is used in place; input nodes never write to their value.
+        // Buffers owned by the library are always copied, since they may belong to a network that reuses them (e.g. a previous output).
+        // Otherwise, switch the node matrix to the right matrix type
         auto& nodeData = computationNode->As<ComputationNode<ElementType>>()->Value();
-        nodeData.AssignValuesOf(*CNTKMatrixAndMBLayout.first);
+        const auto& valueData = *CNTKMatrixAndMBLayout.first;
+        bool bound = bindValueStorage && !valueData.OwnBuffer() && (valueData.GetMatrixType() == MatrixType::DENSE) && (valueData.GetDeviceId() == nodeData.GetDeviceId());
+        if (bound)
+            nodeData = valueData.AsReference();
+        else
+            nodeData.AssignValuesOf(valueData);
 
         auto layout = CNTKMatrixAndMBLayout.second;
         auto& nodeLayout = computationNode->GetMBLayout();
@@ -1810,6 +1817,8 @@ namespace CNTK
                                      variableValue.first.AsString().c_str(), layoutsPopulated.at(nodeLayout).AsString().c_str(), DynamicAxesAsString(variableValue.first.DynamicAxes(), Internal::IsReversingTensorShapesInErrorMessagesEnabled()).c_str());
             }
         }
+
+        return bound;
     }
 
     std::unordered_map<Variable, NDShape> CompositeFunction::InferFreeDimensionsOfArguments(const std::unordered_map<Variable, ValuePtr>& arguments)
@@ -1857,8 +1866,11 @@ namespace CNTK
         return inferredArgumentDimensions;
     }
 
-    void CompositeFunction::PopulateNetworkInputs(const std::unordered_map<Variable, ValuePtr>& arguments)
+    void CompositeFunction::PopulateNetworkInputs(const std::unordered_map<Variable, ValuePtr>& arguments, bool bindValueStorage)
     {
+        // A previous Forward may have failed before releasing the caller's storage.
+        ReleaseBoundArgumentStorage();
+
         std::unordered_map<MBLayoutPtr, Variable> layoutsPopulated;
         std::vector<ComputationNodeBasePtr> inputNodes;
         for (auto argumentValuePair : arguments)
@@ -1869,26 +1881,64 @@ namespace CNTK
             inputNodes.push_back(argumentComputationNode);
 
             ValuePtr argumentValue = arguments.at(argument);
+            bool bound = false;
             switch (argumentValue->GetDataType())
             {
             case DataType::Float:
-                PopulateComputationNodeValue<float>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated);
+                bound = PopulateComputationNodeValue<float>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated, bindValueStorage);
                 break;
             case DataType::Double:
-                PopulateComputationNodeValue<double>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated);
+                bound = PopulateComputationNodeValue<double>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated, bindValueStorage);
                 break;
             case DataType::Float16:
-                PopulateComputationNodeValue<half>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated);
+                bound = PopulateComputationNodeValue<half>({ argument, argumentValue }, argumentComputationNode, layoutsPopulated, bindValueStorage);
                 break;
             default:
                 LogicError("Function '%S' Forward: Unsupported DataType %s.", AsString().c_str(), DataTypeName(argumentValue->GetDataType()));
                 break;
             }
+
+            if (bound)
+                m_argumentsBoundToValueStorage.push_back(argument);
         }
 
         m_computationNetwork->BumpEvalTimeStamp(inputNodes);
     }
 
+    void CompositeFunction::ReleaseBoundArgumentStorage()
+    {
+        for (const auto& argument : m_argumentsBoundToValueStorage)
+        {
+            auto argumentComputationNode = m_variableToNodeMap.at(argument);
+            switch (argument.GetDataType())
+            {
+            case DataType::Float:
+            {
+                auto& nodeData = argumentComputationNode->As<ComputationNode<float>>()->Value();
+                nodeData = Matrix<float>(nodeData.GetDeviceId());
+                break;
+            }
+            case DataType::Double:
+            {
+                auto& nodeData = argumentComputationNode->As<ComputationNode<double>>()->Value();
+                nodeData = Matrix<double>(nodeData.GetDeviceId());
+                break;
+            }
+            case DataType::Float16:
+            {
+                auto& nodeData = argumentComputationNode->As<ComputationNode<half>>()->Value();
+                nodeData = Matrix<half>(nodeData.GetDeviceId());
+                break;
+            }
+            default:
+                LogicError("Function '%S': Unsupported DataType %s.", AsString().c_str(), DataTypeName(argument.GetDataType()));
+                break;
+            }
+        }
+
+        m_argumentsBoundToValueStorage.clear();
+    }
+
     template <typename ElementType>
     /*static*/ void CompositeFunction::PopulateComputationNodeGradient(const std::pair<Variable, ValuePtr>& variableGradient, Microsoft::MSR::CNTK::ComputationNodeBasePtr& computationNode)
     {
@@ -2138,9 +2188,9 @@ namespace CNTK
         else
             InvalidArgument("Unsupported DataType %s", DataTypeName(dataType));
 
-        // Feed data into the arguments of the network
-        // TODO: Avoid copying the data when possible
-        PopulateNetworkInputs(requiredArgumentValues);
+        // Feed data into the arguments of the network.
+        // Without backward state, nothing reads the arguments after this call, and their nodes can use the data of the Values in place.
+        PopulateNetworkInputs(requiredArgumentValues, /*bindValueStorage =*/ outputsToRetainBackwardStateFor.empty());
 
         // Copy all new values for 'dirty' attributes from functions into corresponding network nodes.
         ApplyAttributeUpdates();
@@ -2199,6 +2249,8 @@ namespace CNTK
         }
 
         GetNetworkOutputs(outputs);
+        ReleaseBoundArgumentStorage();
+
         // TODO: How to deal with the specified 'computeDevice'
         BackPropStatePtr backpropStatePtr;
         if (outputsToRetainBackwardStateFor.size() > 0)
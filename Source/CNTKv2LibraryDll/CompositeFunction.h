@@ -318,9 +318,13 @@ namespace CNTK
                                                                     const std::unordered_set<Variable>& inputsToExcludeGradientsFor,
                                                                     bool useMangledNamesForComputationNodes);
 
+        // Returns true if the node's value was bound to the storage of the specified Value instead of being copied; this is only done with 'bindValueStorage'.
         template <typename ElementType>
-        static void PopulateComputationNodeValue(const std::pair<Variable, ValuePtr>& variableValue, Microsoft::MSR::CNTK::ComputationNodeBasePtr& computationNode, std::unordered_map< Microsoft::MSR::CNTK::MBLayoutPtr, Variable>& layoutsPopulated);
-        void PopulateNetworkInputs(const std::unordered_map<Variable, ValuePtr>& arguments);
+        static bool PopulateComputationNodeValue(const std::pair<Variable, ValuePtr>& variableValue, Microsoft::MSR::CNTK::ComputationNodeBasePtr& computationNode, std::unordered_map< Microsoft::MSR::CNTK::MBLayoutPtr, Variable>& layoutsPopulated, bool bindValueStorage = false);
+        void PopulateNetworkInputs(const std::unordered_map<Variable, ValuePtr>& arguments, bool bindValueStorage);
+
+        // Gives the argument nodes bound to the storage of caller's Values their own (empty) storage again.
+        void ReleaseBoundArgumentStorage();
 
         template <typename ElementType>
         static void PopulateComputationNodeGradient(const std::pair<Variable, ValuePtr>& variableGradient, Microsoft::MSR::CNTK::ComputationNodeBasePtr& computationNode);
@@ -356,6 +360,7 @@ namespace CNTK
             m_variableToNodeMap.clear();
             m_currentOutputsToEvaluate.clear();
             m_lastRecordedTimeStamps.clear();
+            m_argumentsBoundToValueStorage.clear();
 
             m_networkMatricesAllocated = false;
             m_computationNetwork = nullptr;
@@ -412,6 +417,10 @@ namespace CNTK
 
         std::unordered_set<Variable> m_inputsExcludedFromGradientComputation;
 
+        // Arguments whose nodes use the storage of the Values passed to the current Forward call, instead of a copy.
+        // This is only done when no backward state is retained, and the nodes are released at the end of the call.
+        std::vector<Variable> m_argumentsBoundToValueStorage;
+
         // Version history:
         // 1 -- initial version.
         // 2 -- add support for stateful functions (with corresponding nodes inheriting from RngUser).
@@ -4,11 +4,364 @@
 //
 
 #include "stdafx.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "CNTKLibrary.h"
 #include "Utils.h"
+#include <CPUMatrix.h> // For CPUMatrix::SetNumThreadsOfCallingThread
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace CNTK
 {
+    namespace
+    {
+        // The logical processors of a NUMA node.
+        struct NumaNode
+        {
+            size_t numCpus;
+#ifdef _WIN32
+            GROUP_AFFINITY affinity;
+#else
+            std::vector<int> cpus;
+#endif
+        };
+
+        // Returns the NUMA nodes of the host; a single node without processor list (i.e. no pinning) if the topology is not known.
+        std::vector<NumaNode> GetNumaNodes()
+        {
+            std::vector<NumaNode> nodes;
+#ifdef _WIN32
+            ULONG highestNode = 0;
+            if (GetNumaHighestNodeNumber(&highestNode))
+            {
+                for (USHORT node = 0; node <= highestNode; node++)
+                {
+                    NumaNode numaNode = {};
+                    if (!GetNumaNodeProcessorMaskEx(node, &numaNode.affinity))
+                        continue;
+                    for (KAFFINITY mask = numaNode.affinity.Mask; mask != 0; mask &= mask - 1)
+                        numaNode.numCpus++;
+                    if (numaNode.numCpus > 0)
+                        nodes.push_back(numaNode);
+                }
+            }
+#else
+            for (size_t node = 0;; node++)
+            {
+                // a list of ranges, e.g. "0-27,56-83"
+                std::ifstream cpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                if (!cpuList)
+                    break;
+
+                NumaNode numaNode;
+                std::string range;
+                while (std::getline(cpuList, range, ','))
+                {
+                    int first, last;
+                    int numFields = sscanf(range.c_str(), "%d-%d", &first, &last);
+                    if (numFields < 1)
+                        continue;
+                    if (numFields == 1)
+                        last = first;
+                    for (int cpu = first; cpu <= last; cpu++)
+                        numaNode.cpus.push_back(cpu);
+                }
+                numaNode.numCpus = numaNode.cpus.size();
+                if (numaNode.numCpus > 0)
+                    nodes.push_back(std::move(numaNode));
+            }
+#endif
+            if (nodes.empty())
+            {
+                NumaNode allCpus = {};
+                allCpus.numCpus = std::max<size_t>(1, std::thread::hardware_concurrency());
+                nodes.push_back(allCpus);
+            }
+            return nodes;
+        }
+
+        // Restricts the calling thread to the processors of 'node'. Memory the thread touches first is then allocated on that node.
+        // Pinning is an optimization only, so failures are ignored.
+        void PinCallingThread(const NumaNode& node)
+        {
+#ifdef _WIN32
+            if (node.affinity.Mask != 0)
+                SetThreadGroupAffinity(GetCurrentThread(), &node.affinity, nullptr);
+#else
+            if (node.cpus.empty())
+                return;
+
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            for (auto cpu : node.cpus)
+            {
+                if (cpu < CPU_SETSIZE)
+                    CPU_SET(cpu, &cpuSet);
+            }
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+        }
+
+        // Returns the sequences [begin, end) of a Value, which must have the batch axis as its last axis.
+        ValuePtr SliceSequences(const ValuePtr& value, size_t begin, size_t end)
+        {
+            auto data = value->Data();
+            auto extent = data->Shape().Dimensions();
+            std::vector<size_t> offset(extent.size(), 0);
+            offset.back() = begin;
+            extent.back() = end - begin;
+            auto slice = data->SliceView(offset, extent, /*readOnly=*/ true);
+
+            auto sourceMask = value->Mask();
+            if (!sourceMask)
+                return MakeSharedObject<Value>(slice);
+
+            // NDMask has no slice view; copy the entries that are not valid.
+            auto maskExtent = sourceMask->Shape().Dimensions();
+            size_t sequenceSize = sourceMask->Shape().TotalSize() / maskExtent.back();
+            maskExtent.back() = end - begin;
+            auto mask = MakeSharedObject<NDMask>(NDShape(maskExtent), sourceMask->Device());
+            const MaskKind* source = sourceMask->DataBuffer() + begin * sequenceSize;
+            std::vector<size_t> position(maskExtent.size());
+            for (size_t i = 0; i < sequenceSize * (end - begin); i++)
+            {
+                if (source[i] == MaskKind::Valid)
+                    continue;
+                for (size_t axis = 0, rest = i; axis < maskExtent.size(); rest /= maskExtent[axis], axis++)
+                    position[axis] = rest % maskExtent[axis];
+                if (source[i] == MaskKind::SequenceBegin)
+                    mask->MarkSequenceBegin(position);
+                else
+                    mask->InvalidateSection(position, NDShape(maskExtent.size(), 1));
+            }
+            return MakeSharedObject<Value>(slice, mask);
+        }
+
+        template <typename ElementType>
+        void AddInPlace(const NDArrayViewPtr& sum, const NDArrayViewPtr& addend)
+        {
+            auto* sumBuffer = sum->WritableDataBuffer<ElementType>();
+            const auto* addendBuffer = addend->DataBuffer<ElementType>();
+            for (size_t i = 0; i < sum->Shape().TotalSize(); i++)
+                sumBuffer[i] += addendBuffer[i];
+        }
+    }
+
+    // Evaluates the shards of a minibatch concurrently. Each shard has a worker thread that is pinned to a NUMA node and evaluates
+    // its own replica of the combined evaluation function; the replicas share the parameters.
+    class Evaluator::ShardedTest
+    {
+    public:
+        ShardedTest(const FunctionPtr& combinedEvalFunction, const Variable& aggregatedEvalVar, const Variable& sampleCountVar, size_t numShards)
+            : m_combinedEvalFunction(combinedEvalFunction), m_sampleCountVar(sampleCountVar), m_stop(false), m_numBusyShards(0)
+        {
+            auto outputs = combinedEvalFunction->Outputs();
+            m_aggregateOutputIndex = std::find(outputs.begin(), outputs.end(), aggregatedEvalVar) - outputs.begin();
+            m_sampleCountOutputIndex = std::find(outputs.begin(), outputs.end(), sampleCountVar) - outputs.begin();
+            if (m_aggregateOutputIndex == outputs.size() || m_sampleCountOutputIndex == outputs.size())
+                LogicError("Evaluator: The evaluation criterion and the sample count are not outputs of the combined evaluation function.");
+
+            // The replicas take the same argument variables as the original.
+            for (const auto& argument : combinedEvalFunction->Arguments())
+                m_argumentReplacements.insert({ argument, argument });
+
+            auto nodes = GetNumaNodes();
+            if (numShards == 0)
+                numShards = nodes.size();
+
+            // The shards are assigned round-robin to the nodes and divide the processors of their node among themselves.
+            m_shards.resize(numShards);
+            for (size_t i = 0; i < numShards; i++)
+            {
+                const auto& node = nodes[i % nodes.size()];
+                size_t numShardsOnNode = numShards / nodes.size() + ((i % nodes.size()) < (numShards % nodes.size()) ? 1 : 0);
+                m_shards[i].node = node;
+                m_shards[i].numThreads = std::max<size_t>(1, node.numCpus / numShardsOnNode);
+                m_shards[i].hasWork = false;
+            }
+            for (auto& shard : m_shards)
+                shard.thread = std::thread([this, &shard] { Run(shard); });
+        }
+
+        ~ShardedTest()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_workAvailable.notify_all();
+            for (auto& shard : m_shards)
+                shard.thread.join();
+        }
+
+        size_t NumShards() const { return m_shards.size(); }
+
+        // Returns false if the minibatch cannot be split by sequence; it then has to be evaluated as a whole.
+        bool Test(const std::unordered_map<Variable, ValuePtr>& arguments, const DeviceDescriptor& computeDevice, std::pair<ValuePtr, size_t>& result)
+        {
+            auto dataType = m_combinedEvalFunction->Outputs()[m_aggregateOutputIndex].GetDataType();
+            if (computeDevice.Type() != DeviceKind::CPU || (dataType != DataType::Float && dataType != DataType::Double))
+                return false;
+
+            // All arguments with dynamic axes must hold the same number of sequences along their last axis.
+            size_t numSequences = 0;
+            for (const auto& argument : arguments)
+            {
+                if (argument.first.DynamicAxes().empty())
+                    continue;
+
+                const auto& shape = argument.second->Shape();
+                if (shape.Rank() != argument.first.Shape().Rank() + argument.first.DynamicAxes().size())
+                    return false;
+
+                size_t numArgumentSequences = shape[shape.Rank() - 1];
+                if (numSequences != 0 && numArgumentSequences != numSequences)
+                    return false;
+                numSequences = numArgumentSequences;
+            }
+            if (numSequences < 2)
+                return false;
+
+            size_t numActiveShards = std::min(m_shards.size(), numSequences);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_computeDevice = computeDevice;
+                for (size_t i = 0; i < numActiveShards; i++)
+                {
+                    auto& shard = m_shards[i];
+                    size_t begin = i * numSequences / numActiveShards;
+                    size_t end = (i + 1) * numSequences / numActiveShards;
+                    shard.arguments.clear();
+                    for (const auto& argument : arguments)
+                        shard.arguments[argument.first] = argument.first.DynamicAxes().empty() ? argument.second : SliceSequences(argument.second, begin, end);
+                    shard.error = nullptr;
+                    shard.hasWork = true;
+                }
+                m_numBusyShards = numActiveShards;
+            }
+            m_workAvailable.notify_all();
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workDone.wait(lock, [this] { return m_numBusyShards == 0; });
+            }
+
+            for (size_t i = 0; i < numActiveShards; i++)
+            {
+                m_shards[i].arguments.clear();
+                if (m_shards[i].error)
+                    std::rethrow_exception(m_shards[i].error);
+            }
+
+            auto sum = m_shards[0].aggregate->Data()->DeepClone(DeviceDescriptor::CPUDevice(), /*readOnly=*/ false);
+            size_t sampleCount = m_shards[0].sampleCount;
+            for (size_t i = 1; i < numActiveShards; i++)
+            {
+                if (dataType == DataType::Float)
+                    AddInPlace<float>(sum, m_shards[i].aggregate->Data());
+                else
+                    AddInPlace<double>(sum, m_shards[i].aggregate->Data());
+                sampleCount += m_shards[i].sampleCount;
+            }
+
+            result = std::make_pair(MakeSharedObject<Value>(sum), sampleCount);
+            return true;
+        }
+
+    private:
+        struct Shard
+        {
+            NumaNode node;
+            size_t numThreads;
+            std::thread thread;
+            FunctionPtr replica;
+
+            // The work item and its result; guarded by m_mutex while 'hasWork' is not set.
+            std::unordered_map<Variable, ValuePtr> arguments;
+            ValuePtr aggregate;
+            size_t sampleCount;
+            std::exception_ptr error;
+            bool hasWork;
+        };
+
+        void Run(Shard& shard)
+        {
+            PinCallingThread(shard.node);
+            Microsoft::MSR::CNTK::CPUMatrix<float>::SetNumThreadsOfCallingThread((int)shard.numThreads);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_workAvailable.wait(lock, [this, &shard] { return m_stop || shard.hasWork; });
+                if (m_stop)
+                    return;
+
+                auto computeDevice = m_computeDevice;
+                lock.unlock();
+                try
+                {
+                    Evaluate(shard, computeDevice);
+                }
+                catch (...)
+                {
+                    shard.error = std::current_exception();
+                }
+                lock.lock();
+
+                shard.hasWork = false;
+                if (--m_numBusyShards == 0)
+                    m_workDone.notify_one();
+            }
+        }
+
+        void Evaluate(Shard& shard, const DeviceDescriptor& computeDevice)
+        {
+            // The replica is created, and its network allocated, on the pinned worker so that its memory is local to the node.
+            if (!shard.replica)
+            {
+                std::lock_guard<std::mutex> lock(m_cloneMutex);
+                shard.replica = m_combinedEvalFunction->Clone(ParameterCloningMethod::Share, m_argumentReplacements);
+            }
+
+            auto replicaOutputs = shard.replica->Outputs();
+            const auto& aggregateVar = replicaOutputs[m_aggregateOutputIndex];
+            const auto& sampleCountVar = replicaOutputs[m_sampleCountOutputIndex];
+            std::unordered_map<Variable, ValuePtr> outputs = { { aggregateVar, nullptr }, { sampleCountVar, nullptr } };
+            shard.replica->Forward(shard.arguments, outputs, computeDevice);
+
+            shard.aggregate = outputs[aggregateVar];
+            shard.sampleCount = GetSampleCount(m_sampleCountVar, outputs[sampleCountVar]);
+        }
+
+        FunctionPtr m_combinedEvalFunction;
+        Variable m_sampleCountVar;
+        size_t m_aggregateOutputIndex;
+        size_t m_sampleCountOutputIndex;
+        std::unordered_map<Variable, Variable> m_argumentReplacements;
+        std::mutex m_cloneMutex;
+
+        std::vector<Shard> m_shards;
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_workDone;
+        DeviceDescriptor m_computeDevice = DeviceDescriptor::CPUDevice();
+        bool m_stop;
+        size_t m_numBusyShards;
+    };
+
     EvaluatorPtr CreateEvaluator(const FunctionPtr& evaluationFunction, const std::vector<ProgressWriterPtr>& progressWriters)
     {
         return MakeSharedObject<Evaluator>(evaluationFunction, progressWriters, true);
@@ -49,6 +402,21 @@ namespace CNTK
             m_combinedEvalFunction = Combine(GetCombinedEvalFunctionArgs());
     }
 
+    void Evaluator::SetNumTestShards(size_t numShards)
+    {
+        if (!m_combinedEvalFunction)
+            InvalidArgument("Evaluator::SetNumTestShards: Cannot shard the test minibatches when no evaluation function was specified during construction.");
+
+        // Stops the workers of the previous setting.
+        m_shardedTest = nullptr;
+        if (numShards == 1)
+            return;
+
+        auto shardedTest = std::make_shared<ShardedTest>(m_combinedEvalFunction, m_aggregatedEvaluationFunction, m_testSampleCountVar, numShards);
+        if (shardedTest->NumShards() > 1)
+            m_shardedTest = shardedTest;
+    }
+
     std::vector<Variable> Evaluator::GetCombinedEvalFunctionArgs() const
     {
         if (!m_evaluationFunction)
@@ -161,6 +529,13 @@ namespace CNTK
             return std::make_pair(zeroValue, 0);
         }
 
+        if (m_shardedTest && outputsToFetch.empty())
+        {
+            std::pair<ValuePtr, size_t> result;
+            if (m_shardedTest->Test(arguments, computeDevice, result))
+                return result;
+        }
+
         std::unordered_map<Variable, ValuePtr> outputs = { { m_aggregatedEvaluationFunction, nullptr }, { m_testSampleCountVar, nullptr } };
         outputs.insert(outputsToFetch.begin(), outputsToFetch.end());
 
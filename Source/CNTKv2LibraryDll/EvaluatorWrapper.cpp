@@ -146,4 +146,268 @@ namespace CNTK
             cloned = m_func->Clone(ToNative(method));
         return unique_ptr<EvaluatorWrapper>(new CNTKEvaluatorWrapper(cloned, m_device));
     }
+
+    BatchingEvaluatorWrapper::BatchingEvaluatorWrapper(FunctionPtr model, DeviceDescriptor device, size_t maxBatchSize, chrono::microseconds maxLatency)
+        : m_func(model), m_device(device), m_maxBatchSize(maxBatchSize), m_maxLatency(maxLatency), m_stopped(false), m_numEvaluatedBatches(0)
+    {
+        if (m_maxBatchSize == 0)
+            InvalidArgument("Maximum batch size of the batching evaluator must be positive.");
+
+        for (const auto arg : m_func->Arguments())
+            m_arguments.insert(make_pair(arg.Name(), arg));
+
+        for (const auto arg : m_func->Outputs())
+            m_outputs.insert(make_pair(arg.Name(), arg));
+
+        m_worker = thread(&BatchingEvaluatorWrapper::ProcessRequests, this);
+    }
+
+    BatchingEvaluatorWrapper::BatchingEvaluatorWrapper(const wchar_t* modelFilePath, const CNTK_DeviceDescriptor* device, size_t maxBatchSize, chrono::microseconds maxLatency) :
+        BatchingEvaluatorWrapper(Function::Load(modelFilePath, GetDeviceDescriptor(device)), GetDeviceDescriptor(device), maxBatchSize, maxLatency)
+    {}
+
+    BatchingEvaluatorWrapper::~BatchingEvaluatorWrapper()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_requestAvailable.notify_all();
+        m_worker.join();
+
+        // Nobody should be waiting at this point, but do not leave a caller blocked forever.
+        for (auto& request : m_queue)
+            request->m_done.set_exception(make_exception_ptr(runtime_error("The batching evaluator has been released.")));
+    }
+
+    void BatchingEvaluatorWrapper::GetModelArgumentsInfo(CNTK_Variable** inputs, uint32_t* numInputs)
+    {
+        assert(inputs != nullptr);
+        assert(numInputs != nullptr);
+        return GetVariableInfo(m_func->Arguments(), inputs, numInputs);
+    }
+
+    void BatchingEvaluatorWrapper::GetModelOutputsInfo(CNTK_Variable** outputs, uint32_t* numOutputs)
+    {
+        assert(outputs != nullptr);
+        assert(numOutputs != nullptr);
+        return GetVariableInfo(m_func->Outputs(), outputs, numOutputs);
+    }
+
+    bool BatchingEvaluatorWrapper::Request::IsCompatibleWith(const Request& other) const
+    {
+        if (m_outputNameSet != other.m_outputNameSet || m_inputs.size() != other.m_inputs.size())
+            return false;
+
+        for (auto i = m_inputs.begin(), j = other.m_inputs.begin(); i != m_inputs.end(); ++i, ++j)
+        {
+            if (i->first != j->first || i->second.m_sampleShape != j->second.m_sampleShape)
+                return false;
+        }
+        return true;
+    }
+
+    void BatchingEvaluatorWrapper::EvaluateSequence(
+        const CNTK_Variable* inputs,
+        const CNTK_Value* inputValues,
+        const bool* inputResetFlags,
+        uint32_t numInputs,
+        const CNTK_Variable* outputs,
+        uint32_t numOutputs,
+        CNTK_Value** outputValues)
+    {
+        if (outputValues == nullptr)
+            InvalidArgument("outputValues is not allowed to be null");
+
+        // Validate and copy the request, the caller's buffers are only used again for the outputs.
+        auto request = make_shared<Request>();
+        for (uint32_t i = 0; i < numInputs; ++i)
+        {
+            auto var = m_arguments.find(inputs[i].name);
+            if (var == m_arguments.end())
+                InvalidArgument("Unexpected argument.");
+
+            if (!inputResetFlags[i])
+                InvalidArgument("The batching evaluator only accepts sequences that start with a reset, '%ls' does not.", inputs[i].name);
+
+            auto inputShape = ToNDShape(inputValues[i].shape);
+            auto sampleShape = inputShape.SubShape(0, var->second.Shape().Rank());
+            if (sampleShape.TotalSize() == 0 || inputShape.TotalSize() % sampleShape.TotalSize() != 0)
+                InvalidArgument("Shape of the value of argument '%ls' does not hold a whole number of samples.", inputs[i].name);
+
+            auto& input = request->m_inputs[var->first];
+            input.m_sampleShape = sampleShape;
+            input.m_data.assign(inputValues[i].data, inputValues[i].data + inputShape.TotalSize());
+        }
+
+        for (uint32_t i = 0; i < numOutputs; ++i)
+        {
+            auto var = m_outputs.find(outputs[i].name);
+            if (var == m_outputs.end())
+                InvalidArgument("Unexpected output.");
+
+            request->m_outputNames.push_back(var->first);
+            request->m_outputNameSet.insert(var->first);
+        }
+        request->m_outputValues = outputValues;
+
+        auto done = request->m_done.get_future();
+        {
+            lock_guard<mutex> lock(m_mutex);
+            request->m_arrival = chrono::steady_clock::now();
+            m_queue.push_back(request);
+        }
+        m_requestAvailable.notify_one();
+
+        // Rethrows the exception if the evaluation of the minibatch failed.
+        done.get();
+    }
+
+    void BatchingEvaluatorWrapper::ProcessRequests()
+    {
+        for (;;)
+        {
+            vector<RequestPtr> batch;
+            {
+                unique_lock<mutex> lock(m_mutex);
+                m_requestAvailable.wait(lock, [this] { return m_stopped || !m_queue.empty(); });
+                if (m_stopped)
+                    return;
+
+                // Give other callers the chance to join the minibatch of the oldest request.
+                auto deadline = m_queue.front()->m_arrival + m_maxLatency;
+                m_requestAvailable.wait_until(lock, deadline, [this] { return m_stopped || m_queue.size() >= m_maxBatchSize; });
+                if (m_stopped)
+                    return;
+
+                const auto head = m_queue.front();
+                for (auto i = m_queue.begin(); i != m_queue.end() && batch.size() < m_maxBatchSize;)
+                {
+                    if ((*i)->IsCompatibleWith(*head))
+                    {
+                        batch.push_back(*i);
+                        i = m_queue.erase(i);
+                    }
+                    else
+                        ++i;
+                }
+            }
+
+            EvaluateBatch(batch);
+        }
+    }
+
+    void BatchingEvaluatorWrapper::EvaluateBatch(const vector<RequestPtr>& batch)
+    {
+        assert(!batch.empty());
+        const auto& head = *batch.front();
+
+        // Outputs of the minibatch, split per sequence.
+        unordered_map<wstring, vector<vector<float>>> sequences;
+        unordered_map<wstring, NDShape> sampleShapes;
+        try
+        {
+            unordered_map<Variable, ValuePtr> preparedInputs;
+            for (const auto& input : head.m_inputs)
+            {
+                vector<vector<float>> batchOfSequences;
+                batchOfSequences.reserve(batch.size());
+                for (const auto& request : batch)
+                    batchOfSequences.push_back(move(request->m_inputs[input.first].m_data));
+
+                preparedInputs[m_arguments.at(input.first)] =
+                    Value::CreateBatchOfSequences(input.second.m_sampleShape, batchOfSequences, vector<bool>(batch.size(), true), m_device);
+            }
+
+            unordered_map<Variable, ValuePtr> preparedOutputs;
+            for (const auto& name : head.m_outputNameSet)
+                preparedOutputs[m_outputs.at(name)] = nullptr;
+
+            m_func->Evaluate(preparedInputs, preparedOutputs, m_device);
+            ++m_numEvaluatedBatches;
+
+            for (const auto& output : preparedOutputs)
+            {
+                const auto& var = output.first;
+                auto& split = sequences[var.Name()];
+                output.second->CopyVariableValueTo(var, split);
+                if (split.size() != batch.size())
+                    RuntimeError("Number of evaluated sequences '%d' of output '%ls' does not match the batch size '%d'.",
+                        (int)split.size(), var.Name().c_str(), (int)batch.size());
+                sampleShapes[var.Name()] = output.second->Shape().SubShape(0, var.Shape().Rank());
+            }
+        }
+        catch (...)
+        {
+            for (const auto& request : batch)
+                request->m_done.set_exception(current_exception());
+            return;
+        }
+
+        for (size_t s = 0; s < batch.size(); ++s)
+        {
+            auto& request = *batch[s];
+            try
+            {
+                const auto numOutputs = request.m_outputNames.size();
+                CNTK_Value* buffers = *request.m_outputValues;
+
+                auto arrayValueCleaner = std::bind(CleanAndDestroyValues, _1, numOutputs);
+                unique_ptr<CNTK_Value, decltype(arrayValueCleaner)> result(nullptr, arrayValueCleaner);
+                if (buffers == nullptr)
+                {
+                    result.reset(new CNTK_Value[numOutputs]);
+                    memset(result.get(), 0, sizeof(CNTK_Value) * numOutputs);
+                }
+
+                for (size_t i = 0; i < numOutputs; ++i)
+                {
+                    const auto& name = request.m_outputNames[i];
+                    const auto& data = sequences[name][s];
+
+                    if (buffers != nullptr) // Buffer has been preallocated.
+                    {
+                        if (ToNDShape(buffers[i].shape).TotalSize() != data.size())
+                            RuntimeError("Preallocated buffer for output '%ls' does not match the size '%d' of the evaluated value.", name.c_str(), (int)data.size());
+                        std::copy(data.begin(), data.end(), buffers[i].data);
+                        continue;
+                    }
+
+                    // Same layout as the value of a single sequence: the sample, the sequence axis if any, and a batch axis of 1.
+                    const auto& sampleShape = sampleShapes[name];
+                    auto shape = sampleShape;
+                    if (m_outputs.at(name).DynamicAxes().size() > 1)
+                        shape = shape.AppendShape({ data.size() / std::max<size_t>(sampleShape.TotalSize(), 1) });
+                    shape = shape.AppendShape({ 1 });
+
+                    // Making sure with cleaners we do not leak anything on exception.
+                    CNTK_Value v{ { 0, 0 }, 0 };
+                    unique_ptr<CNTK_Value, decltype(&CNTK_CleanValue)> valCleaner(&v, CNTK_CleanValue);
+                    v.shape = FromNDShape(shape);
+                    v.data = new float[data.size()];
+                    std::copy(data.begin(), data.end(), v.data);
+                    result.get()[i] = v;
+                    valCleaner.release();
+                }
+
+                if (buffers == nullptr)
+                    *request.m_outputValues = result.release();
+                request.m_done.set_value();
+            }
+            catch (...)
+            {
+                request.m_done.set_exception(current_exception());
+            }
+        }
+    }
+
+    unique_ptr<EvaluatorWrapper> BatchingEvaluatorWrapper::Clone(CNTK_ParameterCloningMethod method, bool flatten)
+    {
+        FunctionPtr cloned;
+        if (flatten)
+            cloned = m_func->CloneFlattened(ToNative(method));
+        else
+            cloned = m_func->Clone(ToNative(method));
+        return unique_ptr<EvaluatorWrapper>(new BatchingEvaluatorWrapper(cloned, m_device, m_maxBatchSize, m_maxLatency));
+    }
 }
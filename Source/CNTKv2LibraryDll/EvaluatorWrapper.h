@@ -6,8 +6,17 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <boost/noncopyable.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 #include <functional>
 
@@ -155,6 +164,76 @@ namespace CNTK
         std::unordered_map<std::wstring, Variable> m_arguments;
         std::unordered_map<std::wstring, Variable> m_outputs;
     };
+
+    //
+    // An evaluator that coalesces concurrent EvaluateSequence calls into a single minibatch.
+    // Calls are queued and evaluated by a worker thread, up to maxBatchSize sequences per Forward.
+    // The oldest queued request waits at most maxLatency for the minibatch to fill up.
+    // Only sequences starting with a reset are accepted, since there is no recurrent state per caller.
+    //
+    class BatchingEvaluatorWrapper : public EvaluatorWrapper
+    {
+    public:
+        BatchingEvaluatorWrapper(const wchar_t* modelFilePath, const CNTK_DeviceDescriptor* device, size_t maxBatchSize, std::chrono::microseconds maxLatency);
+        BatchingEvaluatorWrapper(FunctionPtr model, DeviceDescriptor device, size_t maxBatchSize, std::chrono::microseconds maxLatency);
+        ~BatchingEvaluatorWrapper();
+
+        void GetModelArgumentsInfo(CNTK_Variable** inputs, uint32_t* numInputs) override;
+        void GetModelOutputsInfo(CNTK_Variable** outputs, uint32_t* numOutputs) override;
+
+        std::unique_ptr<EvaluatorWrapper> Clone(CNTK_ParameterCloningMethod method, bool flatten) override;
+
+        void EvaluateSequence(
+            const CNTK_Variable* inputs,
+            const CNTK_Value* inputValues,
+            const bool* inputResetFlags,
+            uint32_t numInputs,
+            const CNTK_Variable* outputs,
+            uint32_t numOutputs,
+            CNTK_Value** outputValues) override;
+
+        // Number of minibatches evaluated so far.
+        size_t NumEvaluatedBatches() const { return m_numEvaluatedBatches; }
+
+    private:
+        struct RequestInput
+        {
+            NDShape m_sampleShape;
+            std::vector<float> m_data;
+        };
+
+        struct Request
+        {
+            std::map<std::wstring, RequestInput> m_inputs;
+            std::vector<std::wstring> m_outputNames;   // In the order of the caller's output values.
+            std::set<std::wstring> m_outputNameSet;
+            CNTK_Value** m_outputValues;
+            std::chrono::steady_clock::time_point m_arrival;
+            std::promise<void> m_done;
+
+            // Requests can share a minibatch if they bind the same inputs with the same sample shapes and ask for the same outputs.
+            bool IsCompatibleWith(const Request& other) const;
+        };
+        typedef std::shared_ptr<Request> RequestPtr;
+
+        void ProcessRequests();
+        void EvaluateBatch(const std::vector<RequestPtr>& batch);
+
+        FunctionPtr m_func;
+        DeviceDescriptor m_device;
+        std::unordered_map<std::wstring, Variable> m_arguments;
+        std::unordered_map<std::wstring, Variable> m_outputs;
+
+        const size_t m_maxBatchSize;
+        const std::chrono::microseconds m_maxLatency;
+
+        std::mutex m_mutex;
+        std::condition_variable m_requestAvailable;
+        std::deque<RequestPtr> m_queue;
+        bool m_stopped;
+        std::atomic<size_t> m_numEvaluatedBatches;
+        std::thread m_worker;
+    };
 }
 
 //#pragma warning(pop)
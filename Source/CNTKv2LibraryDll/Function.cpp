@@ -481,6 +481,13 @@ namespace CNTK
             break;
         }
 
+        case ModelFormat::CNTKv2RawTensors:
+        {
+            Dictionary model = Serialize();
+            model.SaveWithRawTensors(filepath);
+            break;
+        }
+
         case ModelFormat::ONNX:
         {
             ONNXFormat::Save(RootFunction(), filepath);
@@ -494,6 +501,7 @@ namespace CNTK
         switch (format)
         {
         case ModelFormat::CNTKv2:
+        case ModelFormat::CNTKv2RawTensors: // (detected from the file contents)
         {
             auto stream = GetFstream(filepath, true);
             if (!Internal::IsLegacyModel(*stream))
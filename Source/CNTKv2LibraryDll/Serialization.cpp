@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <limits>
+#include <algorithm>
 
 #ifdef _MSC_VER
 #include <io.h>
@@ -29,8 +30,26 @@ namespace CNTK
     using namespace ::google::protobuf;
 
     static const uint32 MAGIC_NUMBER = 0x636e746bU;
+    static const uint32 RAW_TENSORS_MAGIC_NUMBER = 0x636e7472U;
+    static const uint32 RAW_TENSORS_FORMAT_VERSION = 1;
     static const uint32 BLOCK_SIZE = 8 << 10; // 8Kb;
 
+    // Raw-tensor format layout:
+    //   uint32 RAW_TENSORS_MAGIC_NUMBER, uint32 RAW_TENSORS_FORMAT_VERSION, uint64 metadata byte size (all little-endian)
+    //   metadata protobuf (NDArrayViews carry only a raw_data_offset, no values)
+    //   zero padding up to the next RAW_TENSORS_PAGE_ALIGNMENT boundary (relative to the start of the magic number)
+    //   payload section: the raw contents of each NDArrayView at its raw_data_offset
+    // Payloads of at least a page are page-aligned, smaller ones are aligned to a cache line.
+    // Payloads are in host byte order, which is little-endian on all platforms supported by CNTK.
+    static const size_t RAW_TENSORS_HEADER_SIZE = 2 * sizeof(uint32) + sizeof(uint64);
+    static const size_t RAW_TENSORS_PAGE_ALIGNMENT = 4096;
+    static const size_t RAW_TENSORS_MIN_ALIGNMENT = 64;
+
+    static inline uint64 AlignUp(uint64 offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
     static void SetUTF8Locale()
     {
 #ifndef _MSC_VER
@@ -124,8 +143,8 @@ namespace CNTK
         friend class Dictionary;
         friend class DictionaryValue;
 
-        Serializer(const Dictionary& dict);
-        Serializer(const DictionaryValue& dict);
+        Serializer(const Dictionary& dict, bool rawTensors = false);
+        Serializer(const DictionaryValue& dict, bool rawTensors = false);
 
         Serializer() = default;
 
@@ -141,6 +160,7 @@ namespace CNTK
         
         void CopyNDArrayViewDataToProtos();
         void WriteNDArrayViewData(io::CodedOutputStream& output);
+        void WriteWithRawTensors(io::ZeroCopyOutputStream& stream);
 
         std::ostream& Write(std::ostream& stream);
         void Write(const std::wstring& filename);
@@ -156,7 +176,9 @@ namespace CNTK
         bool Read(std::wstring filename, const std::function<bool(io::ZeroCopyInputStream& input)>& callback);
         bool Read(std::istream& stream, const std::function<bool(io::ZeroCopyInputStream& input)>& callback);
 
+        bool ParseMessage(io::ZeroCopyInputStream& input);
         bool ReadNDArrayViewData(io::ZeroCopyInputStream& input);
+        bool ReadRawNDArrayViewData(io::ZeroCopyInputStream& input);
 
         size_t GetTotalByteSize() 
         {
@@ -305,20 +327,56 @@ namespace CNTK
             }
         }
 
+        static size_t RawDataSize(const NDArrayView& view)
+        {
+            return view.Shape().TotalSize() * DataTypeSize(view.GetDataType());
+        }
+
+        static void* RawDataBuffer(NDArrayView& view)
+        {
+            switch (view.GetDataType())
+            {
+            case DataType::Float:   return view.WritableDataBuffer<float>();
+            case DataType::Double:  return view.WritableDataBuffer<double>();
+            case DataType::Float16: return view.WritableDataBuffer<float16>();
+            case DataType::Int8:    return view.WritableDataBuffer<int8_t>();
+            default: NOT_IMPLEMENTED;
+            }
+        }
+
+        static const void* RawDataBuffer(const NDArrayView& view)
+        {
+            switch (view.GetDataType())
+            {
+            case DataType::Float:   return view.DataBuffer<float>();
+            case DataType::Double:  return view.DataBuffer<double>();
+            case DataType::Float16: return view.DataBuffer<float16>();
+            case DataType::Int8:    return view.DataBuffer<int8_t>();
+            default: NOT_IMPLEMENTED;
+            }
+        }
+
         UsingUTF8 m_locale;
         Arena m_arena;
         Message* m_proto;
         std::vector<std::pair<NDArrayView*, proto::NDArrayView*>> m_arrayViews;
         size_t m_byteSize {0};
+
+        // raw-tensor format
+        bool m_rawTensors {false};
+        uint64 m_metadataSize {0};
+        std::vector<std::pair<uint64, NDArrayView*>> m_rawArrayViews; // [(payload offset, array view)], when reading
     };
 
 
-    Serializer::Serializer(const Dictionary& dict) 
+    Serializer::Serializer(const Dictionary& dict, bool rawTensors)
+        : m_rawTensors(rawTensors)
     {
         m_proto = CreateProto(dict, &m_arena);
     }
 
-    Serializer::Serializer(const DictionaryValue& value)
+    Serializer::Serializer(const DictionaryValue& value, bool rawTensors)
+        : m_rawTensors(rawTensors)
     {
         m_proto = CreateProto(value, &m_arena);
     }
@@ -374,6 +432,9 @@ namespace CNTK
 
     bool Serializer::ReadNDArrayViewData(io::ZeroCopyInputStream& input)
     {
+        if (m_rawTensors)
+            return ReadRawNDArrayViewData(input);
+
         if (m_arrayViews.size() == 0)
             return true;
 
@@ -405,6 +466,53 @@ namespace CNTK
         return true;
     }
 
+    bool Serializer::ReadRawNDArrayViewData(io::ZeroCopyInputStream& input)
+    {
+        // payloads are stored in offset order, so they can be read in one sequential pass
+        std::sort(m_rawArrayViews.begin(), m_rawArrayViews.end(),
+                  [](const std::pair<uint64, NDArrayView*>& a, const std::pair<uint64, NDArrayView*>& b) { return a.first < b.first; });
+
+        // skip to the payload section
+        uint64 position = RAW_TENSORS_HEADER_SIZE + m_metadataSize;
+        uint64 payloadStart = AlignUp(position, RAW_TENSORS_PAGE_ALIGNMENT);
+        if (!input.Skip((int)(payloadStart - position)))
+            return false;
+
+        position = 0; // now relative to the payload section
+        for (auto& pair : m_rawArrayViews)
+        {
+            if (pair.first < position)
+                return false; // overlapping payloads, file is corrupt
+            for (uint64 toSkip = pair.first - position; toSkip > 0;)
+            {
+                int n = (int)std::min<uint64>(toSkip, INT_MAX);
+                if (!input.Skip(n))
+                    return false;
+                toSkip -= n;
+            }
+            position = pair.first;
+
+            auto& dst = *pair.second;
+            char* buffer = static_cast<char*>(RawDataBuffer(dst));
+            size_t remaining = RawDataSize(dst);
+            while (remaining > 0)
+            {
+                const void* data;
+                int size;
+                if (!input.Next(&data, &size))
+                    return false;
+                size_t n = std::min<size_t>(remaining, size);
+                memcpy(buffer, data, n);
+                if (n < size)
+                    input.BackUp((int)(size - n));
+                buffer += n;
+                remaining -= n;
+                position += n;
+            }
+        }
+        return true;
+    }
+
     proto::NDShape* Serializer::CreateProto(const NDShape& src, Arena* arena)
     {
         proto::NDShape* dst = (arena != nullptr) ? 
@@ -483,6 +591,12 @@ namespace CNTK
         auto storageFormat = FromProtoType(src.storage_format());
         NDArrayView* dst = new NDArrayView(dataType, storageFormat, *shape, DeviceDescriptor::CPUDevice());
 
+        if (m_rawTensors)
+        {
+            m_rawArrayViews.push_back({ src.raw_data_offset(), dst });
+            return dst;
+        }
+
         if (dataType == DataType::Float)
         {
             if (src.float_values().value().size() == shape->TotalSize())
@@ -674,6 +788,9 @@ namespace CNTK
     }
 
     void Serializer::Write(io::ZeroCopyOutputStream& stream) {
+        if (m_rawTensors)
+            return WriteWithRawTensors(stream);
+
         io::CodedOutputStream output(&stream);
 
         // Protobufs have a hard limit on the maximum message size(INT_MAX = 2GBs). 
@@ -695,6 +812,67 @@ namespace CNTK
         }
     }
 
+    void Serializer::WriteWithRawTensors(io::ZeroCopyOutputStream& stream)
+    {
+        // assign each payload its offset in the payload section; the metadata only stores these offsets
+        uint64 payloadSize = 0;
+        for (auto& pair : m_arrayViews)
+        {
+            auto numBytes = RawDataSize(*pair.first);
+            payloadSize = AlignUp(payloadSize, numBytes >= RAW_TENSORS_PAGE_ALIGNMENT ? RAW_TENSORS_PAGE_ALIGNMENT : RAW_TENSORS_MIN_ALIGNMENT);
+            pair.second->set_raw_data_offset(payloadSize);
+            payloadSize += numBytes;
+        }
+
+        auto metadataSize = m_proto->ByteSizeLong();
+        if (metadataSize >= static_cast<size_t>(INT_MAX))
+            RuntimeError("Metadata of the serialized Dictionary exceeds the protobuf message size limit (%zu bytes).", metadataSize);
+        {
+            io::CodedOutputStream output(&stream);
+            output.WriteLittleEndian32(RAW_TENSORS_MAGIC_NUMBER);
+            output.WriteLittleEndian32(RAW_TENSORS_FORMAT_VERSION);
+            output.WriteLittleEndian64(metadataSize);
+            m_proto->SerializeToCodedStream(&output);
+            if (output.HadError())
+                RuntimeError("Failed to write Dictionary metadata.");
+        }
+
+        // copy the payloads in bulk, zero-filling the alignment gaps
+        auto writeRaw = [&stream](const char* data, uint64 numBytes)
+        {
+            while (numBytes > 0)
+            {
+                void* buffer;
+                int size;
+                if (!stream.Next(&buffer, &size))
+                    RuntimeError("Failed to write NDArrayView payload.");
+                size_t n = std::min<uint64>(numBytes, size);
+                if (data)
+                {
+                    memcpy(buffer, data, n);
+                    data += n;
+                }
+                else
+                    memset(buffer, 0, n);
+                if (n < size)
+                    stream.BackUp((int)(size - n));
+                numBytes -= n;
+            }
+        };
+        uint64 position = RAW_TENSORS_HEADER_SIZE + metadataSize;
+        writeRaw(nullptr, AlignUp(position, RAW_TENSORS_PAGE_ALIGNMENT) - position);
+        position = 0;
+        for (auto& pair : m_arrayViews)
+        {
+            const auto& src = *pair.first;
+            auto offset = pair.second->raw_data_offset();
+            writeRaw(nullptr, offset - position);
+            auto numBytes = RawDataSize(src);
+            writeRaw(static_cast<const char*>(RawDataBuffer(src)), numBytes);
+            position = offset + numBytes;
+        }
+    }
+
     std::ostream& Serializer::Write(std::ostream& stream)
     {
         io::OstreamOutputStream output(&stream);
@@ -716,8 +894,9 @@ namespace CNTK
 #endif
     }
 
-    bool ParseMessage(io::ZeroCopyInputStream& input, Message& msg)
+    bool Serializer::ParseMessage(io::ZeroCopyInputStream& input)
     {
+        Message& msg = *m_proto;
         uint32 prefix = 0, limit = INT_MAX;;
         const void* temp;
         int size;
@@ -734,6 +913,30 @@ namespace CNTK
             io::CodedInputStream::ReadLittleEndian32FromArray(reinterpret_cast<const uint8*>(temp), &prefix);
         }
 
+        // raw-tensor format: header is followed by the metadata message
+        if (prefix == RAW_TENSORS_MAGIC_NUMBER)
+        {
+            if (size < RAW_TENSORS_HEADER_SIZE)
+                return false;
+            uint32 version;
+            io::CodedInputStream::ReadLittleEndian32FromArray(reinterpret_cast<const uint8*>(temp) + sizeof(prefix), &version);
+            if (version > RAW_TENSORS_FORMAT_VERSION)
+                RuntimeError("The serialized Dictionary has a newer raw-tensor format version (%d) than this CNTK version can handle (%d).", (int)version, (int)RAW_TENSORS_FORMAT_VERSION);
+            io::CodedInputStream::ReadLittleEndian64FromArray(reinterpret_cast<const uint8*>(temp) + 2 * sizeof(uint32), &m_metadataSize);
+            if (m_metadataSize >= static_cast<uint64>(INT_MAX))
+                return false;
+            m_rawTensors = true;
+            limit = (uint32)m_metadataSize;
+            input.BackUp(size - RAW_TENSORS_HEADER_SIZE);
+
+            io::CodedInputStream codedInput(&input);
+            codedInput.SetTotalBytesLimit(limit, limit);
+            auto metadataEnd = codedInput.PushLimit(limit);
+            bool success = msg.ParseFromCodedStream(&codedInput) && codedInput.ConsumedEntireMessage();
+            codedInput.PopLimit(metadataEnd);
+            return success;
+        }
+
         // the message is only prefixed with a magic number + message length,
         // if its size exceeds 2GBs.
         if (prefix == MAGIC_NUMBER) 
@@ -794,7 +997,7 @@ namespace CNTK
         auto fd = GetFileDescriptor(filename, true);
         {
             io::FileInputStream input(fd, BLOCK_SIZE);
-            result = ParseMessage(input, *m_proto);
+            result = ParseMessage(input);
             result = result && callback(input);
         }
 #ifdef _MSC_VER
@@ -808,7 +1011,7 @@ namespace CNTK
     bool Serializer::Read(std::istream& stream, const std::function<bool(io::ZeroCopyInputStream& input)>& callback)
     {
         io::IstreamInputStream input(&stream, BLOCK_SIZE);
-        if (ParseMessage(input, *m_proto))
+        if (ParseMessage(input))
         {
             return callback(input);
         }
@@ -835,6 +1038,11 @@ namespace CNTK
         Serializer(*this).Write(filename);
     }
 
+    void Dictionary::SaveWithRawTensors(const std::wstring& filename)
+    {
+        Serializer(*this, /*rawTensors=*/true).Write(filename);
+    }
+
     std::istream& operator>>(std::istream& stream, Dictionary& dictionary)
     {
         if (!Serializer(dictionary).Read(stream, dictionary)) 
@@ -17,12 +17,93 @@ namespace
     const std::wstring learnersPropertyName = L"Learners";
     const std::wstring externalStatePropertyName = L"ExternalState";
     const std::wstring distributedStatePropertyName = L"DistributedState";
+    const std::wstring modelChecksumPropertyName = L"ModelChecksum";
 
     // Version history:
     // 0 -- a version number before the versioning was introduced for the trainer's checkpoints.
     // 1 -- initial version: added a key-value pair for the checkpoint version info, added
     //      distributed state key to save all local state collected from distributed workers.
-    static const size_t trainerCheckpointVersion = 1;
+    // 2 -- added a checksum of the model file the checkpoint belongs to.
+    static const size_t trainerCheckpointVersion = 2;
+
+    // Writes a file through a temporary one that is synced to disk before it replaces the file.
+    void WriteFileAtomically(const std::wstring& filePath, const std::function<void(const std::wstring&)>& write)
+    {
+        std::wstring tempFilePath = filePath + L".tmp";
+        write(tempFilePath);
+
+        FILE* f = fopenOrDie(tempFilePath, L"r+b");
+        fsyncOrDie(f);
+        fcloseOrDie(f);
+
+        renameAtomicallyOrDie(tempFilePath, filePath);
+    }
+
+    // 64-bit FNV-1a hash.
+    class Checksum
+    {
+    public:
+        Checksum() : m_hash(14695981039346656037ull) {}
+
+        void Update(const unsigned char* data, size_t size)
+        {
+            for (size_t i = 0; i < size; i++)
+                m_hash = (m_hash ^ data[i]) * 1099511628211ull;
+        }
+
+        size_t Value() const { return (size_t)m_hash; }
+
+    private:
+        uint64_t m_hash;
+    };
+
+    // Stream buffer that forwards the written bytes to another one and computes their checksum on the way.
+    class ChecksumStreamBuffer : public std::streambuf
+    {
+    public:
+        explicit ChecksumStreamBuffer(std::streambuf* target) : m_target(target) {}
+
+        size_t Value() const { return m_checksum.Value(); }
+
+    protected:
+        virtual std::streamsize xsputn(const char* data, std::streamsize size) override
+        {
+            auto written = m_target->sputn(data, size);
+            m_checksum.Update(reinterpret_cast<const unsigned char*>(data), (size_t)written);
+            return written;
+        }
+
+        virtual int_type overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+
+            char ch = traits_type::to_char_type(c);
+            return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+        }
+
+        virtual int sync() override { return m_target->pubsync(); }
+
+    private:
+        std::streambuf* m_target;
+        Checksum m_checksum;
+    };
+
+    // Checksum of the content of a file.
+    size_t FileChecksum(const std::wstring& filePath)
+    {
+        Checksum checksum;
+        std::vector<unsigned char> buffer(1 << 20);
+        FILE* f = fopenOrDie(filePath, L"rb");
+        size_t n;
+        while ((n = fread(buffer.data(), 1, buffer.size(), f)) > 0)
+            checksum.Update(buffer.data(), n);
+        bool failed = ferror(f) != 0;
+        fcloseOrDie(f);
+        if (failed)
+            RuntimeError("Error reading file '%S'.", filePath.c_str());
+        return checksum.Value();
+    }
 }
 
 namespace CNTK
@@ -407,6 +488,7 @@ namespace CNTK
 
     void Trainer::SaveCheckpoint(const std::wstring& modelFilePath, Dictionary externalState)
     {
+        WaitForCheckpointWrites();
         auto learnersState = m_parameterLearners->CreateCheckpoint();
 
         if (!m_distributed)
@@ -439,33 +521,74 @@ namespace CNTK
         communicator->Barrier();
     }
 
+    void Trainer::SaveCheckpointInBackground(const std::wstring& modelFilePath, Dictionary externalState)
+    {
+        // Distributed checkpoints synchronize the workers around the writing of the files.
+        if (m_distributed)
+            return SaveCheckpoint(modelFilePath, externalState);
+
+        // Bound the checkpoints in flight to one; this also reports the errors of the previous one.
+        WaitForCheckpointWrites();
+
+        // Serializing the model and the learners copies the parameters and the learner state to the CPU, so training
+        // can continue to update them while the snapshot is written.
+        // The snapshots are shared with the writer, not copied: copying a Dictionary clones all its arrays.
+        auto model = std::make_shared<Dictionary>(m_combinedTrainingFunction->Serialize());
+        auto state = std::make_shared<Dictionary>(CheckpointState(m_parameterLearners->CreateCheckpoint(), externalState, {}));
+        m_checkpointWrite = std::async(std::launch::async, [modelFilePath, model, state]()
+        {
+            WriteCheckpoint(modelFilePath, *model, std::move(*state));
+        });
+    }
+
+    void Trainer::WaitForCheckpointWrites()
+    {
+        if (m_checkpointWrite.valid())
+            m_checkpointWrite.get();
+    }
+
     void Trainer::Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState)
     {
-        std::wstring tempModelFile = modelFilePath + L".tmp";
+        WriteCheckpoint(modelFilePath, m_combinedTrainingFunction->Serialize(), CheckpointState(learnerState, externalState, distributedState));
+    }
+
+    /*static*/ Dictionary Trainer::CheckpointState(const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState)
+    {
         Dictionary state;
         state[versionPropertyName] = trainerCheckpointVersion;
         state[learnersPropertyName] = learnerState;
         state[externalStatePropertyName] = externalState;
         state[distributedStatePropertyName] = distributedState;
+        return state;
+    }
 
-        m_combinedTrainingFunction->Save(tempModelFile);
-        std::wstring trainerStateCheckpointFilePath = GetTrainerStateCheckpointFilePath(modelFilePath);
-        std::wstring tempCheckpointFile = trainerStateCheckpointFilePath + L".tmp";
-
-        state.Save(tempCheckpointFile);
-
-        // The return value is ignored here.
-        _wunlink(modelFilePath.c_str());
-        _wunlink(trainerStateCheckpointFilePath.c_str());
-
-        renameOrDie(tempModelFile, modelFilePath);
-        renameOrDie(tempCheckpointFile, trainerStateCheckpointFilePath);
+    /*static*/ void Trainer::WriteCheckpoint(const std::wstring& modelFilePath, const Dictionary& model, Dictionary state)
+    {
+        // Each file is replaced in one step once its new content is on disk. A crash between the two replacements
+        // leaves the new model with the previous trainer state; the checksum of the model in the state detects that.
+        // The checksum of the model is computed while it is written, rather than by reading the file back.
+        size_t modelChecksum = 0;
+        WriteFileAtomically(modelFilePath, [&model, &modelChecksum](const std::wstring& filePath)
+        {
+            auto stream = GetFstream(filePath, false);
+            ChecksumStreamBuffer checksumBuffer(stream->rdbuf());
+            std::ostream checksumStream(&checksumBuffer);
+            checksumStream << model;
+            checksumStream.flush();
+            if (!checksumStream)
+                RuntimeError("Error writing file '%S'.", filePath.c_str());
+            modelChecksum = checksumBuffer.Value();
+        });
+        state[modelChecksumPropertyName] = modelChecksum;
+        WriteFileAtomically(GetTrainerStateCheckpointFilePath(modelFilePath), [&state](const std::wstring& filePath)
+        {
+            state.Save(filePath);
+        });
     }
 
     Dictionary Trainer::RestoreFromCheckpoint(const std::wstring& modelFilePath)
     {
-        // Restore the model's parameters
-        m_combinedTrainingFunction->Restore(modelFilePath);
+        WaitForCheckpointWrites();
 
         Dictionary checkpoint = Dictionary::Load(GetTrainerStateCheckpointFilePath(modelFilePath));
 
@@ -473,7 +596,14 @@ namespace CNTK
 
         if (checkpoint.Contains(versionPropertyName))
             version = checkpoint[versionPropertyName].Value<size_t>();
-        
+
+        if (version >= 2 && checkpoint[modelChecksumPropertyName].Value<size_t>() != FileChecksum(modelFilePath))
+            RuntimeError("Trainer: The checkpoint '%S' does not belong to the model '%S'; the writing of the checkpoint may have been interrupted.",
+                         GetTrainerStateCheckpointFilePath(modelFilePath).c_str(), modelFilePath.c_str());
+
+        // Restore the model's parameters
+        m_combinedTrainingFunction->Restore(modelFilePath);
+
         auto learnerState = checkpoint[learnersPropertyName].Value<std::vector<DictionaryValue>>();
         auto externalState = checkpoint[externalStatePropertyName].Value<Dictionary>();
 
@@ -5,9 +5,15 @@
 
 #include "stdafx.h"
 #include <boost/algorithm/string/predicate.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include "CNTKLibrary.h"
 #include "Utils.h"
+#include "Value.h"
 #include "fileutil.h"
 #include "PerformanceProfiler.h"
 
@@ -30,13 +36,221 @@ namespace CNTK
             mbSource->IsInfinite();
     }
 
+    // Reads training minibatches on a background thread into a ring of minibatch buffers, while the trainer works
+    // on the minibatch returned last. The source returns its minibatches in buffers that it reuses, so each minibatch
+    // is copied into the buffers of a slot of the ring; the buffers are allocated on the first use of a slot and then
+    // only resized.
+    // Minibatches are read with the parameters of the last request, which is what the training loop asks for in the
+    // steady state. When the next request differs (the minibatch size schedule changes, the distributed warm up ends,
+    // or the end of the data limits the size), or the source state is needed by a checkpoint or a cross validation,
+    // the reading is stopped and the source is rewound to the first minibatch that was not handed out, so that
+    // training sees exactly the minibatches it would see without prefetching.
+    class TrainingSession::MinibatchPrefetcher
+    {
+    public:
+        struct Request
+        {
+            size_t m_minibatchSize;
+            size_t m_workerRank;
+            size_t m_numberOfWorkers;
+
+            bool operator==(const Request& other) const
+            {
+                return m_minibatchSize == other.m_minibatchSize && m_workerRank == other.m_workerRank && m_numberOfWorkers == other.m_numberOfWorkers;
+            }
+        };
+
+        MinibatchPrefetcher(const MinibatchSourcePtr& source, const std::unordered_map<Variable, StreamInformation>& inputVarToStream, size_t depth, const DeviceDescriptor& device)
+            : m_source(source), m_varToStream(inputVarToStream), m_device(device), m_slots(depth + 1), m_first(0), m_numReady(0), m_inUse(false), m_stopping(false)
+        {
+        }
+
+        ~MinibatchPrefetcher()
+        {
+            Stop();
+        }
+
+        void GetNextMinibatch(const Request& request, std::unordered_map<Variable, ValuePtr>& minibatch, bool* pIsMinibatchAtSweepEnd)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // The trainer is done with the minibatch returned last.
+            if (m_inUse)
+            {
+                m_inUse = false;
+                m_first = (m_first + 1) % m_slots.size();
+                m_slotAvailable.notify_one();
+            }
+
+            for (;;)
+            {
+                if (!m_worker.joinable())
+                {
+                    m_request = request;
+                    m_stopping = false;
+                    m_worker = std::thread([this]() { ReadMinibatches(); });
+                }
+
+                m_minibatchReady.wait(lock, [this]() { return m_numReady > 0; });
+                if (m_slots[m_first].m_request == request)
+                    break;
+
+                // Read with outdated parameters; rewind and read again.
+                lock.unlock();
+                Stop();
+                lock.lock();
+            }
+
+            // Keep reading with the parameters of this request.
+            m_request = request;
+
+            auto& slot = m_slots[m_first];
+            m_numReady--;
+            m_inUse = true;
+            if (slot.m_error)
+            {
+                auto error = slot.m_error;
+                slot.m_error = nullptr;
+                lock.unlock();
+                Stop();
+                std::rethrow_exception(error);
+            }
+
+            minibatch = slot.m_minibatch;
+            if (pIsMinibatchAtSweepEnd != nullptr)
+                *pIsMinibatchAtSweepEnd = slot.m_isAtSweepEnd;
+        }
+
+        // Stops the reading thread and rewinds the source to the first minibatch that has not been returned yet.
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_slotAvailable.notify_one();
+            if (m_worker.joinable())
+                m_worker.join();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_inUse)
+            {
+                m_inUse = false;
+                m_first = (m_first + 1) % m_slots.size();
+            }
+            if (m_numReady > 0)
+                m_source->RestoreFromCheckpoint(m_slots[m_first].m_sourceState);
+            m_numReady = 0;
+            for (auto& slot : m_slots)
+                slot.m_minibatch.clear();
+        }
+
+    private:
+        struct Slot
+        {
+            Request m_request;
+            Dictionary m_sourceState; // state of the source before the minibatch was read
+            std::unordered_map<Variable, ValuePtr> m_minibatch;
+            bool m_isAtSweepEnd;
+            std::exception_ptr m_error;
+            std::unordered_map<Variable, std::pair<std::shared_ptr<Microsoft::MSR::CNTK::Matrix<float>>, Microsoft::MSR::CNTK::MBLayoutPtr>> m_buffers;
+        };
+
+        void ReadMinibatches()
+        {
+            for (;;)
+            {
+                Request request;
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_slotAvailable.wait(lock, [this]() { return m_stopping || m_numReady + (m_inUse ? 1 : 0) < m_slots.size(); });
+                    if (m_stopping)
+                        return;
+                    request = m_request;
+                    index = (m_first + (m_inUse ? 1 : 0) + m_numReady) % m_slots.size();
+                }
+
+                auto& slot = m_slots[index];
+                slot.m_request = request;
+                slot.m_minibatch.clear();
+                try
+                {
+                    slot.m_sourceState = m_source->GetCheckpointState();
+                    const auto& minibatchData = m_source->GetNextMinibatch(0 /*numberOfSequences*/, request.m_minibatchSize, request.m_numberOfWorkers, request.m_workerRank, m_device);
+                    slot.m_isAtSweepEnd = IsAtSweepEnd(minibatchData);
+                    if (!minibatchData.empty())
+                    {
+                        for (const auto& v : m_varToStream)
+                        {
+                            auto value = minibatchData.find(v.second);
+                            if (value == minibatchData.end())
+                                RuntimeError("Minibatch source cannot find a stream with name '%ls'", v.second.m_name.c_str());
+                            slot.m_minibatch.insert({ v.first, CopyToSlot(slot, v.first, value->second.data) });
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    slot.m_error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_numReady++;
+                m_minibatchReady.notify_one();
+                if (slot.m_error)
+                    return;
+            }
+        }
+
+        // Copies a value returned by the source into the buffers of the slot.
+        ValuePtr CopyToSlot(Slot& slot, const Variable& variable, const ValuePtr& value)
+        {
+            auto packedValue = std::dynamic_pointer_cast<PackedValue>(value);
+            if (!packedValue || !packedValue->IsPacked() || packedValue->GetDataType() != DataType::Float)
+                return value->DeepClone();
+
+            auto packedData = packedValue->PackedData<float>();
+            auto& buffer = slot.m_buffers[variable];
+            if (!buffer.first)
+            {
+                buffer.first = std::make_shared<Microsoft::MSR::CNTK::Matrix<float>>(0, 0, packedData.first->GetDeviceId(), packedData.first->GetMatrixType(), packedData.first->GetFormat());
+                buffer.second = std::make_shared<Microsoft::MSR::CNTK::MBLayout>();
+            }
+            buffer.first->SetValue(*packedData.first);
+            if (packedData.second)
+                buffer.second->CopyFrom(packedData.second);
+            return MakeSharedObject<PackedValue>(packedValue->SampleShape(), packedValue->DynamicAxes(), buffer.first, packedData.second ? buffer.second : nullptr, /*readOnly =*/ false);
+        }
+
+        const MinibatchSourcePtr m_source;
+        const std::unordered_map<Variable, StreamInformation> m_varToStream;
+        const DeviceDescriptor m_device;
+
+        // Ring of slots: m_first is the minibatch in use by the trainer (if m_inUse) or the next one to return,
+        // followed by m_numReady minibatches that are read.
+        std::vector<Slot> m_slots;
+        size_t m_first;
+        size_t m_numReady;
+        bool m_inUse;
+
+        Request m_request;
+        bool m_stopping;
+        std::mutex m_mutex;
+        std::condition_variable m_slotAvailable;
+        std::condition_variable m_minibatchReady;
+        std::thread m_worker;
+    };
+
     CheckpointConfig::CheckpointConfig(
         const std::wstring& checkPointFileName,
         size_t checkpointFrequency,
         DataUnit checkpointFrequencyUnit,
         bool restoreFromCheckpointIfExists,
-        bool preserveAllCheckpoints) :
+        bool preserveAllCheckpoints,
+        bool writeInBackground) :
         m_preserveAll(preserveAllCheckpoints),
+        m_writeInBackground(writeInBackground),
         m_restore(restoreFromCheckpointIfExists),
         m_fileName(checkPointFileName),
         m_frequency(checkpointFrequency),
@@ -126,7 +340,10 @@ namespace CNTK
         m_workerRank(0),
         m_numberOfWorkers(1),
         m_test(test),
-        m_mbSizeScaleFactor(1)
+        m_mbSizeScaleFactor(1),
+        m_prefetchDepth(0),
+        m_lastDataWaitTime(0),
+        m_totalDataWaitTime(0)
     {
         if (!m_trainer)
             InvalidArgument("Trainer must not be null.");
@@ -199,6 +416,9 @@ namespace CNTK
         if (IsInfinite(m_source, m_maxNumSamples))
             InvalidArgument("Train minibatch source must have a limited number of samples or sweeps.");
 
+        if (m_prefetchDepth > 0)
+            m_prefetcher = std::make_shared<MinibatchPrefetcher>(m_source, m_varToStream, m_prefetchDepth, computeDevice);
+
         // Main train loop.
         bool earlyExit = false;
         while (shouldTrain)
@@ -212,7 +432,10 @@ namespace CNTK
             bool isMinibatchAtSweepEnd;
             // Note that in case of distributed training we don't want to stop if the local minibatch
             // is empty - it is possible that the other workers are still processing their minibatches.
+            auto dataWaitStart = std::chrono::steady_clock::now();
             GetTrainingMinibatch(minibatch, &isMinibatchAtSweepEnd, samplesLeft, computeDevice);
+            m_lastDataWaitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - dataWaitStart).count();
+            m_totalDataWaitTime += m_lastDataWaitTime;
 
             // Train on the minibatch.
             OnMinibatchStart();
@@ -240,6 +463,10 @@ namespace CNTK
             }
         }
 
+        // Leave the source after the last minibatch trained on.
+        StopPrefetching();
+        m_prefetcher = nullptr;
+
         if (restoredNumberOfSamples != Trainer()->TotalNumberOfSamplesSeen())
         {
             // Let's do all actions on the last probably a partial data at the end.
@@ -252,6 +479,8 @@ namespace CNTK
             }
         }
 
+        Trainer()->WaitForCheckpointWrites();
+
         // In case of incremental - save final checkpoint.
         // This is required only when we keep all existing checkpoints, otherwise 
         // The checkpoint was already saved with the proper name.
@@ -274,6 +503,7 @@ namespace CNTK
         // training minibatch after CV will cause an exception.
         // Checkpoining currently drop intermediat buffers.
         // TODO: This is meant as a stop gap, the minibatch source should be properly drained instead.
+        StopPrefetching();
         auto state = m_source->GetCheckpointState();
 
         bool result = false;
@@ -362,7 +592,23 @@ namespace CNTK
 
         size_t mbSize = GetMinibatchSize() * scaleFactor;
         mbSize = (std::min)(mbSize, maxMbSize);
-        GetNextMinibatch(m_source, minibatch, m_varToStream, pIsMinibatchAtSweepEnd, mbSize, workerRank, numberOfWorkers, computeDevice);
+        if (m_prefetcher && mbSize != 0)
+            m_prefetcher->GetNextMinibatch({ mbSize, workerRank, numberOfWorkers }, minibatch, pIsMinibatchAtSweepEnd);
+        else
+            GetNextMinibatch(m_source, minibatch, m_varToStream, pIsMinibatchAtSweepEnd, mbSize, workerRank, numberOfWorkers, computeDevice);
+    }
+
+    void TrainingSession::SetMinibatchPrefetchDepth(size_t depth)
+    {
+        if (m_prefetcher)
+            LogicError("The minibatch prefetch depth cannot be changed during training.");
+        m_prefetchDepth = depth;
+    }
+
+    void TrainingSession::StopPrefetching()
+    {
+        if (m_prefetcher)
+            m_prefetcher->Stop();
     }
 
     void TrainingSession::GetCrossValidationMinibatch(std::unordered_map<Variable, ValuePtr>& minibatch, bool* pIsMinibatchAtSweepEnd, size_t maxMbSize, const DeviceDescriptor& computeDevice)
@@ -402,6 +648,7 @@ namespace CNTK
 
     void TrainingSession::RestoreFromCheckpoint(const std::wstring& checkpointFileName)
     {
+        StopPrefetching();
         Dictionary externalState = Trainer()->RestoreFromCheckpoint(checkpointFileName);
         m_source->RestoreFromCheckpoint(externalState[s_trainingMinibatchSource].Value<Dictionary>());
     }
@@ -409,18 +656,23 @@ namespace CNTK
     void TrainingSession::SaveCheckpoint(size_t currentIndex)
     {
         OnCheckpointStart(currentIndex);
+        StopPrefetching();
         Dictionary externalState;
         externalState[s_trainingMinibatchSource] = m_source->GetCheckpointState();
 
         wstring checkpointFile = m_checkpoint.m_fileName;
         if (m_checkpoint.m_preserveAll)
             checkpointFile += std::to_wstring(currentIndex);
-        Trainer()->SaveCheckpoint(checkpointFile, externalState);
+        if (m_checkpoint.m_writeInBackground)
+            Trainer()->SaveCheckpointInBackground(checkpointFile, externalState);
+        else
+            Trainer()->SaveCheckpoint(checkpointFile, externalState);
         OnCheckpointEnd(currentIndex);
     }
 
     void TrainingSession::SaveFinalCheckpoint()
     {
+        StopPrefetching();
         Dictionary externalState;
         externalState[s_trainingMinibatchSource] = m_source->GetCheckpointState();
         Trainer()->SaveCheckpoint(m_checkpoint.m_fileName, externalState);
@@ -192,8 +192,9 @@ namespace CNTK
         NDShape valueDataShape = fullyDefinedSampleShape.AppendShape({ maxSequenceLength, numSequences });
         if (numSequences == 1)
         {
+            // The copy goes directly to the target device.
             if (createNewCopy)
-                valueData = sequences[0]->DeepClone();
+                valueData = sequences[0]->DeepClone(device, readOnly);
             else
                 valueData = sequences[0];
 
@@ -310,15 +311,13 @@ namespace CNTK
                             batchData.size(), shapeSize, sampleShape.AsString().c_str());
 
         auto numOfSequences = batchData.size() / shapeSize;
-        std::vector<NDArrayViewPtr> sequencesView(numOfSequences);
-        for (size_t i = 0; i < numOfSequences; i++)
-        {
-            // Sequence length is 1.
-            auto sequenceDataShape = sampleShape.AppendShape({ 1 });
-            sequencesView[i] = MakeSharedObject<NDArrayView>(sequenceDataShape, batchData.data() + i * shapeSize, shapeSize, DeviceDescriptor::CPUDevice());
-        }
-        // Pass the empty seqStartFlags means all sequences have the start flag with true.
-        return Create(sampleShape, sequencesView, {}, device, readOnly, /*createNewCopy =*/ true);
+        if (numOfSequences == 0)
+            InvalidArgument("Value::CreateBatch: The number of samples must be > 0");
+
+        // The samples already are laid out as a batch of sequences of length 1, all of which start in this batch, so no mask is needed
+        // and a single copy to the target device suffices.
+        auto batchView = MakeSharedObject<NDArrayView>(sampleShape.AppendShape({ 1, numOfSequences }), batchData.data(), batchData.size(), DeviceDescriptor::CPUDevice());
+        return MakeSharedObject<Value>(batchView->DeepClone(device, readOnly));
     }
 
     template <typename ElementType>
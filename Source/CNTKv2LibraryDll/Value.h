@@ -60,6 +60,11 @@ namespace CNTK
         ///
         const std::vector<Axis>& DynamicAxes() const { return m_sampleDynamicAxes; }
 
+        ///
+        /// Returns the shape of a single sample of this packed value
+        ///
+        const NDShape& SampleShape() const { return m_sampleShape; }
+
         const NDShape& Shape() const override { return m_unpackedShape; }
         DeviceDescriptor Device() const override { return m_isPacked ? m_packedData->Device() : Value::Device(); }
         DataType GetDataType() const override { return m_isPacked ? m_packedData->GetDataType() : Value::GetDataType(); }
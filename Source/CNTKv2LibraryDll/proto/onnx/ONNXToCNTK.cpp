@@ -8,7 +8,12 @@
 #include "Utils.h"
 #include "Operators.h"
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 #include "RNNHelper.h"
 
 using namespace ONNXIR;
@@ -30,6 +35,13 @@ public:
                                                  ONNXToCNTKVariableMap &constructedNodeArgVariableMap,
                                                  const Graph *graph, const DeviceDescriptor &computeDevice);
 
+    //
+    // Convert the initializers of the graph to CNTK values on all cores before the graph conversion uses them,
+    // and drop the ones that the conversion did not take.
+    //
+    static void MaterializeInitializers(const Graph *graph);
+    static void ReleaseInitializers(const Graph *graph);
+
 private:
     static FunctionPtr CreateCNTKNode(const Node *node, const std::vector<Variable> &inputs,
                                       const DeviceDescriptor &computeDevice);
@@ -37,6 +49,7 @@ private:
     static Constant CreateConstant(const Node *node, const DeviceDescriptor &computeDevice);
     static Constant CreateConstant(const onnx::TensorProto &valueProto, const std::string &nodeName,
                                    const DeviceDescriptor &computeDevice);
+    static NDArrayViewPtr CreateCPUNDArrayView(const onnx::TensorProto &valueProto);
     static Variable CreateLeafVariableOrConstant(const NodeArg *nodeArg, const Node *parentNode, const Graph *graph,
                                                  const DeviceDescriptor &computeDevice);
     static std::vector<Variable> CreateRNNLeafVariableOrConstant(const NodeArg *nodeArg,
@@ -59,6 +72,10 @@ private:
     static std::vector<bool> FromTypeProtoAsBool(const onnx::TypeProto &tensorShape);
     static DataType FromONNXType(onnx::TypeProto type);
 
+    // Initializer values converted by MaterializeInitializers, until a constant takes them.
+    static std::mutex s_initializersMutex;
+    static std::unordered_map<const onnx::TensorProto *, NDArrayViewPtr> s_initializers;
+
     static NodeAttributes::const_iterator FindAttributeIterator(const Node *node,
                                                                 const string &attributeName, bool required);
     static bool HasNamedAttribute(const Node *node, const string &attributeName);
@@ -325,7 +342,7 @@ void RetrieveRawDataAsDouble(const onnx::TensorProto &valueProto)
     if (!raw_data.empty())
     {
         auto buff = raw_data.c_str();
-        for (int i = 0; i < raw_data.size(); i += 4)
+        for (int i = 0; i < raw_data.size(); i += 8)
         {
             double v = UnpackDouble(buff + i, i);
             p_mutable_double_data->Add(v);
@@ -365,132 +382,156 @@ Constant ONNXToCNTKHelper::CreateConstant(const Node *node, const DeviceDescript
     return CreateConstant(valueProto, node->Name(), computeDevice);
 }
 
-Constant ONNXToCNTKHelper::CreateConstant(const onnx::TensorProto &valueProto, const std::string &nodeName,
-                                          const DeviceDescriptor &computeDevice)
+// Copies the elements of a tensor, held either in the typed field or as little-endian raw data, in bulk.
+template <typename DType>
+static void CopyTensorProtoData(const onnx::TensorProto &valueProto, const ::google::protobuf::RepeatedField<DType> &typedData,
+                                DType *data, size_t totalSize)
 {
-    auto dataType = valueProto.data_type();
+    if (!typedData.empty())
+    {
+        if (typedData.size() != totalSize)
+            CNTK::RuntimeError("ONNX tensor '%s' has %d elements, expected %d.", valueProto.name().c_str(), (int) typedData.size(), (int) totalSize);
+        memcpy(data, typedData.data(), totalSize * sizeof(DType));
+        return;
+    }
 
+    const std::string &rawData = valueProto.raw_data();
+    if (rawData.size() != totalSize * sizeof(DType))
+        CNTK::RuntimeError("ONNX tensor '%s' has %d bytes of raw data, expected %d.", valueProto.name().c_str(), (int) rawData.size(), (int) (totalSize * sizeof(DType)));
+    memcpy(data, rawData.data(), rawData.size());
+    if (!IsLittleEndianOrder())
+    {
+        char *bytes = reinterpret_cast<char *>(data);
+        for (size_t index = 0; index < totalSize; index++)
+            std::reverse(bytes + index * sizeof(DType), bytes + (index + 1) * sizeof(DType));
+    }
+}
+
+NDArrayViewPtr ONNXToCNTKHelper::CreateCPUNDArrayView(const onnx::TensorProto &valueProto)
+{
     NDShape shape(std::vector<size_t>(valueProto.dims().begin(), valueProto.dims().end()));
 
     // the following code is to revert CNTKToONNXHelper::ToTensorShape.to restore a CNTK NDArray
+    // (ONNX tensors are row-major, so the data is in the order CNTK expects for the reversed shape).
     NDShape reversedShape = ReverseShape(shape);
-
     auto totalSize = shape.TotalSize();
 
-    switch (dataType)
+    switch (valueProto.data_type())
     {
     case TensorProto_DataType_FLOAT:
     {
-        float *data = new float[totalSize];
-        if (valueProto.float_data().empty())
-        {
-            RetrieveRawDataAsFloat(valueProto);
-        }
+        auto view = MakeSharedObject<NDArrayView>(DataType::Float, StorageFormat::Dense, reversedShape, DeviceDescriptor::CPUDevice());
+        CopyTensorProtoData(valueProto, valueProto.float_data(), view->WritableDataBuffer<float>(), totalSize);
+        return view;
+    }
+    case TensorProto_DataType_DOUBLE:
+    {
+        auto view = MakeSharedObject<NDArrayView>(DataType::Double, StorageFormat::Dense, reversedShape, DeviceDescriptor::CPUDevice());
+        CopyTensorProtoData(valueProto, valueProto.double_data(), view->WritableDataBuffer<double>(), totalSize);
+        return view;
+    }
+    default:
+        NOT_IMPLEMENTED;
+    }
+}
 
-        if (shape.Rank() <= 2)
-        {
-            for (size_t index = 0; index < totalSize; index++)
-            {
-                data[index] = valueProto.float_data()[index];
-            }
-        }
-        else
-        {
-            int outputChannels = shape[0], inputChanndels = shape[1];
-            NDShape channelKernelShape(std::vector<size_t>(shape.Dimensions().begin() + 2, shape.Dimensions().end()));
-            NDShape channelReversedShape = ReverseShape(channelKernelShape);
-            int channelKernelSize = channelKernelShape.TotalSize();
-            for (int oC = 0; oC < outputChannels; oC++)
-            {
-                for (int iC = 0; iC < inputChanndels; iC++)
-                {
-                    int channelIndex = (oC * inputChanndels + iC);
-                    for (int pixel = 0; pixel < channelKernelSize; pixel++)
-                    {
-                        data[channelIndex * channelKernelSize + pixel] =
-                            valueProto.float_data()[channelIndex * channelKernelSize + pixel];
-                    }
-                }
-            }
-        }
+std::mutex ONNXToCNTKHelper::s_initializersMutex;
+std::unordered_map<const onnx::TensorProto *, NDArrayViewPtr> ONNXToCNTKHelper::s_initializers;
 
-        NDArrayViewPtr dstFinal(new NDArrayView(DataType::Float, reversedShape, &data[0],
-                                                totalSize * sizeof(float), computeDevice.CPUDevice()));
+void ONNXToCNTKHelper::MaterializeInitializers(const Graph *graph)
+{
+    // Only the initializers that CreateConstant takes, that is, inputs of nodes other than RNN ops:
+    // CreateRNNConstant converts the RNN weights from the tensors themselves.
+    std::vector<const onnx::TensorProto *> initializers;
+    std::unordered_set<const onnx::TensorProto *> added;
+    for (Graph::NodeIterator nodeIt = (const_cast<Graph *>(graph))->Nodes_begin();
+         nodeIt != (const_cast<Graph *>(graph))->Nodes_end(); ++nodeIt)
+    {
+        if (Operators::IsRNNOp((*nodeIt)->OpType()))
+            continue;
 
-        if (computeDevice.Type() == DeviceKind::CPU)
-        {
-            Constant constantVariable(dstFinal, ToWString(nodeName));
-            return constantVariable;
-        }
-        else
+        for (const auto &inputDef : (*nodeIt)->InputDefs())
         {
-            // this is the way to load values into GPU:
-            // Create a GPU NDArrayView and CopyFrom a CPU NDArrayView that holding the data.
-            NDArrayViewPtr dstFinalGPU(new NDArrayView(DataType::Float, StorageFormat::Dense, reversedShape, computeDevice));
-            dstFinalGPU->CopyFrom(*dstFinal);
-            Constant constantVariable(dstFinalGPU, ToWString(nodeName));
-            return constantVariable;
+            const onnx::TensorProto *initializer;
+            if (!graph->GetInitialTensor(inputDef.Name(), &initializer))
+                continue;
+
+            auto dataType = initializer->data_type();
+            if ((dataType == TensorProto_DataType_FLOAT || dataType == TensorProto_DataType_DOUBLE) && added.insert(initializer).second)
+                initializers.push_back(initializer);
         }
     }
-    break;
-    case TensorProto_DataType_DOUBLE:
-    {
-        // TODO: refactore commom code for float and double
-        double *data = new double[totalSize];
-        if (valueProto.double_data().empty())
-        {
-            RetrieveRawDataAsDouble(valueProto);
-        }
 
-        if (shape.Rank() <= 2)
+    std::vector<NDArrayViewPtr> views(initializers.size());
+    std::vector<std::exception_ptr> errors(initializers.size());
+    std::atomic<size_t> next(0);
+    auto convert = [&]()
+    {
+        for (size_t index = next++; index < initializers.size(); index = next++)
         {
-            for (size_t index = 0; index < totalSize; index++)
+            try
             {
-                data[index] = valueProto.double_data()[index];
+                views[index] = CreateCPUNDArrayView(*initializers[index]);
             }
-        }
-        else
-        {
-            int outputChannels = shape[0], inputChanndels = shape[1];
-            NDShape channelKernelShape(std::vector<size_t>(shape.Dimensions().begin() + 2, shape.Dimensions().end()));
-            NDShape channelReversedShape = ReverseShape(channelKernelShape);
-            int channelKernelSize = channelKernelShape.TotalSize();
-            for (int oC = 0; oC < outputChannels; oC++)
+            catch (...)
             {
-                for (int iC = 0; iC < inputChanndels; iC++)
-                {
-                    int channelIndex = (oC * inputChanndels + iC);
-                    for (int pixel = 0; pixel < channelKernelSize; pixel++)
-                    {
-                        data[channelIndex * channelKernelSize + pixel] =
-                            valueProto.double_data()[channelIndex * channelKernelSize + pixel];
-                    }
-                }
+                errors[index] = std::current_exception();
             }
         }
+    };
 
-        NDArrayViewPtr dstFinal(new NDArrayView(DataType::Double, reversedShape, &data[0],
-                                                totalSize * sizeof(double), computeDevice.CPUDevice()));
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), initializers.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; i++)
+        threads.emplace_back(convert);
+    convert();
+    for (auto &thread : threads)
+        thread.join();
 
-        if (computeDevice.Type() == DeviceKind::CPU)
-        {
-            Constant constantVariable(dstFinal, ToWString(nodeName));
-            return constantVariable;
-        }
-        else
+    for (const auto &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::lock_guard<std::mutex> lock(s_initializersMutex);
+    for (size_t index = 0; index < initializers.size(); index++)
+        s_initializers[initializers[index]] = views[index];
+}
+
+void ONNXToCNTKHelper::ReleaseInitializers(const Graph *graph)
+{
+    std::lock_guard<std::mutex> lock(s_initializersMutex);
+    for (const auto &initializer : graph->GetAllInitialTensors())
+        s_initializers.erase(initializer.second);
+}
+
+Constant ONNXToCNTKHelper::CreateConstant(const onnx::TensorProto &valueProto, const std::string &nodeName,
+                                          const DeviceDescriptor &computeDevice)
+{
+    // Take the value converted with the other initializers up front; an initializer used by more than one node
+    // is converted again for the other nodes, so that each constant owns its value.
+    NDArrayViewPtr cpuView;
+    {
+        std::lock_guard<std::mutex> lock(s_initializersMutex);
+        auto initializer = s_initializers.find(&valueProto);
+        if (initializer != s_initializers.end())
         {
-            // this is the way to load values into GPU:
-            // Create a GPU NDArrayView and CopyFrom a CPU NDArrayView that holding the data.
-            NDArrayViewPtr dstFinalGPU(new NDArrayView(DataType::Double, StorageFormat::Dense, reversedShape, computeDevice));
-            dstFinalGPU->CopyFrom(*dstFinal);
-            Constant constantVariable(dstFinalGPU, ToWString(nodeName));
-            return constantVariable;
+            cpuView = initializer->second;
+            s_initializers.erase(initializer);
         }
     }
-    break;
-    default:
-        NOT_IMPLEMENTED;
-    }
+    if (!cpuView)
+        cpuView = CreateCPUNDArrayView(valueProto);
+
+    if (computeDevice.Type() == DeviceKind::CPU)
+        return Constant(cpuView, ToWString(nodeName));
+
+    // this is the way to load values into GPU:
+    // Create a GPU NDArrayView and CopyFrom a CPU NDArrayView that holding the data.
+    NDArrayViewPtr gpuView(new NDArrayView(cpuView->GetDataType(), StorageFormat::Dense, cpuView->Shape(), computeDevice));
+    gpuView->CopyFrom(*cpuView);
+    return Constant(gpuView, ToWString(nodeName));
 }
 
 const Node *ONNXToCNTKHelper::GetChildNode(const Node *parentNode, const NodeArg *nodeArg)
@@ -2883,6 +2924,13 @@ FunctionPtr ONNXToCNTK::CreateGraph(ONNXIR::Graph *src, const DeviceDescriptor &
 {
     FunctionPtr cntkModel;
 
+    ONNXToCNTKHelper::MaterializeInitializers(src);
+    struct InitializersGuard
+    {
+        const Graph *m_graph;
+        ~InitializersGuard() { ONNXToCNTKHelper::ReleaseInitializers(m_graph); }
+    } initializersGuard = { src };
+
     // To use depth-first-traversal, keeps a collection of visited nodes.
     ONNXToCNTKMap constructedFunctions;
     ONNXToCNTKVariableMap constructedNodeArgVariableMap;
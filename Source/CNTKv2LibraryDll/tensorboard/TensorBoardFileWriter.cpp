@@ -6,6 +6,7 @@
 #include "stdafx.h"
 #include "CNTKLibraryInternals.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
@@ -74,11 +75,54 @@ namespace CNTK
             return record;
         }
 
+        // Fills a histogram with equally wide buckets between the smallest and the largest value.
+        template <typename ElementType>
+        static void FillHistogram(const ElementType* data, size_t count, tensorflow::HistogramProto& histogram)
+        {
+            const size_t maxNumBuckets = 30;
+            if (count == 0)
+                return;
+
+            auto minMax = std::minmax_element(data, data + count);
+            double min = static_cast<double>(*minMax.first);
+            double max = static_cast<double>(*minMax.second);
+            size_t numBuckets = max > min ? maxNumBuckets : 1;
+            double width = (max - min) / numBuckets;
+
+            std::vector<double> buckets(numBuckets, 0);
+            double sum = 0, sumSquares = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                double value = static_cast<double>(data[i]);
+                sum += value;
+                sumSquares += value * value;
+                size_t bucket = numBuckets > 1 ? static_cast<size_t>((value - min) / width) : 0;
+                buckets[std::min(bucket, numBuckets - 1)]++;
+            }
+
+            histogram.set_min(min);
+            histogram.set_max(max);
+            histogram.set_num(static_cast<double>(count));
+            histogram.set_sum(sum);
+            histogram.set_sum_squares(sumSquares);
+            for (size_t i = 0; i < numBuckets; i++)
+            {
+                histogram.add_bucket_limit(i + 1 < numBuckets ? min + (i + 1) * width : max);
+                histogram.add_bucket(buckets[i]);
+            }
+        }
+
         TensorBoardFileWriter::TensorBoardFileWriter(const std::wstring& dir, const FunctionPtr& modelToVisualize)
             : m_model(modelToVisualize),
             m_dir(dir),
             m_file(NULL),
-            m_fileName()
+            m_fileName(),
+            m_stepSamplingInterval(1),
+            m_writeInBackground(false),
+            m_maxQueuedRecords(0),
+            m_numDroppedRecords(0),
+            m_flushRequested(false),
+            m_stopRequested(false)
         {
         }
 
@@ -98,6 +142,10 @@ namespace CNTK
             m_file = fopenOrDie(ToString(filePath), "wb");
             m_fileName = filePath;
 
+            // The background writer flushes only on request, so let the records accumulate in a large buffer.
+            if (m_writeInBackground)
+                setvbuf(m_file, NULL, _IOFBF, 1 << 20);
+
             // Write the first record with the current version, and flush
             // right away so the file contents will be easily determined.
             WriteVersion(time);
@@ -107,21 +155,163 @@ namespace CNTK
                 WriteModel();
             }
 
-            Flush();
+            FlushFile();
         }
 
         void TensorBoardFileWriter::WriteValue(const std::wstring& name, float value, uint64_t step)
         {
-            tensorflow::Event event;
-            event.set_step(step);
-            event.set_wall_time(static_cast<double>(std::time(0)));
+            if (step % m_stepSamplingInterval != 0)
+                return;
 
-            tensorflow::Summary* summary = event.mutable_summary();
-            tensorflow::Summary::Value* summaryValue = summary->add_value();
-            summaryValue->set_tag(ToString(name));
-            summaryValue->set_simple_value(value);
+            auto wallTime = static_cast<double>(std::time(0));
+            PostRecord([name, value, step, wallTime]()
+            {
+                tensorflow::Event event;
+                event.set_step(step);
+                event.set_wall_time(wallTime);
 
-            WriteRecord(Serialize(event));
+                tensorflow::Summary* summary = event.mutable_summary();
+                tensorflow::Summary::Value* summaryValue = summary->add_value();
+                summaryValue->set_tag(ToString(name));
+                summaryValue->set_simple_value(value);
+
+                return Serialize(event);
+            });
+        }
+
+        void TensorBoardFileWriter::WriteHistogram(const std::wstring& name, NDArrayViewPtr values, uint64_t step)
+        {
+            assert(values != nullptr);
+            if (step % m_stepSamplingInterval != 0)
+                return;
+
+            if (values->IsSparse())
+                InvalidArgument("TensorBoardFileWriter: Histograms of sparse values are not supported.");
+
+            // The values can change once the caller continues; take a copy.
+            auto cpuValues = values->DeepClone(DeviceDescriptor::CPUDevice(), /*readOnly =*/ true);
+            auto wallTime = static_cast<double>(std::time(0));
+            PostRecord([name, cpuValues, step, wallTime]()
+            {
+                tensorflow::Event event;
+                event.set_step(step);
+                event.set_wall_time(wallTime);
+
+                tensorflow::Summary* summary = event.mutable_summary();
+                tensorflow::Summary::Value* summaryValue = summary->add_value();
+                summaryValue->set_tag(ToString(name));
+                tensorflow::HistogramProto* histogram = summaryValue->mutable_histo();
+
+                size_t count = cpuValues->Shape().TotalSize();
+                switch (cpuValues->GetDataType())
+                {
+                case DataType::Float:
+                    FillHistogram(cpuValues->DataBuffer<float>(), count, *histogram);
+                    break;
+
+                case DataType::Double:
+                    FillHistogram(cpuValues->DataBuffer<double>(), count, *histogram);
+                    break;
+
+                default:
+                    fprintf(stderr, "TensorBoardFileWriter: Unsupported data type: %d ", static_cast<int>(cpuValues->GetDataType()));
+                    break;
+                }
+
+                return Serialize(event);
+            });
+        }
+
+        void TensorBoardFileWriter::WriteInBackground(size_t maxQueuedRecords)
+        {
+            if (maxQueuedRecords == 0)
+                InvalidArgument("TensorBoardFileWriter: The maximum number of queued records must be positive.");
+
+            m_writeInBackground = true;
+            m_maxQueuedRecords = maxQueuedRecords;
+        }
+
+        void TensorBoardFileWriter::SetStepSamplingInterval(size_t interval)
+        {
+            if (interval == 0)
+                InvalidArgument("TensorBoardFileWriter: The step sampling interval must be positive.");
+
+            m_stepSamplingInterval = interval;
+        }
+
+        void TensorBoardFileWriter::PostRecord(std::function<std::string()>&& createRecord)
+        {
+            if (!m_writeInBackground)
+            {
+                WriteRecord(createRecord());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                if (!m_writer.joinable())
+                {
+                    m_stopRequested = false;
+                    m_writer = std::thread([this]() { WriteQueuedRecords(); });
+                }
+
+                if (m_queue.size() >= m_maxQueuedRecords)
+                {
+                    m_numDroppedRecords++;
+                    return;
+                }
+
+                m_queue.push_back(std::move(createRecord));
+            }
+            m_queueNotEmpty.notify_one();
+        }
+
+        void TensorBoardFileWriter::WriteQueuedRecords()
+        {
+            for (;;)
+            {
+                std::deque<std::function<std::string()>> records;
+                bool flush, stop;
+                {
+                    std::unique_lock<std::mutex> lock(m_queueMutex);
+                    m_queueNotEmpty.wait(lock, [this]() { return !m_queue.empty() || m_flushRequested || m_stopRequested; });
+                    records.swap(m_queue);
+                    flush = m_flushRequested;
+                    stop = m_stopRequested;
+                    m_flushRequested = false;
+                }
+
+                for (auto& createRecord : records)
+                {
+                    try
+                    {
+                        WriteRecord(createRecord());
+                    }
+                    catch (const std::exception& e)
+                    {
+                        // There is no caller to report to; the next record opens a new file.
+                        fprintf(stderr, "TensorBoardFileWriter: Dropping a record that could not be written (%s).\n", e.what());
+                    }
+                }
+
+                if (flush || stop)
+                    FlushFile();
+                if (stop)
+                    return;
+            }
+        }
+
+        void TensorBoardFileWriter::StopBackgroundWriting()
+        {
+            if (!m_writer.joinable())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                m_stopRequested = true;
+            }
+            m_queueNotEmpty.notify_one();
+            m_writer.join();
         }
 
         void TensorBoardFileWriter::WriteModel()
@@ -173,7 +363,7 @@ namespace CNTK
                 fprintf(stderr,
                     "TensorBoardFileWriter: Unable to write to the currently open file. "
                     "Subsequent writes will attempt to re-open a new one. (%ls)", m_fileName.c_str());
-                Close();
+                CloseFile();
                 throw;
             }
         }
@@ -183,8 +373,24 @@ namespace CNTK
         void TensorBoardFileWriter::WriteImage(const std::wstring& name, NDArrayViewPtr imageData, uint64_t step)
         {
             assert(imageData != nullptr);
+            if (step % m_stepSamplingInterval != 0)
+                return;
+
+            // The image is encoded by the writer; take a copy as the data can change once the caller continues.
+            if (m_writeInBackground)
+                imageData = imageData->DeepClone(DeviceDescriptor::CPUDevice(), /*readOnly =*/ false);
+            auto wallTime = static_cast<double>(std::time(0));
+            PostRecord([name, imageData, step, wallTime]()
+            {
+                return EncodeImages(name, imageData, step, wallTime);
+            });
+        }
+
+        /*static*/ std::string TensorBoardFileWriter::EncodeImages(const std::wstring& name, const NDArrayViewPtr& imageData, uint64_t step, double wallTime)
+        {
             tensorflow::Event event;
-            event.set_wall_time(static_cast<double>(std::time(0)));
+            event.set_step(step);
+            event.set_wall_time(wallTime);
             tensorflow::Summary* summary = event.mutable_summary();
 
             std::vector<size_t> dimensions = imageData->Shape().Dimensions();
@@ -233,8 +439,8 @@ namespace CNTK
                 string str(buffer.begin(), buffer.end());
                 summaryImage->set_encoded_image_string(str);
             }
-            
-            WriteRecord(Serialize(event));
+
+            return Serialize(event);
         }
 
 #endif // !CNTK_UWP
@@ -250,6 +456,27 @@ namespace CNTK
         }
 
         bool TensorBoardFileWriter::Flush()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                if (m_writer.joinable())
+                {
+                    m_flushRequested = true;
+                    m_queueNotEmpty.notify_one();
+                    return true;
+                }
+            }
+
+            return FlushFile();
+        }
+
+        bool TensorBoardFileWriter::Close()
+        {
+            StopBackgroundWriting();
+            return CloseFile();
+        }
+
+        bool TensorBoardFileWriter::FlushFile()
         {
             if (m_file == NULL)
             {
@@ -265,14 +492,14 @@ namespace CNTK
             return true;
         }
 
-        bool TensorBoardFileWriter::Close()
+        bool TensorBoardFileWriter::CloseFile()
         {
             if (m_file == NULL)
             {
                 return false;
             }
 
-            bool success = Flush();
+            bool success = FlushFile();
             if (fclose(m_file))
             {
                 fprintf(stderr,
@@ -27,6 +27,9 @@
 #endif
 #ifdef __unix__
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <linux/limits.h> // for PATH_MAX
 #endif
 
@@ -152,11 +155,17 @@ void File::Init(const wchar_t* filename, int fileOptions)
 #endif
     }
     else
+    {
         attempt([=]() // regular file: use a retry loop
                 {
                     m_file = fopenOrDie(filename, options.c_str());
                     m_seekable = true;
                 });
+#ifndef CNTK_UWP
+        if ((fileOptions & fileOptionsMemoryMapped) && reading && !writing && !appending && (fileOptions & fileOptionsBinary))
+            m_mapping = make_shared<MemoryMappedFile>(m_filename);
+#endif
+    }
 }
 
 // determine the directory for a given pathname
@@ -863,6 +872,159 @@ void File::SetPosition(uint64_t pos)
     fsetpos(m_file, pos);
 }
 
+// PutAlignedPayload - write a raw binary blob, optionally aligned to a page boundary
+// The blob is preceded by the number of padding bytes, followed by that many zero bytes.
+// data - pointer to the blob
+// numBytes - size of the blob
+void File::PutAlignedPayload(const void* data, size_t numBytes)
+{
+    if (IsTextBased())
+        LogicError("File: PutAlignedPayload() is only supported for binary files.");
+    size_t padding = 0;
+    if (m_options & fileOptionsAlignedPayloads)
+    {
+        const size_t pageSize = MemoryMappedFile::PageSize();
+        const uint64_t payloadPos = GetPosition() + sizeof(padding);
+        padding = (size_t)((pageSize - payloadPos % pageSize) % pageSize);
+    }
+    *this << padding;
+    static const char zeros[4096] = { 0 };
+    for (size_t remaining = padding; remaining > 0;)
+    {
+        const size_t n = min(remaining, sizeof(zeros));
+        fwriteOrDie(zeros, 1, n, m_file);
+        remaining -= n;
+    }
+    fwriteOrDie(data, 1, numBytes, m_file);
+}
+
+// GetAlignedPayload - read a raw binary blob written by PutAlignedPayload()
+// numBytes - size of the blob
+// buffer - where to read the blob to; or null to request a pointer into the memory mapping
+// returns - pointer to the blob, or null if 'buffer' is null and the blob cannot be accessed in-place
+void* File::GetAlignedPayload(size_t numBytes, void* buffer)
+{
+    if (IsTextBased())
+        LogicError("File: GetAlignedPayload() is only supported for binary files.");
+    const uint64_t startPos = GetPosition();
+    size_t padding;
+    *this >> padding;
+    const uint64_t payloadPos = GetPosition() + padding;
+    if (!buffer)
+    {
+        // only hand out pointers that are page-aligned, so that unmodified pages remain shared
+        if (!m_mapping || payloadPos % MemoryMappedFile::PageSize() != 0 || payloadPos + numBytes > m_mapping->Size())
+        {
+            SetPosition(startPos);
+            return nullptr;
+        }
+        SetPosition(payloadPos + numBytes);
+        return m_mapping->Data() + payloadPos;
+    }
+    if (m_mapping && payloadPos + numBytes <= m_mapping->Size()) // already mapped: avoid going through the stdio buffer
+    {
+        memcpy(buffer, m_mapping->Data() + payloadPos, numBytes);
+        SetPosition(payloadPos + numBytes);
+    }
+    else
+    {
+        if (padding > 0)
+            SetPosition(payloadPos);
+        freadOrDie(buffer, 1, numBytes, m_file);
+    }
+    return buffer;
+}
+
+// -----------------------------------------------------------------------
+// MemoryMappedFile
+// -----------------------------------------------------------------------
+
+MemoryMappedFile::MemoryMappedFile(const std::wstring& filename)
+    : m_data(nullptr), m_size(0)
+{
+#ifdef CNTK_UWP
+    RuntimeError("MemoryMappedFile: not supported for UWP");
+#elif defined(_WIN32)
+    m_fileHandle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+        RuntimeError("MemoryMappedFile: failed to open '%ls' (error %d)", filename.c_str(), (int)GetLastError());
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_fileHandle, &size))
+    {
+        CloseHandle(m_fileHandle);
+        RuntimeError("MemoryMappedFile: failed to get size of '%ls' (error %d)", filename.c_str(), (int)GetLastError());
+    }
+    m_size = (size_t)size.QuadPart;
+    m_mappingHandle = nullptr;
+    if (m_size == 0)
+        return;
+    m_mappingHandle = CreateFileMappingW(m_fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (m_mappingHandle)
+        m_data = (char*)MapViewOfFile(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    if (!m_data)
+    {
+        int err = (int)GetLastError();
+        if (m_mappingHandle)
+            CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+        RuntimeError("MemoryMappedFile: failed to map '%ls' (error %d)", filename.c_str(), err);
+    }
+#else
+    const auto path = msra::strfun::utf8(filename);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        RuntimeError("MemoryMappedFile: failed to open '%s': %s", path.c_str(), strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        int err = errno;
+        close(fd);
+        RuntimeError("MemoryMappedFile: failed to get size of '%s': %s", path.c_str(), strerror(err));
+    }
+    m_size = (size_t)st.st_size;
+    if (m_size > 0)
+    {
+        void* p = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            int err = errno;
+            close(fd);
+            RuntimeError("MemoryMappedFile: failed to map '%s': %s", path.c_str(), strerror(err));
+        }
+        m_data = (char*)p;
+    }
+    close(fd); // the mapping keeps its own reference to the file
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef CNTK_UWP
+#elif defined(_WIN32)
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+#else
+    if (m_data)
+        munmap(m_data, m_size);
+#endif
+}
+
+/*static*/ size_t MemoryMappedFile::PageSize()
+{
+    // Note: On Windows, views must start at the allocation granularity (64k), but page protection and
+    // sharing happen at page granularity, which is what matters for aligned payloads.
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
 // helper to load a matrix from a stream (file or string literal)
 // The input string is expected to contain one line per matrix row (natural printing order for humans).
 // Inputs:
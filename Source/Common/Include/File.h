@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <stdint.h>
+#include <memory>
 #ifdef _WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
@@ -38,6 +39,8 @@ enum FileOptions
     fileOptionsSequential = 32,                                 // optimize for sequential reads (allocates big buffer)
     fileOptionsReadWrite = fileOptionsRead | fileOptionsWrite,  // read/write mode
     fileOptionsAppend = 128,                                    // open in append mode
+    fileOptionsAlignedPayloads = 256,                           // write bulk payloads (PutAlignedPayload()) aligned to page boundaries
+    fileOptionsMemoryMapped = 512,                              // map the file into memory for zero-copy access to aligned payloads (binary read mode only)
 };
 
 // markers used for text files
@@ -94,6 +97,37 @@ static void attempt(const FUNCTION& body)
     // msra::util::attempt<FUNCTION> (retries, body);
 }
 
+// -----------------------------------------------------------------------
+// MemoryMappedFile -- an entire file mapped into memory
+// The mapping is copy-on-write: pages are shared with the OS page cache (and thus with all
+// other processes mapping the same file) until they are written to, at which point the
+// writing process gets a private copy. The file on disk is never modified.
+// -----------------------------------------------------------------------
+
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile(const std::wstring& filename);
+    ~MemoryMappedFile();
+
+    char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+    // granularity at which mappings are shared/copied; aligned payloads are aligned to this
+    static size_t PageSize();
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    HANDLE m_fileHandle;
+    HANDLE m_mappingHandle;
+#endif
+};
+
 class File
 {
 private:
@@ -102,6 +136,7 @@ private:
     bool m_pcloseNeeded; // was opened with popen(), use pclose() when destructing
     bool m_seekable;     // this stream is seekable
     int m_options;       // FileOptions ored togther
+    std::shared_ptr<MemoryMappedFile> m_mapping; // if opened with fileOptionsMemoryMapped
     void Init(const wchar_t* filename, int fileOptions);
 
 public:
@@ -120,6 +155,18 @@ public:
 
     bool IsTextBased();
 
+    // aligned payloads -- large raw binary blobs (e.g. matrix contents) that start on a page boundary
+    // If the file was opened with fileOptionsAlignedPayloads, the payload is preceded by zero padding up to the next
+    // page boundary; otherwise it is written unpadded. Either way, GetAlignedPayload() reads it back.
+    void PutAlignedPayload(const void* data, size_t numBytes);
+    bool HasAlignedPayloads() const { return (m_options & fileOptionsAlignedPayloads) && (m_options & fileOptionsBinary); }
+    // Reads a payload of 'numBytes' written by PutAlignedPayload() into 'buffer'.
+    // If 'buffer' is null, the file must be memory-mapped and the payload must be aligned; a pointer into the
+    // mapping is returned instead (valid as long as GetMemoryMapping() is held). Returns null if that is not possible,
+    // in which case the read position is left unchanged and the caller must retry with a buffer.
+    void* GetAlignedPayload(size_t numBytes, void* buffer);
+    const std::shared_ptr<MemoryMappedFile>& GetMemoryMapping() const { return m_mapping; }
+
     bool IsUnicodeBOM(bool skip = false);
     bool IsEOF();
     bool IsWhiteSpace(bool skip = false);
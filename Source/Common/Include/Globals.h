@@ -22,6 +22,10 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static void SetGradientAccumulationOptimization(bool enable) { m_optimizeGradientAccumulation = enable; }
         static bool ShouldOptimizeGradientAccumulation() { return m_optimizeGradientAccumulation; }
 
+        // release activations after forward prop and recompute them during backprop, to train larger models in the same memory
+        static void SetActivationRecomputation(bool enable) { m_recomputeActivations = enable; }
+        static bool ShouldRecomputeActivations() { return m_recomputeActivations; }
+
         // TODO: Currently the flag is set to false. Should be switched to true after more rigorous testing.
         static bool UseV2Aggregator() { return false; }
 
@@ -39,6 +43,7 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static std::atomic<bool> m_enableShareNodeValueMatrices;
         static std::atomic<bool> m_forceConstantRandomSeed;
         static std::atomic<bool> m_optimizeGradientAccumulation;
+        static std::atomic<bool> m_recomputeActivations;
         static std::atomic<bool> m_enableNodeTiming;
         static std::atomic<std::size_t> m_mpiPackThresholdInBytes;
     };
@@ -691,6 +691,26 @@ void renameOrDie(const std::wstring& from, const std::wstring& to)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+// renameAtomicallyOrDie(): rename() that replaces an existing destination in one step
+// ----------------------------------------------------------------------------
+
+void renameAtomicallyOrDie(const std::wstring& from, const std::wstring& to)
+{
+#ifdef _WIN32
+#if CNTK_UWP
+    to;
+    RuntimeError("error renaming file '%ls': Not supported in UWP", from.c_str());
+#else
+    if (!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        RuntimeError("error renaming file '%ls': %d", from.c_str(), GetLastError());
+#endif
+#else
+    if (rename(wtocharpath(from.c_str()).c_str(), wtocharpath(to.c_str()).c_str()) != 0)
+        RuntimeError("error renaming file '%ls': %s", from.c_str(), strerror(errno));
+#endif
+}
+
 // ----------------------------------------------------------------------------
 // copyOrDie(): copy file with error handling.
 // ----------------------------------------------------------------------------
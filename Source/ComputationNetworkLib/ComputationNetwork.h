@@ -59,6 +59,8 @@ public:
         m_randomSeedOffset(0),
         m_isCompiled(false),
         m_areMatricesAllocated(false),
+        m_memoryMappedLoading(false),
+        m_fuseRecurrentCells(false),
         m_pMBLayoutOfNetwork(make_shared<MBLayout>(1, 0, ComputationNodeBase::DefaultDynamicAxisName)),
         m_environment(make_shared<ComputationEnvironment>())
     {
@@ -107,6 +109,12 @@ public:
         auto modelVersion = GetModelVersion(fstream);
         ReadPersistableParameters<ElemType>(modelVersion, fstream, false);
     }
+    // Memory-mapped loading: If enabled, Read() maps the model file into memory, and the values of CPU parameters that were
+    // saved with fileOptionsAlignedPayloads are backed directly by that mapping instead of being copied into fresh buffers.
+    // The mapping is copy-on-write, so pages are shared with the OS page cache (and other processes) until a parameter is modified.
+    void SetMemoryMappedLoading(bool enable) { m_memoryMappedLoading = enable; }
+    bool GetMemoryMappedLoading() const { return m_memoryMappedLoading; }
+
     // design BUGBUG: binary files do not know whether they are float or double.
     // TODO: modify file format to know this; then eliminate the <ElemType> dependency (and in some future, allow nodes to be different)
     template <class ElemType> void Read(const std::wstring& fileName);
@@ -251,11 +259,32 @@ public:
     void CompileNetwork(); // call this after creation, Load(), and any modification
     void ValidateNetwork();
 
+    // Recurrent cell fusion: If enabled, CompileNetwork() replaces LSTM cells that were built from elementary
+    // operations (Slice, Sigmoid, Tanh, ElementTimes, Plus) by a single LSTMCellNode each. See FuseRecurrentCells().
+    void SetFuseRecurrentCells(bool enable) { m_fuseRecurrentCells = enable; }
+    bool GetFuseRecurrentCells() const { return m_fuseRecurrentCells; }
+
 private:
     size_t ValidateNodes(list<ComputationNodeBasePtr> nodes, bool isFirstPass, bool isFinalValidationPass);
     bool ValidateNode(ComputationNodeBasePtr node, bool isFinalValidationPass) const;
     void MarkValueNonSharableNodes();
     void ChangeNodeInputs(ComputationNodeBasePtr fromNode, ComputationNodeBasePtr toNode);
+    bool FuseRecurrentCells();
+    template <class ElemType> size_t FuseLSTMCells();
+    void ReplaceNodeInGroups(const ComputationNodeBasePtr& oldNode, const ComputationNodeBasePtr& newNode);
+    size_t RemoveUnreachableNodes(const std::vector<ComputationNodeBasePtr>& outputNodes);
+    size_t RemovePassThroughNodes();
+    template <class ElemType> size_t FoldBatchNormalization();
+    size_t MergeCommonSubexpressions();
+    size_t FoldConstants();
+
+public:
+    // Inference optimization: Rewrites the network into an equivalent one that is cheaper to evaluate, for models that
+    // are no longer trained. Batch normalization is folded into a preceding Times or Convolution, nodes that only matter
+    // for training (Dropout, StopGradient) are removed, duplicate subexpressions are merged, subgraphs that only depend on
+    // parameters are evaluated once and replaced by constants, and nodes not needed for 'outputNodes' are deleted.
+    // The network must be compiled but not have its matrices allocated yet; it is compiled again at the end.
+    void OptimizeForInference(const std::vector<ComputationNodeBasePtr>& outputNodes);
 
 private:
     void DetermineSetOfAllRoots();
@@ -268,12 +297,20 @@ private:
 public:
     void AllocateAllMatrices(const std::vector<ComputationNodeBasePtr>& evalRootNodes, const std::vector<ComputationNodeBasePtr>& outValueRootNodes, ComputationNodeBasePtr trainRootNode);
 
+    // Activation recomputation: the values of these nodes are not kept from forward prop until backprop needs them, but
+    // released and computed again during backprop, trading compute for memory. Nodes whose ForwardProp() cannot be
+    // repeated, or that are part of a loop, are kept. If no nodes are given, Globals::ShouldRecomputeActivations() selects
+    // them automatically. Must be called before AllocateAllMatrices().
+    void SetNodesToRecompute(const std::vector<ComputationNodeBasePtr>& nodes) { m_nodesToRecompute = std::unordered_set<ComputationNodeBasePtr>(nodes.begin(), nodes.end()); }
+
     // From the set of nodes extract all nodes which are used as accumulator nodes.
     std::set<ComputationNodeBasePtr> ExtractNodesWhichAccumulateResult(std::set<ComputationNodeBasePtr> nodes);
 
 private:
     void PrintMemorySharingStructure(const std::vector<ComputationNodeBasePtr>& nodes);
     void ReleaseMatricesAfterEvalForChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap);
+    void ReleaseMatricesBeforeEvalForInPlaceChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap);
+    size_t SelectValuesToRecompute(const ComputationNodeBasePtr& trainRootNode, std::unordered_map<ComputationNodeBasePtr, bool>& outputValueNeededDuringBackProp);
 
 public:
     // -----------------------------------------------------------------------
@@ -364,6 +401,8 @@ public:
         auto iter = m_evalOrders.find(rootNode);
         if (iter == m_evalOrders.end())
         {
+            if (!rootNode)
+                LogicError("GetEvalOrder: Called without prior call to FormEvalOrder() for the whole network");
             LogicError("GetEvalOrder: Called without prior call to FormEvalOrder() for %ls %ls operation", rootNode->NodeName().c_str(), rootNode->OperationName().c_str());
         }
         return iter->second;
@@ -1212,6 +1251,12 @@ protected:
         // There is currently no other constructor for inner nested PAR-traversed sub-networks, but there will be.
         PARTraversalFlowControlNode(const std::vector<shared_ptr<SEQTraversalFlowControlNode>>& recurrentInfo, const std::list<ComputationNodeBasePtr>& allNodes);
         // Base::m_nestedNodes contains all top-level nodes, in evaluation order
+
+        // activation recomputation: the nodes whose values are computed again before backprop of a top-level node, in evaluation order
+        void SetRecomputationBeforeBackprop(std::unordered_map<ComputationNodeBasePtr, std::vector<ComputationNodeBasePtr>>&& plan) { m_recomputeBeforeBackprop = std::move(plan); }
+
+    private:
+        std::unordered_map<ComputationNodeBasePtr, std::vector<ComputationNodeBasePtr>> m_recomputeBeforeBackprop;
     };
 
 public:
@@ -1272,6 +1317,9 @@ private:
     // cache for evaluation ordering:
     bool m_isCompiled; // CompileNetwork has been called
     bool m_areMatricesAllocated; // AllocateAllMatrices has been called
+    bool m_memoryMappedLoading;  // Read() memory-maps the model file
+    bool m_fuseRecurrentCells;   // CompileNetwork() fuses recurrent cells
+    std::unordered_set<ComputationNodeBasePtr> m_nodesToRecompute; // AllocateAllMatrices() releases these values after forward prop and recomputes them for backprop
 
     // cached network iterations
     std::map<const ComputationNodeBasePtr, std::list<ComputationNodeBasePtr>> m_evalOrders; // [out node] flat depth-first traversal starting from out node
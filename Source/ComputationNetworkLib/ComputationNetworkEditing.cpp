@@ -10,9 +10,18 @@
 #include "ComputationNetwork.h"
 #include "InputAndParamNodes.h"
 #include "TrainingNodes.h"
+#include "LinearAlgebraNodes.h"
+#include "NonlinearityNodes.h"
+#include "ReshapingNodes.h"
+#include "ConvolutionalNodes.h"
+#include "SpecialPurposeNodes.h"
+#include "RNNNodes.h"
+#include "MatrixPool.h"
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
+#include <set>
 
 using namespace std;
 
@@ -367,4 +376,593 @@ void ComputationNetwork::SetLearnableNodesBelowLearningRateMultiplier(const floa
     }
 }
 
+// -----------------------------------------------------------------------
+// recurrent cell fusion
+// -----------------------------------------------------------------------
+
+// Replace recurrent cells that are composed of elementary operations by fused cell nodes.
+// This is called by CompileNetwork() after validation, since matching requires the dimensions.
+// Returns true if the network was modified, in which case it must be compiled again.
+bool ComputationNetwork::FuseRecurrentCells()
+{
+    size_t numFused = FuseLSTMCells<float>() + FuseLSTMCells<double>() + FuseLSTMCells<half>();
+    if (numFused > 0 && TraceLevel() > 0)
+        fprintf(stderr, "FuseRecurrentCells: %d LSTM cells replaced by %ls nodes.\n", (int)numFused, OperationNameOf(LSTMCellNode).c_str());
+    return numFused > 0;
+}
+
+// Find LSTM cells of the form created by the Python layers library (without peepholes), i.e.
+//   it = Sigmoid (Slice (p, 0, d))
+//   bit = it .* Tanh (Slice (p, d, 2d))
+//   ft = Sigmoid (Slice (p, 2d, 3d))
+//   bft = ft .* dc
+//   ct = bft + bit
+//   ot = Sigmoid (Slice (p, 3d, 4d))
+//   ht = ot .* Tanh (ct)
+// (operands of .* and + in either order) and replace each by
+//   cell = LSTMCell (p, dc)
+//   ht = Slice (cell, 0, d)
+//   ct = Slice (cell, d, 2d)
+// The new Slice nodes take over the names, node-group memberships and consumers of ht and ct.
+// A cell is only fused if none of its intermediate nodes is used outside of it or is a member of a node group.
+template <class ElemType>
+size_t ComputationNetwork::FuseLSTMCells()
+{
+    // who consumes whom
+    map<ComputationNodeBasePtr, vector<ComputationNodeBasePtr>> consumers;
+    for (const auto& iter : m_nameToNodeMap)
+        for (const auto& input : iter.second->GetInputs())
+            consumers[input].push_back(iter.second);
+    set<ComputationNodeBasePtr> groupMembers;
+    for (auto group : GetAllNodeGroups())
+        groupMembers.insert(group->begin(), group->end());
+
+    // Slice of a single range along the first axis
+    let asGateSlice = [](const ComputationNodeBasePtr& node) -> shared_ptr<SliceNode<ElemType>>
+    {
+        auto slice = dynamic_pointer_cast<SliceNode<ElemType>>(node);
+        if (!slice || slice->Axis() != vector<int>{ 1 } || slice->StrideMultiplier() != vector<int>{ 1 })
+            return nullptr;
+        return slice;
+    };
+    // the given nonlinearity applied to such a Slice
+    let gateSliceOf = [&](const ComputationNodeBasePtr& node, const wstring& opName) -> shared_ptr<SliceNode<ElemType>>
+    {
+        if (node->OperationName() != opName || !dynamic_pointer_cast<ComputationNode<ElemType>>(node))
+            return nullptr;
+        return asGateSlice(node->GetInputs()[0]);
+    };
+
+    struct LSTMCellMatch
+    {
+        ComputationNodeBasePtr ht, ct, gatesIn, prevCell;
+        size_t cellDim;
+        vector<ComputationNodeBasePtr> internalNodes;
+    };
+    vector<LSTMCellMatch> matches;
+    set<ComputationNodeBasePtr> matchedNodes; // (cells must not overlap)
+
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        let& ht = iter.second;
+        if (ht->OperationName() != OperationNameOf(ElementTimesNode) || !dynamic_pointer_cast<ComputationNode<ElemType>>(ht))
+            continue;
+        for (size_t oIndex = 0; oIndex < 2; oIndex++)
+        {
+            let& ot = ht->GetInputs()[oIndex];
+            let& tanhCt = ht->GetInputs()[1 - oIndex];
+            auto oSlice = gateSliceOf(ot, OperationNameOf(SigmoidNode));
+            if (!oSlice || tanhCt->OperationName() != OperationNameOf(TanhNode))
+                continue;
+            let& ct = tanhCt->GetInputs()[0];
+            if (ct->OperationName() != OperationNameOf(PlusNode))
+                continue;
+
+            shared_ptr<SliceNode<ElemType>> iSlice, gSlice, fSlice;
+            ComputationNodeBasePtr it, gt, ft, bit, bft, prevCell;
+            for (size_t fIndex = 0; fIndex < 2 && !prevCell; fIndex++)
+            {
+                bft = ct->GetInputs()[fIndex];
+                bit = ct->GetInputs()[1 - fIndex];
+                if (bft->OperationName() != OperationNameOf(ElementTimesNode) || bit->OperationName() != OperationNameOf(ElementTimesNode))
+                    continue;
+                for (size_t k = 0; k < 2 && !iSlice; k++)
+                {
+                    it = bit->GetInputs()[k];
+                    gt = bit->GetInputs()[1 - k];
+                    iSlice = gateSliceOf(it, OperationNameOf(SigmoidNode));
+                    gSlice = gateSliceOf(gt, OperationNameOf(TanhNode));
+                    if (!gSlice)
+                        iSlice = nullptr;
+                }
+                for (size_t k = 0; k < 2 && iSlice && !prevCell; k++)
+                {
+                    ft = bft->GetInputs()[k];
+                    fSlice = gateSliceOf(ft, OperationNameOf(SigmoidNode));
+                    if (fSlice)
+                        prevCell = bft->GetInputs()[1 - k];
+                }
+                if (!prevCell)
+                    iSlice = nullptr;
+            }
+            if (!prevCell)
+                continue;
+
+            // all four gates must be consecutive slices of the same [4d] vector, in the order i, g, f, o
+            let& gatesIn = iSlice->GetInputs()[0];
+            if (gSlice->GetInputs()[0] != gatesIn || fSlice->GetInputs()[0] != gatesIn || oSlice->GetInputs()[0] != gatesIn)
+                continue;
+            let& gateLayout = gatesIn->GetSampleLayout();
+            let& cellLayout = prevCell->GetSampleLayout();
+            size_t d = cellLayout.GetNumElements();
+            if (gateLayout.GetRank() != 1 || cellLayout.GetRank() != 1 || gateLayout[0] != 4 * d || d == 0 ||
+                !gatesIn->HasMBLayout() || gatesIn->GetMBLayout() != prevCell->GetMBLayout() || ht->GetMBLayout() != gatesIn->GetMBLayout())
+                continue;
+            bool rangesMatch = true;
+            size_t k = 0;
+            for (const auto& slice : { iSlice, gSlice, fSlice, oSlice })
+            {
+                rangesMatch &= slice->BeginIndex(0) == k * d && slice->EndIndex(0) == (k + 1) * d;
+                k++;
+            }
+            if (!rangesMatch)
+                continue;
+
+            // the intermediate nodes must not be visible from the outside
+            vector<ComputationNodeBasePtr> internalNodes = { iSlice, gSlice, fSlice, oSlice, it, gt, ft, ot, bit, bft, tanhCt };
+            set<ComputationNodeBasePtr> cellNodes(internalNodes.begin(), internalNodes.end());
+            cellNodes.insert(ht);
+            cellNodes.insert(ct);
+            bool isSelfContained = cellNodes.size() == internalNodes.size() + 2;
+            for (const auto& node : internalNodes)
+            {
+                isSelfContained &= groupMembers.find(node) == groupMembers.end();
+                for (const auto& consumer : consumers[node])
+                    isSelfContained &= cellNodes.find(consumer) != cellNodes.end();
+            }
+            for (const auto& node : cellNodes)
+                isSelfContained &= matchedNodes.find(node) == matchedNodes.end();
+            if (!isSelfContained)
+                continue;
+
+            matchedNodes.insert(cellNodes.begin(), cellNodes.end());
+
+            matches.push_back(LSTMCellMatch{ ht, ct, gatesIn, prevCell, d, move(internalNodes) });
+            break;
+        }
+    }
+
+    for (const auto& match : matches)
+    {
+        wstring cellName = match.ht->NodeName() + L".cell";
+        while (NodeNameExists(cellName))
+            cellName = L"_" + cellName;
+        auto cell = AddNodeToNetAndAttachInputs(New<LSTMCellNode<ElemType>>(m_deviceId, cellName), { match.gatesIn, match.prevCell });
+
+        // replace ht and ct by slices of the fused node
+        for (size_t k = 0; k < 2; k++)
+        {
+            let oldNode = k == 0 ? match.ht : match.ct;
+            auto newNode = New<SliceNode<ElemType>>(m_deviceId, oldNode->NodeName(), vector<int>{ (int)(k * match.cellDim) }, vector<int>{ (int)((k + 1) * match.cellDim) });
+            ChangeNodeInputs(oldNode, newNode);
+            oldNode->DetachInputs();
+            RemoveNodeFromNet(oldNode);
+            AddNodeToNetAndAttachInputs(newNode, { cell });
+            ReplaceNodeInGroups(oldNode, newNode);
+        }
+
+        for (const auto& node : match.internalNodes)
+        {
+            node->DetachInputs();
+            RemoveNodeFromNet(node);
+        }
+    }
+    return matches.size();
+}
+
+// replace a node in all node groups, e.g. after it has been replaced by an equivalent one in the network
+void ComputationNetwork::ReplaceNodeInGroups(const ComputationNodeBasePtr& oldNode, const ComputationNodeBasePtr& newNode)
+{
+    for (auto groupIter : GetAllNodeGroups())
+    {
+        auto& group = *groupIter;
+        for (auto& node : group)
+            if (node == oldNode)
+                node = newNode;
+    }
+}
+
+// -----------------------------------------------------------------------
+// inference optimization
+// -----------------------------------------------------------------------
+
+void ComputationNetwork::OptimizeForInference(const std::vector<ComputationNodeBasePtr>& outputNodes)
+{
+    VerifyIsCompiled("OptimizeForInference");
+    if (AreMatricesAllocated())
+        LogicError("OptimizeForInference: Must be called before the network's matrices are allocated.");
+
+    // structural passes, only need the dimensions from the last validation
+    size_t numRemoved = RemoveUnreachableNodes(outputNodes);
+    size_t numPassThrough = RemovePassThroughNodes();
+    size_t numBatchNorm = FoldBatchNormalization<float>() + FoldBatchNormalization<double>();
+
+    // merging needs the evaluation order of the edited network
+    CompileNetwork();
+    size_t numMerged = MergeCommonSubexpressions();
+    CompileNetwork();
+
+    // constant folding evaluates nodes, so it needs a freshly compiled network
+    size_t numFolded = FoldConstants();
+    numRemoved += RemoveUnreachableNodes(outputNodes);
+    CompileNetwork();
+
+    if (TraceLevel() > 0)
+        fprintf(stderr, "OptimizeForInference: %d batch normalizations folded, %d pass-through nodes removed, %d common subexpressions merged, %d constant subgraphs folded, %d unused nodes removed.\n",
+                (int)numBatchNorm, (int)numPassThrough, (int)numMerged, (int)numFolded, (int)numRemoved);
+}
+
+// Delete all nodes that do not contribute to the given output nodes (or, if none are given, to any node in a node group).
+// With explicit output nodes, node groups are pruned to what remains.
+size_t ComputationNetwork::RemoveUnreachableNodes(const std::vector<ComputationNodeBasePtr>& outputNodes)
+{
+    list<ComputationNodeBasePtr> toVisit(outputNodes.begin(), outputNodes.end());
+    if (outputNodes.empty())
+        for (auto group : GetAllNodeGroups())
+            toVisit.insert(toVisit.end(), group->begin(), group->end());
+
+    set<ComputationNodeBasePtr> reachable;
+    while (!toVisit.empty())
+    {
+        auto node = toVisit.front();
+        toVisit.pop_front();
+        if (node && reachable.insert(node).second)
+            toVisit.insert(toVisit.end(), node->GetInputs().begin(), node->GetInputs().end());
+    }
+
+    vector<ComputationNodeBasePtr> unreachable;
+    for (const auto& iter : m_nameToNodeMap)
+        if (reachable.find(iter.second) == reachable.end())
+            unreachable.push_back(iter.second);
+    if (unreachable.empty())
+        return 0;
+
+    InvalidateCompiledNetwork();
+    for (auto groupIter : GetAllNodeGroups())
+    {
+        auto& group = *groupIter;
+        group.erase(remove_if(group.begin(), group.end(), [&](const ComputationNodeBasePtr& node) { return reachable.find(node) == reachable.end(); }), group.end());
+    }
+    for (const auto& node : unreachable)
+    {
+        node->DetachInputs();
+        RemoveNodeFromNet(node);
+    }
+    return unreachable.size();
+}
+
+// Dropout and StopGradient are the identity in inference; bypass them unless they are visible from the outside.
+size_t ComputationNetwork::RemovePassThroughNodes()
+{
+    set<ComputationNodeBasePtr> groupMembers;
+    for (auto group : GetAllNodeGroups())
+        groupMembers.insert(group->begin(), group->end());
+
+    vector<ComputationNodeBasePtr> passThroughNodes;
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        const auto& node = iter.second;
+        let& opName = node->OperationName();
+        if ((opName == OperationNameOf(DropoutNode) || opName == OperationNameOf(StopGradientNode) || opName == OperationNameOf(PassNode)) &&
+            node->GetNumInputs() == 1 && groupMembers.find(node) == groupMembers.end())
+            passThroughNodes.push_back(node);
+    }
+    if (passThroughNodes.empty())
+        return 0;
+
+    InvalidateCompiledNetwork();
+    for (const auto& node : passThroughNodes)
+    {
+        ChangeNodeInputs(node, node->Input(0));
+        node->DetachInputs();
+        RemoveNodeFromNet(node);
+    }
+    return passThroughNodes.size();
+}
+
+template <class ElemType>
+static vector<ElemType> CopyToHost(const Matrix<ElemType>& m)
+{
+    vector<ElemType> result(m.GetNumElements());
+    if (!result.empty())
+    {
+        ElemType* data = result.data();
+        size_t size = result.size();
+        m.CopyToArray(data, size);
+    }
+    return result;
+}
+
+// Fold inference-mode batch normalization into the preceding linear operation, i.e. turn
+//   y = BatchNormalization (Plus (P (W, x), b))   with P = Times or Convolution (b is optional)
+// into
+//   y = Plus (P (W', x), b')   with W' = W .* s and b' = (b - mean) .* s + beta, where s = scale / sqrt (var + epsilon)
+// with s broadcast along the input dimension of W. W is updated in place, so W, P, and the original Plus must not be
+// used anywhere else. For convolution, only CHW layout with spatial batch normalization is supported.
+template <class ElemType>
+size_t ComputationNetwork::FoldBatchNormalization()
+{
+    map<ComputationNodeBasePtr, vector<ComputationNodeBasePtr>> consumers;
+    for (const auto& iter : m_nameToNodeMap)
+        for (const auto& input : iter.second->GetInputs())
+            consumers[input].push_back(iter.second);
+    set<ComputationNodeBasePtr> groupMembers;
+    for (auto group : GetAllNodeGroups())
+        groupMembers.insert(group->begin(), group->end());
+    let isPrivateTo = [&](const ComputationNodeBasePtr& node, const ComputationNodeBasePtr& consumer)
+    {
+        return consumers[node].size() == 1 && consumers[node][0] == consumer && groupMembers.find(node) == groupMembers.end();
+    };
+
+    vector<ComputationNodeBasePtr> bnNodes;
+    for (const auto& iter : m_nameToNodeMap)
+        if (dynamic_pointer_cast<BatchNormalizationNode<ElemType>>(iter.second))
+            bnNodes.push_back(iter.second);
+
+    size_t numFolded = 0;
+    for (const auto& bn : bnNodes)
+    {
+        let bnNode = dynamic_pointer_cast<BatchNormalizationNode<ElemType>>(bn);
+        // match the pattern
+        ComputationNodeBasePtr product = bn->Input(0), oldPlus, oldBias;
+        if (product->OperationName() == OperationNameOf(PlusNode) && isPrivateTo(product, bn))
+        {
+            oldPlus = product;
+            for (size_t i = 0; i < 2; i++)
+            {
+                if (dynamic_pointer_cast<LearnableParameter<ElemType>>(oldPlus->Input(i)) && isPrivateTo(oldPlus->Input(i), oldPlus))
+                {
+                    oldBias = oldPlus->Input(i);
+                    product = oldPlus->Input(1 - i);
+                }
+            }
+            if (!oldBias)
+                continue;
+        }
+        let times = dynamic_pointer_cast<TimesNode<ElemType>>(product);
+        let conv = dynamic_pointer_cast<ConvolutionNode<ElemType>>(product);
+        if (!times && !(conv && conv->ImageLayout() == ImageLayoutKind::CHW && !conv->Transpose() && !conv->IsConvolution2D() && bnNode->Spatial()))
+            continue;
+        if (!isPrivateTo(product, oldPlus ? oldPlus : bn))
+            continue;
+        let weights = dynamic_pointer_cast<LearnableParameter<ElemType>>(product->Input(0));
+        if (!weights || !isPrivateTo(product->Input(0), product))
+            continue;
+        let scale = dynamic_pointer_cast<LearnableParameter<ElemType>>(bn->Input(1));
+        let beta  = dynamic_pointer_cast<LearnableParameter<ElemType>>(bn->Input(2));
+        let mean  = dynamic_pointer_cast<LearnableParameter<ElemType>>(bn->Input(3));
+        let var   = dynamic_pointer_cast<LearnableParameter<ElemType>>(bn->Input(4));
+        if (!scale || !beta || !mean || !var)
+            continue;
+        let numElementsOf = [](const ComputationNodeBasePtr& node) { return node->GetSampleLayout().GetNumElements(); };
+
+        // determine the channel of each output element of the product
+        let& outputLayout = product->GetSampleLayout();
+        size_t numOutputs = outputLayout.GetNumElements();
+        size_t numChannels = numElementsOf(bn->Input(1));
+        if (numChannels == 0 || numOutputs % numChannels != 0 || (!bnNode->Spatial() && numChannels != numOutputs) ||
+            numElementsOf(bn->Input(2)) != numChannels || numElementsOf(bn->Input(3)) != numChannels || numElementsOf(bn->Input(4)) != numChannels)
+            continue;
+        size_t numWeights = numElementsOf(product->Input(0));
+        TensorShape biasLayout = outputLayout;
+        if (conv)
+        {
+            // kernel is [kernel elements x maps], maps being the channels of the output
+            if (conv->MapCount().GetNumElements() != numChannels || outputLayout.GetRank() == 0 || outputLayout[outputLayout.GetRank() - 1] != numChannels)
+                continue;
+            SmallVector<size_t> biasDims(outputLayout.GetRank(), 1);
+            biasDims[biasDims.size() - 1] = numChannels;
+            biasLayout = TensorShape(biasDims);
+        }
+        else if (numWeights % numOutputs != 0) // W is [output dims x input dims]
+            continue;
+        size_t outputsPerChannel = numOutputs / numChannels;
+        if (oldBias)
+        {
+            // the old bias must be laid out like the new one (up to trailing singleton dimensions)
+            auto oldBiasLayout = oldBias->GetSampleLayout();
+            if (oldBiasLayout.GetRank() > biasLayout.GetRank())
+                continue;
+            oldBiasLayout.PadRankInPlace(biasLayout.GetRank());
+            if (oldBiasLayout != biasLayout)
+                continue;
+        }
+
+        // per-channel multiplier and offset
+        let scaleValues = CopyToHost(scale->Value());
+        let betaValues  = CopyToHost(beta->Value());
+        let meanValues  = CopyToHost(mean->Value());
+        let varValues   = CopyToHost(var->Value());
+        vector<double> multiplier(numChannels);
+        for (size_t c = 0; c < numChannels; c++)
+            multiplier[c] = scaleValues[c] / sqrt((double)varValues[c] + bnNode->Epsilon());
+
+        // scale W in place
+        auto weightValues = CopyToHost(weights->Value());
+        size_t weightsPerChannel = numWeights / numChannels;
+        for (size_t e = 0; e < numWeights; e++)
+            weightValues[e] = (ElemType)(weightValues[e] * multiplier[conv ? e / weightsPerChannel : (e % numOutputs) / outputsPerChannel]);
+        auto& weightMatrix = weights->Value();
+        weightMatrix.SetValue(weightMatrix.GetNumRows(), weightMatrix.GetNumCols(), weightMatrix.GetDeviceId(), weightValues.data());
+
+        // new bias
+        vector<ElemType> biasValues(biasLayout.GetNumElements());
+        vector<ElemType> oldBiasValues = oldBias ? CopyToHost(dynamic_pointer_cast<LearnableParameter<ElemType>>(oldBias)->Value()) : vector<ElemType>(biasValues.size(), 0);
+        for (size_t o = 0; o < biasValues.size(); o++)
+        {
+            size_t c = conv ? o : o / outputsPerChannel;
+            biasValues[o] = (ElemType)((oldBiasValues[o] - meanValues[c]) * multiplier[c] + betaValues[c]);
+        }
+        wstring biasName = bn->NodeName() + L".foldedBias";
+        while (NodeNameExists(biasName))
+            biasName = L"_" + biasName;
+        auto newBias = New<LearnableParameter<ElemType>>(m_deviceId, biasName, biasLayout);
+        newBias->Value().SetValue(biasLayout.GetNumElements(), 1, m_deviceId, biasValues.data());
+        AddNodeToNet(newBias)->SetLearningRateMultiplier(0);
+
+        // the new Plus takes over name, consumers, and node-group memberships of the BatchNormalization node
+        InvalidateCompiledNetwork();
+        auto newPlus = New<PlusNode<ElemType>>(m_deviceId, bn->NodeName());
+        ChangeNodeInputs(bn, newPlus);
+        bn->DetachInputs();
+        RemoveNodeFromNet(bn);
+        AddNodeToNetAndAttachInputs(newPlus, { product, newBias });
+        ReplaceNodeInGroups(bn, newPlus);
+        if (oldPlus)
+        {
+            oldPlus->DetachInputs();
+            RemoveNodeFromNet(oldPlus);
+            RemoveNodeFromNet(oldBias);
+        }
+        consumers[product] = { newPlus };
+        numFolded++;
+    }
+    return numFolded;
+}
+
+// Merge nodes that compute the same attribute-free operation of the same inputs.
+// Nodes that are members of a node group are never merged away.
+size_t ComputationNetwork::MergeCommonSubexpressions()
+{
+    static const set<wstring> mergeableOperations =
+    {
+        OperationNameOf(PlusNode), OperationNameOf(MinusNode), OperationNameOf(ElementTimesNode), OperationNameOf(LogPlusNode),
+        OperationNameOf(AbsNode), OperationNameOf(ExpNode), OperationNameOf(LogNode), OperationNameOf(NegateNode),
+        OperationNameOf(SqrtNode), OperationNameOf(ReciprocalNode), OperationNameOf(FloorNode), OperationNameOf(SigmoidNode),
+        OperationNameOf(StableSigmoidNode), OperationNameOf(TanhNode), OperationNameOf(RectifiedLinearNode), OperationNameOf(CosineNode),
+        OperationNameOf(SinNode), OperationNameOf(SoftmaxNode), OperationNameOf(LogSoftmaxNode), OperationNameOf(HardmaxNode)
+    };
+    set<ComputationNodeBasePtr> groupMembers;
+    for (auto group : GetAllNodeGroups())
+        groupMembers.insert(group->begin(), group->end());
+
+    // (the eval order visits inputs before their consumers, so merges propagate upwards in a single pass)
+    list<ComputationNodeBasePtr> evalOrder = GetEvalOrder(nullptr);
+    map<pair<wstring, vector<ComputationNodeBasePtr>>, ComputationNodeBasePtr> representatives;
+    size_t numMerged = 0;
+    for (const auto& node : evalOrder)
+    {
+        if (mergeableOperations.find(node->OperationName()) == mergeableOperations.end())
+            continue;
+        auto result = representatives.insert(make_pair(make_pair(node->OperationName(), node->GetInputs()), node));
+        if (result.second || groupMembers.find(node) != groupMembers.end())
+            continue;
+        InvalidateCompiledNetwork();
+        ChangeNodeInputs(node, result.first->second);
+        node->DetachInputs();
+        RemoveNodeFromNet(node);
+        numMerged++;
+    }
+    return numMerged;
+}
+
+// create a constant that holds the current value of 'node', or return nullptr if 'node' is not of type ElemType
+template <class ElemType>
+static ComputationNodeBasePtr CreateConstantFromValue(const ComputationNodeBasePtr& node, DEVICEID_TYPE deviceId)
+{
+    let typedNode = dynamic_pointer_cast<ComputationNode<ElemType>>(node);
+    if (!typedNode || typedNode->Value().GetMatrixType() != MatrixType::DENSE)
+        return nullptr;
+    auto constant = New<LearnableParameter<ElemType>>(deviceId, node->NodeName(), node->GetSampleLayout());
+    constant->Value().SetValue(typedNode->Value());
+    ComputationNodeBasePtr result = constant;
+    result->SetLearningRateMultiplier(0);
+    return result;
+}
+
+// Evaluate all subgraphs that only depend on parameters, and replace them by parameters holding their values
+// (with learning disabled). Nodes with a dynamic axis, random nodes, and stateful nodes are never constant.
+size_t ComputationNetwork::FoldConstants()
+{
+    map<ComputationNodeBasePtr, vector<ComputationNodeBasePtr>> consumers;
+    for (const auto& iter : m_nameToNodeMap)
+        for (const auto& input : iter.second->GetInputs())
+            consumers[input].push_back(iter.second);
+    set<ComputationNodeBasePtr> groupMembers;
+    for (auto group : GetAllNodeGroups())
+        groupMembers.insert(group->begin(), group->end());
+
+    // determine the constant nodes, in evaluation order
+    set<ComputationNodeBasePtr> constants;
+    vector<ComputationNodeBasePtr> nodesToEvaluate;
+    for (const auto& node : GetEvalOrder(nullptr))
+    {
+        bool isConstant;
+        if (node->OperationName() == OperationNameOf(LearnableParameter))
+            isConstant = true;
+        else
+        {
+            isConstant = !node->IsLeaf() && !node->HasMBLayout() && !node->RequiresPreCompute() &&
+                         !dynamic_pointer_cast<IRngUser>(node) && !dynamic_pointer_cast<IStatefulNode>(node);
+            for (const auto& input : node->GetInputs())
+                isConstant &= constants.find(input) != constants.end();
+            if (isConstant)
+                nodesToEvaluate.push_back(node);
+        }
+        if (isConstant)
+            constants.insert(node);
+    }
+
+    // only the constant nodes that are seen from the outside need to be replaced
+    vector<ComputationNodeBasePtr> constantRoots;
+    for (const auto& node : nodesToEvaluate)
+    {
+        bool isUsedOutside = groupMembers.find(node) != groupMembers.end();
+        for (const auto& consumer : consumers[node])
+            isUsedOutside |= constants.find(consumer) == constants.end();
+        if (isUsedOutside)
+            constantRoots.push_back(node);
+    }
+    if (constantRoots.empty())
+        return 0;
+
+    // evaluate them once, with their own (unshared) memory
+    // The pool only hands out matrices that the nodes own, so nothing refers to the pool once it is gone. The evaluated
+    // nodes are removed together with their matrices when they become unreachable below; any that stay get their matrices
+    // anew from the network's pool in AllocateAllMatrices().
+    let previousOperationMode = m_environment->SetOperationMode(NetworkOperationMode::inferring);
+    MatrixPool matrixPool;
+    matrixPool.Reset();
+    for (const auto& node : nodesToEvaluate)
+        node->RequestMatricesBeforeForwardProp(matrixPool);
+    matrixPool.OptimizedMemoryAllocation();
+    for (const auto& node : nodesToEvaluate)
+    {
+        node->BeginForwardProp();
+        node->ForwardProp(FrameRange(nullptr));
+        node->EndForwardProp();
+    }
+    m_environment->SetOperationMode(previousOperationMode);
+
+    size_t numFolded = 0;
+    InvalidateCompiledNetwork();
+    for (const auto& node : constantRoots)
+    {
+        auto constant = CreateConstantFromValue<float>(node, m_deviceId);
+        if (!constant)
+            constant = CreateConstantFromValue<double>(node, m_deviceId);
+        if (!constant)
+            constant = CreateConstantFromValue<half>(node, m_deviceId);
+        if (!constant)
+            continue;
+        ChangeNodeInputs(node, constant);
+        node->DetachInputs(); // (inputs that are no longer needed are removed as unreachable afterwards)
+        RemoveNodeFromNet(node);
+        AddNodeToNet(constant);
+        ReplaceNodeInGroups(node, constant);
+        numFolded++;
+    }
+    return numFolded;
+}
+
 }}}
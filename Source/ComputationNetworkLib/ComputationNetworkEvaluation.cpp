@@ -17,6 +17,8 @@
 #include <set>
 #include <algorithm>
 #include <map>
+#include <functional>
+#include <cmath>
 
 using namespace std;
 
@@ -184,6 +186,20 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
     {
         auto& node = *pnode;
 
+        // activation recomputation: compute the released values again that this node's backprop needs
+        auto recomputation = m_recomputeBeforeBackprop.find(node);
+        if (recomputation != m_recomputeBeforeBackprop.end())
+        {
+            for (auto& recomputedNode : recomputation->second)
+            {
+                recomputedNode->BeginForwardProp();
+                recomputedNode->BeginTiming(false /*backward*/);
+                recomputedNode->ForwardProp(fr.WithLayout(recomputedNode->GetMBLayout()));
+                recomputedNode->EndTiming(false /*backward*/);
+                recomputedNode->EndForwardProp();
+            }
+        }
+
         node->BeginBackprop();
         node->BeginTiming(true /*backward*/);
         node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
@@ -548,7 +564,9 @@ void ComputationNetwork::CompileNetwork()
     ValidateNetwork();
 
     // STEP: Optimize the network.
-    // :)
+    // Rewrites need the dimensions inferred above; if anything was rewritten, the steps above are redone for the result.
+    if (m_fuseRecurrentCells && FuseRecurrentCells())
+        return CompileNetwork();
 
     // STEP: Some final details.
     ResetEvalTimeStamps(); // invalidate all m_value fields. Really belongs into StartEvaluateMinibatchLoop()
@@ -1116,6 +1134,9 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         }
     }
 
+    // activation recomputation: select the values that are released after forward prop although backprop needs them
+    size_t numValuesToRecompute = performingBackPropagation ? SelectValuesToRecompute(trainRootNode, outputValueNeededDuringBackProp) : 0;
+
     // gradient reuse maps
     std::unordered_map<MatrixPool::AliasNodePtr, std::unordered_set<MatrixPool::AliasNodePtr>> gradientReuseChildrenMap;
     std::unordered_map<MatrixPool::AliasNodePtr, MatrixPool::AliasNodePtr> gradientReuseParentMap;
@@ -1154,7 +1175,7 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
 
     m_matrixPool.Reset();
 
-    TravserseInSortedGlobalEvalOrder(forwardPropRoots, [&outputValueNeededDuringBackProp, &parentsMap, this](const ComputationNodeBasePtr& node) {
+    TravserseInSortedGlobalEvalOrder(forwardPropRoots, [&outputValueNeededDuringBackProp, &parentsMap, performingBackPropagation, this](const ComputationNodeBasePtr& node) {
         if (node->Is<SEQTraversalFlowControlNode>())
         {
             auto seqTraversalFlowControlNode = node->As<SEQTraversalFlowControlNode>();
@@ -1169,6 +1190,9 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         else
         {
             node->SetOutputNeededDuringBackprop(outputValueNeededDuringBackProp[node]);
+            // for inference, elementwise operations may compute their value in place of an input that is no longer needed
+            if (!performingBackPropagation)
+                ReleaseMatricesBeforeEvalForInPlaceChildren(node, parentsMap);
             node->RequestMatricesBeforeForwardProp(m_matrixPool);
             // we only release matrices for the children since the root node's information will be used
             // and should not be shared with others
@@ -1230,6 +1254,35 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
 
         m_matrixPool.SetAliasInfo(compactGradientAliasMap, compactGradientAliasRootMap);
 
+        // activation recomputation: before the backprop of a node, request the released values it needs again, together
+        // with the released values they are computed from. These are recorded in evaluation order, to be recomputed at runtime.
+        std::unordered_map<ComputationNodeBasePtr, std::vector<ComputationNodeBasePtr>> recomputationPlan;
+        std::unordered_set<ComputationNodeBasePtr> recomputedValues;
+        std::function<void(const ComputationNodeBasePtr&, std::vector<ComputationNodeBasePtr>&)> recomputeValue =
+            [&](const ComputationNodeBasePtr& node, std::vector<ComputationNodeBasePtr>& recomputation)
+        {
+            if (!node->IsValueRecomputedDuringBackprop() || !recomputedValues.insert(node).second)
+                return;
+            for (const auto& input : node->GetInputs())
+                recomputeValue(input, recomputation);
+            if (node->RequestValueBeforeRecomputation(m_matrixPool))
+                recomputation.push_back(node);
+        };
+        auto recomputeValuesNeededBy = [&](const ComputationNodeBasePtr& node, const ComputationNodeBasePtr& executedNode)
+        {
+            if (numValuesToRecompute == 0 || !node->NeedsGradient())
+                return;
+            std::vector<ComputationNodeBasePtr> recomputation;
+            recomputeValue(node, recomputation);
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                if (node->InputUsedInComputingInputNodesGradients(i))
+                    recomputeValue(node->GetInputs()[i], recomputation);
+            }
+            auto& plan = recomputationPlan[executedNode];
+            plan.insert(plan.end(), recomputation.begin(), recomputation.end());
+        };
+
         // now, simulate the gradient computation order to determine how to allocate matrices
         set<ComputationNodeBasePtr> completedGradient;
 
@@ -1245,6 +1298,9 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
                 shared_ptr<SEQTraversalFlowControlNode> recInfo = FindInRecurrentLoops(m_allSEQNodes, n);
                 if (completedGradient.insert(recInfo).second)
                 {
+                    for (auto& loopNode : recInfo->m_nestedNodes)
+                        recomputeValuesNeededBy(loopNode, recInfo);
+
                     // SEQ mode: allocate all in loop first, then deallocate again
                     // TODO: next step: use PARTraversalFlowControlNode::AllocateGradientMatricesForInputs() and ReleaseMatricesAfterBackprop()...
                     // BUGBUG: naw, ^^ would not work! Wrong order! Need to rethink this. Need to make AllocateEvalMatrices() and AllocateGradientMatrices() the virtual functions.
@@ -1256,12 +1312,21 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
             else
             {
                 // PAR mode: we can allocate and immediately deallocate one by one
+                recomputeValuesNeededBy(n, n);
                 n->AllocateGradientMatricesForInputs(m_matrixPool);
                 // Root node's information will be used and should not be shared with others, also it's small (1x1)
                 if ((n != trainRootNode) && n->NeedsGradient())
                     n->ReleaseMatricesAfterBackprop(m_matrixPool);
             }
         }
+
+        for (auto iter = recomputationPlan.begin(); iter != recomputationPlan.end();)
+            iter = iter->second.empty() ? recomputationPlan.erase(iter) : next(iter);
+        if (TraceLevel() > 0 && numValuesToRecompute > 0)
+            fprintf(stderr, "\nActivation recomputation: %d values are released after forward prop and recomputed during backprop.\n", (int)recomputedValues.size());
+        auto nestedNetwork = m_nestedNetworks.find(trainRootNode);
+        if (nestedNetwork != m_nestedNetworks.end())
+            dynamic_pointer_cast<PARTraversalFlowControlNode>(nestedNetwork->second)->SetRecomputationBeforeBackprop(std::move(recomputationPlan));
     }
 
     m_matrixPool.OptimizedMemoryAllocation(); 
@@ -1279,6 +1344,75 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         PrintMemorySharingStructure(GetAllNodes());
 }
 
+// Activation recomputation: select the nodes whose values are released after forward prop, although backprop needs them,
+// to be computed again during backprop. This trades a second forward prop of these nodes for the memory of their values.
+// A node can be recomputed if its value comes from the pool, it is not part of a loop, its ForwardProp() can be repeated,
+// and the input values it reads are still there during backprop: not from the pool, kept for backprop, or recomputable
+// themselves. The selected nodes are those given by SetNodesToRecompute(), or else, if Globals::ShouldRecomputeActivations(),
+// all that backprop needs except for every ceil(sqrt(N))-th one, which is kept as a checkpoint to recompute the others from.
+// Inputs that backprop does not need but that are needed to recompute a selected node are recomputed as well.
+// Returns the number of selected nodes.
+size_t ComputationNetwork::SelectValuesToRecompute(const ComputationNodeBasePtr& trainRootNode, std::unordered_map<ComputationNodeBasePtr, bool>& outputValueNeededDuringBackProp)
+{
+    const auto& evalOrder = GetEvalOrder(trainRootNode);
+    for (auto& node : evalOrder)
+        node->SetValueRecomputedDuringBackprop(false);
+
+    if (!Globals::ShouldEnableShareNodeValueMatrices() || (m_nodesToRecompute.empty() && !Globals::ShouldRecomputeActivations()))
+        return 0;
+
+    auto isFromPool = [](const ComputationNodeBasePtr& node)
+    {
+        return !node->IsLeaf() && node->IsValueSharable() && !node->IsValueSparse();
+    };
+    auto isNeededDuringBackprop = [&outputValueNeededDuringBackProp](const ComputationNodeBasePtr& node)
+    {
+        auto iter = outputValueNeededDuringBackProp.find(node);
+        return iter != outputValueNeededDuringBackProp.end() && iter->second;
+    };
+
+    // (inputs come before their consumers in evaluation order)
+    std::unordered_set<ComputationNodeBasePtr> recomputable;
+    std::vector<ComputationNodeBasePtr> candidates;
+    for (auto& node : evalOrder)
+    {
+        if (node == trainRootNode || !isFromPool(node) || node->IsPartOfLoop() || node->RequiresPreCompute() || !node->ForwardPropCanBeRepeated())
+            continue;
+
+        const auto& inputs = node->GetInputs();
+        if (std::all_of(inputs.begin(), inputs.end(), [&](const ComputationNodeBasePtr& input)
+            {
+                return !isFromPool(input) || isNeededDuringBackprop(input) || recomputable.find(input) != recomputable.end();
+            }))
+        {
+            recomputable.insert(node);
+            if (isNeededDuringBackprop(node))
+                candidates.push_back(node);
+        }
+    }
+
+    std::function<void(const ComputationNodeBasePtr&)> select = [&](const ComputationNodeBasePtr& node)
+    {
+        node->SetValueRecomputedDuringBackprop(true);
+        for (const auto& input : node->GetInputs())
+        {
+            if (isFromPool(input) && !isNeededDuringBackprop(input) && !input->IsValueRecomputedDuringBackprop())
+                select(input);
+        }
+    };
+    size_t checkpointInterval = (size_t)ceil(sqrt((double)candidates.size()));
+    size_t numSelected = 0;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (m_nodesToRecompute.empty() ? (i + 1) % checkpointInterval != 0 : m_nodesToRecompute.find(candidates[i]) != m_nodesToRecompute.end())
+        {
+            select(candidates[i]);
+            numSelected++;
+        }
+    }
+    return numSelected;
+}
+
 void ComputationNetwork::ReleaseMatricesAfterEvalForChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap)
 {
     for (int i = 0; i < n->GetNumInputs(); i++)
@@ -1293,4 +1427,26 @@ void ComputationNetwork::ReleaseMatricesAfterEvalForChildren(ComputationNodeBase
     }
 }
 
+// Memory plan for inference: before a node requests its value, release the inputs that it can overwrite in place
+// (see ForwardPropCanOverwriteInput()) and that it is the last consumer of, so that the pool can hand their memory on to
+// its value. Chains of elementwise operations then alternate between a few buffers instead of holding one per node.
+// Inputs are only overwritten if they have the same shape and layout, so that the value is computed element by element.
+void ComputationNetwork::ReleaseMatricesBeforeEvalForInPlaceChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap)
+{
+    for (int i = 0; i < n->GetNumInputs(); i++)
+    {
+        ComputationNodeBasePtr pNode = n->GetInputs()[i];
+        if (!n->ForwardPropCanOverwriteInput(i) || pNode->GetSampleLayout() != n->GetSampleLayout() || pNode->GetMBLayout() != n->GetMBLayout())
+            continue;
+
+        auto& parents = parentsMap[pNode];
+        if (parents.size() == 1 && parents.find(n) != parents.end())
+        {
+            // ReleaseMatricesAfterEvalForChildren() will find no parents left and not release it again
+            parents.erase(n);
+            pNode->ReleaseMatricesAfterForwardProp(m_matrixPool);
+        }
+    }
+}
+
 }}}
@@ -312,7 +312,7 @@ public:
     // -----------------------------------------------------------------------
 
     ComputationNodeBase(DEVICEID_TYPE deviceId, const wstring& name) :
-        m_deviceId(deviceId), m_outputNeededDuringBackprop(true), m_learningRateMultiplier(0),
+        m_deviceId(deviceId), m_outputNeededDuringBackprop(true), m_valueRecomputedDuringBackprop(false), m_learningRateMultiplier(0),
         m_gradientInitializedBy(nullptr),
         m_nodeName(name == L"" ? CreateUniqNodeName() : name), m_isValueSparse(false)
     {
@@ -845,6 +845,26 @@ public:
         return !Globals::ShouldEnableShareNodeValueMatrices() || m_outputNeededDuringBackprop; 
     }
 
+    // Can ForwardProp() run once more during backprop and recompute the same value?
+    // This requires that ForwardProp() only reads the input values and only writes the value: no random numbers, no state
+    // updates, and no other matrices from the pool.
+    // Base-class version makes conservative assumption that it cannot. Override if it can.
+    virtual bool ForwardPropCanBeRepeated() const { return false; }
+
+    // Can ForwardProp() write the value over the value of input 'inputIndex' of the same shape, if nothing else needs it anymore?
+    // This requires that each element of the value only depends on the same element of that input, like elementwise operations.
+    // Used for the memory plan of inference, where such an input dies right when the value is computed.
+    // Base-class version makes conservative assumption that it cannot. Override if it can.
+    virtual bool ForwardPropCanOverwriteInput(size_t /*inputIndex*/) const { return false; }
+
+    // activation recomputation: the value is released after forward prop even though backprop needs it, and recomputed
+    // right before backprop needs it. Set by ComputationNetwork::AllocateAllMatrices().
+    void SetValueRecomputedDuringBackprop(bool f) { m_valueRecomputedDuringBackprop = f; }
+    bool IsValueRecomputedDuringBackprop() const { return m_valueRecomputedDuringBackprop; }
+
+    // request the released value matrix again before recomputing it; returns false if it was never released
+    virtual bool RequestValueBeforeRecomputation(MatrixPool& /*matrixPool*/) { return false; }
+
     // -----------------------------------------------------------------------
     // helpers for network traversal
     // -----------------------------------------------------------------------
@@ -978,6 +998,7 @@ protected:
     float m_learningRateMultiplier;    // update parameters? Only used for LearnableParameters.    --TODO: Should we make this a member of LearnableParameters actually? And require a type cast? Currently it is read out for all leaves.
     const ComputationNodeBase* m_gradientInitializedBy; // indicates which node initialized the gradient matrix
     bool m_outputNeededDuringBackprop; // indicates whether the output value of the node is needed during backprop
+    bool m_valueRecomputedDuringBackprop; // indicates whether the output value is released after forward prop and recomputed for backprop
 };
 typedef ComputationNodeBase::ComputationNodeBasePtr ComputationNodeBasePtr;
 
@@ -1341,10 +1362,11 @@ public:
     // This function updates the dimensions to a 2D matrix.
     // If a different tensor layout is associated with this, it must be implanted afterwards.
     // Nodes that call this never have an MB layout.
-    void LoadValue(File& fstream)
+    // If 'mapAlignedPayload', the value may end up backed by the file's memory mapping (see Matrix::Read()).
+    void LoadValue(File& fstream, bool mapAlignedPayload = false)
     {
         CreateMatrixIfNull(m_value);
-        fstream >> Value();
+        Value().Read(fstream, mapAlignedPayload);
         // above reads dimensions, so we must update our own dimensions
         SetDims(TensorShape(Value().GetNumRows(), Value().GetNumCols()), false);
     }
@@ -1868,10 +1890,16 @@ public:
     // don't release matrices that need to be used in the gradient computation
     virtual void ReleaseMatricesAfterForwardProp(MatrixPool& matrixPool) override
     {
-        if (!IsOutputNeededDuringBackprop() && !m_isValueSparse && IsValueSharable())
+        if ((!IsOutputNeededDuringBackprop() || IsValueRecomputedDuringBackprop()) && !m_isValueSparse && IsValueSharable())
             ReleaseMatrixToPool(m_value, matrixPool);
     }
 
+    // the recomputed value is released again in ReleaseMatricesAfterBackprop(), like any value that backprop needs
+    virtual bool RequestValueBeforeRecomputation(MatrixPool& matrixPool) override
+    {
+        return IsValueRecomputedDuringBackprop() && !m_isValueSparse && IsValueSharable() && TypedRequestMatrixReallocateFromPool<ElemType>(m_value, matrixPool);
+    }
+
     virtual void AllocateGradientMatricesForInputs(MatrixPool& matrixPool) override
     {
         for (int i = 0; i < m_inputs.size(); i++)
@@ -1903,9 +1931,9 @@ public:
             if (m_gradient != nullptr && m_gradient->GetMatrixType() != SPARSE) // since we don't have a sparse pool yet
                 ReleaseMatrixToPool(m_gradient, matrixPool, ParentGradientReused() || IsGradientReused());
 
-            // Release the Value matrix only if the output value is needed during backprop
+            // Release the Value matrix only if the output value is needed during backprop (or was recomputed for it)
             // since in the case it isn't used, we release it during forward prop itself
-            if (IsOutputNeededDuringBackprop() && !m_isValueSparse && IsValueSharable())
+            if ((IsOutputNeededDuringBackprop() || IsValueRecomputedDuringBackprop()) && !m_isValueSparse && IsValueSharable())
                 ReleaseMatrixToPool(m_value, matrixPool);
 
             auto multiOutputNode = dynamic_cast<MultiOutputNode<ElemType>*>(this);
@@ -1966,6 +1994,12 @@ protected:
         }
     }
 
+    template<typename ValueType>
+    bool TypedRequestMatrixReallocateFromPool(shared_ptr<Matrix<ValueType>>& matrixPtr, MatrixPool& matrixPool)
+    {
+        return matrixPool.RequestReallocate<ValueType>(&matrixPtr);
+    }
+
     template<typename ValueType>
     void TypedReleaseMatrixToPool(shared_ptr<Matrix<ValueType>>& matrixPtr, MatrixPool& matrixPool, bool aliasing=false)
     {
@@ -2556,6 +2590,8 @@ public:
     virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
 #endif
     virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+    virtual bool ForwardPropCanBeRepeated() const override { return true; }
+    virtual bool ForwardPropCanOverwriteInput(size_t /*inputIndex*/) const override { return true; }
 
     virtual void /*IComputationNode::*/ BeginForwardProp() override // called before first iteration step of ForwardProp()
     {
@@ -171,6 +171,7 @@ public:
     PoolKind PoolingKind() const { return m_poolKind; }
     bool CeilOutDim() const { return m_ceilOutDim; }
     bool PoolIncludePad() const { return m_poolIncludePad; }
+    ImageLayoutKind ImageLayout() const { return m_imageLayout; }
 
     // bottomlessly expand shape to filterRank, then expand to inputRank using defaults or given 'from' values
     template<class V, typename T>
@@ -252,6 +253,30 @@ protected:
             Base::NeedsDynamicValidation(), isFinalValidationPass);
     }
 
+    // Inputs with free dimensions (e.g. images of different sizes) tend to alternate between a few geometries.
+    // Creating an engine, which for cuDNN includes selecting the algorithms, on every change is expensive,
+    // so the engines of the most recent geometries are kept. This makes m_convEng the engine for the geometry
+    // with the given input shape if there is one, and keeps the current engine for later.
+    // Returns false if a new engine must be created.
+    bool ReuseRecentConvolutionEngine(const TensorShape& geometryInputShape)
+    {
+        if (m_convEng != nullptr)
+            m_recentConvEngines.insert(m_recentConvEngines.begin(), std::move(m_convEng));
+
+        auto match = std::find_if(m_recentConvEngines.begin(), m_recentConvEngines.end(),
+                                  [&geometryInputShape](const std::unique_ptr<ConvolutionEngine<ElemType>>& engine) { return engine->Geometry()->InputShape() == geometryInputShape; });
+        if (match != m_recentConvEngines.end())
+        {
+            m_convEng = std::move(*match);
+            m_recentConvEngines.erase(match);
+        }
+
+        if (m_recentConvEngines.size() > s_maxRecentConvEngines)
+            m_recentConvEngines.resize(s_maxRecentConvEngines);
+
+        return m_convEng != nullptr;
+    }
+
 protected:
     TensorShape m_kernelShape;
     TensorShape m_mapCount;
@@ -272,6 +297,10 @@ protected:
     shared_ptr<Matrix<ElemType>> m_tempMatrixBackward;
 
     std::unique_ptr<ConvolutionEngine<ElemType>> m_convEng;
+
+    // Engines for the geometries used before the current one, most recent first (see ReuseRecentConvolutionEngine()).
+    std::vector<std::unique_ptr<ConvolutionEngine<ElemType>>> m_recentConvEngines;
+    static const size_t s_maxRecentConvEngines = 4;
 };
 
 #define UsingConvolutionNodeBaseMembers     \
@@ -294,6 +323,7 @@ protected:                                  \
     using Base::m_tempMatrixForward;        \
     using Base::m_tempMatrixBackward;       \
     using Base::m_convEng;                  \
+    using Base::ReuseRecentConvolutionEngine; \
     using Base::InferConvolution2DReductionDims; \
     using Base::InferReductionDims;         \
 public:
@@ -580,11 +610,13 @@ public:
 
         if (isFinalValidationPass)
         {
+            // The geometry is that of the forward convolution, whose input is the output of a transposed convolution.
+            const auto& geometryInputShape = !m_transpose ? inputShape : outputShape;
             bool recomputeConvGeometry = (m_convEng == nullptr) ? false : // For first minibatch, this flag must be false, so initial mem allocation can happen.
-                                          (outputShape != m_convEng->Geometry()->OutputShape()) || (inputShape != m_convEng->Geometry()->InputShape());
-            if ((m_convEng == nullptr) || ((m_convEng != nullptr) && recomputeConvGeometry))
+                                          (geometryInputShape != m_convEng->Geometry()->InputShape());
+            if ((m_convEng == nullptr) || (recomputeConvGeometry && !ReuseRecentConvolutionEngine(geometryInputShape)))
             {
-                auto geometry = std::make_shared<ConvolveGeometry>(!m_transpose ? inputShape : outputShape,
+                auto geometry = std::make_shared<ConvolveGeometry>(geometryInputShape,
                                                                    m_kernelShape, m_mapCount, m_stride,
                                                                    m_sharing, m_autoPad, m_lowerPad, m_upperPad, m_dilation, false, m_groups);
                 m_convEng = ConvolutionEngine<ElemType>::Create(geometry, m_deviceId, m_imageLayout,
@@ -974,7 +1006,7 @@ public:
         {
             bool recomputeConvGeometry = (m_convEng == nullptr) ? false : // For first minibatch, this flag must be false, so initial mem allocation can happen.
                 (outDims != m_convEng->Geometry()->OutputShape()) || (inputShape != m_convEng->Geometry()->InputShape());
-            if ((m_convEng == nullptr) || ((m_convEng != nullptr) && recomputeConvGeometry))
+            if ((m_convEng == nullptr) || (recomputeConvGeometry && !ReuseRecentConvolutionEngine(inputShape)))
             {
                 auto geometry = std::make_shared<ConvolveGeometry>(inputShape, m_kernelShape, m_mapCount, m_stride,
                                                                    m_sharing, m_autoPad, m_lowerPad, m_upperPad, TensorShape(1), m_ceilOutDim);
@@ -1102,9 +1134,10 @@ public:
         SetDims(outputShape, HasMBLayout());
         if (isFinalValidationPass)
         {
+            // The geometry is that of the pooling, whose input is the output of the unpooling.
             bool recomputeConvGeometry = (m_convEng == nullptr) ? false : // For first minibatch, this flag must be false, so initial mem allocation can happen.
-                (outputShape != m_convEng->Geometry()->OutputShape()) || (inputShape != m_convEng->Geometry()->InputShape());
-            if ((m_convEng == nullptr) || ((m_convEng != nullptr) && recomputeConvGeometry))
+                (outputShape != m_convEng->Geometry()->InputShape());
+            if ((m_convEng == nullptr) || (recomputeConvGeometry && !ReuseRecentConvolutionEngine(outputShape)))
             {
                 auto geometry = std::make_shared<ConvolveGeometry>(outputShape, m_kernelShape, m_mapCount, m_stride,
                                                                    m_sharing, m_autoPad, m_lowerPad, m_upperPad);
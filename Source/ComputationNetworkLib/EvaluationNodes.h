@@ -15,6 +15,7 @@
 #include <stdexcept>
 #include <list>
 #include <memory>
+#include <unordered_map>
 
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -576,119 +577,155 @@ public:
     // insPen - insertion penalty
     // squashInputs - whether to merge sequences of identical samples.
     // tokensToIgnore - list of samples to ignore during edit distance evaluation
+    // The sequences of the minibatch are processed in parallel. With equal penalties, the number of edits is the
+    // Levenshtein distance, which is computed bit-parallel; otherwise the weighted DP below is used.
     ElemType ComputeEditDistanceError(Matrix<ElemType>& firstSeq, const Matrix<ElemType> & secondSeq, MBLayoutPtr pMBLayout, 
         float subPen, float delPen, float insPen, bool squashInputs, const vector<size_t>& tokensToIgnore)
     {
-        std::vector<int> firstSeqVec, secondSeqVec;
-
-        // Edit distance between subsequences
-        Matrix<float> grid(CPUDEVICE);
-        
-        // Number of insertions between subsequences
-        Matrix<float> insMatrix(CPUDEVICE);
-        
-        //Number of deletions between subsequences
-        Matrix<float> delMatrix(CPUDEVICE);
-
-        // Number of substitutions between subsequences
-        Matrix<float> subMatrix(CPUDEVICE);
-
-        float del, ins, sub;
-        ElemType wrongSampleNum = 0.0;
-        size_t totalSampleNum = 0, totalframeNum = 0;
-        size_t sequenceStartFrame = 0;
+        // one transfer each instead of element-wise access
+        std::vector<ElemType> firstSeqHost(firstSeq.GetNumElements()), secondSeqHost(secondSeq.GetNumElements());
+        CopyToHost(firstSeq, firstSeqHost);
+        CopyToHost(secondSeq, secondSeqHost);
 
+        std::vector<std::pair<std::vector<int>, std::vector<int>>> sequencePairs;
+        size_t totalSampleNum = 0, totalframeNum = 0;
         for (const auto& sequence : pMBLayout->GetAllSequences())
         {
             if (sequence.seqId == GAP_SEQUENCE_ID)
                 continue;
 
             auto numFrames = pMBLayout->GetNumSequenceFramesInCurrentMB(sequence);
-
             if (numFrames > 0)
             {
                 totalframeNum += numFrames;
 
                 auto columnIndices = pMBLayout->GetColumnIndices(sequence);
+                sequencePairs.emplace_back();
+                ExtractSampleSequence(firstSeqHost.data(), columnIndices, squashInputs, tokensToIgnore, sequencePairs.back().first);
+                ExtractSampleSequence(secondSeqHost.data(), columnIndices, squashInputs, tokensToIgnore, sequencePairs.back().second);
 
-                ExtractSampleSequence(firstSeq, columnIndices, squashInputs, tokensToIgnore, firstSeqVec);
-                ExtractSampleSequence(secondSeq, columnIndices, squashInputs, tokensToIgnore, secondSeqVec);
-
-                //calculate edit distance
-                size_t firstSize = firstSeqVec.size();
-                size_t secondSize = secondSeqVec.size();
                 if (Base::HasEnvironmentPtr() && Base::Environment().IsV2Library())
-                    totalSampleNum += secondSize;
+                    totalSampleNum += sequencePairs.back().second.size();
                 else 
-                    totalSampleNum += firstSize;
+                    totalSampleNum += sequencePairs.back().first.size();
+            }
+        }
 
-                grid.Resize(firstSize + 1, secondSize + 1);
-                insMatrix.Resize(firstSize + 1, secondSize + 1);
-                delMatrix.Resize(firstSize + 1, secondSize + 1);
-                subMatrix.Resize(firstSize + 1, secondSize + 1);
-                insMatrix.SetValue(0.0f);
-                delMatrix.SetValue(0.0f);
-                subMatrix.SetValue(0.0f);
+        // with equal (positive) penalties every optimal path has the minimum number of edits
+        bool isUnweighted = subPen == delPen && subPen == insPen && subPen > 0;
+        long long wrongSampleNum = 0;
+        const int numSequences = (int)sequencePairs.size();
+#pragma omp parallel for schedule(dynamic) reduction(+ : wrongSampleNum) if (numSequences > 1)
+        for (int k = 0; k < numSequences; k++)
+        {
+            const auto& sequencePair = sequencePairs[k];
+            wrongSampleNum += isUnweighted ? LevenshteinDistance(sequencePair.first, sequencePair.second)
+                                           : WeightedEditDistance(sequencePair.first, sequencePair.second, subPen, delPen, insPen);
+        }
 
-                for (size_t i = 0; i < firstSize + 1; i++)
-                {
-                    grid(i, 0) = (float)(i * delPen);
-                    delMatrix(i, 0) = (float)i;
-                }
+        return (ElemType)((double)wrongSampleNum * totalframeNum / totalSampleNum);
+    }
 
-                for (size_t j = 0; j < secondSize + 1; j++)
-                {
-                    grid(0, j) = (float)(j * insPen);
-                    insMatrix(0, j) = (float)j;
-                }
-                for (size_t i = 1; i < firstSize + 1; i++)
-                {
-                    for (size_t j = 1; j < secondSize + 1; j++)
-                    {
-                        if (firstSeqVec[i - 1] == secondSeqVec[j - 1])
-                        {
-                            grid(i, j) = grid(i - 1, j - 1);
-                            insMatrix(i, j) = insMatrix(i - 1, j - 1);
-                            delMatrix(i, j) = delMatrix(i - 1, j - 1);
-                            subMatrix(i, j) = subMatrix(i - 1, j - 1);
-                        }
-                        else
-                        {
-                            del = grid(i - 1, j) + delPen; //deletion 
-                            ins = grid(i, j - 1) + insPen;  //insertion
-                            sub = grid(i - 1, j - 1) + subPen; //substitution 
-                            if (sub <= del && sub <= ins)
-                            {
-                                insMatrix(i, j) = insMatrix(i - 1, j - 1);
-                                delMatrix(i, j) = delMatrix(i - 1, j - 1);
-                                subMatrix(i, j) = subMatrix(i - 1, j - 1) + 1.0f;
-                                grid(i, j) = sub;
-                            }
-                            else if (del < ins)
-                            {
-                                insMatrix(i, j) = insMatrix(i - 1, j);
-                                subMatrix(i, j) = subMatrix(i - 1, j);
-                                delMatrix(i, j) = delMatrix(i - 1, j) + 1.0f;
-                                grid(i, j) = del;
-                            }
-                            else
-                            {
-                                delMatrix(i, j) = delMatrix(i, j - 1);
-                                subMatrix(i, j) = subMatrix(i, j - 1);
-                                insMatrix(i, j) = insMatrix(i, j - 1) + 1.0f;
-                                grid(i, j) = ins;
-                            }
-                        }
-                    }
-                }
+    // Levenshtein distance, bit-parallel after Myers ("A fast bit-vector algorithm for approximate string matching based on
+    // dynamic programming", 1999) in the formulation of Hyyrö (2001) for the global distance: The columns of the DP table are
+    // represented by the bit vectors of their vertical +1/-1 differences, with the shorter sequence along the bits, in blocks
+    // of 64 rows. Each element of the longer sequence advances all blocks at once, so this is O(ceil(M/64) * N).
+    static size_t LevenshteinDistance(const std::vector<int>& firstSeq, const std::vector<int>& secondSeq)
+    {
+        const auto& pattern = firstSeq.size() <= secondSeq.size() ? firstSeq : secondSeq;
+        const auto& text    = firstSeq.size() <= secondSeq.size() ? secondSeq : firstSeq;
+        const size_t m = pattern.size();
+        if (m == 0)
+            return text.size();
+        const size_t numBlocks = (m + 63) / 64;
+
+        // match masks: bit k of block b of a symbol's mask is set if pattern[64 * b + k] is that symbol
+        std::unordered_map<int, size_t> symbolIndex;
+        std::vector<uint64_t> matchMasks;
+        for (size_t k = 0; k < m; k++)
+        {
+            auto result = symbolIndex.insert(std::make_pair(pattern[k], symbolIndex.size()));
+            if (result.second)
+                matchMasks.resize(matchMasks.size() + numBlocks, 0);
+            matchMasks[result.first->second * numBlocks + k / 64] |= (uint64_t)1 << (k % 64);
+        }
+        const std::vector<uint64_t> noMatch(numBlocks, 0);
 
-                wrongSampleNum += insMatrix(firstSize, secondSize) + delMatrix(firstSize, secondSize) + subMatrix(firstSize, secondSize);
+        // first column: D(i, 0) = i, i.e. all vertical differences are +1
+        std::vector<uint64_t> plusV(numBlocks, ~(uint64_t)0), minusV(numBlocks, 0);
+        const uint64_t lastRowBit = (uint64_t)1 << ((m - 1) % 64); // (rows below the pattern in the last block never influence it)
+        long long distance = m;
+        for (int symbol : text)
+        {
+            auto iter = symbolIndex.find(symbol);
+            const uint64_t* eqs = iter != symbolIndex.end() ? &matchMasks[iter->second * numBlocks] : noMatch.data();
+            int hIn = 1; // first row: D(0, j) = j
+            for (size_t b = 0; b < numBlocks; b++)
+            {
+                uint64_t pv = plusV[b], mv = minusV[b];
+                uint64_t eq = eqs[b] | (hIn < 0 ? 1 : 0);
+                uint64_t xv = eqs[b] | mv;
+                uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                uint64_t ph = mv | ~(xh | pv);
+                uint64_t mh = pv & xh;
+                uint64_t outBit = b + 1 < numBlocks ? (uint64_t)1 << 63 : lastRowBit;
+                int hOut = (ph & outBit) ? 1 : ((mh & outBit) ? -1 : 0);
+                ph = (ph << 1) | (hIn > 0 ? 1 : 0);
+                mh = (mh << 1) | (hIn < 0 ? 1 : 0);
+                plusV[b] = mh | ~(xv | ph);
+                minusV[b] = ph & xv;
+                hIn = hOut;
             }
-
-            sequenceStartFrame += numFrames;
+            distance += hIn; // horizontal difference in the last row
         }
+        return (size_t)distance;
+    }
 
-        return (ElemType)(wrongSampleNum * totalframeNum / totalSampleNum);
+    // Number of edits along the cheapest path under the given penalties (ties resolved as substitution, deletion, insertion).
+    // Only two rows of the DP table are kept. Within a row, the substitution/deletion candidates are computed in a first
+    // (vectorizable) pass, while the insertions, which depend on the left neighbor, are resolved in a second one.
+    static size_t WeightedEditDistance(const std::vector<int>& firstSeq, const std::vector<int>& secondSeq, float subPen, float delPen, float insPen)
+    {
+        enum : char { match, substitution, deletion };
+        const size_t firstSize = firstSeq.size(), secondSize = secondSeq.size();
+        std::vector<float> prevCost(secondSize + 1), cost(secondSize + 1);
+        std::vector<size_t> prevEdits(secondSize + 1), edits(secondSize + 1);
+        std::vector<char> step(secondSize + 1);
+        for (size_t j = 0; j < secondSize + 1; j++)
+        {
+            prevCost[j] = (float)(j * insPen);
+            prevEdits[j] = j;
+        }
+        for (size_t i = 1; i < firstSize + 1; i++)
+        {
+            cost[0] = (float)(i * delPen);
+            edits[0] = i;
+            const int label = firstSeq[i - 1];
+            for (size_t j = 1; j < secondSize + 1; j++)
+            {
+                float sub = prevCost[j - 1] + subPen;
+                float del = prevCost[j] + delPen;
+                bool isMatch = label == secondSeq[j - 1];
+                bool isSub = sub <= del;
+                cost[j]  = isMatch ? prevCost[j - 1] : (isSub ? sub : del);
+                edits[j] = isMatch ? prevEdits[j - 1] : (isSub ? prevEdits[j - 1] : prevEdits[j]) + 1;
+                step[j]  = isMatch ? match : (isSub ? substitution : deletion);
+            }
+            for (size_t j = 1; j < secondSize + 1; j++)
+            {
+                if (step[j] == match)
+                    continue;
+                float ins = cost[j - 1] + insPen;
+                if (step[j] == substitution ? ins < cost[j] : ins <= cost[j])
+                {
+                    cost[j] = ins;
+                    edits[j] = edits[j - 1] + 1;
+                }
+            }
+            std::swap(prevCost, cost);
+            std::swap(prevEdits, edits);
+        }
+        return prevEdits[secondSize];
     }
 
     virtual void Save(File& fstream) const override
@@ -726,13 +763,22 @@ private:
     float m_insPen;
     std::vector<size_t> m_tokensToIgnore;
 
-    // Clear out_SampleSeqVec and extract a vector of samples from the matrix into out_SampleSeqVec.
-    static void ExtractSampleSequence(const Matrix<ElemType>& firstSeq, vector<size_t>& columnIndices, bool squashInputs, const vector<size_t>& tokensToIgnore, std::vector<int>& out_SampleSeqVec)
+    static void CopyToHost(const Matrix<ElemType>& m, std::vector<ElemType>& result)
+    {
+        if (result.empty())
+            return;
+        ElemType* data = result.data();
+        size_t size = result.size();
+        m.CopyToArray(data, size);
+    }
+
+    // Clear out_SampleSeqVec and extract a vector of samples from the sample indices (one per column) into out_SampleSeqVec.
+    static void ExtractSampleSequence(const ElemType* firstSeq, vector<size_t>& columnIndices, bool squashInputs, const vector<size_t>& tokensToIgnore, std::vector<int>& out_SampleSeqVec)
     {
         out_SampleSeqVec.clear();
 
         // Get the first element in the sequence
-        size_t lastId = (int)firstSeq(0, columnIndices[0]);
+        size_t lastId = (int)firstSeq[columnIndices[0]];
         if (std::find(tokensToIgnore.begin(), tokensToIgnore.end(), lastId) == tokensToIgnore.end())
             out_SampleSeqVec.push_back(lastId);
 
@@ -742,7 +788,7 @@ private:
             //squash sequences of identical samples
             for (size_t i = 1; i < columnIndices.size(); i++)
             {
-                size_t refId = (int)firstSeq(0, columnIndices[i]);
+                size_t refId = (int)firstSeq[columnIndices[i]];
                 if (lastId != refId)
                 {
                     lastId = refId;
@@ -755,7 +801,7 @@ private:
         {
             for (size_t i = 1; i < columnIndices.size(); i++)
             {
-                auto refId = (int)firstSeq(0, columnIndices[i]);
+                auto refId = (int)firstSeq[columnIndices[i]];
                 if (std::find(tokensToIgnore.begin(), tokensToIgnore.end(), refId) == tokensToIgnore.end())
                     out_SampleSeqVec.push_back(refId);
             }
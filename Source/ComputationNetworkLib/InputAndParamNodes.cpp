@@ -435,7 +435,8 @@ void LearnableParameter<ElemType>::Save(File& fstream) const /*override*/
     Base::Save(fstream);
     fstream << m_learningRateMultiplier;
     m_sampleLayout.Save(fstream);
-    fstream << Value();
+    // in files written with fileOptionsAlignedPayloads, parameter values are page-aligned so that they can be memory-mapped on load
+    Value().Write(fstream, /*alignPayload=*/fstream.HasAlignedPayloads());
 }
 
 template <class ElemType>
@@ -468,7 +469,14 @@ void LearnableParameter<ElemType>::Load(File& fstream, size_t modelVersion) /*ov
         }
     }
 
-    LoadValue(fstream);
+    // If the model file is memory-mapped, CPU parameters with aligned payloads are backed directly by the mapping,
+    // which we must then keep alive. Pages are copy-on-write, so training such a parameter will just un-share its pages.
+    bool mapValue = fstream.GetMemoryMapping() && m_deviceId == CPUDEVICE;
+    LoadValue(fstream, mapValue);
+    if (mapValue)
+        m_mappedModelFile = fstream.GetMemoryMapping();
+    else
+        m_mappedModelFile.reset();
     SetDims(sampleLayout, false); // note: call this after LoadValue() since LoadValue() overwrites m_sampleLayout
     VerifyDataSize(Value());      // sanity check
 
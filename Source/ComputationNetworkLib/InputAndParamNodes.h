@@ -177,6 +177,9 @@ private:
 
     // flags related to gradient update
     float m_regMultiplier; // The multiplier to adjust the L1Reg and L2Reg for Learnable node
+
+    // model file that Value() is memory-mapped from, if loaded with fileOptionsMemoryMapped
+    std::shared_ptr<MemoryMappedFile> m_mappedModelFile;
 };
 
 // -----------------------------------------------------------------------
@@ -887,6 +887,9 @@ public:
     virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
     // but both *inputs* are used, so we don't overload the InputUsed-() function which defaults to 'true'
 
+    // (reducing the sequence axis uses matrices from the pool)
+    virtual bool ForwardPropCanBeRepeated() const override { return !ReduceSequenceAxis(); }
+
     virtual ParentGradientOptimization ImplementsGradientOptimization(const ComputationNodeBase*) const override { return ParentGradientOptimization::Overwrite; }
 
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
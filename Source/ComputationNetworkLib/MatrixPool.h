@@ -29,15 +29,17 @@ struct MemRequestInfo
     size_t matrixSize;                          // memory size 
     bool mbScale;                               // whether the memory shall be scaled by minibatch size 
     bool isWorkSpace;                           // workspace memory or not, by workspace we indicate whether a memory space will be released very shortly after allocation 
-    int allocStep;                              // at what step counter memory allocation is requested 
-    int releaseStep;                            // at what step counter memory release is requested  
+    vector<pair<int, int>> occupancy;           // at what step counters memory allocation and release are requested; more than one interval if the memory is requested again after release
     int memoryId;                               // integer indexing the memory buffer ID 
     MemRequestInfo(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, int allocStep)
-        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), allocStep(allocStep), releaseStep(INT_MAX), memoryId(-1)
+        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), memoryId(-1)
     {
         pMatrixPtrs.push_back(pMatrixPtr);
+        occupancy.push_back(make_pair(allocStep, INT_MAX));
     }
-    void SetReleaseStep(int step) { releaseStep = step; }
+    void SetReleaseStep(int step) { occupancy.back().second = step; }
+    bool IsReleased() const { return occupancy.back().second != INT_MAX; }
+    void SetReallocateStep(int step) { occupancy.push_back(make_pair(step, INT_MAX)); }
     void SetMemoryId(int id) { memoryId = id;  }
 };
 
@@ -147,6 +149,21 @@ public:
         *pMatrixPtr = make_shared<Matrix<ElemType>>(deviceId);
     }
 
+    // Requests a released matrix again, keeping its pointer. The memory is free for other requests in between; whatever the
+    // matrix held before is lost. This is used for values that are recomputed during backprop (activation recomputation).
+    // Returns false if the matrix is not from this pool or was not released, in which case its content is kept.
+    template <class ElemType>
+    bool RequestReallocate(shared_ptr<Matrix<ElemType>> *pMatrixPtr)
+    {
+        auto memInfo = GetMemInfo(pMatrixPtr);
+        if (memInfo == nullptr || !memInfo->IsReleased())
+            return false;
+
+        memInfo->SetReallocateStep(m_stepCounter);
+        m_stepCounter++;
+        return true;
+    }
+
     void OptimizedMemoryAllocation()
     {
         // MatrixPool is not templated, so we call both float and double versions here 
@@ -228,15 +245,20 @@ public:
     }
 
 private: 
-    bool CheckOverlap(pair<int, int>occ, vector<pair<int, int>>&occVec)
+    bool CheckOverlap(const vector<pair<int, int>>& occupancy, vector<pair<int, int>>&occVec)
     {
         bool bRet = false;
-        for (auto& o : occVec)
+        for (auto& occ : occupancy)
         {
-            if (occ.first <= o.second && occ.second >= o.first)
-            {
-                bRet = true;
+            if (bRet)
                 break;
+            for (auto& o : occVec)
+            {
+                if (occ.first <= o.second && occ.second >= o.first)
+                {
+                    bRet = true;
+                    break;
+                }
             }
         }
 //#define SUPRESS_MEMSHARING // #define this to disable memory sharing by always return true 
@@ -296,14 +318,12 @@ private:
                         // since we assign from highest memory to lowest, every memory that has been allocated can accommodate the 
                         // current memory request, unless there is a conflict (overlap) 
                         auto iter = memAllocInfoVec.begin();
-                        while (iter != memAllocInfoVec.end() && CheckOverlap(make_pair(memInfo.allocStep, memInfo.releaseStep), iter->occupancy))
+                        while (iter != memAllocInfoVec.end() && CheckOverlap(memInfo.occupancy, iter->occupancy))
                             iter++;
                         if (iter == memAllocInfoVec.end())
                         {
                             // no current memory can be assigned, need to create a new one 
-                            vector<pair<int, int>> occ;
-                            occ.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
-                            MemAllocInfo ma(memoryCounter, memInfo.matrixSize, occ);
+                            MemAllocInfo ma(memoryCounter, memInfo.matrixSize, memInfo.occupancy);
                             // insert in the front of the vector to maintain sorted order 
                             memAllocInfoVec.insert(memAllocInfoVec.begin(), ma);
                             memInfo.SetMemoryId(memoryCounter);
@@ -311,15 +331,13 @@ private:
                         }
                         else
                         {
-                            iter->occupancy.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
+                            iter->occupancy.insert(iter->occupancy.end(), memInfo.occupancy.begin(), memInfo.occupancy.end());
                             memInfo.SetMemoryId(iter->memoryId);
                         }
                     }
                     else
                     {
-                        vector<pair<int, int>> occ;
-                        occ.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
-                        MemAllocInfo ma(memoryCounter, memInfo.matrixSize, occ);
+                        MemAllocInfo ma(memoryCounter, memInfo.matrixSize, memInfo.occupancy);
                         memAllocInfoVec.push_back(ma);
                         memInfo.SetMemoryId(memoryCounter);
                         memoryCounter++;
@@ -339,29 +357,25 @@ private:
                         auto workingAlloc = memAllocInfoVec.end();
                         for (auto iter = memAllocInfoVec.begin(); iter != memAllocInfoVec.end(); iter++)
                         {
-                            if (!CheckOverlap(make_pair(memInfo.allocStep, memInfo.releaseStep), iter->occupancy))
+                            if (!CheckOverlap(memInfo.occupancy, iter->occupancy))
                                 workingAlloc = iter;
                         }
                         if (workingAlloc == memAllocInfoVec.end())  // nothing works 
                         {
-                            vector<pair<int, int>> occ;
-                            occ.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
-                            MemAllocInfo ma(memoryCounter, memInfo.matrixSize, occ);
+                            MemAllocInfo ma(memoryCounter, memInfo.matrixSize, memInfo.occupancy);
                             memAllocInfoVec.push_back(ma);  // add as the last one 
                             memInfo.SetMemoryId(memoryCounter);
                             memoryCounter++;
                         }
                         else
                         {
-                            workingAlloc->occupancy.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
+                            workingAlloc->occupancy.insert(workingAlloc->occupancy.end(), memInfo.occupancy.begin(), memInfo.occupancy.end());
                             memInfo.SetMemoryId(workingAlloc->memoryId);
                         }
                     }
                     else
                     {
-                        vector<pair<int, int>> occ;
-                        occ.push_back(make_pair(memInfo.allocStep, memInfo.releaseStep));
-                        MemAllocInfo ma(memoryCounter, memInfo.matrixSize, occ);
+                        MemAllocInfo ma(memoryCounter, memInfo.matrixSize, memInfo.occupancy);
                         memAllocInfoVec.push_back(ma);
                         memInfo.SetMemoryId(memoryCounter);
                         memoryCounter++;
@@ -100,6 +100,9 @@ public:
         return opType == binaryWithInputGradient;
     }
 
+    virtual bool ForwardPropCanBeRepeated() const override { return true; }
+    virtual bool ForwardPropCanOverwriteInput(size_t /*inputIndex*/) const override { return true; }
+
     virtual ParentGradientOptimization ImplementsGradientOptimization(const ComputationNodeBase*) const override { return (opType != noGradient) ? ParentGradientOptimization::Overwrite : ParentGradientOptimization::None; }
 };
 
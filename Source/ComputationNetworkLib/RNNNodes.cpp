@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "TensorView.h"
 #include "RNNNodes.h"
+#include "TensorOps.h"
 
 #include <unordered_set>
 #include <map>
@@ -340,4 +341,162 @@ template class OptimizedRNNStackNode<float>;
 template class OptimizedRNNStackNode<double>;
 template class OptimizedRNNStackNode<half>;
 
+// -----------------------------------------------------------------------
+// LSTMCellNode
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+/*virtual*/ void LSTMCellNode<ElemType>::Validate(bool isFinalValidationPass) /*override*/
+{
+    Base::Validate(isFinalValidationPass);
+    InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+    const auto& gateLayout = Input(0)->GetSampleLayout();
+    const auto& cellLayout = Input(1)->GetSampleLayout();
+    m_cellDim = cellLayout.GetNumElements();
+    if (isFinalValidationPass)
+    {
+        if (gateLayout.GetRank() != 1 || cellLayout.GetRank() != 1 || gateLayout[0] != 4 * m_cellDim)
+            InvalidArgument("%ls %ls operation: The gate pre-activations [%s] must be a vector of 4 times the cell dimension [%s].",
+                            NodeName().c_str(), OperationName().c_str(), string(gateLayout).c_str(), string(cellLayout).c_str());
+        if (!Input(0)->HasMBLayout() || Input(0)->GetMBLayout() != Input(1)->GetMBLayout())
+            InvalidArgument("%ls %ls operation: Both inputs must have the same dynamic axes.", NodeName().c_str(), OperationName().c_str());
+    }
+    SetDims(TensorShape(2 * m_cellDim), HasMBLayout());
+}
+
+// gates are stored in the order it, gt, ft, ot, i.e. k-th gate of a column starts at k * d
+template <class ElemType>
+void LSTMCellNode<ElemType>::ForwardPropCPU(const FrameRange& fr)
+{
+    auto gatesIn = Input(0)->ValueFor(fr);
+    auto cellIn  = Input(1)->ValueFor(fr);
+    auto gates   = DataFor(*m_gates, fr);
+    auto output  = ValueFor(fr);
+
+    const size_t d = m_cellDim;
+    const size_t numCols = output.GetNumCols();
+    for (size_t j = 0; j < numCols; j++)
+    {
+        const ElemType* p  = gatesIn.Data() + j * 4 * d;
+        const ElemType* dc = cellIn.Data()  + j * d;
+        ElemType* g = gates.Data()  + j * 4 * d;
+        ElemType* h = output.Data() + j * 2 * d;
+        ElemType* c = h + d;
+        for (size_t k = 0; k < d; k++)
+        {
+            ElemType it = Sigmoid(p[k]);
+            ElemType gt = tanh_(p[d + k]);
+            ElemType ft = Sigmoid(p[2 * d + k]);
+            ElemType ot = Sigmoid(p[3 * d + k]);
+            g[k] = it; g[d + k] = gt; g[2 * d + k] = ft; g[3 * d + k] = ot;
+            c[k] = ft * dc[k] + it * gt;
+            h[k] = ot * tanh_(c[k]);
+        }
+    }
+}
+
+template <class ElemType>
+void LSTMCellNode<ElemType>::BackpropToCPU(const size_t inputIndex, const FrameRange& fr)
+{
+    auto gates      = DataFor(*m_gates, fr);
+    auto output     = ValueFor(fr);
+    auto outputGrad = GradientFor(fr);
+    auto cellIn     = Input(1)->ValueFor(fr);
+    auto inputGrad  = Input(inputIndex)->GradientFor(fr);
+
+    const size_t d = m_cellDim;
+    const size_t numCols = output.GetNumCols();
+    for (size_t j = 0; j < numCols; j++)
+    {
+        const ElemType* g  = gates.Data()      + j * 4 * d;
+        const ElemType* c  = output.Data()     + j * 2 * d + d;
+        const ElemType* dh = outputGrad.Data() + j * 2 * d;
+        const ElemType* dc = dh + d;
+        const ElemType* prevCell = cellIn.Data() + j * d;
+        ElemType* dIn = inputGrad.Data() + j * (inputIndex == 0 ? 4 * d : d);
+        for (size_t k = 0; k < d; k++)
+        {
+            ElemType it = g[k], gt = g[d + k], ft = g[2 * d + k], ot = g[3 * d + k];
+            ElemType tc = tanh_(c[k]);
+            // total gradient of ct: directly from our second output, and through ht
+            ElemType dct = dc[k] + dh[k] * ot * (1 - tc * tc);
+            if (inputIndex == 0)
+            {
+                dIn[k]         += dct * gt * it * (1 - it);
+                dIn[d + k]     += dct * it * (1 - gt * gt);
+                dIn[2 * d + k] += dct * prevCell[k] * ft * (1 - ft);
+                dIn[3 * d + k] += dh[k] * tc * ot * (1 - ot);
+            }
+            else
+                dIn[k] += dct * ft;
+        }
+    }
+}
+
+template <class ElemType>
+/*virtual*/ void LSTMCellNode<ElemType>::ForwardProp(const FrameRange& fr) /*override*/
+{
+    if (Value().GetDeviceId() == CPUDEVICE)
+        return ForwardPropCPU(fr);
+
+    // same as above, as a sequence of tensor operations
+    auto it = GateTensorFor(m_gates, 0, fr);
+    auto gt = GateTensorFor(m_gates, 1, fr);
+    auto ft = GateTensorFor(m_gates, 2, fr);
+    auto ot = GateTensorFor(m_gates, 3, fr);
+    auto ht = OutputTensorFor(ValuePtr(), 0, fr);
+    auto ct = OutputTensorFor(ValuePtr(), 1, fr);
+    let gatesIn = TensorView<ElemType>(InputRef(0).ValuePtr(), InputRef(0).GetTensorSliceFor(1, fr));
+    let cellIn  = InputRef(1).ValueTensorFor(1, fr);
+
+    TensorView<ElemType>(m_gates, InputRef(0).GetTensorSliceFor(1, fr)).AssignSigmoidOf(gatesIn);
+    gt.AssignTanhOf(GateTensorFor(InputRef(0).ValuePtr(), 1, fr));
+    ct.AssignElementwiseProductOf(ft, cellIn);
+    ct.AddElementwiseProductOf(it, gt);
+    ht.AssignTanhOf(ct);
+    ht.AssignElementwiseProductOf(ht, ot);
+}
+
+template <class ElemType>
+/*virtual*/ void LSTMCellNode<ElemType>::BackpropTo(const size_t inputIndex, const FrameRange& fr) /*override*/
+{
+    if (Value().GetDeviceId() == CPUDEVICE)
+        return BackpropToCPU(inputIndex, fr);
+
+    m_temp->Resize(*m_gates);
+    let it = GateTensorFor(m_gates, 0, fr);
+    let gt = GateTensorFor(m_gates, 1, fr);
+    let ft = GateTensorFor(m_gates, 2, fr);
+    let ot = GateTensorFor(m_gates, 3, fr);
+    let ct = OutputTensorFor(ValuePtr(), 1, fr);
+    let dh = OutputTensorFor(GradientPtr(), 0, fr);
+    let dc = OutputTensorFor(GradientPtr(), 1, fr);
+    auto tc  = GateTensorFor(m_temp, 0, fr);
+    auto dct = GateTensorFor(m_temp, 1, fr);
+    auto tmp = GateTensorFor(m_temp, 2, fr);
+
+    tc.AssignTanhOf(ct);
+    dct.AssignElementwiseProductOf(dh, ot);
+    dct.AssignElementwiseProductWithTanhDerivativeFromOutputOf(dct, tc);
+    dct.AddCopyOf(dc);
+    if (inputIndex == 0)
+    {
+        tmp.AssignElementwiseProductOf(dct, gt);
+        GateTensorFor(InputRef(0).GradientPtr(), 0, fr).AddElementwiseProductWithSigmoidDerivativeFromOutputOf(tmp, it);
+        tmp.AssignElementwiseProductOf(dct, it);
+        GateTensorFor(InputRef(0).GradientPtr(), 1, fr).AddElementwiseProductWithTanhDerivativeFromOutputOf(tmp, gt);
+        tmp.AssignElementwiseProductOf(dct, InputRef(1).ValueTensorFor(1, fr));
+        GateTensorFor(InputRef(0).GradientPtr(), 2, fr).AddElementwiseProductWithSigmoidDerivativeFromOutputOf(tmp, ft);
+        tmp.AssignElementwiseProductOf(dh, tc);
+        GateTensorFor(InputRef(0).GradientPtr(), 3, fr).AddElementwiseProductWithSigmoidDerivativeFromOutputOf(tmp, ot);
+    }
+    else
+        InputRef(1).GradientTensorFor(1, fr).AddElementwiseProductOf(dct, ft);
+}
+
+template class LSTMCellNode<float>;
+template class LSTMCellNode<double>;
+template class LSTMCellNode<half>;
+
 }}}
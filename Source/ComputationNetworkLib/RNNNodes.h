@@ -107,4 +107,100 @@ private:
     bool m_legacySwapInputsPending = false; // to support an internal legacy version
 };
 
+// -----------------------------------------------------------------------
+// LSTMCell (gatePreActivations, previousCell)
+// One step of an LSTM cell, fused into a single node:
+//   it = Sigmoid (p[0:d]),  gt = Tanh (p[d:2d]),  ft = Sigmoid (p[2d:3d]),  ot = Sigmoid (p[3d:4d])
+//   ct = ft .* c(t-1) + it .* gt
+//   ht = ot .* Tanh (ct)
+// where p = b + W x(t) + H h(t-1) is the [4d] gate pre-activation. The output is [2d] = [ht; ct].
+// This node is not meant to be created by users. ComputationNetwork::FuseRecurrentCells() substitutes it
+// for the equivalent chain of Slice/Sigmoid/Tanh/ElementTimes/Plus nodes (as created by the Python
+// layers library), so that a recurrent step costs one node evaluation instead of a dozen.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class LSTMCellNode : public ComputationNode<ElemType>, public NumInputs<2>
+{
+    typedef ComputationNode<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"LSTMCell"; }
+
+public:
+    LSTMCellNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name), m_cellDim(0)
+    {
+    }
+    LSTMCellNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : LSTMCellNode(configp->Get(L"deviceId"), L"<placeholder>")
+    {
+        AttachInputsFromConfig(configp, this->GetExpectedNumInputs());
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override;
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override;
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override;
+
+    virtual void UpdateFunctionMBSize() override
+    {
+        m_gates->Resize(InputRef(0).GetSampleMatrixNumRows(), GetMBLayout()->GetNumCols());
+    }
+
+    // the activated gates are kept from ForwardProp() for BackpropTo()
+    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::RequestMatricesBeforeForwardProp(matrixPool);
+        RequestMatrixFromPool(m_gates, matrixPool);
+    }
+
+    // without backprop (e.g. in inference) the gates are only needed during ForwardProp()
+    virtual void ReleaseMatricesAfterForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::ReleaseMatricesAfterForwardProp(matrixPool);
+        if (!IsOutputNeededDuringBackprop())
+            ReleaseMatrixToPool(m_gates, matrixPool);
+    }
+
+    virtual void RequestMatricesBeforeBackprop(MatrixPool& matrixPool) override
+    {
+        Base::RequestMatricesBeforeBackprop(matrixPool);
+        RequestMatrixFromPool(m_temp, matrixPool);
+    }
+
+    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) override
+    {
+        Base::ReleaseMatricesAfterBackprop(matrixPool);
+        if (IsOutputNeededDuringBackprop())
+            ReleaseMatrixToPool(m_gates, matrixPool);
+        ReleaseMatrixToPool(m_temp, matrixPool);
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return true; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t childIndex) const override { return childIndex == 1; }
+
+    size_t CellDim() const { return m_cellDim; }
+
+protected:
+    // tensor of rows [k * d, (k+1) * d) of a matrix that has the layout of the gate pre-activations
+    TensorView<ElemType> GateTensorFor(const MatrixBasePtr& data, size_t k, const FrameRange& fr) const
+    {
+        auto shape = InputRef(0).GetTensorSliceFor(1, fr);
+        shape.NarrowTo(0, k * m_cellDim, (k + 1) * m_cellDim);
+        return TensorView<ElemType>(data, shape);
+    }
+    // same for our own value or gradient, where k = 0 is ht and k = 1 is ct
+    TensorView<ElemType> OutputTensorFor(const MatrixBasePtr& data, size_t k, const FrameRange& fr) const
+    {
+        auto shape = GetTensorSliceFor(1, fr);
+        shape.NarrowTo(0, k * m_cellDim, (k + 1) * m_cellDim);
+        return TensorView<ElemType>(data, shape);
+    }
+
+    void ForwardPropCPU(const FrameRange& fr);
+    void BackpropToCPU(const size_t inputIndex, const FrameRange& fr);
+
+    size_t m_cellDim;
+    shared_ptr<Matrix<ElemType>> m_gates; // [4d x T*S] it, gt, ft, ot after their nonlinearities
+    shared_ptr<Matrix<ElemType>> m_temp;  // [4d x T*S] scratch for BackpropTo()
+};
+
 }}}
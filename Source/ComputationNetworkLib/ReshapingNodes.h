@@ -795,6 +795,7 @@ public:
             InvalidArgument("Slice Axis call with invalid index (%d) >= axis size (%d)", idx, (int)m_axis.size());
         return m_axis[idx]; 
     }
+    std::vector<int> StrideMultiplier() const { return m_stride_multiplier; }
 
 private:
 
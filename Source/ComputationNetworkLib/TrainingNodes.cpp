@@ -4,7 +4,6 @@
 //
 
 #include "TrainingNodes.h"
-#include <boost/random/uniform_real_distribution.hpp>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -118,50 +117,54 @@ void RandomSampleNodeBase<ElemType>::UpdateWeightsPrefixSum()
 
 // Runs the sampling returning a vector with the id's of the samples. The parameter nTries is used to return the number of draws that was needed
 // to get the expected number of samples.
+// Each draw consumes one position of the counter-based stream of the CPURNGHandle. With duplicates allowed, the number of draws is
+// known up front, and they are done in parallel.
 template<class ElemType>
 const std::vector<size_t> RandomSampleNodeBase<ElemType>::RunSampling(size_t& nTries)
 {
-    boost::random::uniform_real_distribution<double> r(0, m_samplingWeightsPrefixSum.back());
-    std::unordered_set<int> alreadySampled;
-    std::vector<size_t> samples;
     CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&GetRNGHandle(CPUDEVICE));
+    const uint64_t seed = cpuRNGHandle->Seed();
+    const double totalWeight = m_samplingWeightsPrefixSum.back();
+    auto draw = [&](uint64_t position)
+    {
+        uint32_t bits;
+        CPURNGHandle::GenerateBits(seed, position, 1, &bits);
+        double randomValue = totalWeight * CPURNGHandle::ToUniform(bits);
+        // Find the first index where value[idx] >= randomValue.
+        auto lower = std::lower_bound(m_samplingWeightsPrefixSum.begin(), m_samplingWeightsPrefixSum.end(), randomValue);
+        return (size_t)(lower - m_samplingWeightsPrefixSum.begin());
+    };
 
-    // find random samples using the specified weight
+    std::vector<size_t> samples;
     if (m_allowDuplicates)
+    {
         nTries = m_sizeOfSampledSet;
+        samples.resize(m_sizeOfSampledSet);
+        const uint64_t first = cpuRNGHandle->Reserve(m_sizeOfSampledSet);
+#pragma omp parallel for
+        for (long i = 0; i < (long)m_sizeOfSampledSet; i++)
+            samples[i] = draw(first + i);
+    }
     else
-        nTries = 0; // just initialize and count how many tries we need.
-
-    auto offset = GetRngOffset();
-    while (samples.size() < m_sizeOfSampledSet)
     {
-        double randomValue = r(cpuRNGHandle->Generator());
-        offset++;
-        // Find the first index where value[idx] >= randomValue.
-        auto lower = std::lower_bound(m_samplingWeightsPrefixSum.begin(), m_samplingWeightsPrefixSum.end(), randomValue);
-        int idx = (int)(lower - m_samplingWeightsPrefixSum.begin());
-
-        if (m_allowDuplicates)
-            samples.push_back(idx);
-        else
+        // Sampling without replacement: each value can be sampled at most once.
+        // The implementation below using rejection sampling is problematic.
+        // E.g if first class has probability p = 0.999 we typically will have to sample 1000 times or more to hit another class.
+        // BUGBUG Alternative implementions, e.g:
+        // * Weighted Random Sampling with Reservoir: http://utopia.duth.gr/~pefraimi/research/data/2007EncOfAlg.pdf
+        // * Binary tree with classes as leafes and branch probs on non-leafes.
+        // * As in numpy: https://github.com/numpy/numpy/blob/master/numpy/random/mtrand/mtrand.pyx#L1440
+        std::unordered_set<size_t> alreadySampled;
+        nTries = 0; // just initialize and count how many tries we need.
+        while (samples.size() < m_sizeOfSampledSet)
         {
-            // Sampling without replacement: each value can be sampled at most once. 
-            // The implementation below using rejection sampling is problematic.
-            // E.g if first class has probability p = 0.999 we typically will have to sample 1000 times or more to hit another class.
-            // BUGBUG Alternative implementions, e.g:
-            // * Weighted Random Sampling with Reservoir: http://utopia.duth.gr/~pefraimi/research/data/2007EncOfAlg.pdf
-            // * Binary tree with classes as leafes and branch probs on non-leafes.
-            // * As in numpy: https://github.com/numpy/numpy/blob/master/numpy/random/mtrand/mtrand.pyx#L1440
+            size_t idx = draw(cpuRNGHandle->Reserve(1));
             nTries++;
-            if (alreadySampled.find(idx) != alreadySampled.end()) continue;
-            else
-            {
+            if (alreadySampled.insert(idx).second)
                 samples.push_back(idx);
-                alreadySampled.insert(idx);
-            }
         }
     }
-    UpdateRngOffset(offset);
+    UpdateRngOffset(GetRngOffset() + nTries);
     return samples;
 }
 
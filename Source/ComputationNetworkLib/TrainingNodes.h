@@ -1718,6 +1718,689 @@ protected:
 template class ClassBasedCrossEntropyWithSoftmaxNode<float>;
 template class ClassBasedCrossEntropyWithSoftmaxNode<double>;
 
+// -----------------------------------------------------------------------
+// ChunkedCrossEntropyWithSoftmaxNode (labels, weights, hidden)
+// Computes the same criterion as CrossEntropyWithSoftmax (labels, Times (weights, hidden)),
+// i.e. -sum(labels_i * log(softmax_i(weights * hidden))), without materializing the logits.
+//  - Input(0) [V x T] labels, dense or sparse
+//  - Input(1) [V x H] output-layer weights, as they would be passed to Times()
+//  - Input(2) [H x T] hidden activations
+// The logits are computed in blocks of 'blockSize' rows of the vocabulary. The forward pass keeps
+// only a running log-sum-exp per column; the backward pass recomputes each block of logits, turns it
+// into its block of the softmax and immediately multiplies it into the gradients of weights and hidden.
+// Using that log softmax_i = z_i - logSumExp, the label term -sum(labels_i * z_i) is computed through
+// the [H x T] product weights^T * labels, which keeps sparse labels sparse.
+// Peak memory of the output layer is thus O(blockSize x T) instead of O(V x T), at the cost of
+// computing the logits twice.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class ChunkedCrossEntropyWithSoftmaxNode : public ComputationNodeNonLooping /*ComputationNode*/<ElemType>, public NumInputs<3>
+{
+    typedef ComputationNodeNonLooping<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"ChunkedCrossEntropyWithSoftmax"; }
+
+    // our inputs
+    static const size_t LABELS = 0;
+    static const size_t WEIGHTS = 1;
+    static const size_t HIDDEN = 2;
+
+public:
+    ChunkedCrossEntropyWithSoftmaxNode(DEVICEID_TYPE deviceId, const wstring& name, size_t blockSize = 4096)
+        : Base(deviceId, name), m_blockSize(blockSize), m_needBackpropToWeightsAndHidden(false)
+    {
+    }
+
+    ChunkedCrossEntropyWithSoftmaxNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : ChunkedCrossEntropyWithSoftmaxNode(configp->Get(L"deviceId"), L"<placeholder>", configp->Get(L"blockSize"))
+    {
+        AttachInputsFromConfig(configp, this->GetExpectedNumInputs());
+    }
+
+    virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override
+    {
+        FrameRange fr(InputRef(LABELS).GetMBLayout());
+        // gaps are masked to zero in both labels and hidden, such that they contribute zero to the sum
+        auto labels = InputRef(LABELS).MaskedValueFor(fr);
+        auto hidden = InputRef(HIDDEN).MaskedValueFor(fr);
+        const auto& weights = InputRef(WEIGHTS).ValueAsMatrix();
+        const size_t numCols = hidden.GetNumCols();
+
+        // running log-sum-exp over the blocks of the vocabulary
+        auto logSumExp = TensorView<ElemType>(m_logSumExp, TensorShape(1, numCols));
+        auto blockLogSumExp = TensorView<ElemType>(m_blockLogSumExp, TensorShape(1, numCols));
+        ForBlocksOfVocabulary([&](size_t begin, size_t count)
+        {
+            auto logits = ComputeLogitsBlock(weights, hidden, begin, count);
+            if (begin == 0)
+                logSumExp.DoUnaryOpOf(0, logits, 1, ElementWiseOperator::opCopy, ElementWiseOperator::opLogSum);
+            else
+            {
+                blockLogSumExp.DoUnaryOpOf(0, logits, 1, ElementWiseOperator::opCopy, ElementWiseOperator::opLogSum);
+                logSumExp.AssignLogSumOf(logSumExp, blockLogSumExp);
+            }
+        });
+
+        // sum over the labels of each column, 1 for one-hot labels and 0 for gaps
+        if (m_ones->GetNumRows() != labels.GetNumRows())
+        {
+            m_ones->Resize(labels.GetNumRows(), 1);
+            m_ones->SetValue(1);
+        }
+        Matrix<ElemType>::Multiply(*m_ones, true, labels, false, *m_labelSum);
+
+        // -sum(labels_i * log softmax_i) = sum_t(labelSum_t * logSumExp_t) - sum_t(hidden_t . (weights^T labels)_t)
+        Matrix<ElemType>::Multiply(weights, true, labels, false, *m_labelProjection);
+        Value().AssignInnerProductOfMatrices(*m_labelSum, *m_logSumExp);
+        Value() -= Matrix<ElemType>::InnerProductOfMatrices(hidden, *m_labelProjection);
+#if NANCHECK
+        Value().HasNan("ChunkedCrossEntropyWithSoftmax");
+#endif
+        m_needBackpropToWeightsAndHidden = true;
+    }
+
+    virtual void BackpropToNonLooping(size_t inputIndex) override
+    {
+        if (inputIndex == LABELS)
+            BackpropToLabels();
+        else if (m_needBackpropToWeightsAndHidden)
+        {
+            // Both gradients are computed in the same pass over the blocks, so that the logits are recomputed once.
+            for (size_t i = WEIGHTS; i <= HIDDEN; i++)
+            {
+                if (InputRef(i).NeedsGradient())
+                    InputRef(i).LazyZeroGradient(this);
+            }
+            BackpropToWeightsAndHidden();
+            m_needBackpropToWeightsAndHidden = false;
+        }
+    }
+
+private:
+    template <class F>
+    void ForBlocksOfVocabulary(const F& f)
+    {
+        const size_t vocabularySize = InputRef(WEIGHTS).GetAsMatrixNumRows();
+        for (size_t begin = 0; begin < vocabularySize; begin += m_blockSize)
+            f(begin, min(m_blockSize, vocabularySize - begin));
+    }
+
+    // Computes the rows [begin, begin + count) of weights * hidden into m_logits. The block of the weights is kept in m_weightsBlock.
+    TensorView<ElemType> ComputeLogitsBlock(const Matrix<ElemType>& weights, const Matrix<ElemType>& hidden, size_t begin, size_t count)
+    {
+        m_weightsBlock->AssignRowSliceValuesOf(weights, begin, count);
+        Matrix<ElemType>::Multiply(*m_weightsBlock, false, hidden, false, *m_logits);
+        return TensorView<ElemType>(m_logits, TensorShape(count, hidden.GetNumCols()));
+    }
+
+    // gradient w.r.t. the labels: -log softmax_i = logSumExp - z_i
+    void BackpropToLabels()
+    {
+        FrameRange fr(InputRef(LABELS).GetMBLayout());
+        auto hidden = InputRef(HIDDEN).MaskedValueFor(fr);
+        const auto& weights = InputRef(WEIGHTS).ValueAsMatrix();
+        auto gradient = InputRef(LABELS).GradientFor(fr);
+        const ElemType outputGradient = Gradient().Get00Element();
+
+        let logSumExp = TensorView<ElemType>(m_logSumExp, TensorShape(1, hidden.GetNumCols()));
+        ForBlocksOfVocabulary([&](size_t begin, size_t count)
+        {
+            auto logits = ComputeLogitsBlock(weights, hidden, begin, count);
+            logits.AssignDifferenceOf(logSumExp, logits, outputGradient);
+            gradient.AddToRowSliceValuesOf(*m_logits, begin, count);
+        });
+    }
+
+    // gradient w.r.t. the logits is (softmax * labelSum - labels) * outputGradient,
+    // the softmax part is multiplied into the gradients block by block, the labels part in one go at the end
+    void BackpropToWeightsAndHidden()
+    {
+        FrameRange fr(InputRef(LABELS).GetMBLayout());
+        auto labels = InputRef(LABELS).MaskedValueFor(fr);
+        auto hidden = InputRef(HIDDEN).MaskedValueFor(fr);
+        const auto& weights = InputRef(WEIGHTS).ValueAsMatrix();
+        const bool needsWeightsGradient = InputRef(WEIGHTS).NeedsGradient();
+        const bool needsHiddenGradient = InputRef(HIDDEN).NeedsGradient();
+        const ElemType outputGradient = Gradient().Get00Element();
+
+        let logSumExp = TensorView<ElemType>(m_logSumExp, TensorShape(1, hidden.GetNumCols()));
+        let labelSum = TensorView<ElemType>(m_labelSum, TensorShape(1, hidden.GetNumCols()));
+        ForBlocksOfVocabulary([&](size_t begin, size_t count)
+        {
+            // turn the logits of this block into softmax * labelSum * outputGradient
+            auto logits = ComputeLogitsBlock(weights, hidden, begin, count);
+            logits.AssignDifferenceOf(logits, logSumExp);
+            logits.AssignExpOf(logits);
+            logits.AssignElementwiseProductOf(logits, labelSum, outputGradient);
+
+            if (needsHiddenGradient)
+            {
+                auto hiddenGradient = InputRef(HIDDEN).GradientFor(fr);
+                Matrix<ElemType>::MultiplyAndAdd(*m_weightsBlock, true, *m_logits, false, hiddenGradient);
+            }
+            if (needsWeightsGradient) // (this overwrites m_weightsBlock)
+            {
+                Matrix<ElemType>::Multiply(*m_logits, false, hidden, true, *m_weightsBlock);
+                InputRef(WEIGHTS).GradientAsMatrix().AddToRowSliceValuesOf(*m_weightsBlock, begin, count);
+            }
+        });
+
+        if (needsWeightsGradient)
+            Matrix<ElemType>::MultiplyAndWeightedAdd(-outputGradient, labels, false, hidden, true, 1, InputRef(WEIGHTS).GradientAsMatrix());
+        if (needsHiddenGradient)
+        {
+            auto hiddenGradient = InputRef(HIDDEN).GradientFor(fr);
+            Matrix<ElemType>::ScaleAndAdd(-outputGradient, *m_labelProjection, hiddenGradient);
+        }
+    }
+
+public:
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+
+    virtual void UpdateFunctionMBSize() override
+    {
+        const size_t numCols = Input(HIDDEN)->Value().GetNumCols();
+        m_logSumExp->Resize(1, numCols);
+        m_blockLogSumExp->Resize(1, numCols);
+        m_labelSum->Resize(1, numCols);
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        m_pMBLayout = nullptr; // this node does not hold mini-batch data
+
+        if (isFinalValidationPass)
+        {
+            if (!Input(LABELS)->HasMBLayout() || Input(LABELS)->GetMBLayout() != Input(HIDDEN)->GetMBLayout())
+                InvalidArgument("%ls %ls operation requires that the layouts of inputs 0 (labels) and 2 (hidden) match.", NodeName().c_str(), OperationName().c_str());
+            if (Input(WEIGHTS)->HasMBLayout())
+                InvalidArgument("%ls %ls operation requires input 1 (weights) to be a parameter without a dynamic axis.", NodeName().c_str(), OperationName().c_str());
+            if (Input(WEIGHTS)->GetAsMatrixNumRows() != Input(LABELS)->GetSampleMatrixNumRows() ||
+                Input(WEIGHTS)->GetAsMatrixNumCols() != Input(HIDDEN)->GetSampleMatrixNumRows())
+                InvalidArgument("%ls %ls operation: The weights [%d x %d] do not match the dimensions of labels (%d) and hidden (%d).", NodeName().c_str(), OperationName().c_str(),
+                                (int)Input(WEIGHTS)->GetAsMatrixNumRows(), (int)Input(WEIGHTS)->GetAsMatrixNumCols(),
+                                (int)Input(LABELS)->GetSampleMatrixNumRows(), (int)Input(HIDDEN)->GetSampleMatrixNumRows());
+            if (m_blockSize == 0)
+                InvalidArgument("%ls %ls operation: blockSize must be positive.", NodeName().c_str(), OperationName().c_str());
+        }
+
+        SetDims(TensorShape::Scalar(Environment().IsV2Library()), false);
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<ChunkedCrossEntropyWithSoftmaxNode<ElemType>>(nodeP);
+            node->m_blockSize = m_blockSize;
+        }
+    }
+
+    virtual void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << m_blockSize;
+    }
+
+    virtual void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        fstream >> m_blockSize;
+    }
+
+    size_t BlockSize() const { return m_blockSize; }
+
+    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::RequestMatricesBeforeForwardProp(matrixPool);
+        RequestMatrixFromPool(m_logits, matrixPool);
+        RequestMatrixFromPool(m_weightsBlock, matrixPool);
+        RequestMatrixFromPool(m_logSumExp, matrixPool);
+        RequestMatrixFromPool(m_blockLogSumExp, matrixPool);
+        RequestMatrixFromPool(m_labelSum, matrixPool);
+        RequestMatrixFromPool(m_labelProjection, matrixPool);
+        if (!m_ones)
+            m_ones = make_shared<Matrix<ElemType>>(m_deviceId);
+    }
+
+    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) override
+    {
+        Base::ReleaseMatricesAfterBackprop(matrixPool);
+        ReleaseMatrixToPool(m_logits, matrixPool);
+        ReleaseMatrixToPool(m_weightsBlock, matrixPool);
+        ReleaseMatrixToPool(m_logSumExp, matrixPool);
+        ReleaseMatrixToPool(m_blockLogSumExp, matrixPool);
+        ReleaseMatrixToPool(m_labelSum, matrixPool);
+        ReleaseMatrixToPool(m_labelProjection, matrixPool);
+    }
+
+protected:
+    size_t m_blockSize;                               // number of rows of the vocabulary processed at once
+    shared_ptr<Matrix<ElemType>> m_logits;            // [blockSize x T] logits of the current block
+    shared_ptr<Matrix<ElemType>> m_weightsBlock;      // [blockSize x H] current block of the weights, or of their gradient
+    shared_ptr<Matrix<ElemType>> m_logSumExp;         // [1 x T] log of the softmax denominator
+    shared_ptr<Matrix<ElemType>> m_blockLogSumExp;    // [1 x T] same for the current block
+    shared_ptr<Matrix<ElemType>> m_labelSum;          // [1 x T] sum of the labels of each column
+    shared_ptr<Matrix<ElemType>> m_labelProjection;   // [H x T] weights^T * labels
+    shared_ptr<Matrix<ElemType>> m_ones;              // [V x 1] all ones, to sum the (possibly sparse) labels
+    bool m_needBackpropToWeightsAndHidden;
+};
+
+template class ChunkedCrossEntropyWithSoftmaxNode<float>;
+template class ChunkedCrossEntropyWithSoftmaxNode<double>;
+
+// -----------------------------------------------------------------------
+// SampledCrossEntropyWithSoftmaxNode (labels, hidden, weights, samplingWeights)
+// Sampled softmax: estimates CrossEntropyWithSoftmax (labels, Times (weights, hidden, transpose)) from the
+// true class and a set of 'numSamples' negative classes that is drawn once per minibatch and shared by all its columns.
+//  - Input(0) [V x T] one-hot labels, normally sparse
+//  - Input(1) [H x T] hidden activations
+//  - Input(2) [H x V] output embedding, one column per class (the layout of ClassBasedCrossEntropyWithSoftmax and NCE)
+//  - Input(3) [V] sampling weights, e.g. unigram counts
+// The negatives are drawn with replacement from the proposal Q(i) ~ samplingWeights_i^alpha with an alias table,
+// so that a draw is O(1); the table is built once and rebuilt only if the sampling weights can change, i.e. if
+// they are not a constant leaf. Each logit is corrected by the log of its expected count, z_i = w_i . h - log(numSamples Q(i)),
+// and negatives that coincide with the true class of a column are removed from that column.
+// Only the embeddings of the sampled and of the true classes are gathered, and the gradient of the embedding has
+// only those columns. With sparse labels it is produced as a block-sparse matrix, as for an embedding used with Times().
+// The cost of the output layer is thus O(H x (numSamples + 1) x T) per minibatch instead of O(H x V x T).
+// The value is the sampled estimate of the criterion also at evaluation time; use CrossEntropyWithSoftmax for the exact one.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class SampledCrossEntropyWithSoftmaxNode : public ComputationNodeNonLooping /*ComputationNode*/<ElemType>, public NumInputs<4>, public RngUser
+{
+    typedef ComputationNodeNonLooping<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"SampledCrossEntropyWithSoftmax"; }
+
+    // our inputs
+    static const size_t LABELS = 0;
+    static const size_t HIDDEN = 1;
+    static const size_t WEIGHTS = 2;
+    static const size_t SAMPLINGWEIGHTS = 3;
+
+    // per-class statistics gathered with the labels and the samples: class index, log of the expected count, and 1 (to sum the labels)
+    static const size_t CLASSINDEX = 0;
+    static const size_t LOGEXPECTEDCOUNT = 1;
+    static const size_t ONE = 2;
+    static const size_t NUMCLASSSTATISTICS = 3;
+
+public:
+    SampledCrossEntropyWithSoftmaxNode(DEVICEID_TYPE deviceId, const wstring& name, size_t numSamples = 0, double alpha = 1.0)
+        : Base(deviceId, name), m_numSamples(numSamples), m_alpha(alpha), m_needBackpropToWeightsAndHidden(false)
+    {
+        SetRngState(CreateUniqId());
+    }
+
+    SampledCrossEntropyWithSoftmaxNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : SampledCrossEntropyWithSoftmaxNode(configp->Get(L"deviceId"), L"<placeholder>", configp->Get(L"numSamples"), configp->Get(L"alpha"))
+    {
+        AttachInputsFromConfig(configp, this->GetExpectedNumInputs());
+    }
+
+    virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override
+    {
+        FrameRange fr(InputRef(LABELS).GetMBLayout());
+        // gaps are masked to zero in both labels and hidden; their label sum of 0 removes them from the criterion
+        auto labels = InputRef(LABELS).MaskedValueFor(fr);
+        auto hidden = InputRef(HIDDEN).MaskedValueFor(fr);
+        const auto& weights = InputRef(WEIGHTS).ValueAsMatrix();
+        const size_t numCols = hidden.GetNumCols();
+
+        if (ProposalNeedsUpdate())
+            UpdateProposal();
+        DrawSamples();
+
+        // gather the statistics and the embeddings of the samples and of the true classes
+        Matrix<ElemType>::Multiply(*m_sampleSelection, true, *m_classStatistics, false, *m_sampleStatistics);
+        Matrix<ElemType>::Multiply(*m_classStatistics, true, labels, false, *m_labelStatistics);
+        Matrix<ElemType>::Multiply(weights, false, *m_sampleSelection, false, *m_sampledWeights);
+        Matrix<ElemType>::Multiply(weights, false, labels, false, *m_labelWeights);
+
+        // corrected logits of the samples, with the accidental hits of the true class pushed out of the softmax
+        Matrix<ElemType>::Multiply(*m_sampledWeights, true, hidden, false, *m_sampledLogits);
+        auto sampledLogits = TensorView<ElemType>(m_sampledLogits, TensorShape(m_numSamples, numCols));
+        sampledLogits.AssignDifferenceOf(sampledLogits, SampleStatistic(LOGEXPECTEDCOUNT));
+        sampledLogits.DoEqualOf(1, SampleStatistic(CLASSINDEX), LabelStatistic(CLASSINDEX, numCols), -MaskedLogitOffset());
+
+        // corrected logits of the true classes
+        m_trueLogits->AssignInnerProductOf(*m_labelWeights, hidden, true);
+        auto trueLogits = TensorView<ElemType>(m_trueLogits, TensorShape(1, numCols));
+        trueLogits.AssignDifferenceOf(trueLogits, LabelStatistic(LOGEXPECTEDCOUNT, numCols));
+
+        auto logSumExp = TensorView<ElemType>(m_logSumExp, TensorShape(1, numCols));
+        logSumExp.DoUnaryOpOf(0, sampledLogits, 1, ElementWiseOperator::opCopy, ElementWiseOperator::opLogSum);
+        logSumExp.AssignLogSumOf(logSumExp, trueLogits);
+
+        // sum_t labelSum_t * (logSumExp_t - trueLogit_t)
+        auto value = TensorView<ElemType>(ValuePtr(), TensorShape(1, 1));
+        let labelSum = LabelStatistic(ONE, numCols);
+        value.AssignElementwiseProductOf(logSumExp, labelSum);
+        value.DoElementwiseProductOf(1, trueLogits, labelSum, -1);
+#if NANCHECK
+        Value().HasNan("SampledCrossEntropyWithSoftmax");
+#endif
+        m_needBackpropToWeightsAndHidden = true;
+    }
+
+    virtual void BackpropToNonLooping(size_t inputIndex) override
+    {
+        if (inputIndex != HIDDEN && inputIndex != WEIGHTS)
+            InvalidArgument("%ls %ls operation only takes gradients with respect to hidden and weights.", NodeName().c_str(), OperationName().c_str());
+
+        if (m_needBackpropToWeightsAndHidden)
+        {
+            // Both gradients are computed together, from the same gradient of the logits.
+            for (size_t i = HIDDEN; i <= WEIGHTS; i++)
+            {
+                if (InputRef(i).NeedsGradient())
+                    InputRef(i).LazyZeroGradient(this);
+            }
+            BackpropToWeightsAndHidden();
+            m_needBackpropToWeightsAndHidden = false;
+        }
+    }
+
+private:
+    // offset that removes a logit from the softmax without overflowing the element type
+    static ElemType MaskedLogitOffset() { return (ElemType)(std::is_same<ElemType, half>::value ? 1e4 : 1e30); }
+
+    // one statistic of the samples, as an [S x 1] column
+    TensorView<ElemType> SampleStatistic(size_t statistic) const
+    {
+        TensorShape shape(m_numSamples, NUMCLASSSTATISTICS);
+        shape.NarrowTo(1, statistic, statistic + 1);
+        return TensorView<ElemType>(m_sampleStatistics, shape);
+    }
+
+    // one statistic of the labels, as a [1 x T] row
+    TensorView<ElemType> LabelStatistic(size_t statistic, size_t numCols) const
+    {
+        TensorShape shape(NUMCLASSSTATISTICS, numCols);
+        shape.NarrowTo(0, statistic, statistic + 1);
+        return TensorView<ElemType>(m_labelStatistics, shape);
+    }
+
+    // The proposal only changes with the sampling weights. Parameters that are not learned keep their value.
+    bool ProposalNeedsUpdate() const
+    {
+        const auto& samplingWeights = Input(SAMPLINGWEIGHTS);
+        return m_alias.size() != samplingWeights->GetSampleLayout().GetNumElements() || !samplingWeights->IsLeaf() || samplingWeights->NeedsGradient();
+    }
+
+    // Builds the alias table of the proposal (Vose's method) and the per-class statistics [V x 3].
+    void UpdateProposal()
+    {
+        const auto& samplingWeights = InputRef(SAMPLINGWEIGHTS).ValueAsMatrix();
+        const size_t numClasses = samplingWeights.GetNumElements();
+        std::vector<ElemType> weights(numClasses);
+        samplingWeights.CopySection(samplingWeights.GetNumRows(), samplingWeights.GetNumCols(), weights.data(), samplingWeights.GetNumRows());
+
+        std::vector<double> proposal(numClasses);
+        double sum = 0;
+        for (size_t i = 0; i < numClasses; i++)
+        {
+            if (weights[i] < 0)
+                InvalidArgument("%ls %ls operation: Sampling weights contain negative number %f.", NodeName().c_str(), OperationName().c_str(), (float)weights[i]);
+            proposal[i] = pow((double)weights[i], m_alpha);
+            sum += proposal[i];
+        }
+        if (!(sum > 0) || !std::isfinite(sum))
+            InvalidArgument("%ls %ls operation: The sampling weights do not define a distribution.", NodeName().c_str(), OperationName().c_str());
+
+        // Split the classes into those below and above the average probability; each bucket of the table
+        // is then filled with one class below the average, and topped up with the remainder of one above it.
+        m_aliasProbability.resize(numClasses);
+        m_alias.resize(numClasses);
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < numClasses; i++)
+        {
+            m_aliasProbability[i] = proposal[i] / sum * numClasses;
+            m_alias[i] = i;
+            (m_aliasProbability[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty())
+        {
+            size_t less = small.back(), more = large.back();
+            small.pop_back();
+            large.pop_back();
+            m_alias[less] = more;
+            m_aliasProbability[more] -= 1 - m_aliasProbability[less];
+            (m_aliasProbability[more] < 1 ? small : large).push_back(more);
+        }
+        for (auto i : small) // (only left over by rounding)
+            m_aliasProbability[i] = 1;
+        for (auto i : large)
+            m_aliasProbability[i] = 1;
+
+        // Classes the proposal never draws get the smallest expected count instead of log 0.
+        std::vector<ElemType> statistics(numClasses * NUMCLASSSTATISTICS);
+        for (size_t i = 0; i < numClasses; i++)
+        {
+            double expectedCount = std::max(m_numSamples * proposal[i] / sum, (double)std::numeric_limits<float>::min());
+            statistics[i + CLASSINDEX * numClasses] = (ElemType)i;
+            statistics[i + LOGEXPECTEDCOUNT * numClasses] = (ElemType)log(expectedCount);
+            statistics[i + ONE * numClasses] = 1;
+        }
+        m_classStatistics->SetValue(numClasses, NUMCLASSSTATISTICS, m_deviceId, statistics.data());
+    }
+
+    // Draws the shared negatives into m_samples and the [V x S] one-hot selection matrix.
+    // Each draw consumes two words of the counter-based stream, one for the bucket and one for the coin.
+    void DrawSamples()
+    {
+        const size_t numClasses = m_alias.size();
+        CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&GetRNGHandle(CPUDEVICE));
+        const uint64_t seed = cpuRNGHandle->Seed();
+        const uint64_t first = cpuRNGHandle->Reserve(2 * m_numSamples);
+
+        m_samples.resize(m_numSamples);
+#pragma omp parallel for
+        for (long s = 0; s < (long)m_numSamples; s++)
+        {
+            uint32_t bits[2];
+            CPURNGHandle::GenerateBits(seed, first + 2 * s, 2, bits);
+            size_t bucket = std::min((size_t)(CPURNGHandle::ToUniform(bits[0]) * numClasses), numClasses - 1);
+            m_samples[s] = CPURNGHandle::ToUniform(bits[1]) < m_aliasProbability[bucket] ? bucket : m_alias[bucket];
+        }
+        UpdateRngOffset(GetRngOffset() + 2 * m_numSamples);
+
+        std::vector<CPUSPARSE_INDEX_TYPE> colStarts(m_numSamples + 1), rows(m_numSamples);
+        std::vector<ElemType> values(m_numSamples, 1);
+        for (size_t s = 0; s < m_numSamples; s++)
+        {
+            colStarts[s] = (CPUSPARSE_INDEX_TYPE)s;
+            rows[s] = (CPUSPARSE_INDEX_TYPE)m_samples[s];
+        }
+        colStarts[m_numSamples] = (CPUSPARSE_INDEX_TYPE)m_numSamples;
+        m_sampleSelection->SetMatrixFromCSCFormat(colStarts.data(), rows.data(), values.data(), m_numSamples, numClasses, m_numSamples);
+    }
+
+    // Like Times() with a sparse right operand, sparse labels give the weights a block-sparse gradient.
+    void PrepareWeightsGradient(const Matrix<ElemType>& labels)
+    {
+        auto& weights = InputRef(WEIGHTS);
+        if (labels.GetMatrixType() == SPARSE && weights.GetPreferredGradientMatrixType() == UNDETERMINED)
+        {
+            // (the gradient has just been zeroed, so there is nothing to keep)
+            const auto& gradient = weights.Gradient();
+            weights.GradientPtrRef() = std::make_shared<Matrix<ElemType>>(gradient.GetNumRows(), gradient.GetNumCols(), gradient.GetPreferredDeviceId(),
+                                                                          SPARSE, MatrixFormat::matrixFormatSparseBlockCol);
+            weights.SetPreferredGradientMatrixType(SPARSE);
+        }
+        else if (labels.GetMatrixType() == DENSE && weights.GetPreferredGradientMatrixType() != DENSE)
+        {
+            if (weights.GetPreferredGradientMatrixType() == SPARSE)
+                weights.Gradient().SwitchToMatrixType(DENSE, matrixFormatDense, true);
+            weights.SetPreferredGradientMatrixType(DENSE);
+        }
+    }
+
+    // The gradient of the criterion w.r.t. a logit is (softmax - [true class]) * labelSum * outputGradient.
+    // Only the sampled and the true classes have logits, so only their embeddings receive a gradient.
+    void BackpropToWeightsAndHidden()
+    {
+        FrameRange fr(InputRef(LABELS).GetMBLayout());
+        auto labels = InputRef(LABELS).MaskedValueFor(fr);
+        auto hidden = InputRef(HIDDEN).MaskedValueFor(fr);
+        const size_t numCols = hidden.GetNumCols();
+        const bool needsWeightsGradient = InputRef(WEIGHTS).NeedsGradient();
+        const bool needsHiddenGradient = InputRef(HIDDEN).NeedsGradient();
+        const ElemType outputGradient = Gradient().Get00Element();
+
+        let logSumExp = TensorView<ElemType>(m_logSumExp, TensorShape(1, numCols));
+        let labelSum = LabelStatistic(ONE, numCols);
+        auto sampledLogits = TensorView<ElemType>(m_sampledLogits, TensorShape(m_numSamples, numCols));
+        sampledLogits.AssignDifferenceOf(sampledLogits, logSumExp);
+        sampledLogits.AssignExpOf(sampledLogits);
+        sampledLogits.AssignElementwiseProductOf(sampledLogits, labelSum, outputGradient);
+        auto trueLogits = TensorView<ElemType>(m_trueLogits, TensorShape(1, numCols));
+        trueLogits.AssignDifferenceOf(trueLogits, logSumExp);
+        trueLogits.AssignExpOf(trueLogits);
+        trueLogits.AssignElementwiseProductOf(trueLogits, labelSum, outputGradient);
+        trueLogits.DoCopyOf(1, labelSum, -outputGradient);
+
+        if (needsHiddenGradient)
+        {
+            auto hiddenGradient = InputRef(HIDDEN).GradientFor(fr);
+            Matrix<ElemType>::MultiplyAndAdd(*m_sampledWeights, false, *m_sampledLogits, false, hiddenGradient);
+            m_labelWeights->RowElementMultiplyWith(*m_trueLogits);
+            hiddenGradient += *m_labelWeights;
+        }
+        if (needsWeightsGradient) // (this overwrites m_sampledWeights and m_labelWeights)
+        {
+            PrepareWeightsGradient(labels);
+            auto& weightsGradient = InputRef(WEIGHTS).GradientAsMatrix();
+            Matrix<ElemType>::Multiply(hidden, false, *m_sampledLogits, true, *m_sampledWeights);
+            Matrix<ElemType>::MultiplyAndAdd(*m_sampledWeights, false, *m_sampleSelection, true, weightsGradient);
+            m_labelWeights->AssignValuesOf(hidden);
+            m_labelWeights->RowElementMultiplyWith(*m_trueLogits);
+            Matrix<ElemType>::MultiplyAndAdd(*m_labelWeights, false, labels, true, weightsGradient);
+        }
+    }
+
+public:
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t childIndex) const override { return childIndex == LABELS || childIndex == HIDDEN; }
+
+    virtual void UpdateFunctionMBSize() override
+    {
+        const size_t numCols = Input(HIDDEN)->Value().GetNumCols();
+        m_trueLogits->Resize(1, numCols);
+        m_logSumExp->Resize(1, numCols);
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        m_pMBLayout = nullptr; // this node does not hold mini-batch data
+
+        if (isFinalValidationPass)
+        {
+            if (!Input(LABELS)->HasMBLayout() || Input(LABELS)->GetMBLayout() != Input(HIDDEN)->GetMBLayout())
+                InvalidArgument("%ls %ls operation requires that the layouts of inputs 0 (labels) and 1 (hidden) match.", NodeName().c_str(), OperationName().c_str());
+            if (Input(WEIGHTS)->HasMBLayout() || Input(SAMPLINGWEIGHTS)->HasMBLayout())
+                InvalidArgument("%ls %ls operation requires inputs 2 (weights) and 3 (samplingWeights) to be without a dynamic axis.", NodeName().c_str(), OperationName().c_str());
+            if (Input(WEIGHTS)->GetAsMatrixNumRows() != Input(HIDDEN)->GetSampleMatrixNumRows() ||
+                Input(WEIGHTS)->GetAsMatrixNumCols() != Input(LABELS)->GetSampleMatrixNumRows())
+                InvalidArgument("%ls %ls operation: The weights [%d x %d] do not match the dimensions of hidden (%d) and labels (%d).", NodeName().c_str(), OperationName().c_str(),
+                                (int)Input(WEIGHTS)->GetAsMatrixNumRows(), (int)Input(WEIGHTS)->GetAsMatrixNumCols(),
+                                (int)Input(HIDDEN)->GetSampleMatrixNumRows(), (int)Input(LABELS)->GetSampleMatrixNumRows());
+            if (Input(SAMPLINGWEIGHTS)->GetSampleLayout().GetNumElements() != Input(LABELS)->GetSampleMatrixNumRows())
+                InvalidArgument("%ls %ls operation: The number of sampling weights (%d) does not match the dimension of the labels (%d).", NodeName().c_str(), OperationName().c_str(),
+                                (int)Input(SAMPLINGWEIGHTS)->GetSampleLayout().GetNumElements(), (int)Input(LABELS)->GetSampleMatrixNumRows());
+            if (m_numSamples == 0)
+                InvalidArgument("%ls %ls operation: numSamples must be positive.", NodeName().c_str(), OperationName().c_str());
+        }
+
+        SetDims(TensorShape::Scalar(Environment().IsV2Library()), false);
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<SampledCrossEntropyWithSoftmaxNode<ElemType>>(nodeP);
+            node->m_numSamples = m_numSamples;
+            node->m_alpha = m_alpha;
+            node->SetRngState(GetRngSeed(), GetRngOffset());
+        }
+    }
+
+    virtual void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << m_numSamples;
+        fstream << m_alpha;
+        RngUser::Save(fstream);
+    }
+
+    virtual void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        fstream >> m_numSamples;
+        fstream >> m_alpha;
+        RngUser::Load(fstream, modelVersion);
+    }
+
+    size_t NumSamples() const { return m_numSamples; }
+    double Alpha() const { return m_alpha; }
+
+    // the negatives of the last minibatch
+    const std::vector<size_t>& GetSamples() const { return m_samples; }
+
+    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::RequestMatricesBeforeForwardProp(matrixPool);
+        RequestMatrixFromPool(m_sampleStatistics, matrixPool);
+        RequestMatrixFromPool(m_labelStatistics, matrixPool);
+        RequestMatrixFromPool(m_sampledWeights, matrixPool);
+        RequestMatrixFromPool(m_labelWeights, matrixPool);
+        RequestMatrixFromPool(m_sampledLogits, matrixPool);
+        RequestMatrixFromPool(m_trueLogits, matrixPool);
+        RequestMatrixFromPool(m_logSumExp, matrixPool);
+        if (!m_classStatistics)
+            m_classStatistics = make_shared<Matrix<ElemType>>(m_deviceId);
+        if (!m_sampleSelection)
+            m_sampleSelection = make_shared<Matrix<ElemType>>(0, 0, m_deviceId, SPARSE, matrixFormatSparseCSC);
+    }
+
+    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) override
+    {
+        Base::ReleaseMatricesAfterBackprop(matrixPool);
+        ReleaseMatrixToPool(m_sampleStatistics, matrixPool);
+        ReleaseMatrixToPool(m_labelStatistics, matrixPool);
+        ReleaseMatrixToPool(m_sampledWeights, matrixPool);
+        ReleaseMatrixToPool(m_labelWeights, matrixPool);
+        ReleaseMatrixToPool(m_sampledLogits, matrixPool);
+        ReleaseMatrixToPool(m_trueLogits, matrixPool);
+        ReleaseMatrixToPool(m_logSumExp, matrixPool);
+    }
+
+protected:
+    size_t m_numSamples;                              // number of negatives drawn per minibatch
+    double m_alpha;                                   // exponent applied to the sampling weights
+    std::vector<double> m_aliasProbability;           // [V] probability of keeping the class of a bucket of the alias table
+    std::vector<size_t> m_alias;                      // [V] class drawn instead
+    std::vector<size_t> m_samples;                    // [S] negatives of the current minibatch
+    shared_ptr<Matrix<ElemType>> m_classStatistics;   // [V x 3] index, log expected count and 1 for each class
+    shared_ptr<Matrix<ElemType>> m_sampleSelection;   // [V x S] sparse, one-hot columns of the negatives
+    shared_ptr<Matrix<ElemType>> m_sampleStatistics;  // [S x 3] class statistics of the negatives
+    shared_ptr<Matrix<ElemType>> m_labelStatistics;   // [3 x T] class statistics of the true classes
+    shared_ptr<Matrix<ElemType>> m_sampledWeights;    // [H x S] embeddings of the negatives, or their gradient
+    shared_ptr<Matrix<ElemType>> m_labelWeights;      // [H x T] embeddings of the true classes, or their gradient
+    shared_ptr<Matrix<ElemType>> m_sampledLogits;     // [S x T] logits of the negatives, then their gradient
+    shared_ptr<Matrix<ElemType>> m_trueLogits;        // [1 x T] logits of the true classes, then their gradient
+    shared_ptr<Matrix<ElemType>> m_logSumExp;         // [1 x T] log of the sampled softmax denominator
+    bool m_needBackpropToWeightsAndHidden;
+};
+
+template class SampledCrossEntropyWithSoftmaxNode<float>;
+template class SampledCrossEntropyWithSoftmaxNode<double>;
+
 #ifdef COMING_SOON
 
 // -----------------------------------------------------------------------
@@ -431,6 +431,7 @@ public:
 public:
     // This functions do not depend on <ElemType>, i.e. you can call them on any <ElemType>
     static int SetNumThreads(int numThreads);
+    static int SetNumThreadsOfCallingThread(int numThreads); // only for parallel regions and BLAS calls started on the calling thread
     static int GetMaxNumThreads();
 
     enum OptimizationFlag
@@ -559,9 +560,6 @@ public:
     static void RCRFBackwardCompute(const CPUMatrix<ElemType>& alpha, CPUMatrix<ElemType>& beta,
                                     const CPUMatrix<ElemType>& lbls,
                                     const CPUMatrix<ElemType>& pair_scores);
-    static void _rcrfBackwardCompute(size_t t, size_t k, const CPUMatrix<ElemType>& alpha,
-                                     CPUMatrix<ElemType>& beta,
-                                     const CPUMatrix<ElemType>& pair_scores);
 
     static void RCRFTransGrdCompute(const CPUMatrix<ElemType>& lbls,
                                     const CPUMatrix<ElemType>& alpha,
@@ -569,15 +567,6 @@ public:
                                     const CPUMatrix<ElemType>& pair_scores,
                                     CPUMatrix<ElemType>& grd);
 
-    static void _rcrfTransGrdCompute(size_t i,
-                                     const CPUMatrix<ElemType>& lbls,
-                                     const CPUMatrix<ElemType>& alpha,
-                                     const CPUMatrix<ElemType>& beta,
-                                     const CPUMatrix<ElemType>& pair_scores,
-                                     CPUMatrix<ElemType>& grd,
-                                     const size_t tPos // position
-                                     );
-
 protected:
     size_t LocateElement(const size_t i, const size_t j) const;
     size_t LocateColumn(const size_t j) const;
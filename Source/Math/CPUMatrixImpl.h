@@ -12,6 +12,7 @@
 
 #include "CPUMatrix.h"
 #include "TensorOps.h"
+#include "CRFKernels.h"
 #include <assert.h>
 #include <stdexcept>
 #include <omp.h>
@@ -684,7 +685,9 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::DoScatterColumnsOf(ElemType beta, cons
 
     // pre-scale with beta upfront
     // Scatter may add more than one source column to the same target, so we must pre-scale with beta, and then just keep adding.
-    Scale(beta, us); // if beta is 0, then this will be a memset()
+    // With beta == 1 (gradient accumulation) only the scattered columns are touched.
+    if (beta != 1)
+        Scale(beta, us); // if beta is 0, then this will be a memset()
 
     ScatterValues(idx.Data(), a.Data(), us.Data(), alpha, idx.GetNumCols(), a.GetNumRows(), GetNumCols(), idx.GetNumRows());
 
@@ -878,7 +881,8 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
         // free previous array allocation if any before overwriting
-        delete[] Buffer();
+        if (!HasExternalBuffer())
+            delete[] Buffer();
 
         m_numRows = numRows;
         m_numCols = numCols;
@@ -1035,33 +1039,84 @@ void CPUMatrix<ElemType>::SetUniformRandomValue(const ElemType low, const ElemTy
 }
 
 
+// The RNGHandle versions below draw from the counter-based stream of the CPURNGHandle, see CPURNGHandle.h.
+// Each element consumes one stream position (in the same order as the elements), and blocks of c_randomBlockSize
+// elements are generated in parallel. The result only depends on seed and stream position, not on the thread count.
+static const size_t c_randomBlockSize = 4096;
+
+static CPURNGHandle& AsCPURNGHandle(RNGHandle& rngHandle)
+{
+    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&rngHandle);
+    if (cpuRNGHandle == nullptr)
+        LogicError("rngHandle must be a CPURNGHandle.");
+    return *cpuRNGHandle;
+}
+
+// Reserves n positions of the stream and calls f(i, bits) for all elements i < n, where bits is the word at position first + i.
+template <class F>
+static void ForEachRandomBits(CPURNGHandle& rngHandle, size_t n, const F& f)
+{
+    const uint64_t seed = rngHandle.Seed();
+    const uint64_t first = rngHandle.Reserve(n);
+    const long numBlocks = (long)((n + c_randomBlockSize - 1) / c_randomBlockSize);
+#pragma omp parallel for
+    for (long block = 0; block < numBlocks; block++)
+    {
+        uint32_t bits[c_randomBlockSize];
+        const size_t begin = block * c_randomBlockSize;
+        const size_t count = min(c_randomBlockSize, n - begin);
+        CPURNGHandle::GenerateBits(seed, first + begin, count, bits);
+        for (size_t i = 0; i < count; i++)
+            f(begin + i, bits[i]);
+    }
+}
+
 template <class ElemType>
 void CPUMatrix<ElemType>::SetUniformRandomValue(RNGHandle& rngHandle, const ElemType low, const ElemType high)
 {
     if (IsEmpty())
         LogicError("SetUniformRandomValue: Matrix is empty.");
 
-    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&rngHandle);
-    if (cpuRNGHandle == nullptr)
-        LogicError("rngHandle must be a CPURNGHandle.");
-
-    boost::random::uniform_real_distribution<double> r((double)low, (double)high);
-    std::generate(Data(), Data() + GetNumElements(), [&cpuRNGHandle, &r]() {return (ElemType)r(cpuRNGHandle->Generator()); });
+    ElemType* data = Data();
+    const double range = (double)high - (double)low;
+    ForEachRandomBits(AsCPURNGHandle(rngHandle), GetNumElements(), [=](size_t i, uint32_t bits)
+    {
+        data[i] = (ElemType)(low + range * CPURNGHandle::ToUniform(bits));
+    });
 }
 
+// Box-Muller transform, the stream positions 2k and 2k+1 produce the elements at 2k and 2k+1 of the same pair.
 template <class ElemType>
 void CPUMatrix<ElemType>::SetGaussianRandomValue(RNGHandle& rngHandle, const ElemType mean, const ElemType stdev)
 {
     if (IsEmpty())
         LogicError("SetGaussianRandomValue: Matrix is empty.");
 
-    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&rngHandle);
-    if (cpuRNGHandle == nullptr)
-        LogicError("rngHandle must be a CPURNGHandle.");
-
-    boost::random::normal_distribution<double> r((double)mean, (double)stdev);
-    auto n = AsMultipleOf(GetNumElements(), 2);
-    std::generate(Data(), Data() + n, [&cpuRNGHandle, &r]() {return (ElemType)r(cpuRNGHandle->Generator()); });
+    CPURNGHandle& cpuRNGHandle = AsCPURNGHandle(rngHandle);
+    const uint64_t seed = cpuRNGHandle.Seed();
+    const size_t n = GetNumElements();
+    const uint64_t first = cpuRNGHandle.Reserve(AsMultipleOf(n, 2)); // (consume whole pairs)
+    ElemType* data = Data();
+    const long numBlocks = (long)((n + c_randomBlockSize - 1) / c_randomBlockSize);
+#pragma omp parallel for
+    for (long block = 0; block < numBlocks; block++)
+    {
+        // words for all pairs that overlap [begin, begin + count)
+        uint32_t bits[c_randomBlockSize + 2];
+        const size_t begin = block * c_randomBlockSize;
+        const size_t count = min(c_randomBlockSize, n - begin);
+        const uint64_t firstPair = (first + begin) & ~(uint64_t)1;
+        const uint64_t endPair = (first + begin + count + 1) & ~(uint64_t)1;
+        CPURNGHandle::GenerateBits(seed, firstPair, (size_t)(endPair - firstPair), bits);
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint64_t position = first + begin + i;
+            const size_t k = (size_t)((position & ~(uint64_t)1) - firstPair);
+            const double radius = sqrt(-2 * log(CPURNGHandle::ToUniformNonZero(bits[k])));
+            const double angle = 6.283185307179586 /*2 pi*/ * CPURNGHandle::ToUniform(bits[k + 1]);
+            data[begin + i] = (ElemType)(mean + stdev * radius * ((position & 1) ? sin(angle) : cos(angle)));
+        }
+    }
 }
 
 template <class ElemType>
@@ -1070,12 +1125,11 @@ void CPUMatrix<ElemType>::SetGumbelRandomValue(RNGHandle& rngHandle, const ElemT
     if (IsEmpty())
         LogicError("SetGumbelRandomValue: Matrix is empty.");
 
-    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&rngHandle);
-    if (cpuRNGHandle == nullptr)
-        LogicError("rngHandle must be a CPURNGHandle.");
-
-    boost::random::uniform_real_distribution<double> r(0, 1);
-    std::generate(Data(), Data() + GetNumElements(), [&cpuRNGHandle, &r, loc, scale]() {return (ElemType)(loc - scale * log(-log1p(-r(cpuRNGHandle->Generator())))); });
+    ElemType* data = Data();
+    ForEachRandomBits(AsCPURNGHandle(rngHandle), GetNumElements(), [=](size_t i, uint32_t bits)
+    {
+        data[i] = (ElemType)(loc - scale * log(-log1p(-CPURNGHandle::ToUniform(bits))));
+    });
 }
 
 
@@ -1169,35 +1223,12 @@ void CPUMatrix<ElemType>::SetUniformRandomMask(const ElemType maskRate, const El
     if (IsEmpty())
         LogicError("SetUniformRandomValue: Matrix is empty.");
 
-    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&rngHandle);
-    if (cpuRNGHandle == nullptr)
-        LogicError("rngHandle must be a CPURNGHandle.");
-
-    auto& us = *this;
-    boost::random::uniform_real_distribution<double> r(0, 1);
-    long m = (long) GetNumRows(), n = (long) GetNumCols();
-    ElemType v;
-    for (long j = 0; j < n; j++)
+    ElemType* data = Data();
+    const double threshold = (double)maskRate;
+    ForEachRandomBits(AsCPURNGHandle(rngHandle), GetNumElements(), [=](size_t i, uint32_t bits)
     {
-        // four-way unrolling
-        for (long i = 0; i < (m & ~3); i += 4)
-        {
-            v = (ElemType)r(cpuRNGHandle->Generator());
-            us(i, j) = v <= maskRate ? (ElemType)0 : scaleValue;
-            v = r(cpuRNGHandle->Generator());
-            us(i + 1, j) = v <= maskRate ? (ElemType)0 : scaleValue;
-            v = r(cpuRNGHandle->Generator());
-            us(i + 2, j) = v <= maskRate ? (ElemType)0 : scaleValue;
-            v = r(cpuRNGHandle->Generator());
-            us(i + 3, j) = v <= maskRate ? (ElemType)0 : scaleValue;
-        }
-        // handle remaining stuffs
-        for (long i = m & ~3; i < m; i++)
-        {
-            v = (ElemType)r(cpuRNGHandle->Generator());
-            us(i, j) = v <= maskRate ? (ElemType)0 : scaleValue;
-        }
-    }
+        data[i] = CPURNGHandle::ToUniform(bits) <= threshold ? (ElemType)0 : scaleValue;
+    });
 }
 
 template <class ElemType>
@@ -3812,6 +3843,51 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddSignOf(const CPUMatrix<ElemType>& a
 
     return us;
 }
+// A (value, row index) pair considered for top-K selection. Larger values come first; ties are broken
+// by the lower index, so that the result does not depend on how a column was split across threads.
+template <class ElemType>
+using TopKCandidate = std::pair<ElemType, int>;
+
+template <class ElemType>
+static inline bool IsBetterTopKCandidate(const TopKCandidate<ElemType>& a, const TopKCandidate<ElemType>& b)
+{
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Adds a candidate to a heap that keeps the best 'topK' candidates seen so far, with the worst one on top.
+template <class ElemType>
+static inline void PushTopKCandidate(std::vector<TopKCandidate<ElemType>>& heap, const TopKCandidate<ElemType>& candidate, int topK)
+{
+    if (heap.size() < (size_t)topK)
+    {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end(), IsBetterTopKCandidate<ElemType>);
+    }
+    else if (IsBetterTopKCandidate(candidate, heap.front()))
+    {
+        std::pop_heap(heap.begin(), heap.end(), IsBetterTopKCandidate<ElemType>);
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end(), IsBetterTopKCandidate<ElemType>);
+    }
+}
+
+// Selects the 'topK' largest of values[begin..end) into 'heap' (unordered, worst on top).
+template <class ElemType>
+static void SelectTopK(const ElemType* values, int begin, int end, int topK, std::vector<TopKCandidate<ElemType>>& heap)
+{
+    heap.clear();
+    heap.reserve(topK);
+    int i = begin;
+    for (; i < end && heap.size() < (size_t)topK; i++)
+        PushTopKCandidate(heap, TopKCandidate<ElemType>(values[i], i), topK);
+    for (; i < end; i++)
+    {
+        // most elements are rejected by this comparison against the worst kept value
+        if (values[i] > heap.front().first)
+            PushTopKCandidate(heap, TopKCandidate<ElemType>(values[i], i), topK);
+    }
+}
+
 //I decided to use CPUMatrix<ElemType>& maxIndexes instead of integer vector because the result may be used to do additional calculation
 template <class ElemType>
 void CPUMatrix<ElemType>::VectorMax(CPUMatrix<ElemType>& maxIndexes, CPUMatrix<ElemType>& maxValues, const bool isColWise, int topK) const
@@ -3853,26 +3929,39 @@ void CPUMatrix<ElemType>::VectorMax(CPUMatrix<ElemType>& maxIndexes, CPUMatrix<E
         }
         else
         {
-            std::vector<int> indices(m);
+            // Columns are processed independently with a bounded heap, which is O(m log topK) per column and does not
+            // touch more memory than the column itself. If there are fewer columns than threads (e.g. scoring a single
+            // query against a large number of candidates), each column is additionally split into row ranges whose
+            // partial results are merged.
+            const int numThreads = std::max(1, GetMaxNumThreads());
+            const int minRowsPerRange = std::max(4096, 4 * topK);
+            const int numRanges = n >= numThreads ? 1 : std::max(1, std::min(numThreads / n, m / minRowsPerRange));
+
+            std::vector<std::vector<TopKCandidate<ElemType>>> rangeHeaps(n * numRanges);
+#pragma omp parallel for
+            for (int k = 0; k < n * numRanges; k++)
+            {
+                const int icol = k / numRanges;
+                const int range = k % numRanges;
+                SelectTopK(Data() + (size_t)icol * m, (int)((size_t)m * range / numRanges), (int)((size_t)m * (range + 1) / numRanges), topK, rangeHeaps[k]);
+            }
 
-            const ElemType* curVal =            Data();
-            ElemType* curIdx       = maxIndexes.Data();
-            ElemType* curMax       =  maxValues.Data();
-            for (int icol = 0; icol < n; icol++, curVal += m, curIdx += topK, curMax += topK)
+#pragma omp parallel for
+            for (int icol = 0; icol < n; icol++)
             {
-                std::iota(indices.begin(), indices.end(), 0);
-                // Partial sort, descending order.
-                std::partial_sort(indices.begin(), indices.begin() + topK, indices.end(),
-                                    [curVal](const int& a, const int& b)
-                                    {
-                                        return curVal[a] > curVal[b];
-                                    });
-                // REVIEW alexeyk: the following produces warning (see SCL_SECURE_NO_WARNINGS) so use loop instead.
-                // std::transform(indices.begin(), indices.begin() + topK, curIdx, [](const int& a) { return static_cast<ElemType>(a); });
+                auto& heap = rangeHeaps[icol * numRanges];
+                for (int range = 1; range < numRanges; range++)
+                    for (const auto& candidate : rangeHeaps[icol * numRanges + range])
+                        PushTopKCandidate(heap, candidate, topK);
+
+                // Sort the kept elements, descending order.
+                std::sort_heap(heap.begin(), heap.end(), IsBetterTopKCandidate<ElemType>);
+                ElemType* curIdx = maxIndexes.Data() + (size_t)icol * topK;
+                ElemType* curMax = maxValues.Data() + (size_t)icol * topK;
                 for (int i2 = 0; i2 < topK; i2++)
                 {
-                    curIdx[i2] = static_cast<ElemType>(indices[i2]);
-                    curMax[i2] = curVal[indices[i2]];
+                    curIdx[i2] = static_cast<ElemType>(heap[i2].second);
+                    curMax[i2] = heap[i2].first;
                 }
             }
         }
@@ -5023,6 +5112,24 @@ void CPUMatrix<ElemType>::AveragePoolingBackward(const CPUMatrix<int>& mpRowCol,
     }
 }
 
+// Merges the statistics (count, mean, sum of squared deviations from the mean) of two disjoint sets of samples (Chan et al.).
+static inline void MergeBatchNormStatistics(double& n, double& mean, double& m2, double nOther, double meanOther, double m2Other)
+{
+    if (nOther == 0)
+        return;
+    double count = n + nOther;
+    double delta = meanOther - mean;
+    mean += delta * nOther / count;
+    m2 += m2Other + delta * delta * n * nOther / count;
+    n = count;
+}
+
+// Batch normalization on the CPU.
+// Data is laid out as one column per sample. In the spatial case, the rows of a column are [C x spatialSize] with the
+// spatial dimension innermost, so each (sample, channel) pair is a contiguous block; we use these blocks as the unit of
+// parallelism. In the non-spatial case every row is its own channel and we parallelize over blocks of rows.
+// Statistics are accumulated in double precision and with the same update rules as the CUDA kernels in
+// CntkBatchNormalization.cuh, so that both devices produce the same running statistics.
 template <class ElemType>
 template <class StatType>
 void CPUMatrix<ElemType>::BatchNormalizationForward(const CPUMatrix<StatType>& scale, const CPUMatrix<StatType>& bias, bool inferenceOnly, double expAvgFactor, double blendFactor,
@@ -5032,49 +5139,271 @@ void CPUMatrix<ElemType>::BatchNormalizationForward(const CPUMatrix<StatType>& s
     if (GetNumRows() % scale.GetNumRows() != 0)
         LogicError("The number of rows of this matrx must be multiple of the number of rows of the scale matrix.");
 
-    if (!inferenceOnly || expAvgFactor != 0 || blendFactor != 1)
-        RuntimeError("Batch normalization training on CPU is not yet implemented.");
-
-    saveMean.Resize(0, 0); // only doing inference: these two are not produced
-    saveInvStdDev.Resize(0, 0);
+    const bool spatial = GetNumRows() != scale.GetNumRows();
+    const size_t vectorSize = GetNumRows();
+    const size_t numChannels = scale.GetNumRows();
+    const size_t spatialSize = vectorSize / numChannels;
+    const size_t batchSize = GetNumCols();
+    const ElemType* x = Data();
 
-    bool spatial = GetNumRows() != scale.GetNumRows();
-    if (spatial)
+    // mean and inverse standard deviation used for normalizing, per channel
+    std::vector<double> mean(numChannels), invStdDev(numChannels);
+    if (inferenceOnly || (expAvgFactor == 0 && blendFactor == 1))
+    {
+        // running statistics are used as they are, nothing to compute
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            mean[c] = (double)runMean(c, 0);
+            invStdDev[c] = 1.0 / sqrt((double)runVariance(c, 0) + epsilon);
+        }
+    }
+    else
     {
-        size_t spatialSize = GetNumRows() / scale.GetNumRows();
+        // Single pass over the data: the mean and sum of squared deviations (M2) of each block are computed while the
+        // block is in cache, and the per-block results are then merged per channel.
+        std::vector<double> m2(numChannels);
+        if (spatial)
+        {
+            const long numBlocks = (long)(numChannels * batchSize);
+            std::vector<double> blockMean(numBlocks), blockM2(numBlocks);
+#pragma omp parallel for
+            for (long k = 0; k < numBlocks; k++)
+            {
+                const ElemType* block = x + (k / numChannels) * vectorSize + (k % numChannels) * spatialSize;
+                double sum = 0;
+                for (size_t i = 0; i < spatialSize; i++)
+                    sum += (double)(StatType)block[i];
+                double blockAvg = sum / spatialSize;
+                double sqDev = 0;
+                for (size_t i = 0; i < spatialSize; i++)
+                {
+                    double d = (double)(StatType)block[i] - blockAvg;
+                    sqDev += d * d;
+                }
+                blockMean[k] = blockAvg;
+                blockM2[k] = sqDev;
+            }
 #pragma omp parallel for
-        for (long icol = 0; icol < out.GetNumCols(); icol++)
+            for (long c = 0; c < (long)numChannels; c++)
+            {
+                double n = 0;
+                for (size_t j = 0; j < batchSize; j++)
+                    MergeBatchNormStatistics(n, mean[c], m2[c], (double)spatialSize, blockMean[j * numChannels + c], blockM2[j * numChannels + c]);
+            }
+        }
+        else
         {
-            for (long irow = 0; irow < out.GetNumRows(); irow++)
+            // Welford's update across the samples, vectorized over a block of rows.
+            const size_t rowBlockSize = 64;
+            const long numRowBlocks = (long)((vectorSize + rowBlockSize - 1) / rowBlockSize);
+#pragma omp parallel for
+            for (long b = 0; b < numRowBlocks; b++)
             {
-                size_t imap = irow / spatialSize;
-                ElemType stdDev = sqrt(runVariance(imap, 0) + epsilon);
-                out(irow, icol) = (ElemType)(scale(imap, 0) * ((*this)(irow, icol) - runMean(imap, 0)) / stdDev + bias(imap, 0));
+                const size_t rowBegin = b * rowBlockSize;
+                const size_t rowEnd = std::min(rowBegin + rowBlockSize, vectorSize);
+                double* blockMean = mean.data() + rowBegin;
+                double* blockM2 = m2.data() + rowBegin;
+                for (size_t j = 0; j < batchSize; j++)
+                {
+                    const ElemType* column = x + j * vectorSize;
+                    const double invCount = 1.0 / (j + 1);
+                    for (size_t i = 0; i < rowEnd - rowBegin; i++)
+                    {
+                        double v = (double)(StatType)column[rowBegin + i];
+                        double delta = v - blockMean[i];
+                        blockMean[i] += delta * invCount;
+                        blockM2[i] += delta * (v - blockMean[i]);
+                    }
+                }
             }
         }
+
+        // update the running statistics and determine the statistics used for normalizing
+        const double count = (double)(spatialSize * batchSize);
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            double newRunMean = expAvgFactor * mean[c] + (1.0 - expAvgFactor) * (double)runMean(c, 0);
+            double unbiasedVariance = count == 1 ? 0 : m2[c] / (count - 1);
+            double newRunVariance = expAvgFactor * unbiasedVariance + (1.0 - expAvgFactor) * (double)runVariance(c, 0);
+            runMean(c, 0) = (StatType)newRunMean;
+            runVariance(c, 0) = (StatType)newRunVariance;
+
+            mean[c] = blendFactor * newRunMean + (1.0 - blendFactor) * mean[c];
+            invStdDev[c] = 1.0 / sqrt(m2[c] / count + epsilon);
+            if (blendFactor != 0)
+                invStdDev[c] = blendFactor / sqrt(newRunVariance + epsilon) + (1.0 - blendFactor) * invStdDev[c];
+        }
+    }
+
+    if (inferenceOnly)
+    {
+        saveMean.Resize(0, 0); // only doing inference: these two are not produced
+        saveInvStdDev.Resize(0, 0);
+    }
+    else
+    {
+        saveMean.Resize(numChannels, 1);
+        saveInvStdDev.Resize(numChannels, 1);
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            saveMean(c, 0) = (StatType)mean[c];
+            saveInvStdDev(c, 0) = (StatType)invStdDev[c];
+        }
+    }
+
+    // Normalization fused with scale and shift: out = scale * (x - mean) * invStdDev + bias = a * x + b.
+    std::vector<StatType> a(numChannels), b(numChannels);
+    for (size_t c = 0; c < numChannels; c++)
+    {
+        double s = (double)scale(c, 0) * invStdDev[c];
+        a[c] = (StatType)s;
+        b[c] = (StatType)((double)bias(c, 0) - mean[c] * s);
+    }
+    ElemType* y = out.Data();
+    if (spatial)
+    {
+        const long numBlocks = (long)(numChannels * batchSize);
+#pragma omp parallel for
+        for (long k = 0; k < numBlocks; k++)
+        {
+            const size_t c = k % numChannels;
+            const size_t offset = (k / numChannels) * vectorSize + c * spatialSize;
+            const StatType ac = a[c], bc = b[c];
+            for (size_t i = 0; i < spatialSize; i++)
+                y[offset + i] = (ElemType)(ac * (StatType)x[offset + i] + bc);
+        }
     }
     else
     {
 #pragma omp parallel for
-        for (long icol = 0; icol < out.GetNumCols(); icol++)
+        for (long j = 0; j < (long)batchSize; j++)
         {
-            for (long irow = 0; irow < out.GetNumRows(); irow++)
-            {
-                ElemType stdDev = sqrt(runVariance(irow, 0) + epsilon);
-                out(irow, icol) = (ElemType)(scale(irow, 0) * ((*this)(irow, icol) - runMean(irow, 0)) / stdDev + bias(irow, 0));
-            }
+            const size_t offset = j * vectorSize;
+            for (size_t i = 0; i < vectorSize; i++)
+                y[offset + i] = (ElemType)(a[i] * (StatType)x[offset + i] + b[i]);
         }
     }
 }
 
+// savedMean/savedInvStdDev are the interpolated mean/inverse standard deviation as used in ForwardProp().
+// The scale and bias gradients are computed in a single pass over the input and output gradient; a second pass then
+// adds the input gradient, mirroring BackpropagateBatchNormGradients in CntkBatchNormalization.cuh.
 template <class ElemType>
 template <class StatType>
 void CPUMatrix<ElemType>::BatchNormalizationBackward(const CPUMatrix<ElemType>& in, CPUMatrix<ElemType>& grad, const CPUMatrix<StatType>& scale, double blendFactor,
                                                      const CPUMatrix<StatType>& saveMean, const CPUMatrix<StatType>& saveInvStdDev,
                                                      CPUMatrix<StatType>& scaleGrad, CPUMatrix<StatType>& biasGrad) const
 {
-    UNUSED(in); UNUSED(grad); UNUSED(scale); UNUSED(blendFactor), UNUSED(saveMean); UNUSED(saveInvStdDev); UNUSED(scaleGrad); UNUSED(biasGrad);
-    RuntimeError("Batch normalization training on CPU is not yet implemented.");
+    if (GetNumRows() % scale.GetNumRows() != 0)
+        LogicError("The number of rows of this matrx must be multiple of the number of rows of the scale matrix.");
+    if (saveMean.GetNumRows() != scale.GetNumRows() || saveInvStdDev.GetNumRows() != scale.GetNumRows())
+        LogicError("BatchNormalizationBackward: The saved mean and inverse standard deviation were not produced by a training forward pass.");
+
+    const bool spatial = GetNumRows() != scale.GetNumRows();
+    const size_t vectorSize = GetNumRows();
+    const size_t numChannels = scale.GetNumRows();
+    const size_t spatialSize = vectorSize / numChannels;
+    const size_t batchSize = GetNumCols();
+    const ElemType* x = in.Data();
+    const ElemType* dy = Data();
+
+    // dBias = sum(dy), dScale = sum(dy * (x - mean)) * invStdDev, over all samples (and spatial positions) of a channel
+    std::vector<double> dScale(numChannels), dBias(numChannels);
+    if (spatial)
+    {
+        const long numBlocks = (long)(numChannels * batchSize);
+        std::vector<double> blockScaleGrad(numBlocks), blockBiasGrad(numBlocks);
+#pragma omp parallel for
+        for (long k = 0; k < numBlocks; k++)
+        {
+            const size_t c = k % numChannels;
+            const size_t offset = (k / numChannels) * vectorSize + c * spatialSize;
+            const double m = (double)saveMean(c, 0);
+            double ds = 0, db = 0;
+            for (size_t i = 0; i < spatialSize; i++)
+            {
+                double g = (double)(StatType)dy[offset + i];
+                ds += g * ((double)(StatType)x[offset + i] - m);
+                db += g;
+            }
+            blockScaleGrad[k] = ds;
+            blockBiasGrad[k] = db;
+        }
+#pragma omp parallel for
+        for (long c = 0; c < (long)numChannels; c++)
+        {
+            for (size_t j = 0; j < batchSize; j++)
+            {
+                dScale[c] += blockScaleGrad[j * numChannels + c];
+                dBias[c] += blockBiasGrad[j * numChannels + c];
+            }
+        }
+    }
+    else
+    {
+        const size_t rowBlockSize = 64;
+        const long numRowBlocks = (long)((vectorSize + rowBlockSize - 1) / rowBlockSize);
+#pragma omp parallel for
+        for (long b = 0; b < numRowBlocks; b++)
+        {
+            const size_t rowBegin = b * rowBlockSize;
+            const size_t rowEnd = std::min(rowBegin + rowBlockSize, vectorSize);
+            for (size_t j = 0; j < batchSize; j++)
+            {
+                const size_t offset = j * vectorSize;
+                for (size_t i = rowBegin; i < rowEnd; i++)
+                {
+                    double g = (double)(StatType)dy[offset + i];
+                    dScale[i] += g * ((double)(StatType)x[offset + i] - (double)saveMean(i, 0));
+                    dBias[i] += g;
+                }
+            }
+        }
+    }
+    for (size_t c = 0; c < numChannels; c++)
+    {
+        dScale[c] *= (double)saveInvStdDev(c, 0);
+        scaleGrad(c, 0) = (StatType)dScale[c];
+        biasGrad(c, 0) = (StatType)dBias[c];
+    }
+
+    // dx += scale * invStdDev * (dy - mbStatsWeight * (xHat * dScale + dBias) / m), with xHat = (x - mean) * invStdDev,
+    // rewritten as dx += k1 * dy - k2 * (x - mean) - k3 with per-channel constants.
+    const double mbStatsWeight = 1 - blendFactor; // weight for contribution from actual MB stats (0 if none, e.g. locked BN node)
+    const double count = (double)(spatialSize * batchSize);
+    std::vector<StatType> k1(numChannels), k2(numChannels), k3(numChannels), mean(numChannels);
+    for (size_t c = 0; c < numChannels; c++)
+    {
+        double invStdDev = (double)saveInvStdDev(c, 0);
+        double s = (double)scale(c, 0) * invStdDev;
+        k1[c] = (StatType)s;
+        k2[c] = (StatType)(s * mbStatsWeight * invStdDev * dScale[c] / count);
+        k3[c] = (StatType)(s * mbStatsWeight * dBias[c] / count);
+        mean[c] = saveMean(c, 0);
+    }
+    ElemType* dx = grad.Data();
+    if (spatial)
+    {
+        const long numBlocks = (long)(numChannels * batchSize);
+#pragma omp parallel for
+        for (long k = 0; k < numBlocks; k++)
+        {
+            const size_t c = k % numChannels;
+            const size_t offset = (k / numChannels) * vectorSize + c * spatialSize;
+            for (size_t i = 0; i < spatialSize; i++)
+                dx[offset + i] = (ElemType)((StatType)dx[offset + i] + k1[c] * (StatType)dy[offset + i] - k2[c] * ((StatType)x[offset + i] - mean[c]) - k3[c]);
+        }
+    }
+    else
+    {
+#pragma omp parallel for
+        for (long j = 0; j < (long)batchSize; j++)
+        {
+            const size_t offset = j * vectorSize;
+            for (size_t i = 0; i < vectorSize; i++)
+                dx[offset + i] = (ElemType)((StatType)dx[offset + i] + k1[i] * (StatType)dy[offset + i] - k2[i] * ((StatType)x[offset + i] - mean[i]) - k3[i]);
+        }
+    }
 }
 
 
@@ -6444,13 +6773,31 @@ void CPUMatrix<ElemType>::RCRFBackwardCompute(const CPUMatrix<ElemType>& alpha,
 
     beta.RequireSize(iNumLab, iNumPos);
 
+    // beta(k, t) = alpha(k, t) + log sum_j exp(beta(j, t + 1) - Z(j, t) + pair_scores(j, k)),
+    // where Z(j, t) = log sum_m exp(alpha(m, t) + pair_scores(j, m)) is the forward transition step.
+    // Z is computed once per time step, which makes each step O(iNumLab^2).
+    const ElemType* pairScores = pair_scores.Data();
+    std::vector<ElemType> z(iNumLab), next(iNumLab), workspace(iNumLab);
     for (int t = iNumPos - 1; t >= 0; t--)
     {
-#pragma omp parallel for
-        for (int k = 0; k < iNumLab; k++)
+        const ElemType* alphaT = alpha.Data() + (size_t) t * iNumLab;
+        ElemType* betaT = beta.Data() + (size_t) t * iNumLab;
+        if (t == iNumPos - 1)
         {
-            _rcrfBackwardCompute(t, k, alpha, beta, pair_scores);
+            ElemType fSum = (ElemType) LZERO;
+            for (int j = 0; j < iNumLab; j++)
+                fSum = (ElemType) LogAddD(fSum, alphaT[j]);
+            for (int k = 0; k < iNumLab; k++)
+                betaT[k] = alphaT[k] - fSum;
+            continue;
         }
+
+        CRFLogAddTransition(pairScores, alphaT, iNumLab, z.data(), workspace.data());
+        for (int j = 0; j < iNumLab; j++)
+            next[j] = betaT[iNumLab + j] - z[j];
+#pragma omp parallel for
+        for (int k = 0; k < iNumLab; k++)
+            betaT[k] = alphaT[k] + CRFLogAddTransitionFrom(pairScores, next.data(), iNumLab, k);
     }
 };
 
@@ -6801,44 +7148,6 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignCTCScore(
     return *this;
 }
 
-/// the kernel function for RCRF backward computation
-template <class ElemType>
-void CPUMatrix<ElemType>::_rcrfBackwardCompute(size_t t, size_t k, const CPUMatrix<ElemType>& alpha,
-                                               CPUMatrix<ElemType>& beta,
-                                               const CPUMatrix<ElemType>& pair_scores)
-{
-    size_t iNumLab = alpha.GetNumRows();
-    size_t iNumPos = alpha.GetNumCols();
-
-    ElemType fSum;
-    ElemType fTmp = (ElemType) LZERO;
-    if (t == iNumPos - 1)
-    {
-        fSum = (ElemType) LZERO;
-        for (int j = 0; j < iNumLab; j++)
-        {
-            fSum = (ElemType) LogAddD(fSum, alpha(j, t));
-        }
-
-        fTmp = alpha(k, t) - fSum;
-        beta(k, t) = fTmp;
-    }
-    else
-    {
-        for (int j = 0; j < iNumLab; j++)
-        {
-            fSum = (ElemType) LZERO;
-            for (int m = 0; m < iNumLab; m++)
-            {
-                fSum = (ElemType) LogAddD(fSum, alpha(m, t) + pair_scores(j, m));
-            }
-
-            fTmp = (ElemType) LogAddD(fTmp, beta(j, t + 1) + alpha(k, t) + pair_scores(j, k) - fSum);
-        }
-        beta(k, t) = fTmp;
-    }
-}
-
 template <class ElemType>
 void CPUMatrix<ElemType>::RCRFTransGrdCompute(const CPUMatrix<ElemType>& lbls,
                                               const CPUMatrix<ElemType>& alpha,
@@ -6857,17 +7166,25 @@ void CPUMatrix<ElemType>::RCRFTransGrdCompute(const CPUMatrix<ElemType>& lbls,
             break;
         }
 
+    // grd(j, i) += exp(prev(i) + pair_scores(j, i) - Z(j) + beta(j, tPos)), where prev is alpha(:, tPos - 1)
+    // (or the start label at tPos == 0) and Z(j) = log sum_k exp(prev(k) + pair_scores(j, k)).
+    const ElemType* pairScores = pair_scores.Data();
+    std::vector<ElemType> start(iNumLab, (ElemType) LZERO), z(iNumLab), workspace(iNumLab);
+    if (firstLbl >= 0)
+        start[firstLbl] = 0;
     for (size_t tPos = 0; tPos < iNumPos; tPos++)
     {
-        CPUMatrix<ElemType> b = beta.ColumnSlice(tPos, 1);
-        CPUMatrix<ElemType> a;
-        if (tPos > 0)
-            a = alpha.ColumnSlice(tPos - 1, 1);
+        const ElemType* prev = tPos == 0 ? start.data() : alpha.Data() + (tPos - 1) * iNumLab;
+        const ElemType* betaT = beta.Data() + tPos * iNumLab;
+        CRFLogAddTransition(pairScores, prev, iNumLab, z.data(), workspace.data());
 
 #pragma omp parallel for
         for (int i = 0; i < iNumLab; i++)
         {
-            _rcrfTransGrdCompute(i, lbls, alpha, beta, pair_scores, grd, tPos);
+            const ElemType* pairColumn = pairScores + (size_t) i * iNumLab;
+            ElemType* grdColumn = grd.Data() + (size_t) i * iNumLab;
+            for (int j = 0; j < iNumLab; j++)
+                grdColumn[j] += exp(prev[i] + pairColumn[j] - z[j] + betaT[j]);
         }
 
         // transition score
@@ -6898,81 +7215,6 @@ void CPUMatrix<ElemType>::RCRFTransGrdCompute(const CPUMatrix<ElemType>& lbls,
     }
 };
 
-template <class ElemType>
-void CPUMatrix<ElemType>::_rcrfTransGrdCompute(size_t i,
-                                               const CPUMatrix<ElemType>& lbls,
-                                               const CPUMatrix<ElemType>& alpha,
-                                               const CPUMatrix<ElemType>& beta,
-                                               const CPUMatrix<ElemType>& pair_scores,
-                                               CPUMatrix<ElemType>& grd,
-                                               const size_t tPos // position
-                                               )
-{
-    int iNumLab = (int) alpha.GetNumRows();
-
-    int firstLbl = -1;
-    for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-        if (lbls(ik, 0) != 0)
-        {
-            firstLbl = ik;
-            break;
-        }
-
-    CPUMatrix<ElemType> b = beta.ColumnSlice(tPos, 1);
-    CPUMatrix<ElemType> a;
-    if (tPos > 0)
-        a = alpha.ColumnSlice(tPos - 1, 1);
-
-    {
-        ElemType fTmp = (ElemType) LZERO;
-        for (int j = 0; j < iNumLab; j++)
-        {
-            if (tPos == 0)
-            {
-                if (i == firstLbl)
-                {
-                    fTmp = 0;
-                }
-                else
-                {
-                    fTmp = (ElemType) LZERO;
-                }
-            }
-            else
-            {
-                fTmp = a(i, 0);
-            }
-            fTmp += pair_scores(j, i);
-
-            ElemType fSum = (ElemType) LZERO;
-            for (int k = 0; k < iNumLab; k++)
-            {
-                ElemType fTmp2;
-                if (tPos == 0)
-                {
-                    if (k == firstLbl)
-                    {
-                        fTmp2 = 0;
-                    }
-                    else
-                    {
-                        fTmp2 = (ElemType) LZERO;
-                    }
-                }
-                else
-                {
-                    fTmp2 = a(k, 0);
-                }
-                fSum = (ElemType) LogAddD(fSum, fTmp2 + pair_scores(j, k));
-            }
-
-            fTmp -= fSum;
-            fTmp += b(j, 0);
-
-            grd(j, i) += exp(fTmp);
-        }
-    }
-};
 template <class ElemType>
 CPUMatrix<ElemType>& CPUMatrix<ElemType>::DropFrame(const CPUMatrix<ElemType>& label, const CPUMatrix<ElemType>& gamma, const ElemType& threshhold)
 {
@@ -7041,6 +7283,26 @@ int CPUMatrix<ElemType>::SetNumThreads(int numThreads)
     return numThreads;
 }
 
+// note: this function does not depend on the <ElemType> parameter
+// OpenMP keeps the thread count per thread; MKL only does so if asked with mkl_set_num_threads_local().
+// OpenBLAS has no per-thread setting, so there the global one stays in effect.
+template <class ElemType>
+int CPUMatrix<ElemType>::SetNumThreadsOfCallingThread(int numThreads)
+{
+    if (numThreads <= 0)
+        return GetMaxNumThreads();
+
+#ifdef _OPENMP
+    omp_set_num_threads(numThreads);
+    numThreads = omp_get_max_threads();
+
+    #ifdef USE_MKL
+        mkl_set_num_threads_local(numThreads);
+    #endif
+#endif
+    return numThreads;
+}
+
 template <class ElemType>
 int CPUMatrix<ElemType>::GetMaxNumThreads()
 {
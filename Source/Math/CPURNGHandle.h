@@ -10,21 +10,84 @@
 #include "RNGHandle.h"
 #include <memory>
 #include <random>
+#include <stdint.h>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// Random number source for CPU matrices.
+// Matrix fills draw from a counter-based generator (Philox4x32-10, Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// The stream is a sequence of 32-bit words, and the word at a given stream position is a pure function of the seed and the position.
+// A fill reserves a range of positions and can then generate any part of it independently, so matrices are filled in
+// parallel blocks with results that depend only on seed and offset, not on the number of threads.
+// The stream position starts at 'offset' and is advanced by the number of values each fill consumes, which is exactly what
+// the RngUser nodes count in their rng offset. Re-creating a handle from a checkpointed (seed, offset) is therefore O(1).
 class CPURNGHandle : public RNGHandle
 {
 public:
     CPURNGHandle(int deviceId, uint64_t seed, uint64_t offset = 0);
 
-    std::mt19937_64& Generator()
+    // Reserves the next 'count' positions of the counter-based stream, returns the first one.
+    uint64_t Reserve(uint64_t count)
     {
-        return m_generator;
+        uint64_t first = m_position;
+        m_position += count;
+        return first;
+    }
+
+    uint64_t Seed() const { return m_seed; }
+    uint64_t Position() const { return m_position; }
+
+    // Writes the words at stream positions [position, position + count) of the stream with the given seed to out[].
+    static void GenerateBits(uint64_t seed, uint64_t position, size_t count, uint32_t* out)
+    {
+        uint32_t block[4];
+        uint64_t blockIndex = position / 4;
+        size_t lane = (size_t)(position % 4);
+        size_t i = 0;
+        if (lane != 0) // unaligned head
+        {
+            Philox4x32(seed, blockIndex++, block);
+            for (; lane < 4 && i < count; lane++)
+                out[i++] = block[lane];
+        }
+        for (; i + 4 <= count; i += 4)
+            Philox4x32(seed, blockIndex++, out + i);
+        if (i < count) // tail
+        {
+            Philox4x32(seed, blockIndex, block);
+            for (lane = 0; i < count; lane++)
+                out[i++] = block[lane];
+        }
+    }
+
+    // uniform in [0, 1), resp. (0, 1]
+    static double ToUniform(uint32_t bits) { return bits * (1.0 / 4294967296.0); }
+    static double ToUniformNonZero(uint32_t bits) { return (bits + 1.0) * (1.0 / 4294967296.0); }
+
+    // one block of the Philox4x32-10 generator: 4 words for the given seed (key) and block index (counter)
+    static void Philox4x32(uint64_t seed, uint64_t blockIndex, uint32_t out[4])
+    {
+        uint32_t c0 = (uint32_t)blockIndex, c1 = (uint32_t)(blockIndex >> 32), c2 = 0, c3 = 0;
+        uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+        for (int round = 0; round < 10; round++)
+        {
+            uint64_t p0 = (uint64_t)0xD2511F53 * c0;
+            uint64_t p1 = (uint64_t)0xCD9E8D57 * c2;
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c1 = (uint32_t)p1;
+            c3 = (uint32_t)p0;
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
     }
 
 private:
-    std::mt19937_64 m_generator;
+    uint64_t m_seed;
+    uint64_t m_position;
 };
 
 }}}
@@ -0,0 +1,171 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CRFKernels.h -- label-transition step of the CRF forward-backward and Viterbi recursions
+//
+// One step of these recursions is a matrix-vector product over the labels in a semiring: (log-add, +) for
+// the forward-backward algorithm, and (max, +) for Viterbi decoding. The pair scores are a column-major
+// [numLabels x numLabels] matrix where transitions(k, j) is the score of moving from label j to label k.
+// The loops are arranged so that the innermost one runs over contiguous memory and can be vectorized;
+// log-add is computed with a single max and a single log per output element.
+//
+// The batch variants run one step for several sequences at once. Their state is a column-major
+// [numLabels x numSequences] block, one column per sequence, which is the layout of one time step of an MBLayout.
+// They are not used by CRFNode or SequenceDecoderNode yet, which are compiled out (COMING_SOON).
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// result[k] = log sum_j exp(prev[j] + transitions(k, j))
+// 'workspace' must hold numLabels elements.
+template <class ElemType>
+void CRFLogAddTransition(const ElemType* transitions, const ElemType* prev, size_t numLabels, ElemType* result, ElemType* workspace)
+{
+    ElemType* maxScore = workspace;
+    for (size_t k = 0; k < numLabels; k++)
+        maxScore[k] = prev[0] + transitions[k];
+    for (size_t j = 1; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        const ElemType p = prev[j];
+        for (size_t k = 0; k < numLabels; k++)
+            maxScore[k] = std::max(maxScore[k], p + column[k]);
+    }
+
+    std::fill(result, result + numLabels, (ElemType) 0);
+    for (size_t j = 0; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        const ElemType p = prev[j];
+        for (size_t k = 0; k < numLabels; k++)
+            result[k] += exp(p + column[k] - maxScore[k]);
+    }
+    for (size_t k = 0; k < numLabels; k++)
+        result[k] = maxScore[k] + log(result[k]);
+}
+
+// log sum_k exp(next[k] + transitions(k, j)) for a single j; this is the step in the backward direction.
+template <class ElemType>
+ElemType CRFLogAddTransitionFrom(const ElemType* transitions, const ElemType* next, size_t numLabels, size_t j)
+{
+    const ElemType* column = transitions + j * numLabels;
+    ElemType maxScore = next[0] + column[0];
+    for (size_t k = 1; k < numLabels; k++)
+        maxScore = std::max(maxScore, next[k] + column[k]);
+    ElemType sum = 0;
+    for (size_t k = 0; k < numLabels; k++)
+        sum += exp(next[k] + column[k] - maxScore);
+    return maxScore + log(sum);
+}
+
+// result(k, s) = log sum_j exp(prev(j, s) + transitions(k, j)) for each sequence s.
+// Like CRFLogAddTransition, with the sequences in the middle loop, so that each column of 'transitions' is
+// read once per step for all of them: a pass for the maxima, a pass for the exp-sums, and one log per element.
+// 'workspace' must hold numLabels * numSequences elements.
+template <class ElemType>
+void CRFLogAddTransitionBatch(const ElemType* transitions, const ElemType* prev, size_t numLabels, size_t numSequences, ElemType* result, ElemType* workspace)
+{
+    ElemType* maxScore = workspace;
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        ElemType* maxScoreS = maxScore + s * numLabels;
+        const ElemType p = prev[s * numLabels];
+        for (size_t k = 0; k < numLabels; k++)
+            maxScoreS[k] = p + transitions[k];
+    }
+    for (size_t j = 1; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            ElemType* maxScoreS = maxScore + s * numLabels;
+            const ElemType p = prev[s * numLabels + j];
+            for (size_t k = 0; k < numLabels; k++)
+                maxScoreS[k] = std::max(maxScoreS[k], p + column[k]);
+        }
+    }
+
+    std::fill(result, result + numLabels * numSequences, (ElemType) 0);
+    for (size_t j = 0; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            const ElemType* maxScoreS = maxScore + s * numLabels;
+            ElemType* resultS = result + s * numLabels;
+            const ElemType p = prev[s * numLabels + j];
+            for (size_t k = 0; k < numLabels; k++)
+                resultS[k] += exp(p + column[k] - maxScoreS[k]);
+        }
+    }
+    for (size_t i = 0; i < numLabels * numSequences; i++)
+        result[i] = maxScore[i] + log(result[i]);
+}
+
+// result[k] = max_j (prev[j] + transitions(k, j)); backpointer[k] is the first j that attains the maximum.
+template <class ElemType>
+void CRFMaxTransition(const ElemType* transitions, const ElemType* prev, size_t numLabels, ElemType* result, ElemType* backpointer)
+{
+    for (size_t k = 0; k < numLabels; k++)
+    {
+        result[k] = prev[0] + transitions[k];
+        backpointer[k] = 0;
+    }
+    for (size_t j = 1; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        const ElemType p = prev[j];
+        for (size_t k = 0; k < numLabels; k++)
+        {
+            ElemType score = p + column[k];
+            if (score > result[k])
+            {
+                result[k] = score;
+                backpointer[k] = (ElemType) j;
+            }
+        }
+    }
+}
+
+// CRFMaxTransition for each sequence s of a [numLabels x numSequences] block, with the sequences in the middle loop.
+template <class ElemType>
+void CRFMaxTransitionBatch(const ElemType* transitions, const ElemType* prev, size_t numLabels, size_t numSequences, ElemType* result, ElemType* backpointer)
+{
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        const ElemType p = prev[s * numLabels];
+        for (size_t k = 0; k < numLabels; k++)
+        {
+            result[s * numLabels + k] = p + transitions[k];
+            backpointer[s * numLabels + k] = 0;
+        }
+    }
+    for (size_t j = 1; j < numLabels; j++)
+    {
+        const ElemType* column = transitions + j * numLabels;
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            ElemType* resultS = result + s * numLabels;
+            ElemType* backpointerS = backpointer + s * numLabels;
+            const ElemType p = prev[s * numLabels + j];
+            for (size_t k = 0; k < numLabels; k++)
+            {
+                ElemType score = p + column[k];
+                if (score > resultS[k])
+                {
+                    resultS[k] = score;
+                    backpointerS[k] = (ElemType) j;
+                }
+            }
+        }
+    }
+}
+
+}}}
@@ -7,6 +7,8 @@
 #include "ConvolutionEngine.h"
 #include "CuDnnFactories.h"
 #include "MklDnnCommon.h"
+#include <climits>
+#include <numeric>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -1148,6 +1150,363 @@ public:
     }
 };
 
+//------------------------------------------------------------------
+// Pooling engine for 2D max and average pooling on the CPU.
+// The reference engine walks the generic index maps (MpRowCol/MpRowIndices/Indices) for every output element.
+// In 2D pooling every window is a rectangle of one channel plane, so this engine extracts the column and row
+// bounds of the windows from those maps once and then streams over the input rows of each plane. The windows in
+// the interior of a row have full width and a fixed stride, which turns the inner loop into a strided loop over
+// output columns that the compiler vectorizes; only the padded border columns are handled one by one.
+// Max pooling records the position of each maximum, so that backprop does not have to rescan the windows.
+// Convolution and max unpooling are inherited from the reference engine.
+//------------------------------------------------------------------
+template <class ElemType>
+class PoolingConvolutionEngine : public ReferenceConvolutionEngine<ElemType>
+{
+public:
+    using Base = ReferenceConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+public:
+    PoolingConvolutionEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind, bool poolIncludePad)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind, poolIncludePad),
+        m_argmaxIn(nullptr), m_argmaxOut(nullptr)
+    {
+        if (!ComputeWindows(*m_geometry, m_windows))
+            LogicError("Pooling engine does not support the geometry %s.", ((std::string)*m_geometry).c_str());
+    }
+
+protected:
+    using Base::m_geometry;
+    using Base::m_deviceId;
+    using Base::m_imageLayout;
+    using Base::m_poolKind;
+    using Base::m_poolIncludePad;
+
+    void EnsureCompatible() override
+    {
+        if (m_imageLayout != ImageLayoutKind::CHW)
+            LogicError("Pooling engine supports only CHW/cudnn layout.");
+        if (IsGpu(m_deviceId))
+            LogicError("Pooling engine supports only CPU device.");
+        if (m_poolKind != PoolKind::Max && m_poolKind != PoolKind::Average)
+            InvalidArgument("Pooling type %d is not supported.", (int)m_poolKind);
+    }
+
+    void ForwardPoolingCore(const Mat& in, Mat& out) override
+    {
+        const auto& w = m_windows;
+        size_t batchSize = in.GetNumCols();
+        bool isMax = m_poolKind == PoolKind::Max;
+        if (isMax)
+            m_argmax.resize(out.GetNumRows() * batchSize);
+
+        const ElemType* src = in.Data();
+        ElemType* dst = out.Data();
+        int64_t planeCount = (int64_t)(batchSize * w.m_channels);
+#pragma omp parallel for
+        for (int64_t plane = 0; plane < planeCount; plane++)
+        {
+            const ElemType* inPlane = src + plane * w.m_inWidth * w.m_inHeight;
+            ElemType* outPlane = dst + plane * w.m_outWidth * w.m_outHeight;
+            if (isMax)
+                MaxPoolPlane(inPlane, outPlane, m_argmax.data() + plane * w.m_outWidth * w.m_outHeight);
+            else
+                AveragePoolPlane(inPlane, outPlane);
+        }
+
+        if (isMax)
+        {
+            m_argmaxIn = in.Data();
+            m_argmaxOut = out.Data();
+        }
+    }
+
+    void BackwardPoolingCore(const Mat& out, const Mat& srcGrad, const Mat& in, Mat& grad, bool accumulateGradient) override
+    {
+        const auto& w = m_windows;
+        size_t batchSize = in.GetNumCols();
+        size_t inPlaneSize = w.m_inWidth * w.m_inHeight;
+        size_t outPlaneSize = w.m_outWidth * w.m_outHeight;
+        int64_t planeCount = (int64_t)(batchSize * w.m_channels);
+        bool isMax = m_poolKind == PoolKind::Max;
+
+        // The positions of the maxima are valid if they were recorded for these very matrices; otherwise (e.g. if
+        // the engine was used to evaluate another minibatch in between) they are recomputed from the input.
+        if (isMax && (m_argmaxIn != in.Data() || m_argmaxOut != out.Data() || m_argmax.size() != out.GetNumRows() * batchSize))
+        {
+            m_argmax.resize(out.GetNumRows() * batchSize);
+            const ElemType* src = in.Data();
+#pragma omp parallel for
+            for (int64_t plane = 0; plane < planeCount; plane++)
+            {
+                std::vector<ElemType> scratch(outPlaneSize);
+                MaxPoolPlane(src + plane * inPlaneSize, scratch.data(), m_argmax.data() + plane * outPlaneSize);
+            }
+            m_argmaxIn = in.Data();
+            m_argmaxOut = out.Data();
+        }
+
+        if (!accumulateGradient)
+            grad.SetValue((ElemType)0);
+
+        const ElemType* srcGradData = srcGrad.Data();
+        ElemType* gradData = grad.Data();
+#pragma omp parallel for
+        for (int64_t plane = 0; plane < planeCount; plane++)
+        {
+            const ElemType* srcGradPlane = srcGradData + plane * outPlaneSize;
+            ElemType* gradPlane = gradData + plane * inPlaneSize;
+            if (isMax)
+            {
+                const int* argmax = m_argmax.data() + plane * outPlaneSize;
+                for (size_t i = 0; i < outPlaneSize; i++)
+                    gradPlane[argmax[i]] += srcGradPlane[i];
+            }
+            else
+                AveragePoolBackwardPlane(srcGradPlane, gradPlane);
+        }
+    }
+
+private:
+    // Window bounds of a 2D pooling geometry: output column 'ox' pools input columns [m_colBegin[ox], m_colEnd[ox]),
+    // output row 'oy' pools input rows [m_rowBegin[oy], m_rowEnd[oy]), in the same channel.
+    // Output columns [m_interiorBegin, m_interiorEnd) all have windows of width m_kernelWidth, m_stride columns apart.
+    struct Windows
+    {
+        size_t m_inWidth, m_inHeight, m_outWidth, m_outHeight, m_channels;
+        std::vector<int> m_colBegin, m_colEnd, m_rowBegin, m_rowEnd;
+        int m_interiorBegin, m_interiorEnd;
+        int m_kernelWidth, m_stride;
+        int m_fullKernelSize;
+    };
+
+    // Extracts the window bounds from the index maps of the geometry. Fails if the geometry is not a 2D pooling
+    // whose windows are rectangles determined by the output column and row alone.
+    static bool ComputeWindows(ConvolveGeometry& g, Windows& w)
+    {
+        const auto& inShape = g.InputShape();
+        const auto& outShape = g.OutputShape();
+        size_t rank = inShape.GetRank();
+        if ((rank != 2 && rank != 3) || outShape.GetRank() != rank)
+            return false;
+        w.m_inWidth = inShape[0];
+        w.m_inHeight = inShape[1];
+        w.m_outWidth = outShape[0];
+        w.m_outHeight = outShape[1];
+        w.m_channels = rank == 3 ? inShape[2] : 1;
+        if (rank == 3 && outShape[2] != w.m_channels)
+            return false;
+        if (!g.ComputeConvGeometryExplicit() || g.MpRowIndices().empty() || g.Indices().empty())
+            return false;
+
+        const auto& mpRowCol = g.MpRowCol();
+        const auto& mpRowIndices = g.MpRowIndices();
+        const auto& indices = g.Indices();
+        size_t inPlaneSize = w.m_inWidth * w.m_inHeight;
+        size_t outPlaneSize = w.m_outWidth * w.m_outHeight;
+        if (mpRowCol.size() != outPlaneSize * w.m_channels)
+            return false;
+
+        w.m_colBegin.assign(w.m_outWidth, -1);
+        w.m_colEnd.assign(w.m_outWidth, -1);
+        w.m_rowBegin.assign(w.m_outHeight, -1);
+        w.m_rowEnd.assign(w.m_outHeight, -1);
+        auto setBounds = [](int& begin, int& end, int newBegin, int newEnd)
+        {
+            if (begin < 0)
+            {
+                begin = newBegin;
+                end = newEnd;
+            }
+            return begin == newBegin && end == newEnd;
+        };
+        for (size_t row = 0; row < mpRowCol.size(); row++)
+        {
+            size_t ox = row % w.m_outWidth;
+            size_t oy = (row / w.m_outWidth) % w.m_outHeight;
+            size_t channel = row / outPlaneSize;
+            int i0 = mpRowIndices[row];
+            int size = indices[i0];
+            if (size <= 0)
+                return false;
+            int x0 = INT_MAX, x1 = INT_MIN, y0 = INT_MAX, y1 = INT_MIN;
+            for (int i = 0; i < size; i++)
+            {
+                int col = mpRowCol[row] + indices[i0 + 1 + i];
+                if (col < 0 || (size_t)col / inPlaneSize != channel)
+                    return false;
+                int x = (int)(col % w.m_inWidth);
+                int y = (int)((col % inPlaneSize) / w.m_inWidth);
+                x0 = std::min(x0, x);
+                x1 = std::max(x1, x + 1);
+                y0 = std::min(y0, y);
+                y1 = std::max(y1, y + 1);
+            }
+            // (the offsets of a window are distinct, so this means the window is the whole rectangle)
+            if ((x1 - x0) * (y1 - y0) != size)
+                return false;
+            if (!setBounds(w.m_colBegin[ox], w.m_colEnd[ox], x0, x1) || !setBounds(w.m_rowBegin[oy], w.m_rowEnd[oy], y0, y1))
+                return false;
+        }
+        w.m_fullKernelSize = indices[0];
+
+        // the interior: the longest run of full-width windows at a fixed stride, starting at the first full-width one
+        w.m_kernelWidth = 0;
+        for (size_t ox = 0; ox < w.m_outWidth; ox++)
+            w.m_kernelWidth = std::max(w.m_kernelWidth, w.m_colEnd[ox] - w.m_colBegin[ox]);
+        int outWidth = (int)w.m_outWidth;
+        auto isFull = [&](int ox) { return w.m_colEnd[ox] - w.m_colBegin[ox] == w.m_kernelWidth; };
+        w.m_interiorBegin = 0;
+        while (w.m_interiorBegin < outWidth && !isFull(w.m_interiorBegin))
+            w.m_interiorBegin++;
+        w.m_stride = 1;
+        if (w.m_interiorBegin + 1 < outWidth && isFull(w.m_interiorBegin + 1))
+            w.m_stride = w.m_colBegin[w.m_interiorBegin + 1] - w.m_colBegin[w.m_interiorBegin];
+        w.m_interiorEnd = w.m_interiorBegin;
+        while (w.m_interiorEnd < outWidth && isFull(w.m_interiorEnd) &&
+               w.m_colBegin[w.m_interiorEnd] == w.m_colBegin[w.m_interiorBegin] + (w.m_interiorEnd - w.m_interiorBegin) * w.m_stride)
+            w.m_interiorEnd++;
+        if (w.m_stride <= 0)
+            w.m_interiorEnd = w.m_interiorBegin + std::min(1, outWidth - w.m_interiorBegin);
+        return true;
+    }
+
+    // Max pooling of one channel plane. Candidates of a window are visited in increasing input position, and only a
+    // strictly larger value replaces the current maximum, so the recorded position is the first maximum, as in the
+    // reference engine.
+    void MaxPoolPlane(const ElemType* in, ElemType* out, int* argmax) const
+    {
+        const auto& w = m_windows;
+        const int inWidth = (int)w.m_inWidth;
+        const int interiorBegin = w.m_interiorBegin, interiorEnd = w.m_interiorEnd, stride = w.m_stride;
+        for (size_t oy = 0; oy < w.m_outHeight; oy++)
+        {
+            ElemType* outRow = out + oy * w.m_outWidth;
+            int* argmaxRow = argmax + oy * w.m_outWidth;
+            for (size_t ox = 0; ox < w.m_outWidth; ox++)
+            {
+                outRow[ox] = -std::numeric_limits<ElemType>::infinity();
+                argmaxRow[ox] = w.m_rowBegin[oy] * inWidth + w.m_colBegin[ox];
+            }
+            for (int y = w.m_rowBegin[oy]; y < w.m_rowEnd[oy]; y++)
+            {
+                const ElemType* inRow = in + y * inWidth;
+                for (int ox = 0; ox < interiorBegin; ox++)
+                    MaxPoolSpan(inRow, y * inWidth, w.m_colBegin[ox], w.m_colEnd[ox], outRow[ox], argmaxRow[ox]);
+                for (int kx = 0; kx < w.m_kernelWidth; kx++)
+                {
+                    const int x0 = w.m_colBegin[interiorBegin] + kx - interiorBegin * stride;
+                    const ElemType* inCol = inRow + x0;
+                    const int pos0 = y * inWidth + x0;
+                    for (int ox = interiorBegin; ox < interiorEnd; ox++)
+                    {
+                        ElemType v = inCol[ox * stride];
+                        bool larger = v > outRow[ox];
+                        outRow[ox] = larger ? v : outRow[ox];
+                        argmaxRow[ox] = larger ? pos0 + ox * stride : argmaxRow[ox];
+                    }
+                }
+                for (int ox = interiorEnd; ox < (int)w.m_outWidth; ox++)
+                    MaxPoolSpan(inRow, y * inWidth, w.m_colBegin[ox], w.m_colEnd[ox], outRow[ox], argmaxRow[ox]);
+            }
+        }
+    }
+
+    static void MaxPoolSpan(const ElemType* inRow, int rowPos, int x0, int x1, ElemType& max, int& argmax)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            if (inRow[x] > max)
+            {
+                max = inRow[x];
+                argmax = rowPos + x;
+            }
+        }
+    }
+
+    // Number of input elements the average of output (ox, oy) is divided by.
+    int AverageDivisor(size_t ox, size_t oy) const
+    {
+        const auto& w = m_windows;
+        // Note that by default we divide by the number of actual elements (does not include padding).
+        if (m_poolIncludePad)
+            return w.m_fullKernelSize;
+        return (w.m_colEnd[ox] - w.m_colBegin[ox]) * (w.m_rowEnd[oy] - w.m_rowBegin[oy]);
+    }
+
+    void AveragePoolPlane(const ElemType* in, ElemType* out) const
+    {
+        const auto& w = m_windows;
+        const int inWidth = (int)w.m_inWidth;
+        const int interiorBegin = w.m_interiorBegin, interiorEnd = w.m_interiorEnd, stride = w.m_stride;
+        for (size_t oy = 0; oy < w.m_outHeight; oy++)
+        {
+            ElemType* outRow = out + oy * w.m_outWidth;
+            std::fill(outRow, outRow + w.m_outWidth, (ElemType)0);
+            for (int y = w.m_rowBegin[oy]; y < w.m_rowEnd[oy]; y++)
+            {
+                const ElemType* inRow = in + y * inWidth;
+                for (int ox = 0; ox < interiorBegin; ox++)
+                    outRow[ox] += std::accumulate(inRow + w.m_colBegin[ox], inRow + w.m_colEnd[ox], (ElemType)0);
+                for (int kx = 0; kx < w.m_kernelWidth; kx++)
+                {
+                    const ElemType* inCol = inRow + w.m_colBegin[interiorBegin] + kx - interiorBegin * stride;
+                    for (int ox = interiorBegin; ox < interiorEnd; ox++)
+                        outRow[ox] += inCol[ox * stride];
+                }
+                for (int ox = interiorEnd; ox < (int)w.m_outWidth; ox++)
+                    outRow[ox] += std::accumulate(inRow + w.m_colBegin[ox], inRow + w.m_colEnd[ox], (ElemType)0);
+            }
+            for (size_t ox = 0; ox < w.m_outWidth; ox++)
+                outRow[ox] /= (ElemType)AverageDivisor(ox, oy);
+        }
+    }
+
+    void AveragePoolBackwardPlane(const ElemType* srcGrad, ElemType* grad) const
+    {
+        const auto& w = m_windows;
+        const int inWidth = (int)w.m_inWidth;
+        const int interiorBegin = w.m_interiorBegin, interiorEnd = w.m_interiorEnd, stride = w.m_stride;
+        std::vector<ElemType> g(w.m_outWidth);
+        for (size_t oy = 0; oy < w.m_outHeight; oy++)
+        {
+            for (size_t ox = 0; ox < w.m_outWidth; ox++)
+                g[ox] = srcGrad[oy * w.m_outWidth + ox] / (ElemType)AverageDivisor(ox, oy);
+            for (int y = w.m_rowBegin[oy]; y < w.m_rowEnd[oy]; y++)
+            {
+                ElemType* gradRow = grad + y * inWidth;
+                for (int ox = 0; ox < interiorBegin; ox++)
+                    for (int x = w.m_colBegin[ox]; x < w.m_colEnd[ox]; x++)
+                        gradRow[x] += g[ox];
+                for (int kx = 0; kx < w.m_kernelWidth; kx++)
+                {
+                    ElemType* gradCol = gradRow + w.m_colBegin[interiorBegin] + kx - interiorBegin * stride;
+                    for (int ox = interiorBegin; ox < interiorEnd; ox++)
+                        gradCol[ox * stride] += g[ox];
+                }
+                for (int ox = interiorEnd; ox < (int)w.m_outWidth; ox++)
+                    for (int x = w.m_colBegin[ox]; x < w.m_colEnd[ox]; x++)
+                        gradRow[x] += g[ox];
+            }
+        }
+    }
+
+    Windows m_windows;
+    // Position of the maximum within its channel plane for every output element of the last max pooling,
+    // and the matrices it was computed for.
+    std::vector<int> m_argmax;
+    const ElemType* m_argmaxIn;
+    const ElemType* m_argmaxOut;
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry, PoolKind poolKind)
+    {
+        Windows windows;
+        return deviceId < 0 && (poolKind == PoolKind::Max || poolKind == PoolKind::Average) && ComputeWindows(*geometry, windows);
+    }
+};
+
 template <class ElemType>
 std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId,
                                                                                  ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind,
@@ -1186,6 +1545,14 @@ std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create
                                                                forceDeterministicAlgorithms, poolIncludePad, inputHasFreeDimension);
     }
 
+    if (isEnabled(ConvolutionEngineKind::Pooling) && PoolingConvolutionEngine<ElemType>::IsSupported(deviceId, geometry, poolKind))
+    {
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing pooling engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
+
+        return std::make_unique<PoolingConvolutionEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind, poolIncludePad);
+    }
+
     if (geometry->Groups() == 1)
     {
         if (isEnabled(ConvolutionEngineKind::Gemm) && GemmConvolutionEngine<ElemType>::IsSupported(deviceId, geometry))
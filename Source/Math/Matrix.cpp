@@ -599,12 +599,43 @@ void Matrix<ElemType>::SetDevice(DEVICEID_TYPE deviceId)
 }
 
 template <class ElemType>
-void Matrix<ElemType>::Read(File& stream)
+void Matrix<ElemType>::Read(File& stream, bool mapAlignedPayload)
 {
     Matrix<ElemType>& M = *this;
     char type;
     stream >> type;
-    if (type == 'd')
+    if (type == 'a') // dense, raw aligned payload
+    {
+        size_t elsize, numRows, numCols;
+        stream >> elsize >> numRows >> numCols;
+        if (sizeof(ElemType) != elsize)
+            RuntimeError("Read: Template argument size doesn't match those in file");
+        const size_t numBytes = numRows * numCols * sizeof(ElemType);
+        if (M.GetDeviceId() < 0)
+        {
+            if (!M.m_CPUMatrix)
+                M.m_CPUMatrix = make_shared<CPUMatrix<ElemType>>();
+            void* mapped = mapAlignedPayload && numBytes > 0 ? stream.GetAlignedPayload(numBytes, nullptr) : nullptr;
+            if (mapped)
+                M.m_CPUMatrix->SetValue(numRows, numCols, (ElemType*)mapped, matrixFlagDontOwnBuffer);
+            else
+            {
+                M.m_CPUMatrix->RequireSize(numRows, numCols);
+                stream.GetAlignedPayload(numBytes, M.m_CPUMatrix->Data());
+            }
+            M.SetDataLocation(CPU, DENSE);
+        }
+        else
+        {
+            vector<ElemType> buffer(numRows * numCols);
+            stream.GetAlignedPayload(numBytes, buffer.data());
+            if (!M.m_GPUMatrix)
+                M.m_GPUMatrix = make_shared<GPUMatrix<ElemType>>(M.GetDeviceId());
+            M.m_GPUMatrix->SetValue(numRows, numCols, M.GetDeviceId(), buffer.data(), matrixFlagNormal);
+            M.SetDataLocation(GPU, DENSE);
+        }
+    }
+    else if (type == 'd')
     {
         if (M.GetDeviceId() < 0)
         {
@@ -636,14 +667,27 @@ void Matrix<ElemType>::Read(File& stream)
         }
     }
     else
-        LogicError("Read: Input file corrupt (invalid matrix type field 0x%02d, should be 'f' or 'd').", type);
+        LogicError("Read: Input file corrupt (invalid matrix type field 0x%02d, should be 'a', 's', or 'd').", type);
 }
 
 template <class ElemType>
-void Matrix<ElemType>::Write(File& stream) const
+void Matrix<ElemType>::Write(File& stream, bool alignPayload) const
 {
     const Matrix<ElemType>& M = *this;
-    if (M.GetMatrixType() == MatrixType::DENSE)
+    if (M.GetMatrixType() == MatrixType::DENSE && alignPayload)
+    {
+        stream << 'a';
+        stream << sizeof(ElemType) << M.GetNumRows() << M.GetNumCols();
+        const size_t numBytes = M.GetNumElements() * sizeof(ElemType);
+        if (M.GetDeviceId() < 0)
+            stream.PutAlignedPayload(M.m_CPUMatrix->Data(), numBytes);
+        else
+        {
+            unique_ptr<ElemType[]> buffer(M.m_GPUMatrix->CopyToArray());
+            stream.PutAlignedPayload(buffer.get(), numBytes);
+        }
+    }
+    else if (M.GetMatrixType() == MatrixType::DENSE)
     {
         stream << 'd';
         if (M.GetDeviceId() < 0)
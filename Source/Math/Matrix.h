@@ -653,8 +653,11 @@ public:
                      const SmallVector<size_t>& reducingOpDims, const std::array<SmallVector<ptrdiff_t>, 2>& reducingStrides);
 
 public:
-    void Read(File& stream);
-    void Write(File& stream) const;
+    // If 'mapAlignedPayload', a CPU matrix written with an aligned payload is backed directly by the file's
+    // memory mapping (see File::GetAlignedPayload()); the caller must then keep File::GetMemoryMapping() alive.
+    void Read(File& stream, bool mapAlignedPayload = false);
+    // If 'alignPayload', a dense matrix's contents are written as a raw aligned payload (see File::PutAlignedPayload()).
+    void Write(File& stream, bool alignPayload = false) const;
 
     Matrix<ElemType>& Shift(const Matrix<ElemType>& a, int shift);
 
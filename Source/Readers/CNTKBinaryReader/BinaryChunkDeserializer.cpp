@@ -58,6 +58,7 @@ BinaryChunkDeserializer::BinaryChunkDeserializer(const BinaryConfigHelper& helpe
 BinaryChunkDeserializer::BinaryChunkDeserializer(const std::wstring& filename) :
     DataDeserializerBase(true),
     m_file(FileWrapper::OpenOrDie(filename, L"rb")),
+    m_asyncFile(filename),
     m_headerOffset(0),
     m_chunkTableOffset(0),
     m_traceLevel(0)
@@ -150,10 +151,8 @@ void BinaryChunkDeserializer::SequenceInfosForChunk(ChunkIdType chunkId, std::ve
     auto numberOfSequences = m_chunkTable->GetNumSequences(chunkId);
     unique_ptr<uint32_t[]> numSamplesPerSequence(new uint32_t[numberOfSequences]);
 
-    // Seek to the start of the chunk
-    m_file.SeekOrDie(offset, SEEK_SET);
-    // read 'numberOfSequences' unsigned ints
-    m_file.ReadOrDie(numSamplesPerSequence.get(), sizeof(uint32_t), numberOfSequences);
+    // read 'numberOfSequences' unsigned ints from the start of the chunk
+    m_asyncFile.ReadOrDie(numSamplesPerSequence.get(), offset, sizeof(uint32_t) * numberOfSequences);
 
     auto startId = m_chunkTable->GetStartIndex(chunkId);
     for (decltype(numberOfSequences) i = 0; i < numberOfSequences; i++)
@@ -171,9 +170,6 @@ void BinaryChunkDeserializer::SequenceInfosForChunk(ChunkIdType chunkId, std::ve
 
 unique_ptr<byte[]> BinaryChunkDeserializer::ReadChunk(ChunkIdType chunkId)
 {
-    // Seek to the start of the data portion in the chunk
-    m_file.SeekOrDie(m_chunkTable->GetDataStartOffset(chunkId), SEEK_SET);
-
     // Determine how big the chunk is.
     size_t chunkSize = m_chunkTable->GetChunkSize(chunkId);
     
@@ -181,8 +177,8 @@ unique_ptr<byte[]> BinaryChunkDeserializer::ReadChunk(ChunkIdType chunkId)
     // TODO: use a pool of buffers instead of allocating a new one, each time a chunk is read.
     unique_ptr<byte[]> buffer(new byte[chunkSize]);
 
-    // Read the chunk from disk
-    m_file.ReadOrDie(buffer.get(), sizeof(byte), chunkSize);
+    // Read the data portion of the chunk from disk
+    m_asyncFile.ReadOrDie(buffer.get(), m_chunkTable->GetDataStartOffset(chunkId), chunkSize);
 
     return buffer;
 }
@@ -9,6 +9,7 @@
 #include "BinaryConfigHelper.h"
 #include "BinaryDataChunk.h"
 #include "BinaryDataDeserializer.h"
+#include "AsyncFileReader.h"
 
 namespace CNTK {
 
@@ -118,6 +119,9 @@ private:
 private:
     FileWrapper m_file;
 
+    // Serves chunk reads, which do not depend on (or move) the position of m_file.
+    AsyncFileReader m_asyncFile;
+
     int64_t m_headerOffset, m_chunkTableOffset;
 
     std::vector<BinaryDataDeserializerPtr> m_deserializers;
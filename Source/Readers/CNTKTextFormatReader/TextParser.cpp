@@ -8,6 +8,7 @@
 #include <inttypes.h>
 #include <cfloat>
 #include "BufferedFileReader.h"
+#include "ChunkReadAhead.h"
 #include "IndexBuilder.h"
 #include "TextParser.h"
 #include "TextReaderConstants.h"
@@ -199,6 +200,7 @@ void TextParser<ElemType>::Initialize()
         m_index = builder.Build();
 
         m_fileReader = std::make_shared<BufferedFileReader>(BUFFER_SIZE, *m_file);
+        m_readAhead = std::make_shared<ChunkReadAhead>();
     });
 
     assert(m_index != nullptr);
@@ -264,7 +266,7 @@ ChunkPtr TextParser<ElemType>::GetChunk(ChunkIdType chunkId)
     const auto& chunkDescriptor = m_index->Chunks()[chunkId];
     auto textChunk = make_shared<TextDataChunk>(this);
 
-    attempt(m_numRetries, [this, &textChunk, &chunkDescriptor]()
+    attempt(m_numRetries, [this, &textChunk, chunkId, &chunkDescriptor]()
     {
         if (m_file->CheckError())
         {
@@ -272,21 +274,38 @@ ChunkPtr TextParser<ElemType>::GetChunk(ChunkIdType chunkId)
             m_file->CheckIsOpenOrDie();
         }
 
-        LoadChunk(textChunk, chunkDescriptor);
+        LoadChunk(textChunk, chunkId, chunkDescriptor);
     });
 
     return textChunk;
 }
 
 template <class ElemType>
-void TextParser<ElemType>::LoadChunk(TextChunkPtr& chunk, const ChunkDescriptor& descriptor)
+void TextParser<ElemType>::PrefetchChunks(const std::vector<ChunkIdType>& chunkIds)
+{
+    vector<ChunkReadAhead::Request> requests;
+    for (auto chunkId : chunkIds)
+    {
+        const auto& chunkDescriptor = m_index->Chunks()[chunkId];
+        requests.push_back(ChunkReadAhead::Request{ chunkId, m_filename, chunkDescriptor.StartOffset(), chunkDescriptor.SizeInBytes() });
+    }
+    m_readAhead->Start(requests);
+}
+
+template <class ElemType>
+void TextParser<ElemType>::LoadChunk(TextChunkPtr& chunk, ChunkIdType chunkId, const ChunkDescriptor& descriptor)
 {
     chunk->m_sequenceMap.resize(descriptor.NumberOfSequences());
+
+    // Parse the chunk from memory, then release the chunk sized buffer.
+    auto data = m_readAhead->Take(ChunkReadAhead::Request{ chunkId, m_filename, descriptor.StartOffset(), descriptor.SizeInBytes() });
+    m_fileReader->LoadRange(move(data), descriptor.StartOffset());
     for (size_t sequenceIndex = 0; sequenceIndex < descriptor.NumberOfSequences(); ++sequenceIndex)
     {
         const auto& sequenceDescriptor = descriptor.Sequences()[sequenceIndex];
         chunk->m_sequenceMap[sequenceIndex] = LoadSequence(sequenceDescriptor, descriptor.StartOffset());
     }
+    m_fileReader->ReleaseRange();
 }
 
 template <class ElemType>
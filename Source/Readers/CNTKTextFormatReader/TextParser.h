@@ -17,6 +17,7 @@ template <class ElemType>
 class CNTKTextFormatReaderTestRunner;
 
 class FileWrapper;
+class ChunkReadAhead;
 class BufferedFileReader;
 
 // TODO: more details when tracing warnings
@@ -30,6 +31,9 @@ public:
     // Retrieves a chunk of data.
     ChunkPtr GetChunk(ChunkIdType chunkId) override;
 
+    // Starts the reads of the chunks that are going to be requested next.
+    void PrefetchChunks(const std::vector<ChunkIdType>& chunkIds) override;
+
     // Get information about chunks.
     std::vector<ChunkInfo> ChunkInfos() override;
 
@@ -109,6 +113,8 @@ private:
     const std::wstring m_filename;
     std::shared_ptr<FileWrapper> m_file;
     std::shared_ptr<BufferedFileReader> m_fileReader;
+    // Whole chunk reads, the chunks are then parsed from memory by m_fileReader.
+    std::shared_ptr<ChunkReadAhead> m_readAhead;
 
     // An internal structure to assist with copying from input stream buffers into
     // into sequence data in a proper format.
@@ -186,7 +192,7 @@ private:
     SequenceBuffer LoadSequence(const SequenceDescriptor& descriptor, size_t chunkOffset);
 
     // Given a descriptor, retrieves the data for the corresponding chunk from the file.
-    void LoadChunk(TextChunkPtr& chunk, const ChunkDescriptor& descriptor);
+    void LoadChunk(TextChunkPtr& chunk, ChunkIdType chunkId, const ChunkDescriptor& descriptor);
 
     // Fills some metadata members to be conformant to the exposed SequenceData interface.
     void FillSequenceMetadata(SequenceBuffer& sequenceBuffer, const SequenceKey& sequenceKey);
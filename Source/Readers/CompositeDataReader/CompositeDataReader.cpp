@@ -164,8 +164,17 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
             }
 
             bool shouldPrefetch = true;
-            m_sequenceEnumerator = std::make_shared<BlockRandomizer>(verbosity, randomizationWindow, deserializer, shouldPrefetch,
+            auto randomizer = std::make_shared<BlockRandomizer>(verbosity, randomizationWindow, deserializer, shouldPrefetch,
                 multiThreadedDeserialization, maxErrors, sampleBasedRandomizationWindow, GetRandomSeed(config));
+
+            // Number of chunks loaded ahead of the randomization window, how many of them can be loaded in parallel
+            // (only for deserializers that support concurrent chunk loads) and the memory budget for prefetched chunks.
+            size_t prefetchDepth = config(L"prefetchDepth", 1);
+            size_t prefetchParallelLoads = config(L"prefetchParallelLoads", 1);
+            size_t prefetchMemoryBudget = config(L"prefetchMemoryBudgetInBytes", 0);
+            randomizer->SetPrefetchConfiguration(prefetchDepth, prefetchParallelLoads, prefetchMemoryBudget);
+
+            m_sequenceEnumerator = randomizer;
         }
         else
             m_sequenceEnumerator = std::make_shared<NoRandomizer>(deserializer, multiThreadedDeserialization, maxErrors);
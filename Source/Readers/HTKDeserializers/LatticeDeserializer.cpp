@@ -51,7 +51,10 @@ protected:
     const LatticeDeserializer& m_deserializer;
     const ChunkDescriptor& m_descriptor;     // Current chunk descriptor.
     int m_verbosity;
-    ChunkBase(const LatticeDeserializer& deserializer, const ChunkDescriptor& descriptor, const wstring& fileName, int verbosity):
+    // The buffer holds the chunk read into memory, followed by 3 zero bytes for buffer overrun, i.e. 4 byte alignment.
+    // This is required because currently lattices are exposed as an array of floats, because CPUMatrix does not support chars.
+    // TODO: switch to char when possible.
+    ChunkBase(const LatticeDeserializer& deserializer, const ChunkDescriptor& descriptor, const wstring& fileName, vector<char>&& buffer, int verbosity):
         m_descriptor(descriptor),
         m_deserializer(deserializer),
         m_verbosity(verbosity)
@@ -62,23 +65,7 @@ protected:
         if (m_verbosity == 1)
             fprintf(stderr, "Reading lattice from file '%ls'\n", fileName.c_str());
 
-        auto f = FileWrapper::OpenOrDie(fileName, L"rbS");
-        size_t sizeInBytes = descriptor.SizeInBytes();
-
-        // Make sure we always have 3 at the end for buffer overrun, i.e. 4 byte alignment
-        // This is required because currently lattices are exposed as an array of floats, because CPUMatrix does not support chars.
-        // TODO: switch to char when possible.
-        vector<char> buffer(sizeInBytes + sizeof(float) - 1);
-        for (int fl = 0; fl < sizeof(float) - 1; fl++)
-        {
-            buffer[sizeInBytes + fl] = 0;
-        }
-
-        // Seek and read chunk into memory.
-        f.SeekOrDie(descriptor.StartOffset(), SEEK_SET);
-
-        f.ReadOrDie(buffer.data(), sizeInBytes, 1);
-
+        assert(buffer.size() == descriptor.SizeInBytes() + sizeof(float) - 1);
         m_pBuffer = make_shared<vector<char> >(move(buffer));
 
         // all sequences are valid by default.
@@ -96,8 +83,8 @@ class LatticeDeserializer::SequenceChunk : public LatticeDeserializer::ChunkBase
 {
 
 public:
-    SequenceChunk(const LatticeDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, int verbosity)
-        : ChunkBase(parent, descriptor, fileName, verbosity), m_ndShape({ 1 })
+    SequenceChunk(const LatticeDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, vector<char>&& buffer, int verbosity)
+        : ChunkBase(parent, descriptor, fileName, move(buffer), verbosity), m_ndShape({ 1 })
     {
     }
 
@@ -292,14 +279,29 @@ ChunkPtr LatticeDeserializer::GetChunk(ChunkIdType chunkId)
     attempt(5, [this, &result, chunkId]()
     {
         auto chunk = m_chunks[chunkId];
-        auto& fileName = m_latticeFiles[m_chunkToFileIndex[chunk]];
+        auto request = ChunkReadRequest(chunkId);
+        auto buffer = m_readAhead.Take(request);
 
-        result = make_shared<SequenceChunk>(*this, *chunk, fileName, m_verbosity);
+        result = make_shared<SequenceChunk>(*this, *chunk, request.m_fileName, move(buffer), m_verbosity);
     });
 
     return result;
 };
 
+void LatticeDeserializer::PrefetchChunks(const std::vector<ChunkIdType>& chunkIds)
+{
+    vector<ChunkReadAhead::Request> requests;
+    for (auto chunkId : chunkIds)
+        requests.push_back(ChunkReadRequest(chunkId));
+    m_readAhead.Start(requests);
+}
+
+ChunkReadAhead::Request LatticeDeserializer::ChunkReadRequest(ChunkIdType chunkId)
+{
+    auto chunk = m_chunks[chunkId];
+    return ChunkReadAhead::Request{ chunkId, m_latticeFiles[m_chunkToFileIndex[chunk]], chunk->StartOffset(), chunk->SizeInBytes() };
+}
+
 bool LatticeDeserializer::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& result)
 {
     auto found = std::lower_bound(m_keyToChunkLocation.begin(), m_keyToChunkLocation.end(), std::make_tuple(key.m_sequence, 0, 0),
@@ -10,6 +10,7 @@
 #include "CorpusDescriptor.h"
 #include "ConfigHelper.h"
 #include "Index.h"
+#include "ChunkReadAhead.h"
 #include <boost/noncopyable.hpp>
 
 namespace CNTK {
@@ -34,11 +35,16 @@ public:
     // Retrieves data for a chunk.
     virtual ChunkPtr GetChunk(ChunkIdType chunkId) override;
 
+    // Starts the reads of the chunks that are going to be requested next.
+    virtual void PrefetchChunks(const std::vector<ChunkIdType>& chunkIds) override;
+
 private:
     class LatticeChunk;
     class ChunkBase;
     class SequenceChunk;
 
+    ChunkReadAhead::Request ChunkReadRequest(ChunkIdType chunkId);
+
     // Initialization functions.
     void InitializeChunkInfos(CorpusDescriptorPtr corpus, ConfigHelper& config);
     void InitializeStreams(const std::wstring& featureName);
@@ -58,6 +64,9 @@ private:
     size_t m_chunkSizeBytes;
     std::vector<std::shared_ptr<Index>> m_indices;
     std::vector<std::wstring> m_latticeFiles;
+
+    // Reads of the chunk buffers, each buffer ends with 3 zero bytes for 4 byte alignment.
+    ChunkReadAhead m_readAhead{ sizeof(float) - 1 };
 };
 
 }
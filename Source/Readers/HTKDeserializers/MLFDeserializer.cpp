@@ -81,25 +81,17 @@ protected:
     const MLFDeserializer& m_deserializer;
     const ChunkDescriptor& m_descriptor;     // Current chunk descriptor.
 
-    ChunkBase(const MLFDeserializer& deserializer, const ChunkDescriptor& descriptor, const wstring& fileName, const StateTablePtr& states)
-        : m_parser(states),
+    // The buffer holds the chunk read into memory, always followed by 0 for buffer overrun.
+    ChunkBase(const MLFDeserializer& deserializer, const ChunkDescriptor& descriptor, vector<char>&& buffer, const StateTablePtr& states)
+        : m_buffer(move(buffer)),
+          m_parser(states),
           m_descriptor(descriptor),
           m_deserializer(deserializer)
     {
         if (descriptor.NumberOfSequences() == 0 || descriptor.SizeInBytes() == 0)
             LogicError("Empty chunks are not supported.");
 
-        auto f = FileWrapper::OpenOrDie(fileName, L"rbS");
-        size_t sizeInBytes = descriptor.SizeInBytes();
-
-        // Make sure we always have 0 at the end for buffer overrun.
-        m_buffer.resize(sizeInBytes + 1);
-        m_buffer[sizeInBytes] = 0;
-
-        // Seek and read chunk into memory.
-        f.SeekOrDie(descriptor.StartOffset(), SEEK_SET);
-
-        f.ReadOrDie(m_buffer.data(), sizeInBytes, 1);
+        assert(m_buffer.size() == descriptor.SizeInBytes() + 1 && m_buffer.back() == 0);
 
         // all sequences are valid by default.
         m_valid.resize(m_descriptor.NumberOfSequences(), true);
@@ -124,8 +116,8 @@ class MLFDeserializer::SequenceChunk : public MLFDeserializer::ChunkBase
     vector<vector<MLFFrameRange>> m_sequences; // Each sequence is a vector of sequential frame ranges.
 
 public:
-    SequenceChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states)
-        : ChunkBase(parent, descriptor, fileName, states)
+    SequenceChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, vector<char>&& buffer, StateTablePtr states)
+        : ChunkBase(parent, descriptor, move(buffer), states)
     {
         m_sequences.resize(m_descriptor.Sequences().size());
 
@@ -217,8 +209,8 @@ class MLFDeserializer::FrameChunk : public MLFDeserializer::ChunkBase
     std::vector<uint32_t> m_sequenceOffsetInChunkInSamples;
 
 public:
-    FrameChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states)
-        : ChunkBase(parent, descriptor, fileName, states)
+    FrameChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, vector<char>&& buffer, StateTablePtr states)
+        : ChunkBase(parent, descriptor, move(buffer), states)
     {
         uint32_t numSamples = static_cast<uint32_t>(m_descriptor.NumberOfSamples());
 
@@ -509,17 +501,31 @@ ChunkPtr MLFDeserializer::GetChunk(ChunkIdType chunkId)
     attempt(5, [this, &result, chunkId]()
     {
         auto chunk = m_chunks[chunkId];
-        auto& fileName = m_mlfFiles[m_chunkToFileIndex[chunk]];
+        auto buffer = m_readAhead.Take(ChunkReadRequest(chunkId));
 
         if (m_frameMode)
-            result = make_shared<FrameChunk>(*this, *chunk, fileName, m_stateTable);
+            result = make_shared<FrameChunk>(*this, *chunk, move(buffer), m_stateTable);
         else
-            result = make_shared<SequenceChunk>(*this, *chunk, fileName, m_stateTable);
+            result = make_shared<SequenceChunk>(*this, *chunk, move(buffer), m_stateTable);
     });
 
     return result;
 };
 
+void MLFDeserializer::PrefetchChunks(const std::vector<ChunkIdType>& chunkIds)
+{
+    vector<ChunkReadAhead::Request> requests;
+    for (auto chunkId : chunkIds)
+        requests.push_back(ChunkReadRequest(chunkId));
+    m_readAhead.Start(requests);
+}
+
+ChunkReadAhead::Request MLFDeserializer::ChunkReadRequest(ChunkIdType chunkId)
+{
+    auto chunk = m_chunks[chunkId];
+    return ChunkReadAhead::Request{ chunkId, m_mlfFiles[m_chunkToFileIndex[chunk]], chunk->StartOffset(), chunk->SizeInBytes() };
+}
+
 bool MLFDeserializer::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& result)
 {
     auto found = std::lower_bound(m_keyToChunkLocation.begin(), m_keyToChunkLocation.end(), std::make_tuple(key.m_sequence, 0, 0),
@@ -10,6 +10,7 @@
 #include "CorpusDescriptor.h"
 #include "MLFUtils.h"
 #include "Index.h"
+#include "ChunkReadAhead.h"
 
 namespace CNTK {
 
@@ -36,11 +37,16 @@ public:
     // Retrieves a chunk with data.
     virtual ChunkPtr GetChunk(ChunkIdType) override;
 
+    // Starts the reads of the chunks that are going to be requested next.
+    virtual void PrefetchChunks(const std::vector<ChunkIdType>& chunkIds) override;
+
 private:
     class ChunkBase;
     class SequenceChunk;
     class FrameChunk;
 
+    ChunkReadAhead::Request ChunkReadRequest(ChunkIdType chunkId);
+
     // Initializes chunk descriptions.
     void InitializeChunkInfos(CorpusDescriptorPtr corpus, const ConfigHelper& config, const std::wstring& stateListPath);
 
@@ -83,6 +89,9 @@ private:
 
     std::vector<std::shared_ptr<Index>> m_indices;
     std::vector<std::wstring> m_mlfFiles;
+
+    // Reads of the chunk buffers, each buffer ends with 0 for buffer overrun.
+    ChunkReadAhead m_readAhead{ 1 };
 };
 
 }
@@ -25,28 +25,15 @@ namespace CNTK {
         std::vector<char> m_buffer;
 
     public:
-        ImageChunk(const ChunkDescriptor& descriptor, Base64ImageDeserializerImpl& parent)
-            : m_descriptor(descriptor), m_deserializer(parent)
+        // The buffer holds the chunk read into memory, always followed by 0 for buffer overrun.
+        ImageChunk(const ChunkDescriptor& descriptor, std::vector<char>&& buffer, Base64ImageDeserializerImpl& parent)
+            : m_descriptor(descriptor), m_deserializer(parent), m_buffer(std::move(buffer))
         {
-            // Let's see if the open descriptor has problems.
-            if (ferror(m_deserializer.m_dataFile.get()) != 0)
-                m_deserializer.m_dataFile.reset(fopenOrDie(m_deserializer.m_fileName.c_str(), L"rbS"), [](FILE* f) { if (f) fclose(f); });
-
             if (descriptor.Sequences().empty() || !descriptor.SizeInBytes())
                 LogicError("Empty chunks are not supported.");
 
-            m_buffer.resize(descriptor.SizeInBytes() + 1);
-
-            // Make sure we always have 0 at the end for buffer overrun.
-            m_buffer[descriptor.SizeInBytes()] = 0;
+            assert(m_buffer.size() == descriptor.SizeInBytes() + 1 && m_buffer.back() == 0);
             m_chunkOffset = descriptor.StartOffset();
-
-            // Read chunk into memory.
-            int rc = _fseeki64(m_deserializer.m_dataFile.get(), m_chunkOffset, SEEK_SET);
-            if (rc)
-                RuntimeError("Error seeking to position '%" PRId64 "' in the input file '%ls', error code '%d'", m_chunkOffset, m_deserializer.m_fileName.c_str(), rc);
-
-            freadOrDie(m_buffer.data(), descriptor.SizeInBytes(), 1, m_deserializer.m_dataFile.get());
         }
 
         std::string KeyOf(const SequenceDescriptor& s) const
@@ -208,7 +195,21 @@ namespace CNTK {
     ChunkPtr Base64ImageDeserializerImpl::GetChunk(ChunkIdType chunkId)
     {
         const auto& chunkDescriptor = m_index->Chunks()[chunkId];
-        return make_shared<ImageChunk>(chunkDescriptor, *this);
+        return make_shared<ImageChunk>(chunkDescriptor, m_readAhead.Take(ChunkReadRequest(chunkId)), *this);
+    }
+
+    void Base64ImageDeserializerImpl::PrefetchChunks(const std::vector<ChunkIdType>& chunkIds)
+    {
+        std::vector<ChunkReadAhead::Request> requests;
+        for (auto chunkId : chunkIds)
+            requests.push_back(ChunkReadRequest(chunkId));
+        m_readAhead.Start(requests);
+    }
+
+    ChunkReadAhead::Request Base64ImageDeserializerImpl::ChunkReadRequest(ChunkIdType chunkId) const
+    {
+        const auto& chunkDescriptor = m_index->Chunks()[chunkId];
+        return ChunkReadAhead::Request{ chunkId, m_fileName, chunkDescriptor.StartOffset(), chunkDescriptor.SizeInBytes() };
     }
 
     bool Base64ImageDeserializerImpl::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& r)
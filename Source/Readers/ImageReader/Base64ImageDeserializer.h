@@ -8,6 +8,7 @@
 #include "ImageDeserializerBase.h"
 #include "Config.h"
 #include "CorpusDescriptor.h"
+#include "ChunkReadAhead.h"
 
 namespace CNTK {
 
@@ -20,6 +21,9 @@ namespace CNTK {
         // Get a chunk by id.
         ChunkPtr GetChunk(ChunkIdType chunkId) override;
 
+        // Starts the reads of the chunks that are going to be requested next.
+        void PrefetchChunks(const std::vector<ChunkIdType>& chunkIds) override;
+
         // Get chunk descriptions.
         std::vector<ChunkInfo> ChunkInfos() override;
 
@@ -32,10 +36,15 @@ namespace CNTK {
     private:
         class ImageChunk;
 
+        ChunkReadAhead::Request ChunkReadRequest(ChunkIdType chunkId) const;
+
         std::shared_ptr<Index> m_index;
         std::shared_ptr<FILE> m_dataFile;
         std::wstring m_fileName;
         bool m_hasSequenceIds;
+
+        // Reads of the chunk buffers, each buffer ends with 0 for buffer overrun.
+        ChunkReadAhead m_readAhead{ 1 };
     };
 
 }
@@ -31,6 +31,12 @@ public:
     // Gets sequences by specified ids. Order of returned sequences corresponds to the order of provided ids.
     virtual ChunkPtr GetChunk(ChunkIdType chunkId) override;
 
+    // GetChunk only wraps the sequence description, images are read when the sequence is requested.
+    virtual bool IsGetChunkThreadSafe() const override
+    {
+        return true;
+    }
+
     // Gets chunk descriptions.
     virtual std::vector<ChunkInfo> ChunkInfos() override;
 
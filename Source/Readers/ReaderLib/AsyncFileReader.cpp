@@ -0,0 +1,455 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _FILE_OFFSET_BITS 64
+
+#include "AsyncFileReader.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <errno.h>
+#include <string.h>
+#include "Basics.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef USE_IO_URING
+#include <liburing.h>
+#endif
+#endif
+
+namespace CNTK {
+
+using namespace std;
+
+// An open file, shared between the reader and all reads in flight against it.
+struct AsyncFileReader::Handle
+{
+    Handle(const wstring& filename) : m_filename(filename)
+    {
+#ifdef _WIN32
+        m_file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_file == INVALID_HANDLE_VALUE)
+            RuntimeError("Error opening file '%ls' for asynchronous reading: error code %d.", filename.c_str(), (int)GetLastError());
+#else
+        m_file = open(wtocharpath(filename).c_str(), O_RDONLY);
+        if (m_file < 0)
+            RuntimeError("Error opening file '%ls' for asynchronous reading: %s.", filename.c_str(), strerror(errno));
+#endif
+    }
+
+    ~Handle()
+    {
+#ifdef _WIN32
+        CloseHandle(m_file);
+#else
+        close(m_file);
+#endif
+    }
+
+    // Reads up to 'size' bytes at 'offset', blocking. Returns the number of bytes read (0 at the EOF).
+    size_t ReadAt(void* buffer, uint64_t offset, size_t size) const
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD bytesRead = 0;
+        DWORD toRead = (DWORD)std::min<size_t>(size, MaxReadSize);
+        if (!ReadFile(m_file, buffer, toRead, &bytesRead, &overlapped) && GetLastError() != ERROR_HANDLE_EOF)
+            RuntimeError("Error reading file '%ls' at offset %llu: error code %d.", m_filename.c_str(), (unsigned long long)offset, (int)GetLastError());
+        return bytesRead;
+#else
+        ssize_t bytesRead;
+        do
+        {
+            bytesRead = pread(m_file, buffer, std::min<size_t>(size, MaxReadSize), (off_t)offset);
+        } while (bytesRead < 0 && errno == EINTR);
+        if (bytesRead < 0)
+            RuntimeError("Error reading file '%ls' at offset %llu: %s.", m_filename.c_str(), (unsigned long long)offset, strerror(errno));
+        return (size_t)bytesRead;
+#endif
+    }
+
+    uint64_t Size() const
+    {
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size))
+            RuntimeError("Error getting the size of file '%ls': error code %d.", m_filename.c_str(), (int)GetLastError());
+        return (uint64_t)size.QuadPart;
+#else
+        struct stat st;
+        if (fstat(m_file, &st) != 0)
+            RuntimeError("Error getting the size of file '%ls': %s.", m_filename.c_str(), strerror(errno));
+        return (uint64_t)st.st_size;
+#endif
+    }
+
+    // Upper bound on a single read call, larger requests are served in pieces.
+    static const size_t MaxReadSize = 1 << 30;
+
+    wstring m_filename;
+#ifdef _WIN32
+    HANDLE m_file;
+#else
+    int m_file;
+#endif
+};
+
+const size_t AsyncFileReader::Handle::MaxReadSize;
+
+namespace {
+
+// A request in flight, owned by the engine until its promise is fulfilled.
+struct PendingRead
+{
+    shared_ptr<AsyncFileReader::Handle> m_file;
+    FileReadRequest m_request;
+    size_t m_bytesRead;
+    promise<size_t> m_promise;
+
+    char* Next() const { return static_cast<char*>(m_request.m_buffer) + m_bytesRead; }
+    uint64_t NextOffset() const { return m_request.m_offset + m_bytesRead; }
+    size_t Remaining() const { return m_request.m_size - m_bytesRead; }
+};
+
+typedef unique_ptr<PendingRead> PendingReadPtr;
+
+class AsyncIOEngine
+{
+public:
+    virtual ~AsyncIOEngine() {}
+    virtual void Submit(vector<PendingReadPtr>& batch) = 0;
+    virtual const char* Name() const = 0;
+
+    static AsyncIOEngine& Instance();
+};
+
+// Fallback engine: a fixed pool of threads, each serving one request at a time with blocking positional reads.
+class ThreadPoolEngine : public AsyncIOEngine
+{
+public:
+    ThreadPoolEngine()
+    {
+        size_t numThreads = std::max<size_t>(MinThreads, std::min<size_t>(MaxThreads, thread::hardware_concurrency()));
+        for (size_t i = 0; i < numThreads; ++i)
+            thread([this]() { Run(); }).detach();
+    }
+
+    void Submit(vector<PendingReadPtr>& batch) override
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            for (auto& r : batch)
+                m_queue.push_back(move(r));
+        }
+        m_hasWork.notify_all();
+    }
+
+    const char* Name() const override { return "threadpool"; }
+
+private:
+    void Run()
+    {
+        for (;;)
+        {
+            PendingReadPtr read;
+            {
+                unique_lock<mutex> lock(m_mutex);
+                m_hasWork.wait(lock, [this]() { return !m_queue.empty(); });
+                read = move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            try
+            {
+                while (read->Remaining() > 0)
+                {
+                    size_t n = read->m_file->ReadAt(read->Next(), read->NextOffset(), read->Remaining());
+                    if (n == 0)
+                        break; // EOF
+                    read->m_bytesRead += n;
+                }
+                read->m_promise.set_value(read->m_bytesRead);
+            }
+            catch (...)
+            {
+                read->m_promise.set_exception(current_exception());
+            }
+        }
+    }
+
+    static const size_t MinThreads = 4;
+    static const size_t MaxThreads = 16;
+
+    mutex m_mutex;
+    condition_variable m_hasWork;
+    deque<PendingReadPtr> m_queue;
+};
+
+const size_t ThreadPoolEngine::MinThreads;
+const size_t ThreadPoolEngine::MaxThreads;
+
+#if !defined(_WIN32) && defined(USE_IO_URING)
+
+// io_uring engine: requests are queued as SQEs from the submitting thread and reaped by a single completion thread.
+// Short reads are resubmitted for the remainder, the number of requests in flight is bounded by the ring size.
+class IoUringEngine : public AsyncIOEngine
+{
+public:
+    IoUringEngine()
+    {
+        int rc = io_uring_queue_init(QueueDepth, &m_ring, 0);
+        if (rc < 0)
+            RuntimeError("io_uring_queue_init failed: %s.", strerror(-rc));
+        thread([this]() { Reap(); }).detach();
+    }
+
+    void Submit(vector<PendingReadPtr>& batch) override
+    {
+        unique_lock<mutex> lock(m_mutex);
+        for (auto& r : batch)
+        {
+            WaitForSlot(lock);
+            if (m_error)
+            {
+                // The ring is unusable, report the error on the caller's thread through the futures.
+                r->m_promise.set_exception(m_error);
+                continue;
+            }
+            Queue(r.release());
+        }
+        if (!m_error)
+            io_uring_submit(&m_ring);
+    }
+
+    const char* Name() const override { return "io_uring"; }
+
+private:
+    // Requires m_mutex to be held.
+    void WaitForSlot(unique_lock<mutex>& lock)
+    {
+        // Entries queued but not yet submitted can never complete, so flush them before blocking.
+        if (m_inFlight >= QueueDepth)
+            io_uring_submit(&m_ring);
+        m_hasSlot.wait(lock, [this]() { return m_inFlight < QueueDepth || m_error; });
+    }
+
+    // Requires m_mutex to be held and a free slot.
+    void Queue(PendingRead* read)
+    {
+        auto sqe = io_uring_get_sqe(&m_ring);
+        if (!sqe)
+        {
+            // The submission queue is full of unsubmitted entries, flush them first.
+            io_uring_submit(&m_ring);
+            sqe = io_uring_get_sqe(&m_ring);
+        }
+        auto size = (unsigned int)std::min<size_t>(read->Remaining(), AsyncFileReader::Handle::MaxReadSize);
+        io_uring_prep_read(sqe, read->m_file->m_file, read->Next(), size, read->NextOffset());
+        io_uring_sqe_set_data(sqe, read);
+        m_pending.insert(read);
+        m_inFlight++;
+    }
+
+    // Runs on the completion thread. Errors must not escape it: they are reported through the futures of the reads.
+    void Reap()
+    {
+        try
+        {
+            for (;;)
+                ReapOne();
+        }
+        catch (...)
+        {
+            Fail(current_exception());
+        }
+    }
+
+    void ReapOne()
+    {
+        io_uring_cqe* cqe;
+        int rc;
+        do
+        {
+            rc = io_uring_wait_cqe(&m_ring, &cqe);
+        } while (rc == -EINTR);
+        if (rc < 0)
+            RuntimeError("io_uring_wait_cqe failed: %s.", strerror(-rc));
+
+        auto read = static_cast<PendingRead*>(io_uring_cqe_get_data(cqe));
+        int result = cqe->res;
+        io_uring_cqe_seen(&m_ring, cqe);
+
+        unique_lock<mutex> lock(m_mutex);
+        m_inFlight--;
+        if (result == -EINTR || result == -EAGAIN || (result > 0 && (size_t)result < read->Remaining()))
+        {
+            // Short or interrupted read, queue the remainder.
+            if (result > 0)
+                read->m_bytesRead += result;
+            Queue(read);
+            io_uring_submit(&m_ring);
+            return;
+        }
+        m_pending.erase(read);
+        lock.unlock();
+        m_hasSlot.notify_one();
+
+        PendingReadPtr completed(read);
+        if (result < 0)
+        {
+            try
+            {
+                RuntimeError("Error reading file '%ls' at offset %llu: %s.",
+                    read->m_file->m_filename.c_str(), (unsigned long long)read->NextOffset(), strerror(-result));
+            }
+            catch (...)
+            {
+                read->m_promise.set_exception(current_exception());
+            }
+        }
+        else
+        {
+            read->m_bytesRead += result;
+            read->m_promise.set_value(read->m_bytesRead);
+        }
+    }
+
+    // Fails all reads in flight and all reads submitted from now on with the given error.
+    void Fail(exception_ptr error)
+    {
+        unordered_set<PendingRead*> pending;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_error = error;
+            m_pending.swap(pending);
+            m_inFlight = 0;
+        }
+        m_hasSlot.notify_all();
+
+        for (auto read : pending)
+        {
+            PendingReadPtr failed(read);
+            failed->m_promise.set_exception(error);
+        }
+    }
+
+    static const unsigned int QueueDepth = 64;
+
+    io_uring m_ring;
+    mutex m_mutex;
+    condition_variable m_hasSlot;
+    unsigned int m_inFlight{ 0 };
+    // Reads queued to the ring and not completed yet.
+    unordered_set<PendingRead*> m_pending;
+    // Set once the completion thread has failed, the ring is not used anymore.
+    exception_ptr m_error;
+};
+
+#endif
+
+// The engine is created on first use and intentionally never destroyed: its threads are detached and may still be
+// blocked waiting for work when the process exits, so joining them from a static destructor could hang the exit.
+AsyncIOEngine& AsyncIOEngine::Instance()
+{
+    static AsyncIOEngine* engine = []() -> AsyncIOEngine*
+    {
+#if !defined(_WIN32) && defined(USE_IO_URING)
+        try
+        {
+            return new IoUringEngine();
+        }
+        catch (const std::exception& e)
+        {
+            fprintf(stderr, "WARNING: %s Falling back to thread pool based asynchronous reads.\n", e.what());
+        }
+#endif
+        return new ThreadPoolEngine();
+    }();
+    return *engine;
+}
+
+}
+
+AsyncFileReader::AsyncFileReader(const wstring& filename)
+    : m_handle(make_shared<Handle>(filename))
+{
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+}
+
+const wstring& AsyncFileReader::Filename() const
+{
+    return m_handle->m_filename;
+}
+
+uint64_t AsyncFileReader::Size() const
+{
+    return m_handle->Size();
+}
+
+const char* AsyncFileReader::EngineName()
+{
+    return AsyncIOEngine::Instance().Name();
+}
+
+vector<future<size_t>> AsyncFileReader::Submit(const vector<FileReadRequest>& requests)
+{
+    vector<future<size_t>> result;
+    result.reserve(requests.size());
+
+    vector<PendingReadPtr> batch;
+    batch.reserve(requests.size());
+    for (const auto& r : requests)
+    {
+        PendingReadPtr read(new PendingRead{ m_handle, r, 0, promise<size_t>() });
+        result.push_back(read->m_promise.get_future());
+        if (r.m_size == 0)
+            read->m_promise.set_value(0);
+        else
+            batch.push_back(move(read));
+    }
+
+    if (!batch.empty())
+        AsyncIOEngine::Instance().Submit(batch);
+    return result;
+}
+
+future<size_t> AsyncFileReader::Submit(const FileReadRequest& request)
+{
+    return move(Submit(vector<FileReadRequest>{ request }).front());
+}
+
+void AsyncFileReader::ReadOrDie(const vector<FileReadRequest>& requests)
+{
+    auto results = Submit(requests);
+
+    // Wait for all reads before reporting, the buffers must not be released while reads are in flight.
+    for (auto& r : results)
+        r.wait();
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        size_t bytesRead = results[i].get();
+        if (bytesRead != requests[i].m_size)
+            RuntimeError("Error reading file '%ls': expected %zu bytes at offset %llu, got %zu.",
+                Filename().c_str(), requests[i].m_size, (unsigned long long)requests[i].m_offset, bytesRead);
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+
+namespace CNTK {
+
+// A single positional read: 'size' bytes starting at 'offset' in the file are read into 'buffer'.
+// The buffer must stay valid until the corresponding future is ready.
+struct FileReadRequest
+{
+    uint64_t m_offset;
+    size_t m_size;
+    void* m_buffer;
+};
+
+// Asynchronous positional reads against a single file.
+// A batch of requests is submitted at once and each request completes independently,
+// fulfilling a future with the number of bytes actually read (less than requested only at the EOF).
+// All readers share one process-wide I/O engine: on Linux builds with USE_IO_URING this is an
+// io_uring submission queue, otherwise (or if the kernel refuses to set up a ring) a small pool
+// of threads issuing blocking positional reads. Reads never touch a file position, so a reader
+// can be used concurrently and alongside a FileWrapper opened on the same file.
+class AsyncFileReader
+{
+public:
+    explicit AsyncFileReader(const std::wstring& filename);
+    ~AsyncFileReader();
+
+    // Submits all requests as one batch, returns a future for each of them (in the same order).
+    std::vector<std::future<size_t>> Submit(const std::vector<FileReadRequest>& requests);
+
+    std::future<size_t> Submit(const FileReadRequest& request);
+
+    // Submits the requests and waits until all of them are complete,
+    // fails if any of the reads could not be satisfied completely.
+    void ReadOrDie(const std::vector<FileReadRequest>& requests);
+
+    void ReadOrDie(void* buffer, uint64_t offset, size_t size)
+    {
+        ReadOrDie(std::vector<FileReadRequest>{ { offset, size, buffer } });
+    }
+
+    const std::wstring& Filename() const;
+
+    // Current size of the file in bytes.
+    uint64_t Size() const;
+
+    // Name of the I/O engine in use ("io_uring" or "threadpool"), for diagnostics.
+    static const char* EngineName();
+
+    struct Handle;
+
+private:
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    std::shared_ptr<Handle> m_handle;
+};
+
+typedef std::shared_ptr<AsyncFileReader> AsyncFileReaderPtr;
+
+}
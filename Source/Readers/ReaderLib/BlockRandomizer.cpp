@@ -9,10 +9,12 @@
 #include <inttypes.h>
 #include "BlockRandomizer.h"
 #include <algorithm>
+#include <chrono>
 #include <utility>
 
 #include "DataReader.h"
 #include "ExceptionCapture.h"
+#include "DataDeserializerBase.h"
 
 namespace CNTK {
 
@@ -34,7 +36,11 @@ BlockRandomizer::BlockRandomizer(
       m_sweepSizeInSamples(0),
       m_chunkRandomizer(std::make_shared<ChunkRandomizer>(deserializer, randomizationRange, sampleBasedRandomizationWindow)),
       m_multithreadedGetNextSequences(multithreadedGetNextSequence),
-      m_prefetchedChunk(ChunkIdMax),
+      m_prefetchLanes(1),
+      m_nextPrefetchLane(0),
+      m_prefetchDepth(1),
+      m_prefetchMemoryBudget(0),
+      m_sampleSizeInBytes(0),
       m_cleaner(maxNumberOfInvalidSequences),
       m_seedOffset(seedOffset)
 {
@@ -45,6 +51,13 @@ BlockRandomizer::BlockRandomizer(
     m_streams = m_deserializer->StreamInfos();
     m_sequenceRandomizer = std::make_shared<SequenceRandomizer>(verbosity, m_deserializer, m_chunkRandomizer);
 
+    for (const auto& stream : m_streams)
+    {
+        if (stream.m_storageFormat == StorageFormat::Dense && stream.m_elementType != DataType::Unknown &&
+            !stream.m_sampleLayout.IsUnknown() && !stream.m_sampleLayout.HasUnboundDimension())
+            m_sampleSizeInBytes += stream.m_sampleLayout.TotalSize() * DataTypeSize(stream.m_elementType);
+    }
+
     // Calculate total number of samples.
     m_sweepSizeInSamples = 0;
     for (auto const & chunk : m_deserializer->ChunkInfos())
@@ -234,8 +247,7 @@ std::pair<size_t, size_t> BlockRandomizer::LoadSequenceData(size_t globalSampleC
     }
 
     // Now it is safe to start the new chunk prefetch.
-    ChunkIdType chunkToPrefetchNext = GetChunkToPrefetch(windowRange);
-    Prefetch(chunkToPrefetchNext);
+    Prefetch(windowRange);
 
     return { numGlobalSamples, numLocalSamples };
 }
@@ -395,10 +407,13 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
         }
 
         auto const& chunk = m_chunkRandomizer->GetRandomizedChunks()[i];
-        if (chunk.m_original->m_id == m_prefetchedChunk && m_prefetch.valid())
+        auto prefetched = m_prefetched.find(chunk.m_original->m_id);
+        if (prefetched != m_prefetched.end())
         {
             // Taking prefetched chunk.
-            m_chunks[chunk.m_original->m_id] = m_prefetch.get();
+            auto data = prefetched->second;
+            m_prefetched.erase(prefetched);
+            m_chunks[chunk.m_original->m_id] = data.get();
             if (m_verbosity >= Information)
                 fprintf(stderr, "BlockRandomizer::RetrieveDataChunks: paged in prefetched chunk %u (original chunk: %u), now %" PRIu64 " chunks in memory\n",
                 chunk.m_chunkId,
@@ -407,10 +422,10 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
         }
         else
         {
-            // Make sure we have no outstanding prefetches.
-            if (m_prefetch.valid())
+            // Make sure we have no outstanding prefetches, unless the deserializer can load chunks concurrently.
+            if (m_prefetchLanes.size() == 1)
             {
-                m_prefetch.wait();
+                WaitForPrefetches();
             }
 
             m_chunks[chunk.m_original->m_id] = m_deserializer->GetChunk(chunk.m_original->m_id);
@@ -429,45 +444,130 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
                 m_chunkRandomizer->GetRandomizedChunks()[windowRange.m_end - 1].m_chunkId);
 }
 
-// Identifies chunk id that should be prefetched.
-ChunkIdType BlockRandomizer::GetChunkToPrefetch(const ClosedOpenChunkInterval& windowRange)
+// Identifies chunk ids that should be prefetched, in the order they will be needed.
+std::vector<ChunkIdType> BlockRandomizer::GetChunksToPrefetch(const ClosedOpenChunkInterval& windowRange)
 {
-    ChunkIdType toBePrefetched = ChunkIdMax;
-    auto current = windowRange.m_end;
-    while (current < m_chunkRandomizer->GetRandomizedChunks().size())
+    std::vector<ChunkIdType> toBePrefetched;
+    size_t estimatedSize = 0;
+    const auto& chunks = m_chunkRandomizer->GetRandomizedChunks();
+    for (auto current = windowRange.m_end; current < chunks.size() && toBePrefetched.size() < m_prefetchDepth; ++current)
     {
-        const auto& chunk = m_chunkRandomizer->GetRandomizedChunks()[current];
-        if (chunk.m_chunkId % m_config.m_numberOfWorkers == m_config.m_workerRank &&
-            m_chunks.find(chunk.m_original->m_id) == m_chunks.end())
+        const auto& chunk = chunks[current];
+        if (chunk.m_chunkId % m_config.m_numberOfWorkers != m_config.m_workerRank ||
+            m_chunks.find(chunk.m_original->m_id) != m_chunks.end())
         {
-            toBePrefetched = chunk.m_original->m_id;
-            break;
+            continue;
         }
-        ++current;
+
+        // Always allow at least one chunk, so that a small budget does not disable the prefetch.
+        estimatedSize += EstimatedChunkSizeInBytes(*chunk.m_original);
+        if (m_prefetchMemoryBudget != 0 && !toBePrefetched.empty() && estimatedSize > m_prefetchMemoryBudget)
+            break;
+
+        toBePrefetched.push_back(chunk.m_original->m_id);
     }
     return toBePrefetched;
 }
 
-// Performs io prefetch of the specified chunk if needed.
-void BlockRandomizer::Prefetch(ChunkIdType chunkId)
+// Performs io prefetch of the chunks following the window if needed.
+void BlockRandomizer::Prefetch(const ClosedOpenChunkInterval& windowRange)
 {
-    // Start new prefetch if necessary.
-    if (m_prefetchedChunk != chunkId && chunkId != ChunkIdMax)
+    auto toBePrefetched = GetChunksToPrefetch(windowRange);
+
+    // Drop the prefetched chunks that are not needed ahead of the window anymore (i.e. after a reconfiguration).
+    // Loads in flight are kept until they complete, dropping them would block on the load.
+    for (auto it = m_prefetched.begin(); it != m_prefetched.end();)
+    {
+        if (std::find(toBePrefetched.begin(), toBePrefetched.end(), it->first) == toBePrefetched.end() &&
+            it->second.wait_for(std::chrono::seconds(0)) != std::future_status::timeout)
+        {
+            if (m_verbosity >= Debug)
+                fprintf(stderr, "BlockRandomizer::Prefetch: dropping prefetched original chunk: %u\n", it->first);
+            it = m_prefetched.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    // Let the deserializer start the reads of all new chunks as one batch, the loads below then wait for them.
+    auto deserializer = std::dynamic_pointer_cast<DataDeserializerBase>(m_deserializer);
+    if (deserializer && m_launchType == launch::async)
     {
-        // Wait to make sure there is no outstanding prefetches.
-        if (m_prefetch.valid())
+        std::vector<ChunkIdType> toBeRead;
+        for (auto chunkId : toBePrefetched)
         {
-            m_prefetch.wait();
+            if (m_prefetched.find(chunkId) == m_prefetched.end())
+                toBeRead.push_back(chunkId);
         }
 
-        m_prefetchedChunk = chunkId;
-        m_prefetch = std::async(m_launchType, [this, chunkId]() { return m_deserializer->GetChunk(chunkId); });
+        if (!toBeRead.empty())
+            deserializer->PrefetchChunks(toBeRead);
+    }
+
+    // Start new prefetches if necessary.
+    for (auto chunkId : toBePrefetched)
+    {
+        if (m_prefetched.find(chunkId) != m_prefetched.end())
+            continue;
+
+        // The lanes bound the number of loads running in parallel.
+        auto& lane = m_prefetchLanes[m_nextPrefetchLane];
+        m_nextPrefetchLane = (m_nextPrefetchLane + 1) % m_prefetchLanes.size();
+
+        auto previous = lane;
+        lane = std::async(m_launchType, [this, chunkId, previous]() mutable
+        {
+            if (previous.valid())
+            {
+                previous.wait();
+                previous = std::shared_future<ChunkPtr>(); // do not keep the previous chunk alive
+            }
+            return m_deserializer->GetChunk(chunkId);
+        }).share();
+        m_prefetched[chunkId] = lane;
 
         if (m_verbosity >= Debug)
             fprintf(stderr, "BlockRandomizer::Prefetch: prefetching original chunk: %u\n", chunkId);
     }
 }
 
+void BlockRandomizer::WaitForPrefetches()
+{
+    for (auto& lane : m_prefetchLanes)
+    {
+        if (lane.valid())
+            lane.wait();
+    }
+}
+
+size_t BlockRandomizer::EstimatedChunkSizeInBytes(const ChunkInfo& chunk) const
+{
+    return chunk.m_numberOfSamples * m_sampleSizeInBytes;
+}
+
+void BlockRandomizer::SetPrefetchConfiguration(size_t depth, size_t maxParallelLoads, size_t memoryBudgetInBytes)
+{
+    if (maxParallelLoads == 0)
+        InvalidArgument("The number of parallel chunk loads must be greater than zero.");
+
+    // Parallel lanes call GetChunk concurrently, which only some deserializers support.
+    auto deserializer = std::dynamic_pointer_cast<DataDeserializerBase>(m_deserializer);
+    if (maxParallelLoads > 1 && (!deserializer || !deserializer->IsGetChunkThreadSafe()))
+    {
+        if (m_verbosity >= (int)TraceLevel::Warning)
+            fprintf(stderr, "Warning: BlockRandomizer::SetPrefetchConfiguration: the deserializer does not support concurrent chunk loads, "
+                "using 1 instead of %" PRIu64 " parallel loads\n", maxParallelLoads);
+        maxParallelLoads = 1;
+    }
+
+    WaitForPrefetches();
+    m_prefetched.clear();
+    m_prefetchLanes.assign(maxParallelLoads, std::shared_future<ChunkPtr>());
+    m_nextPrefetchLane = 0;
+    m_prefetchDepth = depth;
+    m_prefetchMemoryBudget = memoryBudgetInBytes;
+}
+
 void BlockRandomizer::SetState(const std::map<std::wstring, size_t>& state)
 {
     auto it = state.find(g_minibatchSourcePosition);
@@ -65,12 +65,15 @@ public:
 
     ~BlockRandomizer()
     {
-        if (m_prefetch.valid())
-        {
-            m_prefetch.wait();
-        }
+        WaitForPrefetches();
     }
 
+    // Configures io prefetch: the number of chunks following the randomization window that are loaded ahead of time,
+    // the maximum number of such chunk loads that run in parallel (reduced to 1, with a warning, for deserializers
+    // that do not declare GetChunk thread-safe) and an upper bound on the estimated memory held by prefetched chunks
+    // (0 - no bound). The default is one chunk with no memory bound.
+    void SetPrefetchConfiguration(size_t depth, size_t maxParallelLoads, size_t memoryBudgetInBytes);
+
     void SetState(const std::map<std::wstring, size_t>& state) override;
 
     void SetConfiguration(const ReaderConfiguration& config) override;
@@ -97,11 +100,19 @@ private:
     // Prepares a new sweep if needed.
     void PrepareNewSweepIfNeeded(size_t samplePosition);
 
-    // Performs io prefetch of the specified chunk if needed.
-    void Prefetch(ChunkIdType chunkId);
+    // Performs io prefetch of the chunks following the given window if needed,
+    // dropping prefetched chunks that are not ahead of the window anymore.
+    void Prefetch(const ClosedOpenChunkInterval& windowRange);
+
+    // Returns next candidates for the prefetch following the given window,
+    // limited by the prefetch depth and memory budget.
+    std::vector<ChunkIdType> GetChunksToPrefetch(const ClosedOpenChunkInterval& windowRange);
+
+    // Waits for all outstanding prefetches.
+    void WaitForPrefetches();
 
-    // Returns next candidate for the prefetch in the given range.
-    ChunkIdType GetChunkToPrefetch(const ClosedOpenChunkInterval& windowRange);
+    // Rough estimate of the memory taken by the chunk data, based on dense streams only.
+    size_t EstimatedChunkSizeInBytes(const ChunkInfo& chunk) const;
 
     // Global sample position on the timeline.
     size_t m_globalSamplePosition;
@@ -153,12 +164,19 @@ private:
 
     int m_verbosity;
 
-    // Prefetch future.
-    std::future<ChunkPtr> m_prefetch;
+    // Prefetch futures, by original chunk id.
+    std::map<ChunkIdType, std::shared_future<ChunkPtr>> m_prefetched;
+    // Last prefetch started in each of the parallel load lanes, a new prefetch waits for the previous one in its lane.
+    std::vector<std::shared_future<ChunkPtr>> m_prefetchLanes;
+    size_t m_nextPrefetchLane;
     // Whether to have async or deferred prefetch.
     launch m_launchType;
-    // Prefetched original chunk id.
-    ChunkIdType m_prefetchedChunk;
+    // Number of chunks to prefetch ahead of the randomization window.
+    size_t m_prefetchDepth;
+    // Upper bound on the estimated memory held by prefetched chunks, 0 - no bound.
+    size_t m_prefetchMemoryBudget;
+    // Estimated number of bytes per sample, used to apply the memory budget.
+    size_t m_sampleSizeInBytes;
 
     // Current loaded chunks.
     ClosedOpenChunkInterval m_currentWindowRange;
@@ -41,6 +41,25 @@ namespace CNTK {
         m_done = (bytesRead == 0);
     }
 
+    void BufferedFileReader::LoadRange(vector<char>&& data, size_t fileOffset)
+    {
+        if (data.empty())
+        {
+            SetFileOffset(fileOffset);
+            return;
+        }
+
+        size_t size = data.size();
+        m_buffer = move(data);
+
+        // Keep the file position right after the buffer, so that Refill() picks up from there.
+        m_file.SeekOrDie(fileOffset + size, SEEK_SET);
+        m_fileOffset = fileOffset;
+        m_index = 0;
+        m_lineNumber = 0;
+        m_done = false;
+    }
+
     bool BufferedFileReader::TryMoveToNextLine()
     {
         for (; !m_done; Refill())
@@ -90,6 +90,21 @@ public:
         }
     }
 
+    // Takes over 'data', the contents of the file starting at 'fileOffset' (e.g. a whole chunk read elsewhere), as the buffer.
+    // Subsequent SetFileOffset calls within this range are served from memory, reading past its end continues
+    // from the file as usual.
+    void LoadRange(std::vector<char>&& data, size_t fileOffset);
+
+    // Releases the memory of a range loaded with LoadRange, so that the buffer does not stay at the size of the range.
+    // Call SetFileOffset before reading again.
+    void ReleaseRange()
+    {
+        std::vector<char>().swap(m_buffer);
+        m_buffer.reserve(m_maxSize);
+        m_index = 0;
+        m_done = true;
+    }
+
 private:
     // Read up to m_maxSize bytes from file into the buffer.
     void Refill();
@@ -268,7 +268,11 @@ public:
                                 launch::async,
                                 [this, c, i]()
                                 {
-                                    ChunkPtr chunk = m_parent->m_weakChunkTable[i][c].lock();
+                                    ChunkPtr chunk;
+                                    {
+                                        std::lock_guard<std::mutex> lock(m_parent->m_weakChunkTableMutex);
+                                        chunk = m_parent->m_weakChunkTable[i][c].lock();
+                                    }
                                     if (chunk)
                                         return chunk;
                                     return m_parent->m_deserializers[i]->GetChunk(c);
@@ -321,10 +325,15 @@ public:
                 }
 
                 m_sequenceToSequence[currentIndex] = s.m_indexInChunk;
-                ChunkPtr secondaryChunk = chunkTable[s.m_chunkId].lock();
+                ChunkPtr secondaryChunk;
+                {
+                    std::lock_guard<std::mutex> lock(m_parent->m_weakChunkTableMutex);
+                    secondaryChunk = chunkTable[s.m_chunkId].lock();
+                }
                 if (!secondaryChunk)
                 {
                     secondaryChunk = chunks[deserializerIndex].find(s.m_chunkId)->second->get();
+                    std::lock_guard<std::mutex> lock(m_parent->m_weakChunkTableMutex);
                     chunkTable[s.m_chunkId] = secondaryChunk;
                 }
 
@@ -361,4 +370,41 @@ ChunkPtr Bundler::GetChunk(ChunkIdType chunkId)
     return std::make_shared<BundlingChunk>(m_streams.size(), this, chunkId);
 }
 
+void Bundler::PrefetchChunks(const std::vector<ChunkIdType>& chunkIds)
+{
+    for (size_t i = 0; i < m_deserializers.size(); ++i)
+    {
+        auto deserializer = std::dynamic_pointer_cast<DataDeserializerBase>(m_deserializers[i]);
+        if (!deserializer)
+            continue;
+
+        std::vector<ChunkIdType> innerChunkIds;
+        {
+            std::lock_guard<std::mutex> lock(m_weakChunkTableMutex);
+            for (auto chunkId : chunkIds)
+            {
+                for (auto c : m_chunks[chunkId].m_secondaryChunks[i])
+                {
+                    if (m_weakChunkTable[i][c].expired())
+                        innerChunkIds.push_back(c);
+                }
+            }
+        }
+
+        if (!innerChunkIds.empty())
+            deserializer->PrefetchChunks(innerChunkIds);
+    }
+}
+
+bool Bundler::IsGetChunkThreadSafe() const
+{
+    for (const auto& d : m_deserializers)
+    {
+        auto deserializer = std::dynamic_pointer_cast<DataDeserializerBase>(d);
+        if (!deserializer || !deserializer->IsGetChunkThreadSafe())
+            return false;
+    }
+    return true;
+}
+
 }
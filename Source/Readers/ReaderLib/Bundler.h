@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <set>
 #include "DataDeserializerBase.h"
 #include "Config.h"
@@ -29,6 +30,12 @@ public:
     // Gets a chunk with data.
     virtual ChunkPtr GetChunk(ChunkIdType chunkId) override;
 
+    // Forwards the hint to the underlying deserializers, for the chunks that are not loaded yet.
+    virtual void PrefetchChunks(const std::vector<ChunkIdType>& chunkIds) override;
+
+    // Chunks can be loaded concurrently only if all underlying deserializers support it.
+    virtual bool IsGetChunkThreadSafe() const override;
+
 private:
     DISABLE_COPY_AND_MOVE(Bundler);
 
@@ -73,6 +80,8 @@ private:
     // A table of loaded chunks to make sure we do not load same chunk twice.
     // Inner vector is the table of chunk id into weak pointer, the outer vector has an element per deserializer.
     std::vector<std::vector<std::weak_ptr<Chunk>>> m_weakChunkTable;
+    // Guards m_weakChunkTable, which chunk loads (GetChunk) and PrefetchChunks access from different threads.
+    std::mutex m_weakChunkTableMutex;
 
     // General configuration
     int m_verbosity;
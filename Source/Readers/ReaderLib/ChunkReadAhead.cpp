@@ -0,0 +1,108 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "ChunkReadAhead.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+namespace CNTK {
+
+using namespace std;
+
+ChunkReadAhead::~ChunkReadAhead()
+{
+    for (auto& p : m_pending)
+        p.second->m_read.wait();
+}
+
+void ChunkReadAhead::Start(const vector<Request>& requests)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    // Reads in flight are kept until they complete, their buffers must stay alive.
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        bool requested = any_of(requests.begin(), requests.end(), [&it](const Request& r) { return r.m_chunkId == it->first; });
+        if (!requested && it->second->m_read.wait_for(chrono::seconds(0)) == future_status::ready)
+            it = m_pending.erase(it);
+        else
+            ++it;
+    }
+
+    // Group the new reads by file.
+    map<wstring, vector<PendingChunkPtr>> batches;
+    set<ChunkIdType> started;
+    for (const auto& r : requests)
+    {
+        if (r.m_size == 0 || m_pending.find(r.m_chunkId) != m_pending.end() || !started.insert(r.m_chunkId).second)
+            continue;
+
+        auto chunk = make_shared<PendingChunk>();
+        chunk->m_request = r;
+        chunk->m_buffer.resize(r.m_size + m_padding, 0);
+        batches[r.m_fileName].push_back(chunk);
+    }
+
+    for (auto& batch : batches)
+    {
+        shared_ptr<AsyncFileReader> file;
+        try
+        {
+            file = make_shared<AsyncFileReader>(batch.first);
+        }
+        catch (const exception&)
+        {
+            // Not started, the error is reported when the chunks are read in Take().
+            continue;
+        }
+
+        vector<FileReadRequest> reads;
+        reads.reserve(batch.second.size());
+        for (const auto& chunk : batch.second)
+            reads.push_back(FileReadRequest{ chunk->m_request.m_offset, chunk->m_request.m_size, chunk->m_buffer.data() });
+
+        auto results = file->Submit(reads);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            auto& chunk = batch.second[i];
+            chunk->m_file = file;
+            chunk->m_read = move(results[i]);
+            m_pending[chunk->m_request.m_chunkId] = chunk;
+        }
+    }
+}
+
+vector<char> ChunkReadAhead::Take(const Request& request)
+{
+    PendingChunkPtr chunk;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        auto found = m_pending.find(request.m_chunkId);
+        if (found != m_pending.end())
+        {
+            chunk = found->second;
+            m_pending.erase(found);
+        }
+    }
+
+    if (!chunk)
+    {
+        vector<char> buffer(request.m_size + m_padding, 0);
+        AsyncFileReader(request.m_fileName).ReadOrDie(buffer.data(), request.m_offset, request.m_size);
+        return buffer;
+    }
+
+    assert(chunk->m_request.m_offset == request.m_offset && chunk->m_request.m_size == request.m_size);
+    size_t bytesRead = chunk->m_read.get();
+    if (bytesRead != request.m_size)
+        RuntimeError("Error reading file '%ls': expected %zu bytes at offset %llu, got %zu.",
+            request.m_fileName.c_str(), request.m_size, (unsigned long long)request.m_offset, bytesRead);
+    return move(chunk->m_buffer);
+}
+
+}
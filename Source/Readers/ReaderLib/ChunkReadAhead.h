@@ -0,0 +1,64 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DataDeserializer.h"
+#include "AsyncFileReader.h"
+
+namespace CNTK {
+
+// Reads of whole chunks that are started before the chunks are requested (see DataDeserializerBase::PrefetchChunks).
+// The reads started together are submitted as a single batch per file, so that they are all in flight at once,
+// and GetChunk only waits for the read of its own chunk. Each chunk buffer is followed by 'padding' zero bytes,
+// which deserializers keep at the end of their buffers as a guard against overruns.
+class ChunkReadAhead
+{
+public:
+    struct Request
+    {
+        ChunkIdType m_chunkId;
+        std::wstring m_fileName;
+        uint64_t m_offset;
+        size_t m_size;
+    };
+
+    explicit ChunkReadAhead(size_t padding = 0) : m_padding(padding) {}
+
+    // Waits for the reads in flight, their buffers are released.
+    ~ChunkReadAhead();
+
+    // Starts the reads of the given chunks, unless they are already started.
+    // Completed reads of chunks that are not among the given ones are dropped.
+    void Start(const std::vector<Request>& requests);
+
+    // Returns the chunk data followed by the padding.
+    // Waits for the read of the chunk if it has been started, otherwise reads the chunk directly.
+    std::vector<char> Take(const Request& request);
+
+private:
+    struct PendingChunk
+    {
+        Request m_request;
+        std::shared_ptr<AsyncFileReader> m_file;
+        std::vector<char> m_buffer;
+        std::future<size_t> m_read;
+    };
+
+    typedef std::shared_ptr<PendingChunk> PendingChunkPtr;
+
+    const size_t m_padding;
+
+    std::mutex m_mutex;
+    std::map<ChunkIdType, PendingChunkPtr> m_pending;
+
+    DISABLE_COPY_AND_MOVE(ChunkReadAhead);
+};
+
+}
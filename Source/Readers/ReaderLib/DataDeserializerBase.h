@@ -29,6 +29,17 @@ public:
         return m_streams;
     }
 
+    // Hints that the given chunks are going to be requested by GetChunk soon, in this order.
+    // Deserializers that read chunks from files start all the reads here, GetChunk then waits for them.
+    virtual void PrefetchChunks(const std::vector<ChunkIdType>& /*chunkIds*/)
+    {}
+
+    // Whether GetChunk can be called from several threads at the same time.
+    virtual bool IsGetChunkThreadSafe() const
+    {
+        return false;
+    }
+
 protected:
     virtual bool GetSequenceInfoByKey(const SequenceKey&, SequenceInfo&)
     {
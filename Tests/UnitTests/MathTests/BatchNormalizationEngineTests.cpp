@@ -325,6 +325,100 @@ BOOST_AUTO_TEST_CASE(BatchNormalizationBackward)
     }
 }
 
+BOOST_AUTO_TEST_CASE(BatchNormalizationTrainingInCPU)
+{
+    // The CPU implementation is compared against a straightforward double precision evaluation of the
+    // same formulas as in CntkBatchNormalization.cuh.
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd(0.5f, 2.0f);
+
+    int deviceId = -1;
+    double eps = 1e-5;
+    for (bool spatial : {false, true})
+    {
+        for (double blendFactor : {0.0, 0.5})
+        {
+            for (size_t batchSize : {1, 7})
+            {
+                TensorShape inOutT(5, 3, 4);
+                auto eng = BNEng::Create(deviceId, inOutT, spatial, ImageLayoutKind::CHW, BatchNormEngineKind::Cntk);
+
+                size_t crow = inOutT.GetNumElements();
+                size_t crowScaleBias = spatial ? inOutT[inOutT.GetRank() - 1] : crow;
+                size_t spatialSize = crow / crowScaleBias;
+                auto randomMatrix = [&](size_t r, size_t c)
+                {
+                    vec buf(r * c);
+                    std::generate(begin(buf), end(buf), [&] { return nd(rng); });
+                    return SingleMatrix(r, c, buf.data(), deviceId, matrixFlagNormal);
+                };
+                SingleMatrix x = randomMatrix(crow, batchSize);
+                SingleMatrix dy = randomMatrix(crow, batchSize);
+                SingleMatrix dx = randomMatrix(crow, batchSize);
+                SingleMatrix scale = randomMatrix(crowScaleBias, 1);
+                SingleMatrix bias = randomMatrix(crowScaleBias, 1);
+                SingleMatrix runMean = randomMatrix(crowScaleBias, 1);
+                SingleMatrix runVariance = randomMatrix(crowScaleBias, 1);
+                runVariance.InplaceAbs();
+                SingleMatrix runMean0(runMean.DeepClone()), runVariance0(runVariance.DeepClone()), dx0(dx.DeepClone());
+                SingleMatrix out(crow, batchSize, deviceId), saveMean(deviceId), saveInvStdDev(deviceId);
+                SingleMatrix dScale(crowScaleBias, 1, deviceId), dBias(crowScaleBias, 1, deviceId);
+
+                double expAvg = 0.1;
+                eng->Forward(x, scale, bias, false, expAvg, blendFactor, runMean, runVariance, out, eps, saveMean, saveInvStdDev);
+                eng->Backward(x, dy, dx, scale, blendFactor, saveMean, saveInvStdDev, dScale, dBias, true);
+
+                double m = (double)(spatialSize * batchSize);
+                for (size_t c = 0; c < crowScaleBias; c++)
+                {
+                    auto row = [&](size_t i) { return spatial ? c * spatialSize + i % spatialSize : c; };
+                    double mean = 0, m2 = 0;
+                    for (size_t j = 0; j < batchSize; j++)
+                        for (size_t i = 0; i < spatialSize; i++)
+                            mean += x(row(i), j) / m;
+                    for (size_t j = 0; j < batchSize; j++)
+                        for (size_t i = 0; i < spatialSize; i++)
+                            m2 += (x(row(i), j) - mean) * (x(row(i), j) - mean);
+                    double expRunMean = expAvg * mean + (1 - expAvg) * runMean0(c, 0);
+                    double expRunVariance = expAvg * (m == 1 ? 0 : m2 / (m - 1)) + (1 - expAvg) * runVariance0(c, 0);
+                    double xMean = blendFactor * expRunMean + (1 - blendFactor) * mean;
+                    double xInvStdDev = blendFactor / sqrt(expRunVariance + eps) + (1 - blendFactor) / sqrt(m2 / m + eps);
+                    BOOST_CHECK_SMALL(runMean(c, 0) - expRunMean, 1e-5);
+                    BOOST_CHECK_CLOSE((double)runVariance(c, 0), expRunVariance, 1e-3);
+                    BOOST_CHECK_SMALL(saveMean(c, 0) - xMean, 1e-5);
+                    BOOST_CHECK_CLOSE((double)saveInvStdDev(c, 0), xInvStdDev, 1e-3);
+
+                    double expScaleGrad = 0, expBiasGrad = 0;
+                    for (size_t j = 0; j < batchSize; j++)
+                    {
+                        for (size_t i = 0; i < spatialSize; i++)
+                        {
+                            double xHat = (x(row(i), j) - xMean) * xInvStdDev;
+                            // (the tolerance grows with the magnitude of the terms, since a large inverse standard deviation amplifies rounding errors)
+                            double magnitude = fabs(scale(c, 0)) * xInvStdDev * (fabs(x(row(i), j)) + fabs(xMean)) + fabs(bias(c, 0));
+                            BOOST_CHECK_SMALL(out(row(i), j) - (scale(c, 0) * xHat + bias(c, 0)), 1e-5 * (1 + magnitude));
+                            expScaleGrad += dy(row(i), j) * xHat;
+                            expBiasGrad += dy(row(i), j);
+                        }
+                    }
+                    BOOST_CHECK_SMALL(dScale(c, 0) - expScaleGrad, 1e-4 * (1 + fabs(expScaleGrad)));
+                    BOOST_CHECK_SMALL(dBias(c, 0) - expBiasGrad, 1e-4 * (1 + fabs(expBiasGrad)));
+                    for (size_t j = 0; j < batchSize; j++)
+                    {
+                        for (size_t i = 0; i < spatialSize; i++)
+                        {
+                            double xHat = (x(row(i), j) - xMean) * xInvStdDev;
+                            double expDx = dx0(row(i), j) + scale(c, 0) * xInvStdDev * (dy(row(i), j) - (1 - blendFactor) * (xHat * expScaleGrad + expBiasGrad) / m);
+                            double magnitude = fabs(dx0(row(i), j)) + fabs(scale(c, 0)) * xInvStdDev * (fabs(dy(row(i), j)) + (fabs(xHat * expScaleGrad) + fabs(expBiasGrad)) / m);
+                            BOOST_CHECK_SMALL(dx(row(i), j) - expDx, 1e-5 * (1 + magnitude));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
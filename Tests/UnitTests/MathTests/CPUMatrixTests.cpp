@@ -4,6 +4,9 @@
 //
 #include "stdafx.h"
 #include "../../../Source/Math/CPUMatrix.h"
+#include "../../../Source/Math/CRFKernels.h"
+#include <omp.h>
+#include <random>
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -651,6 +654,49 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixSetValues, RandomSeedFixture)
     BOOST_CHECK_CLOSE(m1.SumOfElements(), static_cast<double>(m1.GetNumElements()), 1);
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixCounterBasedRandom, RandomSeedFixture)
+{
+    // known-answer test of the Philox4x32-10 block function (counter 0, key 0)
+    uint32_t block[4];
+    CPURNGHandle::Philox4x32(0, 0, block);
+    BOOST_CHECK_EQUAL(block[0], 0x6627e8d5u);
+    BOOST_CHECK_EQUAL(block[1], 0xe169c58du);
+    BOOST_CHECK_EQUAL(block[2], 0xbc57ac4cu);
+    BOOST_CHECK_EQUAL(block[3], 0x9b00dbd8u);
+
+    const uint64_t seed = IncrementCounter();
+    const int numThreads = omp_get_max_threads();
+
+    // the values do not depend on the number of threads
+    DMatrix mask1(300, 100), mask2(300, 100);
+    CPURNGHandle rng1(CPUDEVICE, seed), rng2(CPUDEVICE, seed);
+    omp_set_num_threads(1);
+    mask1.SetUniformRandomMask(0.3, 2.0, rng1);
+    omp_set_num_threads(std::max(numThreads, 4));
+    mask2.SetUniformRandomMask(0.3, 2.0, rng2);
+    omp_set_num_threads(numThreads);
+    BOOST_CHECK(mask1.IsEqualTo(mask2, 0));
+    BOOST_CHECK_CLOSE(mask1.SumOfElements(), 2.0 * 0.7 * mask1.GetNumElements(), 2);
+    BOOST_CHECK_EQUAL(rng1.Position(), mask1.GetNumElements());
+
+    // a handle created at an offset continues where another one left off, and fills of arbitrary sizes concatenate
+    DMatrix all(1, 16), first(1, 7), second(1, 9);
+    CPURNGHandle rngAll(CPUDEVICE, seed, 12), rngFirst(CPUDEVICE, seed, 12);
+    all.SetGaussianRandomValue(rngAll, 0.0, 1.0);
+    first.SetGaussianRandomValue(rngFirst, 0.0, 1.0);
+    CPURNGHandle rngSecond(CPUDEVICE, seed, 12 + 7);
+    second.SetGaussianRandomValue(rngSecond, 0.0, 1.0);
+    for (size_t i = 0; i < 7; i++)
+        BOOST_CHECK_EQUAL(all(0, i), first(0, i));
+    for (size_t i = 0; i < 9; i++)
+        BOOST_CHECK_EQUAL(all(0, 7 + i), second(0, i));
+
+    DMatrix gauss(100, 100);
+    CPURNGHandle rngGauss(CPUDEVICE, seed);
+    gauss.SetGaussianRandomValue(rngGauss, 1.0, 0.01);
+    BOOST_CHECK_CLOSE(gauss.SumOfElements(), static_cast<double>(gauss.GetNumElements()), 1);
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUMatrixTranspose, RandomSeedFixture)
 {
     DMatrix m0(2, 3);
@@ -1195,6 +1241,109 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixGatherFromTarget, RandomSeedFixture)
     BOOST_CHECK(m2.IsEqualTo(expect, 1e-6));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixRCRFBackwardAndTransitionGradient, RandomSeedFixture)
+{
+    // Compares the CRF posteriors and transition gradient against brute-force enumeration of all label sequences.
+    const int numLabels = 3, numPos = 4, firstLabel = 1;
+    std::mt19937 rng(0);
+    std::normal_distribution<double> dist(0, 2);
+    DMatrix pairScores(numLabels, numLabels), posScores(numLabels, numPos), lbls(numLabels, numPos);
+    foreach_coord (i, j, pairScores)
+        pairScores(i, j) = dist(rng);
+    foreach_coord (i, j, posScores)
+        posScores(i, j) = dist(rng);
+    std::vector<int> reference = { firstLabel, 0, 2, 2 };
+    lbls.SetValue(0);
+    for (int t = 0; t < numPos; t++)
+        lbls(reference[t], t) = 1;
+
+    // forward recursion with exact log-add, like the brute-force sums below
+    DMatrix alpha(numLabels, numPos);
+    std::vector<double> start(numLabels, LZERO), workspace(numLabels);
+    start[firstLabel] = 0;
+    for (int t = 0; t < numPos; t++)
+    {
+        CRFLogAddTransition(pairScores.Data(), t > 0 ? &alpha(0, t - 1) : start.data(), numLabels, &alpha(0, t), workspace.data());
+        for (int k = 0; k < numLabels; k++)
+            alpha(k, t) += posScores(k, t);
+    }
+
+    DMatrix beta, grd(numLabels, numLabels);
+    grd.SetValue(0);
+    DMatrix::RCRFBackwardCompute(alpha, beta, lbls, pairScores);
+    DMatrix::RCRFTransGrdCompute(lbls, alpha, beta, pairScores, grd);
+
+    // enumerate all paths; the path starts from the transition out of 'firstLabel'
+    DMatrix posterior(numLabels, numPos), expectedGrd(numLabels, numLabels);
+    posterior.SetValue(0);
+    expectedGrd.SetValue(0);
+    double total = 0;
+    std::vector<int> path(numPos);
+    int numPaths = 1;
+    for (int t = 0; t < numPos; t++)
+        numPaths *= numLabels;
+    for (int n = 0; n < numPaths; n++)
+    {
+        for (int t = 0, r = n; t < numPos; t++, r /= numLabels)
+            path[t] = r % numLabels;
+        double score = 0;
+        for (int t = 0; t < numPos; t++)
+            score += posScores(path[t], t) + pairScores(path[t], t > 0 ? path[t - 1] : firstLabel);
+        double p = exp(score);
+        total += p;
+        for (int t = 0; t < numPos; t++)
+        {
+            posterior(path[t], t) += p;
+            expectedGrd(path[t], t > 0 ? path[t - 1] : firstLabel) += p;
+        }
+    }
+    for (int t = 0; t < numPos; t++)
+        expectedGrd(reference[t], t > 0 ? reference[t - 1] : firstLabel) -= total;
+
+    foreach_coord (i, j, posterior)
+        BOOST_CHECK_CLOSE(exp(beta(i, j)), posterior(i, j) / total, 1e-8);
+    foreach_coord (i, j, grd)
+        BOOST_CHECK_SMALL(grd(i, j) - expectedGrd(i, j) / total, 1e-10);
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixCRFTransitionBatch, RandomSeedFixture)
+{
+    // The batched CRF steps must give the values of the per-sequence steps.
+    const size_t numLabels = 5, numSequences = 3;
+    std::mt19937 rng(0);
+    std::normal_distribution<double> dist(0, 4);
+    std::vector<double> transitions(numLabels * numLabels), prev(numLabels * numSequences);
+    for (auto& v : transitions)
+        v = dist(rng);
+    for (auto& v : prev)
+        v = dist(rng);
+    // a sequence at its start
+    std::fill(prev.begin(), prev.begin() + numLabels, (double) LZERO);
+    prev[2] = 0;
+
+    std::vector<double> result(numLabels * numSequences), workspace(numLabels * numSequences);
+    std::vector<double> expected(numLabels), expectedWorkspace(numLabels);
+    CRFLogAddTransitionBatch(transitions.data(), prev.data(), numLabels, numSequences, result.data(), workspace.data());
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        CRFLogAddTransition(transitions.data(), &prev[s * numLabels], numLabels, expected.data(), expectedWorkspace.data());
+        for (size_t k = 0; k < numLabels; k++)
+            BOOST_CHECK_CLOSE(result[s * numLabels + k], expected[k], 1e-10);
+    }
+
+    std::vector<double> backpointer(numLabels * numSequences), expectedBackpointer(numLabels);
+    CRFMaxTransitionBatch(transitions.data(), prev.data(), numLabels, numSequences, result.data(), backpointer.data());
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        CRFMaxTransition(transitions.data(), &prev[s * numLabels], numLabels, expected.data(), expectedBackpointer.data());
+        for (size_t k = 0; k < numLabels; k++)
+        {
+            BOOST_CHECK_EQUAL(result[s * numLabels + k], expected[k]);
+            BOOST_CHECK_EQUAL(backpointer[s * numLabels + k], expectedBackpointer[k]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
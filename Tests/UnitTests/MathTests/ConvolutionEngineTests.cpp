@@ -642,6 +642,66 @@ BOOST_AUTO_TEST_CASE(MaxUnpooling)
     }
 }
 
+// The CPU pooling engine must match the reference engine exactly, including which element of a window
+// receives the gradient when several elements are equal to the maximum.
+BOOST_AUTO_TEST_CASE(PoolingEngineMatchesReference)
+{
+    std::mt19937 rng(0);
+    boost::random::uniform_int_distribution<> batchSizeG(1, 8);
+    boost::random::uniform_int_distribution<> valueG(-3, 3);
+
+    int deviceId = -1;
+    for (auto kind : {PoolKind::Max, PoolKind::Average})
+    {
+        for (bool poolIncludePad : {false, true})
+        {
+            for (const auto& g : GeneratePoolTestConfigs())
+            {
+                auto baseEng = ConvEng::Create(g, deviceId, ImageLayoutKind::CHW, 0, kind, ConvolutionEngineKind::Reference, L"", false, poolIncludePad);
+                auto testEng = ConvEng::Create(g, deviceId, ImageLayoutKind::CHW, 0, kind, ConvolutionEngineKind::Pooling, L"", false, poolIncludePad);
+
+                size_t n = batchSizeG(rng);
+                size_t crowIn = g->InputShape().GetNumElements();
+                size_t crowOut = g->OutputShape().GetNumElements();
+                // Small integers, so that windows often have several maxima.
+                vec buf(crowIn * n);
+                std::generate(begin(buf), end(buf), [&] { return (float)valueG(rng); });
+                SingleMatrix in(crowIn, n, buf.data(), deviceId, matrixFlagNormal);
+                buf.resize(crowOut * n);
+                std::generate(begin(buf), end(buf), [&] { return (float)valueG(rng); });
+                SingleMatrix srcGrad(crowOut, n, buf.data(), deviceId, matrixFlagNormal);
+
+                SingleMatrix out(crowOut, n, deviceId);
+                SingleMatrix outB(crowOut, n, deviceId);
+                testEng->ForwardPooling(in, out);
+                baseEng->ForwardPooling(in, outB);
+
+                SingleMatrix grad(crowIn, n, deviceId);
+                SingleMatrix gradB(crowIn, n, deviceId);
+                grad.SetValue(1);
+                gradB.SetValue(1);
+                testEng->BackwardPooling(out, srcGrad, in, grad, true);
+                baseEng->BackwardPooling(outB, srcGrad, in, gradB, true);
+                SingleMatrix gradReset(crowIn, n, deviceId);
+                SingleMatrix gradBReset(crowIn, n, deviceId);
+                testEng->BackwardPooling(out, srcGrad, in, gradReset, false);
+                baseEng->BackwardPooling(outB, srcGrad, in, gradBReset, false);
+
+                std::stringstream tmsg;
+                tmsg << "Geometry: " << (std::string)(*g) << ", Pool: " << (int)kind << ", IncludePad: " << poolIncludePad << ", Batch: " << n;
+                std::string msg = " are not equal, " + tmsg.str();
+                float relErr = Err<float>::Rel;
+                float absErr = Err<float>::Abs;
+                std::string emsg;
+
+                BOOST_REQUIRE_MESSAGE(CheckEqual(out, outB, emsg, relErr, absErr), "out" << msg << ". " << emsg);
+                BOOST_REQUIRE_MESSAGE(CheckEqual(grad, gradB, emsg, relErr, absErr), "grad" << msg << ". " << emsg);
+                BOOST_REQUIRE_MESSAGE(CheckEqual(gradReset, gradBReset, emsg, relErr, absErr), "gradReset" << msg << ". " << emsg);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(Half_ConvolutionSuite)
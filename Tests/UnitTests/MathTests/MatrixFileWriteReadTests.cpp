@@ -70,6 +70,56 @@ BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
     BOOST_CHECK(matrixSparseRead.IsEqualTo(matrixSparseCopy, c_epsilonFloatE5));
 }
 
+BOOST_FIXTURE_TEST_CASE(MatrixFileWriteReadAlignedPayload, RandomSeedFixture)
+{
+    Matrix<float> matrix = Matrix<float>::RandomUniform(43, 10, CPUDEVICE, -26.3f, 30.2f, IncrementCounter());
+    Matrix<float> matrixCopy = matrix.DeepClone();
+
+    std::wstring fileName(L"MAligned.bin");
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsWrite | fileOptionsAlignedPayloads);
+        file << 'x'; // misalign the payload start
+        matrix.Write(file, /*alignPayload=*/true);
+        file << 'y';
+    }
+
+    // read back through stdio
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsRead);
+        char c;
+        file >> c;
+        Matrix<float> matrixRead(CPUDEVICE);
+        matrixRead.Read(file, /*mapAlignedPayload=*/true); // not mapped: falls back to copying
+        file >> c;
+        BOOST_CHECK_EQUAL(c, 'y');
+        BOOST_CHECK(matrixRead.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+    }
+
+    // read back in-place from the memory mapping
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsRead | fileOptionsMemoryMapped);
+        auto mapping = file.GetMemoryMapping();
+        BOOST_REQUIRE(mapping);
+        char c;
+        file >> c;
+        Matrix<float> matrixRead(CPUDEVICE);
+        matrixRead.Read(file, /*mapAlignedPayload=*/true);
+        file >> c;
+        BOOST_CHECK_EQUAL(c, 'y');
+        BOOST_CHECK(matrixRead.Data() >= (float*)mapping->Data() && matrixRead.Data() < (float*)(mapping->Data() + mapping->Size()));
+        BOOST_CHECK_EQUAL(((size_t)matrixRead.Data()) % MemoryMappedFile::PageSize(), 0);
+        BOOST_CHECK(matrixRead.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+
+        // writes go to a private copy
+        matrixRead.SetValue(0.0f);
+        File fileAgain(fileName, fileOptionsBinary | fileOptionsRead);
+        fileAgain >> c;
+        Matrix<float> matrixReadAgain(CPUDEVICE);
+        matrixReadAgain.Read(fileAgain);
+        BOOST_CHECK(matrixReadAgain.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(GPUMatrixSuite)
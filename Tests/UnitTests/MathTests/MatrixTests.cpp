@@ -7,6 +7,9 @@
 #include "../../../Source/Math/Matrix.h"
 #include "../../../Source/Math/CPUMatrix.h"
 #include "../../../Source/Math/Helpers.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
 
 #define IDX2C(i, j, ld) (((j) * (ld)) + (i)) // 0 based indexing
 
@@ -1164,6 +1167,41 @@ BOOST_FIXTURE_TEST_CASE(MatrixVectorMax, RandomSeedFixture)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(MatrixVectorMaxTopKLargeColumns, RandomSeedFixture)
+{
+    // Few columns with many rows: the CPU splits each column across threads. Values are drawn from a small
+    // range, so there are many ties, which must be resolved by the lower index.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> valueG(0, 1000);
+    for (size_t numCols : {1, 3})
+    {
+        const size_t numRows = 100000;
+        const int topK = 20;
+        std::vector<float> src(numRows * numCols);
+        std::generate(src.begin(), src.end(), [&] { return (float)valueG(rng); });
+
+        Matrix<float> actual(numRows, numCols, src.data(), CPUDEVICE, matrixFlagNormal);
+        Matrix<float> actualIdx(CPUDEVICE);
+        Matrix<float> actualVal(CPUDEVICE);
+        actual.VectorMax(actualIdx, actualVal, true, topK);
+        BOOST_REQUIRE_EQUAL(actualIdx.GetNumRows(), topK);
+        BOOST_REQUIRE_EQUAL(actualIdx.GetNumCols(), numCols);
+
+        for (size_t j = 0; j < numCols; j++)
+        {
+            const float* column = src.data() + j * numRows;
+            std::vector<size_t> expected(numRows);
+            std::iota(expected.begin(), expected.end(), 0);
+            std::stable_sort(expected.begin(), expected.end(), [column](size_t a, size_t b) { return column[a] > column[b]; });
+            for (int i = 0; i < topK; i++)
+            {
+                BOOST_CHECK_EQUAL(actualIdx(i, j), (float)expected[i]);
+                BOOST_CHECK_EQUAL(actualVal(i, j), column[expected[i]]);
+            }
+        }
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(MatrixAssignNumOfDiff, RandomSeedFixture)
 {
     float labels[] = {1.0f, 2.0f, 3.0f};
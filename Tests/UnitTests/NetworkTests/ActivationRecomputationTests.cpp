@@ -0,0 +1,136 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/ComputationNetworkLib/LinearAlgebraNodes.h"
+#include "../../../Source/ComputationNetworkLib/NonlinearityNodes.h"
+#include "../../../Source/ComputationNetworkLib/TrainingNodes.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+static const size_t c_dim = 4;
+static const size_t c_numLayers = 4;
+static const size_t c_minibatchSize = 3;
+
+// loss = SquareError (y, h4) with h[l] = Tanh (z[l]) and z[l] = W[l] h[l-1], h0 = x
+static ComputationNetworkPtr CreateDeepNetwork(const vector<wstring>& nodesToRecompute = vector<wstring>())
+{
+    mt19937 rng(7);
+    uniform_real_distribution<float> dist(-1, 1);
+    auto setRandomValues = [&](const shared_ptr<ComputationNode<float>>& node, size_t rows, size_t cols)
+    {
+        vector<float> values(rows * cols);
+        for (auto& v : values)
+            v = dist(rng);
+        node->Value().SetValue(rows, cols, c_deviceId, values.data());
+    };
+
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto x = builder.CreateInputNode(L"x", c_dim);
+    auto y = builder.CreateInputNode(L"y", c_dim);
+    auto h = x;
+    for (size_t l = 1; l <= c_numLayers; l++)
+    {
+        auto w = builder.CreateLearnableParameter(L"W" + to_wstring(l), c_dim, c_dim);
+        setRandomValues(w, c_dim, c_dim);
+        h = builder.Tanh(builder.Times(w, h, 1, L"z" + to_wstring(l)), L"h" + to_wstring(l));
+    }
+    auto loss = builder.SquareError(y, h, L"loss");
+    net->AddToNodeGroup(L"criterion", loss);
+    net->CompileNetwork();
+
+    vector<ComputationNodeBasePtr> nodes;
+    for (const auto& name : nodesToRecompute)
+        nodes.push_back(net->GetNodeFromName(name));
+    net->SetNodesToRecompute(nodes);
+    net->AllocateAllMatrices(vector<ComputationNodeBasePtr>(), vector<ComputationNodeBasePtr>(), loss);
+    net->GetMBLayoutPtrOfNetwork()->InitAsFrameMode(c_minibatchSize);
+    setRandomValues(x, c_dim, c_minibatchSize);
+    setRandomValues(y, c_dim, c_minibatchSize);
+    return net;
+}
+
+// returns the gradients of all weights, after forward prop and backprop of one minibatch
+static vector<vector<float>> ComputeGradients(const ComputationNetworkPtr& net)
+{
+    auto loss = net->GetNodeFromName(L"loss");
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->StartEvaluateMinibatchLoop(loss);
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ net->GetNodeFromName(L"x"), net->GetNodeFromName(L"y") });
+    net->ForwardProp(loss);
+    net->Backprop(loss);
+
+    vector<vector<float>> gradients;
+    for (size_t l = 1; l <= c_numLayers; l++)
+    {
+        auto& gradient = dynamic_pointer_cast<ComputationNode<float>>(net->GetNodeFromName(L"W" + to_wstring(l)))->Gradient();
+        gradients.push_back(vector<float>(gradient.Data(), gradient.Data() + gradient.GetNumElements()));
+    }
+    return gradients;
+}
+
+static void CheckGradientsEqual(const vector<vector<float>>& gradients, const vector<vector<float>>& expected)
+{
+    BOOST_REQUIRE_EQUAL(gradients.size(), expected.size());
+    for (size_t l = 0; l < expected.size(); l++)
+    {
+        BOOST_REQUIRE_EQUAL(gradients[l].size(), expected[l].size());
+        for (size_t i = 0; i < expected[l].size(); i++)
+            BOOST_CHECK_SMALL(gradients[l][i] - expected[l][i], 1e-6f);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(ActivationRecomputationTestSuite)
+
+BOOST_AUTO_TEST_CASE(RecomputedActivationsGiveSameGradients)
+{
+    auto expected = ComputeGradients(CreateDeepNetwork());
+
+    // checkpoints every ceil(sqrt(4)) = 2 Tanh outputs: h1 and h3 are recomputed, together with z1 and z3 they are computed from
+    Globals::SetActivationRecomputation(true);
+    auto net = CreateDeepNetwork();
+    Globals::SetActivationRecomputation(false);
+    for (const auto& name : { L"h1", L"z1", L"h3", L"z3" })
+        BOOST_CHECK(net->GetNodeFromName(name)->IsValueRecomputedDuringBackprop());
+    for (const auto& name : { L"h2", L"z2", L"h4", L"z4", L"loss" })
+        BOOST_CHECK(!net->GetNodeFromName(name)->IsValueRecomputedDuringBackprop());
+    CheckGradientsEqual(ComputeGradients(net), expected);
+}
+
+BOOST_AUTO_TEST_CASE(RecomputeGivenActivations)
+{
+    auto expected = ComputeGradients(CreateDeepNetwork());
+
+    // the Times outputs are not needed by backprop, but they are recomputed to recompute the Tanh outputs
+    auto net = CreateDeepNetwork(vector<wstring>{ L"h2", L"h3", L"h4" });
+    for (const auto& name : { L"h2", L"z2", L"h3", L"z3", L"h4", L"z4" })
+        BOOST_CHECK(net->GetNodeFromName(name)->IsValueRecomputedDuringBackprop());
+    for (const auto& name : { L"h1", L"z1", L"loss" })
+        BOOST_CHECK(!net->GetNodeFromName(name)->IsValueRecomputedDuringBackprop());
+    CheckGradientsEqual(ComputeGradients(net), expected);
+
+    // a second minibatch recomputes from the new input
+    auto x = dynamic_pointer_cast<ComputationNode<float>>(net->GetNodeFromName(L"x"));
+    auto reference = CreateDeepNetwork();
+    auto referenceX = dynamic_pointer_cast<ComputationNode<float>>(reference->GetNodeFromName(L"x"));
+    x->Value().SetValue(0.5f);
+    referenceX->Value().SetValue(0.5f);
+    CheckGradientsEqual(ComputeGradients(net), ComputeGradients(reference));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
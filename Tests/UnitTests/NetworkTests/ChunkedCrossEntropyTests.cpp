@@ -0,0 +1,106 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/TrainingNodes.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+// Extends the node to allocate the matrices that are normally taken from the matrix pool.
+template <class ElemType>
+class ChunkedCrossEntropyWithSoftmaxNodeTest : public ChunkedCrossEntropyWithSoftmaxNode<ElemType>
+{
+public:
+    ChunkedCrossEntropyWithSoftmaxNodeTest(size_t blockSize)
+        : ChunkedCrossEntropyWithSoftmaxNode<ElemType>(c_deviceId, L"ChunkedCrossEntropyWithSoftmaxNodeTest", blockSize)
+    {
+    }
+
+    void AllocMatrices()
+    {
+        this->CreateValueMatrixIfNull();
+        this->CreateGradientMatrixIfNull();
+        this->Gradient().Resize(1, 1);
+        this->Gradient().SetValue(1);
+        for (auto matrix : { &this->m_logits, &this->m_weightsBlock, &this->m_logSumExp, &this->m_blockLogSumExp, &this->m_labelSum, &this->m_labelProjection, &this->m_ones })
+            *matrix = make_shared<Matrix<ElemType>>(c_deviceId);
+        this->UpdateFunctionMBSize();
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(ChunkedCrossEntropyWithSoftmaxTestSuite)
+
+BOOST_AUTO_TEST_CASE(ChunkedCrossEntropyMatchesFullSoftmax)
+{
+    const size_t V = 11, H = 4, T = 5;
+    mt19937 rng(3);
+    uniform_real_distribution<double> dist(-2, 2);
+    vector<double> weights(V * H), hidden(H * T), labels(V * T, 0);
+    for (auto& v : weights) v = dist(rng);
+    for (auto& v : hidden) v = dist(rng);
+    for (size_t t = 0; t < T; t++)
+        labels[t * V + (t * 7) % V] = 1;
+
+    // reference: full logits, softmax, and the gradient (softmax - labels) of the logits
+    double expectedLoss = 0;
+    vector<double> expectedWeightsGradient(V * H, 0), expectedHiddenGradient(H * T, 0);
+    for (size_t t = 0; t < T; t++)
+    {
+        vector<double> z(V, 0);
+        for (size_t i = 0; i < V; i++)
+            for (size_t k = 0; k < H; k++)
+                z[i] += weights[k * V + i] * hidden[t * H + k];
+        double maxZ = *max_element(z.begin(), z.end()), sum = 0;
+        for (auto v : z)
+            sum += exp(v - maxZ);
+        double logSumExp = maxZ + log(sum);
+        for (size_t i = 0; i < V; i++)
+        {
+            expectedLoss -= labels[t * V + i] * (z[i] - logSumExp);
+            double dz = exp(z[i] - logSumExp) - labels[t * V + i];
+            for (size_t k = 0; k < H; k++)
+            {
+                expectedWeightsGradient[k * V + i] += dz * hidden[t * H + k];
+                expectedHiddenGradient[t * H + k] += dz * weights[k * V + i];
+            }
+        }
+    }
+
+    // block sizes that do and do not divide the vocabulary, and one that covers all of it
+    for (size_t blockSize : { 1, 3, 11, 4096 })
+    {
+        auto layout = make_shared<MBLayout>();
+        layout->InitAsFrameMode(T);
+        auto labelsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, T, labels, layout);
+        auto weightsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, H, weights, nullptr);
+        auto hiddenIn = make_shared<ValueNodeTest<double>>(c_deviceId, H, T, hidden, layout);
+
+        auto criterion = make_shared<ChunkedCrossEntropyWithSoftmaxNodeTest<double>>(blockSize);
+        criterion->AttachInputs(vector<ComputationNodeBasePtr>{ labelsIn, weightsIn, hiddenIn });
+        criterion->Validate(true);
+        criterion->AllocMatrices();
+
+        criterion->ForwardPropNonLooping();
+        BOOST_CHECK_CLOSE(criterion->Value().Get00Element(), expectedLoss, 1e-9);
+
+        criterion->BackpropToNonLooping(1);
+        criterion->BackpropToNonLooping(2); // (already computed together with input 1)
+        BOOST_CHECK(AreEqual(weightsIn->GetGradient().Data(), expectedWeightsGradient.data(), V * H, 1e-10f));
+        BOOST_CHECK(AreEqual(hiddenIn->GetGradient().Data(), expectedHiddenGradient.data(), H * T, 1e-10f));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
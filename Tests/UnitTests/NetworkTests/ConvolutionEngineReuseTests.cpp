@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/ConvolutionalNodes.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+// Extends the pooling node to expose its convolution engine.
+template <class ElemType>
+class PoolingNodeTest : public PoolingNode<ElemType>
+{
+public:
+    PoolingNodeTest()
+        : PoolingNode<ElemType>(c_deviceId, L"PoolingNodeTest", PoolKind::Max, TensorShape(2, 2, 1), TensorShape(2, 2, 1),
+                                vector<bool>{ false }, TensorShape(0), TensorShape(0), false, false, ImageLayoutKind::CHW)
+    {
+    }
+
+    const ConvolutionEngine<ElemType>* GetConvolutionEngine() const
+    {
+        return this->m_convEng.get();
+    }
+
+    const TensorShape& GetSampleLayoutForTest() const
+    {
+        return this->GetSampleLayout();
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(ConvolutionEngineReuseTestSuite)
+
+BOOST_AUTO_TEST_CASE(PoolingReusesEngineOfRecentGeometry)
+{
+    vector<float> smallImage(8 * 8), largeImage(12 * 12);
+    auto input = make_shared<DummyNodeTest<float>>(c_deviceId, 1, SmallVector<size_t>{ 8, 8, 1 }, smallImage);
+    auto pooling = make_shared<PoolingNodeTest<float>>();
+    pooling->AttachInputs(vector<ComputationNodeBasePtr>{ input });
+
+    pooling->Validate(true);
+    auto smallEngine = pooling->GetConvolutionEngine();
+    BOOST_REQUIRE(smallEngine != nullptr);
+
+    input->SetMinibatch(1, SmallVector<size_t>{ 12, 12, 1 }, largeImage);
+    pooling->Validate(true);
+    auto largeEngine = pooling->GetConvolutionEngine();
+    BOOST_CHECK(largeEngine != smallEngine);
+    BOOST_CHECK(pooling->GetSampleLayoutForTest() == TensorShape(6, 6, 1));
+
+    // switching back to a previous size picks up the engine created for it
+    input->SetMinibatch(1, SmallVector<size_t>{ 8, 8, 1 }, smallImage);
+    pooling->Validate(true);
+    BOOST_CHECK(pooling->GetConvolutionEngine() == smallEngine);
+    BOOST_CHECK(pooling->GetSampleLayoutForTest() == TensorShape(4, 4, 1));
+
+    input->SetMinibatch(1, SmallVector<size_t>{ 12, 12, 1 }, largeImage);
+    pooling->Validate(true);
+    BOOST_CHECK(pooling->GetConvolutionEngine() == largeEngine);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -4,6 +4,7 @@
 //
 #include "stdafx.h"
 #include "EvaluationNodes.h"
+#include <random>
 
 using namespace Microsoft::MSR::CNTK;
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
@@ -44,6 +45,45 @@ BOOST_AUTO_TEST_CASE(ComputeEditDistanceErrorTest)
     assert((int)ed == 1);
 }
 
+BOOST_AUTO_TEST_CASE(BitParallelEditDistanceMatchesDP)
+{
+    // lengths beyond 64 and 128 exercise the carries between the bit-vector blocks
+    mt19937 rng(5);
+    for (size_t test = 0; test < 200; test++)
+    {
+        size_t firstSize = rng() % 200, secondSize = rng() % 200, numLabels = 1 + rng() % 5;
+        vector<int> first(firstSize), second(secondSize);
+        for (auto& label : first)
+            label = (int)(rng() % numLabels);
+        for (auto& label : second)
+            label = (int)(rng() % numLabels);
+        BOOST_CHECK_EQUAL(EditDistanceErrorNode<float>::LevenshteinDistance(first, second), EditDistanceErrorNode<float>::WeightedEditDistance(first, second, 1, 1, 1));
+    }
+    BOOST_CHECK_EQUAL(EditDistanceErrorNode<float>::LevenshteinDistance(vector<int>{}, vector<int>{ 1, 2, 3 }), 3);
+    BOOST_CHECK_EQUAL(EditDistanceErrorNode<float>::LevenshteinDistance(vector<int>{ 1, 2, 3, 4 }, vector<int>{ 2, 3, 5 }), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ComputeEditDistanceErrorMultipleSequences)
+{
+    // two sequences of 4 frames each: "abcd" vs "abxd" (1 substitution) and "aabb" vs "bbbb" (2 substitutions)
+    const size_t numFrames = 4;
+    MBLayoutPtr pMBLayout = make_shared<MBLayout>(2, numFrames, L"X");
+    pMBLayout->AddSequence(0, 0, 0, numFrames);
+    pMBLayout->AddSequence(1, 1, 0, numFrames);
+    float first[]  = { 0, 0,  1, 0,  2, 1,  3, 1 }; // (columns are interleaved by time step)
+    float second[] = { 0, 1,  1, 1,  9, 1,  3, 1 };
+    Matrix<float> firstSeq(1, 2 * numFrames, first, CPUDEVICE);
+    Matrix<float> secondSeq(1, 2 * numFrames, second, CPUDEVICE);
+    unique_ptr<EditDistanceErrorNode<float>> pEDNode(new EditDistanceErrorNode<float>(-1, L"ednode"));
+
+    float ed = pEDNode->ComputeEditDistanceError(firstSeq, secondSeq, pMBLayout, 1, 1, 1, false, vector<size_t>());
+    BOOST_CHECK_CLOSE(ed, 3.0f, 1e-4);
+
+    // a substitution that is more expensive than a deletion plus an insertion is replaced by those
+    ed = pEDNode->ComputeEditDistanceError(firstSeq, secondSeq, pMBLayout, 3, 1, 1, false, vector<size_t>());
+    BOOST_CHECK_CLOSE(ed, 6.0f, 1e-4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
\ No newline at end of file
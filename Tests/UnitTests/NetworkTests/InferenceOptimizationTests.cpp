@@ -0,0 +1,214 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/ComputationNetworkLib/LinearAlgebraNodes.h"
+#include "../../../Source/ComputationNetworkLib/NonlinearityNodes.h"
+#include "../../../Source/ComputationNetworkLib/TrainingNodes.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+static vector<float> RandomValues(size_t n, mt19937& rng, float lo, float hi)
+{
+    uniform_real_distribution<float> dist(lo, hi);
+    vector<float> values(n);
+    for (auto& v : values)
+        v = dist(rng);
+    return values;
+}
+
+static vector<float> ValuesOf(const ComputationNodeBasePtr& node)
+{
+    auto& value = dynamic_pointer_cast<ComputationNode<float>>(node)->Value();
+    vector<float> result(value.GetNumElements());
+    for (size_t j = 0; j < value.GetNumCols(); j++)
+        for (size_t i = 0; i < value.GetNumRows(); i++)
+            result[i + j * value.GetNumRows()] = value(i, j);
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(InferenceOptimizationTestSuite)
+
+// out = Sigmoid (Dropout (BN (W x + b))) + Sigmoid (Dropout (BN (W x + b))) + A * B
+BOOST_AUTO_TEST_CASE(OptimizeForInferenceFoldsAndPrunes)
+{
+    const size_t inDim = 3, outDim = 4, innerDim = 2;
+    mt19937 rng(13);
+    auto w      = RandomValues(outDim * inDim, rng, -1, 1);
+    auto b      = RandomValues(outDim, rng, -1, 1);
+    auto scale  = RandomValues(outDim, rng, 0.5f, 2);
+    auto beta   = RandomValues(outDim, rng, -1, 1);
+    auto mean   = RandomValues(outDim, rng, -1, 1);
+    auto var    = RandomValues(outDim, rng, 0.1f, 2);
+    auto a      = RandomValues(outDim * innerDim, rng, -1, 1);
+    auto bInner = RandomValues(innerDim, rng, -1, 1);
+
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto setValues = [](const ComputationNodeBasePtr& node, size_t rows, size_t cols, vector<float>& values)
+    {
+        dynamic_pointer_cast<ComputationNode<float>>(node)->Value().SetValue(rows, cols, c_deviceId, values.data());
+    };
+    auto x = builder.CreateInputNode(L"x", inDim);
+    auto wNode = builder.CreateLearnableParameter(L"W", outDim, inDim);
+    auto bNode = builder.CreateLearnableParameter(L"b", TensorShape(outDim));
+    auto scaleNode = builder.CreateLearnableParameter(L"scale", TensorShape(outDim));
+    auto betaNode = builder.CreateLearnableParameter(L"beta", TensorShape(outDim));
+    auto meanNode = builder.CreateLearnableParameter(L"mean", TensorShape(outDim));
+    auto varNode = builder.CreateLearnableParameter(L"var", TensorShape(outDim));
+    auto countNode = builder.CreateLearnableParameter(L"count", TensorShape(1));
+    auto aNode = builder.CreateLearnableParameter(L"A", outDim, innerDim);
+    auto bInnerNode = builder.CreateLearnableParameter(L"B", TensorShape(innerDim));
+    setValues(wNode, outDim, inDim, w);
+    setValues(bNode, outDim, 1, b);
+    setValues(scaleNode, outDim, 1, scale);
+    setValues(betaNode, outDim, 1, beta);
+    setValues(meanNode, outDim, 1, mean);
+    setValues(varNode, outDim, 1, var);
+    setValues(aNode, outDim, innerDim, a);
+    setValues(bInnerNode, innerDim, 1, bInner);
+    dynamic_pointer_cast<ComputationNode<float>>(countNode)->Value().SetValue(100);
+
+    auto z = builder.Plus(builder.Times(wNode, x, 1, L"Wx"), bNode, L"z");
+    auto bn = builder.BatchNormalization(z, scaleNode, betaNode, meanNode, varNode, countNode, /*spatial=*/false, 0, 0, /*epsilon=*/1e-5, true, false, ImageLayoutKind::CHW, L"bn");
+    auto dropout = builder.Dropout(bn, L"drop");
+    auto s1 = builder.Sigmoid(dropout, L"s1");
+    auto s2 = builder.Sigmoid(dropout, L"s2");
+    auto ab = builder.Times(aNode, bInnerNode, 1, L"AB");
+    auto out = builder.Plus(builder.Plus(s1, s2, L"sum"), ab, L"out");
+    builder.Tanh(x, L"unused");
+    net->AddToNodeGroup(L"output", out);
+    net->CompileNetwork();
+
+    net->OptimizeForInference(vector<ComputationNodeBasePtr>{ net->GetNodeFromName(L"out") });
+
+    // pass-through, duplicate, and dead nodes are gone
+    BOOST_CHECK(!net->NodeNameExists(L"drop"));
+    BOOST_CHECK(!net->NodeNameExists(L"unused"));
+    BOOST_CHECK(net->NodeNameExists(L"s1") != net->NodeNameExists(L"s2"));
+    auto sum = net->GetNodeFromName(L"sum");
+    BOOST_CHECK(sum->Input(0) == sum->Input(1));
+
+    // batch normalization has become a bias
+    auto folded = net->GetNodeFromName(L"bn");
+    BOOST_CHECK(folded->OperationName() == OperationNameOf(PlusNode));
+    BOOST_CHECK(folded->Input(0) == net->GetNodeFromName(L"Wx"));
+    BOOST_CHECK(!net->NodeNameExists(L"z"));
+    BOOST_CHECK(!net->NodeNameExists(L"scale"));
+    BOOST_CHECK(sum->Input(0)->Input(0) == folded);
+    auto newW = ValuesOf(net->GetNodeFromName(L"W"));
+    auto newB = ValuesOf(folded->Input(1));
+    BOOST_REQUIRE_EQUAL(newB.size(), outDim);
+    for (size_t i = 0; i < outDim; i++)
+    {
+        double s = scale[i] / sqrt(var[i] + 1e-5);
+        for (size_t j = 0; j < inDim; j++)
+            BOOST_CHECK_SMALL(newW[i + j * outDim] - w[i + j * outDim] * s, 1e-5);
+        BOOST_CHECK_SMALL(newB[i] - ((b[i] - mean[i]) * s + beta[i]), 1e-5);
+    }
+
+    // A * B has been precomputed
+    auto abConstant = net->GetNodeFromName(L"AB");
+    BOOST_CHECK(abConstant->OperationName() == OperationNameOf(LearnableParameter));
+    BOOST_CHECK_EQUAL(abConstant->GetLearningRateMultiplier(), 0);
+    BOOST_CHECK(!net->NodeNameExists(L"A"));
+    auto abValues = ValuesOf(abConstant);
+    BOOST_REQUIRE_EQUAL(abValues.size(), outDim);
+    for (size_t i = 0; i < outDim; i++)
+    {
+        double expected = 0;
+        for (size_t k = 0; k < innerDim; k++)
+            expected += a[i + k * outDim] * bInner[k];
+        BOOST_CHECK_SMALL(abValues[i] - expected, 1e-5);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(OptimizeForInferenceKeepsSharedWeights)
+{
+    // W is also used elsewhere, so scaling it in place would change the other use
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto x = builder.CreateInputNode(L"x", 3);
+    auto wNode = builder.CreateLearnableParameter(L"W", 4, 3);
+    vector<shared_ptr<ComputationNode<float>>> params;
+    for (const auto& name : { L"scale", L"beta", L"mean", L"var" })
+        params.push_back(builder.CreateLearnableParameter(name, TensorShape(4)));
+    auto countNode = builder.CreateLearnableParameter(L"count", TensorShape(1));
+    auto bn = builder.BatchNormalization(builder.Times(wNode, x, 1, L"Wx"), params[0], params[1], params[2], params[3], countNode, false, 0, 0, 1e-5, true, false, ImageLayoutKind::CHW, L"bn");
+    auto other = builder.Times(wNode, x, 1, L"other");
+    net->AddToNodeGroup(L"output", bn);
+    net->AddToNodeGroup(L"output", other);
+    net->CompileNetwork();
+
+    net->OptimizeForInference(vector<ComputationNodeBasePtr>());
+    BOOST_CHECK(net->GetNodeFromName(L"bn")->OperationName() == OperationNameOf(BatchNormalizationNode));
+    BOOST_CHECK(net->NodeNameExists(L"other"));
+}
+
+// out = Tanh (Sigmoid (W x)) + b: for inference, the elementwise operations compute their values in place of their inputs
+BOOST_AUTO_TEST_CASE(InferenceMemoryPlanComputesElementwiseInPlace)
+{
+    const size_t inDim = 3, outDim = 4, minibatchSize = 5;
+    mt19937 rng(17);
+    auto w = RandomValues(outDim * inDim, rng, -1, 1);
+    auto b = RandomValues(outDim, rng, -1, 1);
+    auto xValues = RandomValues(inDim * minibatchSize, rng, -1, 1);
+
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto x = builder.CreateInputNode(L"x", inDim);
+    auto wNode = builder.CreateLearnableParameter(L"W", outDim, inDim);
+    auto bNode = builder.CreateLearnableParameter(L"b", TensorShape(outDim));
+    wNode->Value().SetValue(outDim, inDim, c_deviceId, w.data());
+    bNode->Value().SetValue(outDim, 1, c_deviceId, b.data());
+    auto z = builder.Times(wNode, x, 1, L"z");
+    auto s = builder.Sigmoid(z, L"s");
+    auto t = builder.Tanh(s, L"t");
+    auto out = builder.Plus(t, bNode, L"out");
+    net->AddToNodeGroup(L"output", out);
+    net->CompileNetwork();
+    net->AllocateAllMatrices(vector<ComputationNodeBasePtr>(), vector<ComputationNodeBasePtr>{ out }, nullptr);
+
+    // each value dies when the next one is computed, so all of them live in one buffer
+    BOOST_CHECK(s->ValuePtr() == z->ValuePtr());
+    BOOST_CHECK(t->ValuePtr() == z->ValuePtr());
+    BOOST_CHECK(out->ValuePtr() != z->ValuePtr());
+
+    net->GetMBLayoutPtrOfNetwork()->InitAsFrameMode(minibatchSize);
+    x->Value().SetValue(inDim, minibatchSize, c_deviceId, xValues.data());
+    ComputationNodeBasePtr root = out;
+    net->StartEvaluateMinibatchLoop(root);
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ x });
+    net->ForwardProp(root);
+
+    auto outValues = ValuesOf(out);
+    BOOST_REQUIRE_EQUAL(outValues.size(), outDim * minibatchSize);
+    for (size_t j = 0; j < minibatchSize; j++)
+    {
+        for (size_t i = 0; i < outDim; i++)
+        {
+            double zij = 0;
+            for (size_t k = 0; k < inDim; k++)
+                zij += w[i + k * outDim] * xValues[k + j * inDim];
+            double expected = tanh(1 / (1 + exp(-zij))) + b[i];
+            BOOST_CHECK_SMALL(outValues[i + j * outDim] - expected, 1e-5);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
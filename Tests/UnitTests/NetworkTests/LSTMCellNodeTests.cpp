@@ -0,0 +1,280 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/RNNNodes.h"
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/ComputationNetworkLib/LinearAlgebraNodes.h"
+#include "../../../Source/ComputationNetworkLib/ReshapingNodes.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// The CPU implementation is a hand-written loop; this is what we test here.
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+// Extends LSTMCell node to allocate the matrices that are normally taken from the matrix pool.
+template <class ElemType>
+class LSTMCellNodeTest : public LSTMCellNode<ElemType>
+{
+public:
+    LSTMCellNodeTest() : LSTMCellNode<ElemType>(c_deviceId, L"LSTMCellNodeTest") {}
+
+    void AllocMatrices()
+    {
+        size_t numCols = this->GetMBLayout()->GetNumCols();
+        this->CreateValueMatrixIfNull();
+        this->CreateGradientMatrixIfNull();
+        this->Value().Resize(this->GetSampleLayout().GetNumElements(), numCols);
+        this->Gradient().Resize(this->GetSampleLayout().GetNumElements(), numCols);
+        this->m_gates = make_shared<Matrix<ElemType>>(c_deviceId);
+        this->m_temp = make_shared<Matrix<ElemType>>(c_deviceId);
+        this->UpdateFunctionMBSize();
+    }
+    Matrix<ElemType>& GetGradient() { return this->Gradient(); }
+};
+
+// reference implementation of one LSTM step for a single sample, output is [h; c]
+static vector<double> LSTMCellReference(const double* p, const double* prevCell, size_t d)
+{
+    auto sigmoid = [](double x) { return 1 / (1 + exp(-x)); };
+    vector<double> result(2 * d);
+    for (size_t k = 0; k < d; k++)
+    {
+        double c = sigmoid(p[2 * d + k]) * prevCell[k] + sigmoid(p[k]) * tanh(p[d + k]);
+        result[k] = sigmoid(p[3 * d + k]) * tanh(c);
+        result[d + k] = c;
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(LSTMCellNodeTestSuite)
+
+BOOST_AUTO_TEST_CASE(LSTMCellForwardBackward)
+{
+    const size_t d = 3;
+    const size_t c_minibatchSize = 4;
+    mt19937 rng(7);
+    uniform_real_distribution<double> dist(-2, 2);
+    vector<double> gatesData(4 * d * c_minibatchSize), cellData(d * c_minibatchSize), outputGradData(2 * d * c_minibatchSize);
+    for (auto& v : gatesData) v = dist(rng);
+    for (auto& v : cellData) v = dist(rng);
+    for (auto& v : outputGradData) v = dist(rng);
+
+    auto gatesIn = make_shared<DummyNodeTest<double>>(c_deviceId, c_minibatchSize, SmallVector<size_t>{ 4 * d }, gatesData);
+    auto cellIn = make_shared<DummyNodeTest<double>>(c_deviceId, c_minibatchSize, SmallVector<size_t>{ d }, cellData);
+    // (DummyNodeTest stores the data as [minibatch x dim])
+    gatesIn->Value().SetValue(4 * d, c_minibatchSize, c_deviceId, gatesData.data());
+    cellIn->Value().SetValue(d, c_minibatchSize, c_deviceId, cellData.data());
+    static_pointer_cast<ComputationNodeBase>(cellIn)->LinkToMBLayout(static_pointer_cast<ComputationNodeBase>(gatesIn)->GetMBLayout());
+
+    auto cell = make_shared<LSTMCellNodeTest<double>>();
+    cell->AttachInputs(vector<ComputationNodeBasePtr>{ gatesIn, cellIn });
+    cell->Validate(true);
+    BOOST_REQUIRE_EQUAL(static_pointer_cast<ComputationNodeBase>(cell)->GetSampleLayout().GetNumElements(), 2 * d);
+    cell->AllocMatrices();
+
+    FrameRange fr;
+    cell->ForwardProp(fr);
+    for (size_t j = 0; j < c_minibatchSize; j++)
+    {
+        auto expected = LSTMCellReference(gatesData.data() + j * 4 * d, cellData.data() + j * d, d);
+        BOOST_CHECK(AreEqual(cell->Value().Data() + j * 2 * d, expected.data(), 2 * d, 1e-12f));
+    }
+
+    // gradients, compared against finite differences of the loss sum(outputGrad .* output)
+    cell->GetGradient().SetValue(2 * d, c_minibatchSize, c_deviceId, outputGradData.data());
+    gatesIn->GetGradient().SetValue(0);
+    cellIn->GetGradient().SetValue(0);
+    cell->BackpropTo(0, fr);
+    cell->BackpropTo(1, fr);
+
+    auto loss = [&](size_t j)
+    {
+        auto output = LSTMCellReference(gatesData.data() + j * 4 * d, cellData.data() + j * d, d);
+        double sum = 0;
+        for (size_t k = 0; k < 2 * d; k++)
+            sum += outputGradData[j * 2 * d + k] * output[k];
+        return sum;
+    };
+    const double eps = 1e-6;
+    auto numericalGradient = [&](vector<double>& data, size_t index, size_t j)
+    {
+        double orig = data[index];
+        data[index] = orig + eps;
+        double plus = loss(j);
+        data[index] = orig - eps;
+        double minus = loss(j);
+        data[index] = orig;
+        return (plus - minus) / (2 * eps);
+    };
+    for (size_t j = 0; j < c_minibatchSize; j++)
+    {
+        for (size_t k = 0; k < 4 * d; k++)
+            BOOST_CHECK_SMALL(gatesIn->GetGradient()(k, j) - numericalGradient(gatesData, j * 4 * d + k, j), 1e-7);
+        for (size_t k = 0; k < d; k++)
+            BOOST_CHECK_SMALL(cellIn->GetGradient()(k, j) - numericalGradient(cellData, j * d + k, j), 1e-7);
+    }
+}
+
+// builds the LSTM step the way the Python layers library does, with 'p' standing in for b + W x + H h(t-1)
+static ComputationNetworkPtr CreateLSTMStepNetwork(size_t d, bool exposeInputGate)
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto p = builder.CreateInputNode(L"p", 4 * d);
+    auto dc = builder.PastValue(p, 0.0f, d, 1, L"dc"); // (input is set below, when ct exists)
+    auto it = builder.Sigmoid(builder.RowSlice(p, 0, d, L"pi"), L"it");
+    auto bit = builder.ElementTimes(it, builder.Tanh(builder.RowSlice(p, d, d, L"pg"), L"gt"), L"bit");
+    auto ft = builder.Sigmoid(builder.RowSlice(p, 2 * d, d, L"pf"), L"ft");
+    auto bft = builder.ElementTimes(ft, dc, L"bft");
+    auto ct = builder.Plus(bft, bit, L"ct");
+    auto ot = builder.Sigmoid(builder.RowSlice(p, 3 * d, d, L"po"), L"ot");
+    auto ht = builder.ElementTimes(ot, builder.Tanh(ct, L"tanhCt"), L"ht");
+    static_pointer_cast<ComputationNodeBase>(dc)->SetInput(0, ct);
+    net->AddToNodeGroup(L"output", ht);
+    if (exposeInputGate)
+        net->AddToNodeGroup(L"output", it);
+    return net;
+}
+
+BOOST_AUTO_TEST_CASE(FuseRecurrentCellsReplacesLSTMPattern)
+{
+    const size_t d = 5;
+    auto net = CreateLSTMStepNetwork(d, /*exposeInputGate=*/false);
+    net->SetFuseRecurrentCells(true);
+    net->CompileNetwork();
+
+    // ht and ct survive by name, as slices of the fused cell; the internal nodes are gone
+    auto ht = net->GetNodeFromName(L"ht");
+    auto ct = net->GetNodeFromName(L"ct");
+    BOOST_CHECK(ht->OperationName() == OperationNameOf(SliceNode));
+    BOOST_CHECK(ct->OperationName() == OperationNameOf(SliceNode));
+    BOOST_CHECK(ht->GetInputs()[0] == ct->GetInputs()[0]);
+    BOOST_CHECK(ht->GetInputs()[0]->OperationName() == OperationNameOf(LSTMCellNode));
+    BOOST_CHECK(net->GetNodeFromName(L"dc")->GetInputs()[0] == ct);
+    BOOST_CHECK(net->OutputNodes().size() == 1 && net->OutputNodes()[0] == ht);
+    for (const auto& name : { L"pi", L"pg", L"pf", L"po", L"it", L"gt", L"ft", L"ot", L"bit", L"bft", L"tanhCt" })
+        BOOST_CHECK(!net->NodeNameExists(name));
+    BOOST_CHECK_EQUAL(ht->GetSampleLayout().GetNumElements(), d);
+}
+
+BOOST_AUTO_TEST_CASE(FuseRecurrentCellsKeepsVisibleIntermediates)
+{
+    // the input gate is an output of the network, so the cell must not be fused
+    auto net = CreateLSTMStepNetwork(5, /*exposeInputGate=*/true);
+    net->SetFuseRecurrentCells(true);
+    net->CompileNetwork();
+    BOOST_CHECK(net->GetNodeFromName(L"ht")->OperationName() == OperationNameOf(ElementTimesNode));
+    BOOST_CHECK(net->NodeNameExists(L"it"));
+}
+
+// an LSTM over sequences with p = W x + H h(t-1) + b and the loss SquareError (y, h), with or without cell fusion
+static ComputationNetworkPtr CreateLSTMNetwork(size_t inputDim, size_t d, size_t numSequences, size_t numTimeSteps, bool fuse)
+{
+    mt19937 rng(11);
+    uniform_real_distribution<double> dist(-1, 1);
+    auto setRandomValues = [&](const shared_ptr<ComputationNode<double>>& node, size_t rows, size_t cols)
+    {
+        vector<double> values(rows * cols);
+        for (auto& v : values)
+            v = dist(rng);
+        node->Value().SetValue(rows, cols, c_deviceId, values.data());
+    };
+
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<double> builder(*net);
+    auto x = builder.CreateInputNode(L"x", inputDim);
+    auto y = builder.CreateInputNode(L"y", d);
+    auto w = builder.CreateLearnableParameter(L"W", 4 * d, inputDim);
+    auto h = builder.CreateLearnableParameter(L"H", 4 * d, d);
+    auto b = builder.CreateLearnableParameter(L"b", TensorShape(4 * d));
+    setRandomValues(w, 4 * d, inputDim);
+    setRandomValues(h, 4 * d, d);
+    setRandomValues(b, 4 * d, 1);
+    auto dh = builder.PastValue(x, 0.0f, d, 1, L"dh"); // (inputs are set below, when ht and ct exist)
+    auto dc = builder.PastValue(x, 0.0f, d, 1, L"dc");
+    auto p = builder.Plus(builder.Plus(builder.Times(w, x, 1, L"Wx"), builder.Times(h, dh, 1, L"Hh"), L"WxHh"), b, L"p");
+    auto it = builder.Sigmoid(builder.RowSlice(p, 0, d, L"pi"), L"it");
+    auto bit = builder.ElementTimes(it, builder.Tanh(builder.RowSlice(p, d, d, L"pg"), L"gt"), L"bit");
+    auto ft = builder.Sigmoid(builder.RowSlice(p, 2 * d, d, L"pf"), L"ft");
+    auto bft = builder.ElementTimes(ft, dc, L"bft");
+    auto ct = builder.Plus(bft, bit, L"ct");
+    auto ot = builder.Sigmoid(builder.RowSlice(p, 3 * d, d, L"po"), L"ot");
+    auto ht = builder.ElementTimes(ot, builder.Tanh(ct, L"tanhCt"), L"ht");
+    static_pointer_cast<ComputationNodeBase>(dh)->SetInput(0, ht);
+    static_pointer_cast<ComputationNodeBase>(dc)->SetInput(0, ct);
+    auto loss = builder.SquareError(y, ht, L"loss");
+    net->AddToNodeGroup(L"criterion", loss);
+    net->AddToNodeGroup(L"output", ht);
+    net->SetFuseRecurrentCells(fuse);
+    net->CompileNetwork();
+
+    net->AllocateAllMatrices(vector<ComputationNodeBasePtr>(), net->OutputNodes(), loss);
+    auto layout = net->GetMBLayoutPtrOfNetwork();
+    layout->Init(numSequences, numTimeSteps);
+    for (size_t s = 0; s < numSequences; s++)
+        layout->AddSequence(s, s, 0, numTimeSteps);
+    setRandomValues(x, inputDim, numSequences * numTimeSteps);
+    setRandomValues(y, d, numSequences * numTimeSteps);
+    return net;
+}
+
+// returns the output h followed by the gradients of W, H and b, after forward prop and backprop of one minibatch
+static vector<vector<double>> ComputeLSTMOutputAndGradients(const ComputationNetworkPtr& net)
+{
+    auto loss = net->GetNodeFromName(L"loss");
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->StartEvaluateMinibatchLoop(loss);
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ net->GetNodeFromName(L"x"), net->GetNodeFromName(L"y") });
+    net->ForwardProp(loss);
+    net->Backprop(loss);
+
+    auto toVector = [](const Matrix<double>& m)
+    {
+        vector<double> result;
+        for (size_t j = 0; j < m.GetNumCols(); j++)
+            for (size_t i = 0; i < m.GetNumRows(); i++)
+                result.push_back(m(i, j));
+        return result;
+    };
+    vector<vector<double>> results;
+    results.push_back(toVector(dynamic_pointer_cast<ComputationNode<double>>(net->GetNodeFromName(L"ht"))->Value()));
+    for (const auto& name : { L"W", L"H", L"b" })
+        results.push_back(toVector(dynamic_pointer_cast<ComputationNode<double>>(net->GetNodeFromName(name))->Gradient()));
+    return results;
+}
+
+BOOST_AUTO_TEST_CASE(FusedLSTMMatchesUnfusedLSTM)
+{
+    const size_t inputDim = 3, d = 4, numSequences = 2, numTimeSteps = 5;
+    auto unfused = CreateLSTMNetwork(inputDim, d, numSequences, numTimeSteps, /*fuse=*/false);
+    auto fused = CreateLSTMNetwork(inputDim, d, numSequences, numTimeSteps, /*fuse=*/true);
+    BOOST_REQUIRE(unfused->GetNodeFromName(L"ht")->OperationName() == OperationNameOf(ElementTimesNode));
+    BOOST_REQUIRE(fused->GetNodeFromName(L"ht")->OperationName() == OperationNameOf(SliceNode));
+
+    auto expected = ComputeLSTMOutputAndGradients(unfused);
+    auto actual = ComputeLSTMOutputAndGradients(fused);
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK_EQUAL(expected[0].size(), d * numSequences * numTimeSteps);
+    for (size_t k = 0; k < expected.size(); k++)
+    {
+        BOOST_REQUIRE_EQUAL(actual[k].size(), expected[k].size());
+        for (size_t i = 0; i < expected[k].size(); i++)
+            BOOST_CHECK_SMALL(actual[k][i] - expected[k][i], 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
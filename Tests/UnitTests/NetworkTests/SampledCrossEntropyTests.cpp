@@ -0,0 +1,176 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/TrainingNodes.h"
+#include "TestHelpers.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+// Extends the node to allocate the matrices that are normally taken from the matrix pool.
+template <class ElemType>
+class SampledCrossEntropyWithSoftmaxNodeTest : public SampledCrossEntropyWithSoftmaxNode<ElemType>
+{
+public:
+    SampledCrossEntropyWithSoftmaxNodeTest(size_t numSamples, double alpha)
+        : SampledCrossEntropyWithSoftmaxNode<ElemType>(c_deviceId, L"SampledCrossEntropyWithSoftmaxNodeTest", numSamples, alpha)
+    {
+        this->SetRngState(17);
+    }
+
+    void AllocMatrices()
+    {
+        this->CreateValueMatrixIfNull();
+        this->CreateGradientMatrixIfNull();
+        this->Value().Resize(1, 1);
+        this->Gradient().Resize(1, 1);
+        this->Gradient().SetValue(1);
+        for (auto matrix : { &this->m_classStatistics, &this->m_sampleStatistics, &this->m_labelStatistics, &this->m_sampledWeights,
+                             &this->m_labelWeights, &this->m_sampledLogits, &this->m_trueLogits, &this->m_logSumExp })
+            *matrix = make_shared<Matrix<ElemType>>(c_deviceId);
+        this->m_sampleSelection = make_shared<Matrix<ElemType>>(0, 0, c_deviceId, SPARSE, matrixFormatSparseCSC);
+        this->UpdateFunctionMBSize();
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(SampledCrossEntropyWithSoftmaxTestSuite)
+
+BOOST_AUTO_TEST_CASE(SampledCrossEntropyMatchesReference)
+{
+    const size_t V = 13, H = 4, T = 6, S = 7;
+    const double alpha = 0.75;
+    mt19937 rng(5);
+    uniform_real_distribution<double> dist(-2, 2);
+    uniform_real_distribution<double> countDist(0.5, 5);
+    vector<double> weights(H * V), hidden(H * T), labels(V * T, 0), samplingWeights(V);
+    for (auto& v : weights) v = dist(rng);
+    for (auto& v : hidden) v = dist(rng);
+    for (auto& v : samplingWeights) v = countDist(rng);
+    vector<size_t> trueClasses(T);
+    for (size_t t = 0; t < T; t++)
+    {
+        trueClasses[t] = (t * 5) % V;
+        labels[t * V + trueClasses[t]] = 1;
+    }
+
+    auto layout = make_shared<MBLayout>();
+    layout->InitAsFrameMode(T);
+    auto labelsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, T, labels, layout, false);
+    labelsIn->Value().SwitchToMatrixType(SPARSE, matrixFormatSparseCSC, true);
+    auto hiddenIn = make_shared<ValueNodeTest<double>>(c_deviceId, H, T, hidden, layout);
+    auto weightsIn = make_shared<ValueNodeTest<double>>(c_deviceId, H, V, weights, nullptr);
+    auto samplingWeightsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, 1, samplingWeights, nullptr, false);
+
+    auto criterion = make_shared<SampledCrossEntropyWithSoftmaxNodeTest<double>>(S, alpha);
+    criterion->AttachInputs(vector<ComputationNodeBasePtr>{ labelsIn, hiddenIn, weightsIn, samplingWeightsIn });
+    criterion->Validate(true);
+    criterion->AllocMatrices();
+
+    criterion->ForwardPropNonLooping();
+    const auto& samples = criterion->GetSamples();
+    BOOST_REQUIRE_EQUAL(samples.size(), S);
+
+    // reference: logits corrected by log(S Q), the true class and the non-coinciding samples in the softmax
+    double sum = 0;
+    for (auto w : samplingWeights)
+        sum += pow(w, alpha);
+    auto logit = [&](size_t i, size_t t)
+    {
+        double z = -log(S * pow(samplingWeights[i], alpha) / sum);
+        for (size_t k = 0; k < H; k++)
+            z += weights[i * H + k] * hidden[t * H + k];
+        return z;
+    };
+    double expectedLoss = 0;
+    vector<double> expectedWeightsGradient(H * V, 0), expectedHiddenGradient(H * T, 0);
+    for (size_t t = 0; t < T; t++)
+    {
+        vector<pair<size_t, double>> candidates = { { trueClasses[t], 1.0 } }; // (class, label)
+        for (auto s : samples)
+        {
+            if (s != trueClasses[t])
+                candidates.push_back({ s, 0.0 });
+        }
+        double maxZ = -1e300, total = 0;
+        for (const auto& c : candidates)
+            maxZ = max(maxZ, logit(c.first, t));
+        for (const auto& c : candidates)
+            total += exp(logit(c.first, t) - maxZ);
+        double logSumExp = maxZ + log(total);
+        expectedLoss += logSumExp - logit(trueClasses[t], t);
+        for (const auto& c : candidates)
+        {
+            double dz = exp(logit(c.first, t) - logSumExp) - c.second;
+            for (size_t k = 0; k < H; k++)
+            {
+                expectedWeightsGradient[c.first * H + k] += dz * hidden[t * H + k];
+                expectedHiddenGradient[t * H + k] += dz * weights[c.first * H + k];
+            }
+        }
+    }
+    BOOST_CHECK_CLOSE(criterion->Value().Get00Element(), expectedLoss, 1e-9);
+
+    criterion->BackpropToNonLooping(1);
+    criterion->BackpropToNonLooping(2); // (already computed together with input 1)
+    BOOST_CHECK(AreEqual(hiddenIn->GetGradient().Data(), expectedHiddenGradient.data(), H * T, 1e-10f));
+
+    // sparse labels give a block-sparse gradient that only holds the columns of the candidates
+    auto& weightsGradient = weightsIn->GetGradient();
+    BOOST_CHECK(weightsGradient.GetMatrixType() == SPARSE);
+    weightsGradient.SwitchToMatrixType(DENSE, matrixFormatDense, true);
+    BOOST_CHECK(AreEqual(weightsGradient.Data(), expectedWeightsGradient.data(), H * V, 1e-10f));
+}
+
+BOOST_AUTO_TEST_CASE(SampledCrossEntropyDrawsFromProposal)
+{
+    const size_t V = 6, H = 2, T = 3, S = 20000;
+    const double alpha = 0.5;
+    vector<double> samplingWeights = { 1, 2, 3, 4, 0, 6 };
+    vector<double> weights(H * V, 0.1), hidden(H * T, 0.2), labels(V * T, 0);
+    for (size_t t = 0; t < T; t++)
+        labels[t * V + t] = 1;
+
+    auto layout = make_shared<MBLayout>();
+    layout->InitAsFrameMode(T);
+    auto labelsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, T, labels, layout, false);
+    auto hiddenIn = make_shared<ValueNodeTest<double>>(c_deviceId, H, T, hidden, layout);
+    auto weightsIn = make_shared<ValueNodeTest<double>>(c_deviceId, H, V, weights, nullptr);
+    auto samplingWeightsIn = make_shared<ValueNodeTest<double>>(c_deviceId, V, 1, samplingWeights, nullptr, false);
+
+    auto criterion = make_shared<SampledCrossEntropyWithSoftmaxNodeTest<double>>(S, alpha);
+    criterion->AttachInputs(vector<ComputationNodeBasePtr>{ labelsIn, hiddenIn, weightsIn, samplingWeightsIn });
+    criterion->Validate(true);
+    criterion->AllocMatrices();
+
+    criterion->ForwardPropNonLooping();
+    auto firstSamples = criterion->GetSamples();
+    vector<size_t> counts(V, 0);
+    for (auto s : firstSamples)
+        counts[s]++;
+
+    double sum = 0;
+    for (auto w : samplingWeights)
+        sum += sqrt(w);
+    for (size_t i = 0; i < V; i++)
+        BOOST_CHECK_SMALL((double)counts[i] / S - sqrt(samplingWeights[i]) / sum, 0.015);
+    BOOST_CHECK_EQUAL(counts[4], 0);
+
+    // every minibatch gets its own negatives
+    criterion->ForwardPropNonLooping();
+    BOOST_CHECK(criterion->GetSamples() != firstSamples);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -41,4 +41,22 @@ public:
 
     void SetMinibatch(size_t minibatchSize, SmallVector<size_t> sampleDimensions, std::vector<ElemType>& data);
 };
+
+// Node holding a fixed value and a gradient, either a minibatch of samples or (without layout) a parameter.
+template <class ElemType>
+class ValueNodeTest : public DummyNodeTest<ElemType>
+{
+public:
+    ValueNodeTest(DEVICEID_TYPE deviceId, size_t numRows, size_t numCols, const std::vector<ElemType>& data, MBLayoutPtr layout, bool needsGradient = true)
+        : DummyNodeTest<ElemType>(deviceId, L"ValueNodeTest")
+    {
+        if (layout)
+            this->LinkToMBLayout(layout);
+        this->SetDims(layout ? TensorShape(numRows) : TensorShape(numRows, numCols), !!layout);
+        this->CreateValueMatrixIfNull();
+        this->CreateGradientMatrixIfNull();
+        this->Value().SetValue(numRows, numCols, deviceId, const_cast<ElemType*>(data.data()));
+        this->m_needsGradient = needsGradient;
+    }
+};
 } } } }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <numeric>
 #include <random>
 #include <set>
+#include <atomic>
 #include "NoRandomizer.h"
 #include "LTNoRandomizer.h"
 #include "DataDeserializer.h"
@@ -18,6 +19,7 @@
 #include "CudaMemoryProvider.h"
 #include "HeapMemoryProvider.h"
 #include "BufferedFileReader.h"
+#include "DataDeserializerBase.h"
 
 #pragma warning(push)
 // disable warning about possible mod 0 operation in uniform_int_distribution
@@ -792,6 +794,95 @@ BOOST_AUTO_TEST_CASE(BlockRandomizerOneEpochWithChunks2)
     BlockRandomizerOneEpochWithChunks2Test(true);
 }
 
+// Forwards to a deserializer and records the largest number of GetChunk calls that ran at the same time.
+class ConcurrentLoadsDeserializer : public DataDeserializerBase
+{
+public:
+    ConcurrentLoadsDeserializer(DataDeserializerPtr deserializer, bool threadSafe)
+        : DataDeserializerBase(true), m_deserializer(deserializer), m_threadSafe(threadSafe), m_activeLoads(0), m_maxActiveLoads(0)
+    {
+        m_streams = deserializer->StreamInfos();
+    }
+
+    std::vector<ChunkInfo> ChunkInfos() override
+    {
+        return m_deserializer->ChunkInfos();
+    }
+
+    void SequenceInfosForChunk(ChunkIdType chunkId, std::vector<SequenceInfo>& result) override
+    {
+        m_deserializer->SequenceInfosForChunk(chunkId, result);
+    }
+
+    ChunkPtr GetChunk(ChunkIdType chunkId) override
+    {
+        size_t active = ++m_activeLoads;
+        for (size_t max = m_maxActiveLoads; active > max && !m_maxActiveLoads.compare_exchange_weak(max, active);)
+            ;
+
+        // Keeps the load running long enough for the other lanes to start theirs.
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        auto chunk = m_deserializer->GetChunk(chunkId);
+        --m_activeLoads;
+        return chunk;
+    }
+
+    bool IsGetChunkThreadSafe() const override
+    {
+        return m_threadSafe;
+    }
+
+    size_t MaxActiveLoads() const
+    {
+        return m_maxActiveLoads;
+    }
+
+private:
+    DataDeserializerPtr m_deserializer;
+    bool m_threadSafe;
+    std::atomic<size_t> m_activeLoads;
+    std::atomic<size_t> m_maxActiveLoads;
+};
+
+BOOST_AUTO_TEST_CASE(BlockRandomizerMultiChunkPrefetch)
+{
+    size_t chunkSizeInSamples = 1000;
+    size_t sweepNumberOfSamples = 50000;
+    uint32_t maxSequenceLength = 30;
+    size_t randomizationWindow = chunkSizeInSamples * 5;
+    auto sequential = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+    auto deserializer = make_shared<ConcurrentLoadsDeserializer>(sequential, true);
+
+    auto expectedRandomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false);
+    auto expected = ReadFullEpoch(expectedRandomizer, sweepNumberOfSamples * 2, 0);
+
+    // The prefetch depth, parallelism and memory budget must not change the data or its order.
+    for (auto depth : { 0, 1, 4, 16 })
+    {
+        for (auto parallelLoads : { 1, 3 })
+        {
+            for (auto memoryBudget : { 0, 1, 16 * 1024 })
+            {
+                auto randomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false);
+                randomizer->SetPrefetchConfiguration(depth, parallelLoads, memoryBudget);
+                auto actual = ReadFullEpoch(randomizer, sweepNumberOfSamples * 2, 0);
+                BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), actual.begin(), actual.end());
+            }
+        }
+    }
+
+    auto randomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false);
+    BOOST_REQUIRE_THROW(randomizer->SetPrefetchConfiguration(1, 0, 0), std::invalid_argument);
+
+    // Deserializers that do not declare GetChunk thread-safe get a single load lane.
+    auto serialOnly = make_shared<ConcurrentLoadsDeserializer>(sequential, false);
+    randomizer = make_shared<BlockRandomizer>(0, randomizationWindow, serialOnly, true, false);
+    randomizer->SetPrefetchConfiguration(16, 3, 0);
+    auto actual = ReadFullEpoch(randomizer, sweepNumberOfSamples * 2, 0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), actual.begin(), actual.end());
+    BOOST_CHECK_EQUAL(serialOnly->MaxActiveLoads(), 1u);
+}
+
 void RandomizerChaosMonkeyTest(SequenceEnumerator& randomizer, size_t sweepSize, int seed)
 {
     std::mt19937 rng(seed);
@@ -6,6 +6,7 @@
 #include <chrono>
 #include "stdafx.h"
 #include "BufferedFileReader.h"
+#include "ChunkReadAhead.h"
 #include "FileWrapper.h"
 #include "Index.h"
 #include "Platform.h"
@@ -270,6 +271,112 @@ BOOST_AUTO_TEST_CASE(Test_set_offset_after_reading_all)
     }
 }
 
+BOOST_AUTO_TEST_CASE(Test_async_reads)
+{
+    CreateTestFile(s_textData);
+
+    AsyncFileReader asyncReader(L"test.tmp");
+
+    // A batch of reads in random order, including one that runs over the EOF.
+    std::vector<std::string> buffers(4, std::string(20, '\0'));
+    std::vector<FileReadRequest> requests = {
+        { 100, 16, &buffers[0][0] },
+        { 0, 16, &buffers[1][0] },
+        { 48, 9, &buffers[2][0] },
+        { s_textData.size() - 5, 20, &buffers[3][0] },
+    };
+
+    auto results = asyncReader.Submit(requests);
+    BOOST_REQUIRE_EQUAL(results.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        size_t expected = std::min(requests[i].m_size, s_textData.size() - (size_t)requests[i].m_offset);
+        BOOST_REQUIRE_EQUAL(results[i].get(), expected);
+        BOOST_REQUIRE_EQUAL(buffers[i].substr(0, expected), s_textData.substr(requests[i].m_offset, expected));
+    }
+
+    // ReadOrDie fails on a short read.
+    BOOST_REQUIRE_THROW(asyncReader.ReadOrDie(&buffers[3][0], s_textData.size() - 5, 20), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(Test_load_range_then_read_past_it)
+{
+    CreateTestFile(s_textData);
+    AsyncFileReader asyncReader(L"test.tmp");
+
+    for (size_t i : {1, 7, 19, 300})
+    {
+        auto f = FileWrapper::OpenOrDie(L"test.tmp", L"rb");
+        BufferedFileReader reader(i, f);
+
+        // Load the 3rd to 5th lines, then read from the 4th line to the end of the file.
+        std::vector<char> range(34);
+        asyncReader.ReadOrDie(range.data(), 32, range.size());
+        reader.LoadRange(std::move(range), 32);
+        reader.SetFileOffset(48);
+        for (size_t j = 48; j < s_textData.size(); ++j)
+        {
+            char c;
+            BOOST_REQUIRE_EQUAL(reader.GetFileOffset(), j);
+            BOOST_REQUIRE(reader.TryGetNext(c));
+            BOOST_REQUIRE_EQUAL(c, s_textData[j]);
+        }
+        BOOST_REQUIRE(reader.Empty());
+
+        // After the range is released, reads are served from the file again.
+        reader.ReleaseRange();
+        reader.SetFileOffset(16);
+        std::string line;
+        BOOST_REQUIRE(reader.TryReadLine(line));
+        BOOST_REQUIRE_EQUAL(line, s_textData.substr(16, 15));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Test_chunk_read_ahead)
+{
+    CreateTestFile(s_textData);
+
+    // Chunks are the lines 1-3, 4-5 and 6-10 of the file.
+    std::vector<ChunkReadAhead::Request> chunks = {
+        { 0, L"test.tmp", 0, 48 },
+        { 1, L"test.tmp", 48, 18 },
+        { 2, L"test.tmp", 66, s_textData.size() - 66 },
+    };
+
+    auto check = [](const std::vector<char>& data, const ChunkReadAhead::Request& chunk)
+    {
+        BOOST_REQUIRE_EQUAL(data.size(), chunk.m_size + 2);
+        BOOST_REQUIRE_EQUAL(std::string(data.begin(), data.begin() + chunk.m_size), s_textData.substr(chunk.m_offset, chunk.m_size));
+        BOOST_REQUIRE_EQUAL(data[chunk.m_size], 0);
+        BOOST_REQUIRE_EQUAL(data[chunk.m_size + 1], 0);
+    };
+
+    ChunkReadAhead readAhead(2);
+
+    // Started chunks are taken in any order, chunks that were not started are read directly.
+    readAhead.Start({ chunks[2], chunks[0] });
+    check(readAhead.Take(chunks[0]), chunks[0]);
+    check(readAhead.Take(chunks[1]), chunks[1]);
+    check(readAhead.Take(chunks[2]), chunks[2]);
+
+    // A chunk is taken only once, starting it again reads it again.
+    readAhead.Start({ chunks[1] });
+    readAhead.Start({ chunks[1], chunks[2] });
+    check(readAhead.Take(chunks[1]), chunks[1]);
+    check(readAhead.Take(chunks[1]), chunks[1]);
+
+    // Reads past the end of the file fail on the taking thread, also when they were started ahead.
+    ChunkReadAhead::Request pastEnd = { 3, L"test.tmp", s_textData.size() - 5, 20 };
+    readAhead.Start({ pastEnd });
+    BOOST_REQUIRE_THROW(readAhead.Take(pastEnd), std::runtime_error);
+    BOOST_REQUIRE_THROW(readAhead.Take(pastEnd), std::runtime_error);
+
+    // A file that cannot be opened is reported when the chunk is taken.
+    ChunkReadAhead::Request missing = { 4, L"missing.tmp", 0, 10 };
+    readAhead.Start({ missing });
+    BOOST_REQUIRE_THROW(readAhead.Take(missing), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
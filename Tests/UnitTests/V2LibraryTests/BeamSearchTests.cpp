@@ -0,0 +1,184 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace CNTK;
+using namespace std;
+
+namespace CNTK { namespace Test {
+
+static const size_t c_vocabularySize = 3;
+static const size_t c_contextDim = 2;
+static const size_t c_endToken = 2;
+
+// The model of the step function: score = LogSoftmax(W token + U context + S state), newState = Tanh(state + token).
+struct BeamSearchTestModel
+{
+    vector<float> W, U, S;
+
+    BeamSearchTestModel()
+    {
+        mt19937 rng(11);
+        uniform_real_distribution<float> dist(-2, 2);
+        W.resize(c_vocabularySize * c_vocabularySize);
+        U.resize(c_vocabularySize * c_contextDim);
+        S.resize(c_vocabularySize * c_vocabularySize);
+        for (auto* v : { &W, &U, &S })
+            for (auto& x : *v)
+                x = dist(rng);
+    }
+
+    // returns the log-probabilities of the next token and updates 'state'
+    vector<double> Step(size_t token, const vector<float>& context, vector<double>& state) const
+    {
+        vector<double> logits(c_vocabularySize);
+        for (size_t i = 0; i < c_vocabularySize; i++)
+        {
+            logits[i] = W[i + token * c_vocabularySize];
+            for (size_t j = 0; j < c_contextDim; j++)
+                logits[i] += U[i + j * c_vocabularySize] * context[j];
+            for (size_t j = 0; j < c_vocabularySize; j++)
+                logits[i] += S[i + j * c_vocabularySize] * state[j];
+        }
+        double maxLogit = *max_element(logits.begin(), logits.end());
+        double sum = 0;
+        for (auto l : logits)
+            sum += exp(l - maxLogit);
+        for (auto& l : logits)
+            l -= maxLogit + log(sum);
+        state[token] += 1;
+        for (auto& s : state)
+            s = tanh(s);
+        return logits;
+    }
+
+    // all hypotheses the decoder can produce, with their scores
+    void Enumerate(vector<size_t>& prefix, size_t token, const vector<float>& context, vector<double> state, double score, size_t maxLength,
+                   vector<pair<vector<size_t>, double>>& result) const
+    {
+        auto logProbabilities = Step(token, context, state);
+        for (size_t v = 0; v < c_vocabularySize; v++)
+        {
+            prefix.push_back(v);
+            if (v == c_endToken || prefix.size() == maxLength)
+                result.push_back({ prefix, score + logProbabilities[v] });
+            else
+                Enumerate(prefix, v, context, state, score + logProbabilities[v], maxLength, result);
+            prefix.pop_back();
+        }
+    }
+};
+
+static NDArrayViewPtr MatrixView(vector<float>& data, size_t rows, size_t cols, const DeviceDescriptor& device)
+{
+    return MakeSharedObject<NDArrayView>(NDShape({ rows, cols }), data.data(), data.size(), device);
+}
+
+static vector<vector<BeamSearchHypothesis>> Decode(BeamSearchTestModel& model, const vector<vector<float>>& contexts, size_t beamWidth, size_t maxLength, const DeviceDescriptor& device)
+{
+    auto token = InputVariable({ c_vocabularySize }, DataType::Float, L"token", { Axis::DefaultBatchAxis() });
+    auto state = InputVariable({ c_vocabularySize }, DataType::Float, L"state", { Axis::DefaultBatchAxis() });
+    auto context = InputVariable({ c_contextDim }, DataType::Float, L"context", { Axis::DefaultBatchAxis() });
+    auto W = Constant(MatrixView(model.W, c_vocabularySize, c_vocabularySize, device));
+    auto U = Constant(MatrixView(model.U, c_vocabularySize, c_contextDim, device));
+    auto S = Constant(MatrixView(model.S, c_vocabularySize, c_vocabularySize, device));
+    auto score = LogSoftmax(Plus(Plus(Times(W, token), Times(U, context)), Times(S, state)), L"score");
+    auto newState = Tanh(Plus(state, token), L"newState");
+    auto step = Combine({ score, newState });
+
+    auto decoder = CreateBeamSearchDecoder(step, token, score, { { state, newState } }, { context }, beamWidth, c_endToken, maxLength);
+
+    vector<float> initialStates(c_vocabularySize * contexts.size(), 0), contextData;
+    for (const auto& c : contexts)
+        contextData.insert(contextData.end(), c.begin(), c.end());
+    unordered_map<Variable, ValuePtr> initialValues = {
+        { state, Value::CreateBatch(state.Shape(), initialStates, device) },
+        { context, Value::CreateBatch(context.Shape(), contextData, device) }
+    };
+    return decoder->Decode(vector<size_t>(contexts.size(), 0), initialValues, device);
+}
+
+void TestBeamSearchIsExhaustiveWithWideBeam(const DeviceDescriptor& device)
+{
+    BeamSearchTestModel model;
+    const size_t maxLength = 3;
+    vector<vector<float>> contexts = { { 0.5f, -1.0f }, { -1.5f, 2.0f } };
+    auto results = Decode(model, contexts, 16, maxLength, device);
+    BOOST_REQUIRE_EQUAL(results.size(), contexts.size());
+
+    for (size_t s = 0; s < contexts.size(); s++)
+    {
+        vector<pair<vector<size_t>, double>> expected;
+        vector<size_t> prefix;
+        model.Enumerate(prefix, 0, contexts[s], vector<double>(c_vocabularySize, 0), 0, maxLength, expected);
+        stable_sort(expected.begin(), expected.end(), [](const pair<vector<size_t>, double>& a, const pair<vector<size_t>, double>& b) { return a.second > b.second; });
+
+        BOOST_REQUIRE_EQUAL(results[s].size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            BOOST_CHECK_SMALL(results[s][i].m_score - expected[i].second, 1e-4);
+            // (ties in the score would make the order ambiguous; the random model has none)
+            BOOST_CHECK(results[s][i].m_tokens == expected[i].first);
+        }
+    }
+}
+
+void TestBeamSearchWithBeamWidthOneIsGreedy(const DeviceDescriptor& device)
+{
+    BeamSearchTestModel model;
+    const size_t maxLength = 5;
+    vector<vector<float>> contexts = { { 0.5f, -1.0f }, { -1.5f, 2.0f }, { 1.0f, 1.0f } };
+    auto results = Decode(model, contexts, 1, maxLength, device);
+    BOOST_REQUIRE_EQUAL(results.size(), contexts.size());
+
+    for (size_t s = 0; s < contexts.size(); s++)
+    {
+        vector<size_t> expectedTokens;
+        vector<double> state(c_vocabularySize, 0);
+        double expectedScore = 0;
+        size_t token = 0;
+        while (expectedTokens.size() < maxLength && token != c_endToken)
+        {
+            auto logProbabilities = model.Step(token, contexts[s], state);
+            token = max_element(logProbabilities.begin(), logProbabilities.end()) - logProbabilities.begin();
+            expectedScore += logProbabilities[token];
+            expectedTokens.push_back(token);
+        }
+
+        BOOST_REQUIRE_EQUAL(results[s].size(), 1);
+        BOOST_CHECK(results[s][0].m_tokens == expectedTokens);
+        BOOST_CHECK_SMALL(results[s][0].m_score - expectedScore, 1e-4);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(BeamSearchSuite)
+
+BOOST_AUTO_TEST_CASE(BeamSearchIsExhaustiveWithWideBeamInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestBeamSearchIsExhaustiveWithWideBeam(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(BeamSearchIsExhaustiveWithWideBeamInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestBeamSearchIsExhaustiveWithWideBeam(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(BeamSearchWithBeamWidthOneIsGreedyInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestBeamSearchWithBeamWidthOneIsGreedy(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+#include <random>
+
+using namespace CNTK;
+using namespace std;
+
+namespace CNTK { namespace Test {
+
+// Evaluates the same minibatch of sequences of different lengths with and without sharding; the recurrence makes the result depend
+// on the sequence boundaries being kept.
+void TestShardedTestMinibatchMatchesUnsharded(size_t numShards)
+{
+    const size_t inputDim = 3, numClasses = 4;
+    const vector<size_t> sequenceLengths = { 3, 1, 4, 2, 5 };
+    auto device = DeviceDescriptor::CPUDevice();
+
+    auto features = InputVariable({ inputDim }, DataType::Float, L"features");
+    auto labels = InputVariable({ numClasses }, DataType::Float, L"labels");
+    auto W = Parameter({ numClasses, inputDim }, DataType::Float, GlorotUniformInitializer(), device, L"W");
+    auto z = Times(W, Plus(features, PastValue(features)));
+    auto loss = CrossEntropyWithSoftmax(z, labels, L"loss");
+
+    mt19937 rng(3);
+    uniform_real_distribution<float> dist(-1, 1);
+    vector<vector<float>> featureData, labelData;
+    for (auto length : sequenceLengths)
+    {
+        vector<float> sequenceFeatures(length * inputDim), sequenceLabels(length * numClasses, 0);
+        for (auto& x : sequenceFeatures)
+            x = dist(rng);
+        for (size_t t = 0; t < length; t++)
+            sequenceLabels[t * numClasses + rng() % numClasses] = 1;
+        featureData.push_back(sequenceFeatures);
+        labelData.push_back(sequenceLabels);
+    }
+    unordered_map<Variable, ValuePtr> arguments = {
+        { features, Value::CreateBatchOfSequences(features.Shape(), featureData, device) },
+        { labels, Value::CreateBatchOfSequences(labels.Shape(), labelData, device) }
+    };
+
+    auto evaluator = CreateEvaluator(loss);
+    double expected = evaluator->TestMinibatch(arguments, device);
+
+    auto shardedEvaluator = CreateEvaluator(loss);
+    shardedEvaluator->SetNumTestShards(numShards);
+    for (size_t i = 0; i < 2; i++) // (the second call reuses the replicas)
+        BOOST_CHECK_CLOSE(shardedEvaluator->TestMinibatch(arguments, device), expected, 1e-4);
+}
+
+BOOST_AUTO_TEST_SUITE(EvaluatorSuite)
+
+BOOST_AUTO_TEST_CASE(ShardedTestMinibatchMatchesUnshardedInCPU)
+{
+    if (ShouldRunOnCpu())
+    {
+        TestShardedTestMinibatchMatchesUnsharded(2);
+        TestShardedTestMinibatchMatchesUnsharded(3);
+        TestShardedTestMinibatchMatchesUnsharded(8); // more shards than sequences
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
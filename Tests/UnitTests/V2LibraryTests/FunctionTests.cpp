@@ -1096,6 +1096,70 @@ void SetRandomSeed(const DeviceDescriptor& device)
     FloatingPointVectorCompare(result2, result4, "SetRandomSeed: output does match the expected after resetting the dropout seed.");
 }
 
+void TestEvaluateWithCallerOwnedInputBuffer(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 3, outputDim = 2, sequenceLength = 4;
+    std::vector<float> weights = { 1, -2, 0.5f, 3, -1, 0.25f };
+    auto W = Parameter(MakeSharedObject<NDArrayView>(NDShape({ outputDim, inputDim }), weights.data(), weights.size(), DeviceDescriptor::CPUDevice())->DeepClone(device));
+    auto input = InputVariable({ inputDim }, DataType::Float, L"input");
+    auto output = Times(W, input, L"output");
+
+    auto expectedOutput = [&](const std::vector<float>& inputData)
+    {
+        std::vector<float> result(outputDim * sequenceLength, 0);
+        for (size_t t = 0; t < sequenceLength; ++t)
+            for (size_t i = 0; i < outputDim; ++i)
+                for (size_t j = 0; j < inputDim; ++j)
+                    result[t * outputDim + i] += weights[j * outputDim + i] * inputData[t * inputDim + j];
+        return result;
+    };
+
+    auto evaluate = [&](const ValuePtr& inputValue)
+    {
+        std::unordered_map<Variable, ValuePtr> outputs = { { output->Output(), nullptr } };
+        output->Evaluate({ { input, inputValue } }, outputs, device);
+        std::vector<std::vector<float>> sequences;
+        outputs[output->Output()]->CopyVariableValueTo(output->Output(), sequences);
+        return sequences[0];
+    };
+
+    // A Value backed by a caller-owned buffer, that evaluation may use in place.
+    std::vector<float> buffer(inputDim * sequenceLength);
+    std::iota(buffer.begin(), buffer.end(), 1.0f);
+    auto inputValue = MakeSharedObject<Value>(MakeSharedObject<NDArrayView>(NDShape({ inputDim, sequenceLength, 1 }), buffer.data(), buffer.size(), DeviceDescriptor::CPUDevice()));
+    auto bufferBefore = buffer;
+    FloatingPointVectorCompare(evaluate(inputValue), expectedOutput(buffer), "Output of a Value over a caller-owned buffer does not match.");
+    BOOST_TEST((buffer == bufferBefore), "Evaluation must not write into the caller-owned input buffer.");
+
+    // Changes of the buffer are seen by the next evaluation.
+    for (auto& x : buffer)
+        x = -0.5f * x;
+    FloatingPointVectorCompare(evaluate(inputValue), expectedOutput(buffer), "Output after changing the caller-owned buffer does not match.");
+
+    // Values owning a copy of their data still work after the node used the caller's buffer.
+    auto copiedData = buffer;
+    for (auto& x : copiedData)
+        x += 1;
+    FloatingPointVectorCompare(evaluate(Value::CreateSequence(NDShape({ inputDim }), copiedData, device)), expectedOutput(copiedData), "Output of a Value with copied data does not match.");
+
+    // Forward with backward state copies the data; the gradient of W is the sum over frames of the input.
+    std::unordered_map<Variable, ValuePtr> outputs = { { output->Output(), nullptr } };
+    auto backpropState = output->Forward({ { input, inputValue } }, outputs, device, { output->Output() });
+    std::unordered_map<Variable, ValuePtr> gradients = { { W, nullptr } };
+    auto rootGradient = MakeSharedObject<Value>(MakeSharedObject<NDArrayView>(1.0f, NDShape({ outputDim, sequenceLength, 1 }), device));
+    output->Backward(backpropState, { { output->Output(), rootGradient } }, gradients);
+
+    std::vector<float> gradientData(outputDim * inputDim);
+    auto gradientView = MakeSharedObject<NDArrayView>(NDShape({ outputDim, inputDim }), gradientData.data(), gradientData.size(), DeviceDescriptor::CPUDevice());
+    gradientView->CopyFrom(*gradients[W]->Data());
+    std::vector<float> expectedGradient(outputDim * inputDim, 0);
+    for (size_t t = 0; t < sequenceLength; ++t)
+        for (size_t i = 0; i < outputDim; ++i)
+            for (size_t j = 0; j < inputDim; ++j)
+                expectedGradient[j * outputDim + i] += buffer[t * inputDim + j];
+    FloatingPointVectorCompare(gradientData, expectedGradient, "Gradient for a Value over a caller-owned buffer does not match.");
+}
+
 BOOST_AUTO_TEST_SUITE(FunctionSuite)
 
 BOOST_AUTO_TEST_CASE(FindNameInCPU)
@@ -1222,6 +1286,15 @@ BOOST_AUTO_TEST_CASE(TestSettingRandomSeed)
         SetRandomSeed(DeviceDescriptor::GPUDevice(0));
 }
 
+BOOST_AUTO_TEST_CASE(EvaluateWithCallerOwnedInputBuffer)
+{
+    if (ShouldRunOnCpu())
+        TestEvaluateWithCallerOwnedInputBuffer(DeviceDescriptor::CPUDevice());
+
+    if (ShouldRunOnGpu())
+        TestEvaluateWithCallerOwnedInputBuffer(DeviceDescriptor::GPUDevice(0));
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,243 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace CNTK;
+
+namespace CNTK { namespace Test {
+
+// ONNX TensorProto.DataType values
+static const uint64_t c_onnxFloat = 1;
+static const uint64_t c_onnxDouble = 11;
+
+inline bool IsLittleEndian()
+{
+    const uint16_t one = 1;
+    return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+// Little-endian bytes of the values, as in TensorProto.raw_data (and in packed fixed-size fields).
+template <typename T>
+std::string ToBytes(const std::vector<T>& values)
+{
+    std::string bytes(values.size() * sizeof(T), '\0');
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        uint8_t element[sizeof(T)];
+        memcpy(element, &values[i], sizeof(T));
+        if (!IsLittleEndian())
+            std::reverse(element, element + sizeof(T));
+        memcpy(&bytes[i * sizeof(T)], element, sizeof(T));
+    }
+    return bytes;
+}
+
+// Writes the protobuf wire format, so that the tests can build ONNX models that CNTK does not export,
+// e.g. with raw tensor data or with a tensor whose data does not match its dimensions.
+class WireWriter
+{
+public:
+    WireWriter& Varint(uint32_t field, uint64_t value)
+    {
+        AppendKey(field, 0);
+        AppendVarint(value);
+        return *this;
+    }
+
+    WireWriter& Bytes(uint32_t field, const std::string& bytes)
+    {
+        AppendKey(field, 2);
+        AppendVarint(bytes.size());
+        m_data += bytes;
+        return *this;
+    }
+
+    WireWriter& Message(uint32_t field, const WireWriter& message) { return Bytes(field, message.m_data); }
+
+    template <typename T>
+    WireWriter& Packed(uint32_t field, const std::vector<T>& values) { return Bytes(field, ToBytes(values)); }
+
+    const std::string& Data() const { return m_data; }
+
+private:
+    void AppendKey(uint32_t field, uint32_t wireType) { AppendVarint((static_cast<uint64_t>(field) << 3) | wireType); }
+
+    void AppendVarint(uint64_t value)
+    {
+        for (; value >= 0x80; value >>= 7)
+            m_data.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        m_data.push_back(static_cast<char>(value));
+    }
+
+    std::string m_data;
+};
+
+struct Initializer
+{
+    std::string m_name;
+    std::vector<int64_t> m_dims;
+    uint64_t m_dataType;
+    bool m_raw;
+    std::vector<float> m_floats;
+    std::vector<double> m_doubles;
+};
+
+// Saves an ONNX model made of Add nodes over initializers; node i adds the initializers inputs[i].
+void SaveAddModel(const std::wstring& path, const std::vector<Initializer>& initializers, const std::vector<std::pair<std::string, std::string>>& inputs)
+{
+    WireWriter graph;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        auto name = "add" + std::to_string(i);
+        graph.Message(1, WireWriter().Bytes(1, inputs[i].first).Bytes(1, inputs[i].second).Bytes(2, name + "_output").Bytes(3, name).Bytes(4, "Add"));
+    }
+    graph.Bytes(2, "ONNXImportTest");
+    for (const auto& initializer : initializers)
+    {
+        WireWriter tensor;
+        for (auto dim : initializer.m_dims)
+            tensor.Varint(1, static_cast<uint64_t>(dim));
+        tensor.Varint(2, initializer.m_dataType);
+        tensor.Bytes(8, initializer.m_name);
+        if (initializer.m_raw)
+            tensor.Bytes(9, initializer.m_dataType == c_onnxFloat ? ToBytes(initializer.m_floats) : ToBytes(initializer.m_doubles));
+        else if (initializer.m_dataType == c_onnxFloat)
+            tensor.Packed(4, initializer.m_floats);
+        else
+            tensor.Packed(10, initializer.m_doubles);
+        graph.Message(5, tensor);
+    }
+    for (size_t i = 0; i < inputs.size(); i++)
+        graph.Message(12, WireWriter().Bytes(1, "add" + std::to_string(i) + "_output"));
+
+    WireWriter model;
+    model.Varint(1, 3).Bytes(2, "CNTK").Message(7, graph);
+
+    std::ofstream file(std::string(path.begin(), path.end()), std::ios::binary);
+    file.write(model.Data().data(), model.Data().size());
+}
+
+template <typename ElementType>
+std::vector<std::vector<ElementType>> ConstantValues(const FunctionPtr& model, const std::wstring& name)
+{
+    std::vector<std::vector<ElementType>> values;
+    for (const auto& constant : model->Constants())
+    {
+        if (constant.Name() != name)
+            continue;
+
+        auto value = constant.Value()->DeepClone(DeviceDescriptor::CPUDevice());
+        values.push_back(std::vector<ElementType>(value->DataBuffer<ElementType>(), value->DataBuffer<ElementType>() + value->Shape().TotalSize()));
+    }
+    return values;
+}
+
+void TestImportInitializers(const DeviceDescriptor& device)
+{
+    const std::vector<float> floats = { 1.5f, -2.0f, 3.25f, 0.0f, 1e-3f, -7.0f };
+    const std::vector<double> doubles = { 0.1, -0.2, 3e10, 4.5, -1e-20, 6.0 };
+
+    // raw and typed float data; 'weights' is used by both nodes, and each gets a constant of its own
+    std::vector<Initializer> floatInitializers = {
+        { "weights", { 2, 3 }, c_onnxFloat, true, floats, {} },
+        { "bias", { 2, 3 }, c_onnxFloat, false, floats, {} },
+        { "offset", { 2, 3 }, c_onnxFloat, true, floats, {} },
+    };
+    SaveAddModel(L"onnx_import_float.onnx", floatInitializers, { { "weights", "bias" }, { "weights", "offset" } });
+    auto floatModel = Function::Load(L"onnx_import_float.onnx", device, ModelFormat::ONNX);
+    auto weights = ConstantValues<float>(floatModel, L"weights");
+    BOOST_REQUIRE_EQUAL(weights.size(), 2u);
+    for (const auto& name : { L"bias", L"offset" })
+    {
+        auto values = ConstantValues<float>(floatModel, name);
+        BOOST_REQUIRE_EQUAL(values.size(), 1u);
+        weights.push_back(values[0]);
+    }
+    for (const auto& values : weights)
+        FloatingPointVectorCompare(values, floats, "Imported float initializer does not match the ONNX tensor");
+
+    // raw and typed double data
+    std::vector<Initializer> doubleInitializers = {
+        { "raw", { 3, 2 }, c_onnxDouble, true, {}, doubles },
+        { "typed", { 3, 2 }, c_onnxDouble, false, {}, doubles },
+    };
+    SaveAddModel(L"onnx_import_double.onnx", doubleInitializers, { { "raw", "typed" } });
+    auto doubleModel = Function::Load(L"onnx_import_double.onnx", device, ModelFormat::ONNX);
+    for (const auto& name : { L"raw", L"typed" })
+    {
+        auto values = ConstantValues<double>(doubleModel, name);
+        BOOST_REQUIRE_EQUAL(values.size(), 1u);
+        BOOST_CHECK(values[0] == doubles);
+    }
+}
+
+void TestImportInitializerErrors(const DeviceDescriptor& device)
+{
+    const std::vector<float> floats(6, 1.0f);
+    auto expectError = [&device](const std::wstring& path, const std::string& tensorName)
+    {
+        bool thrown = false;
+        try
+        {
+            Function::Load(path, device, ModelFormat::ONNX);
+        }
+        catch (const std::exception& e)
+        {
+            thrown = true;
+            BOOST_CHECK_MESSAGE(std::string(e.what()).find("'" + tensorName + "'") != std::string::npos, e.what());
+        }
+        BOOST_CHECK_MESSAGE(thrown, "Loading an ONNX tensor whose data does not match its dimensions did not fail");
+    };
+
+    // too few typed elements, and too many bytes of raw data
+    SaveAddModel(L"onnx_import_typed_size.onnx",
+        { { "good", { 2, 3 }, c_onnxFloat, false, floats, {} }, { "short", { 2, 3 }, c_onnxFloat, false, std::vector<float>(5, 1.0f), {} } },
+        { { "good", "short" } });
+    expectError(L"onnx_import_typed_size.onnx", "short");
+    SaveAddModel(L"onnx_import_raw_size.onnx",
+        { { "good", { 2, 3 }, c_onnxFloat, true, floats, {} }, { "long", { 2, 3 }, c_onnxFloat, true, std::vector<float>(7, 1.0f), {} } },
+        { { "good", "long" } });
+    expectError(L"onnx_import_raw_size.onnx", "long");
+
+    // More initializers than cores, so that the bad one is converted by some worker thread.
+    std::vector<Initializer> initializers;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (size_t i = 0; i < 64; i++)
+    {
+        auto name = "weights" + std::to_string(i);
+        initializers.push_back({ name, { 2, 3 }, c_onnxFloat, i % 2 == 0, i == 37 ? std::vector<float>(4, 1.0f) : floats, {} });
+        if (i % 2 == 1)
+            inputs.push_back({ initializers[i - 1].m_name, name });
+    }
+    SaveAddModel(L"onnx_import_worker_error.onnx", initializers, inputs);
+    expectError(L"onnx_import_worker_error.onnx", "weights37");
+}
+
+BOOST_AUTO_TEST_SUITE(ONNXImportSuite)
+
+BOOST_AUTO_TEST_CASE(ImportInitializersInCPU)
+{
+    TestImportInitializers(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(ImportInitializersInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestImportInitializers(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(ImportInitializerErrors)
+{
+    TestImportInitializerErrors(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
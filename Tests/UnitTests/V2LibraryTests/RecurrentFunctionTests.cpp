@@ -7,7 +7,9 @@
 #include <functional>
 #include "Common.h"
 #include <numeric>
+#include <thread>
 #include "CNTKLibraryC.h"
+#include "EvaluatorWrapper.h"
 
 using namespace CNTK;
 
@@ -716,6 +718,118 @@ void ParityCandCppLSTMModel(DeviceDescriptor device, CNTK_DeviceDescriptor cdevi
     CNTK_ReleaseArray(argumentInfos);
 }
 
+void ParityBatchedCandCppLSTMModel(DeviceDescriptor device, CNTK_DeviceDescriptor cdevice)
+{
+    const size_t inputDim = 7;
+    const size_t cellDim = 16;
+    const size_t hiddenDim = 8;
+    const size_t numOutputClasses = 5;
+    const size_t numRequests = 6;
+
+    auto features = InputVariable({ inputDim }, AsDataType<float>(), L"features");
+    auto classifier = LSTMNet<float>(features, cellDim, hiddenDim, numOutputClasses, 1, device, L"classifierOutput");
+    auto output = classifier->Output();
+
+    const std::wstring tempModelPath = L"batched.model";
+    if ((_wunlink(tempModelPath.c_str()) != 0) && (errno != ENOENT))
+        BOOST_ERROR("Error deleting temp model file 'batched.model'");
+    classifier->Save(tempModelPath);
+
+    // Sequences of different lengths, evaluated one by one in C++.
+    std::mt19937_64 generator(17);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<std::vector<float>> inputData(numRequests), expected(numRequests);
+    for (size_t r = 0; r < numRequests; ++r)
+    {
+        for (size_t i = 0; i < inputDim * (r + 1); ++i)
+            inputData[r].push_back(distribution(generator));
+
+        std::unordered_map<Variable, ValuePtr> outputs{ { output, nullptr } };
+        classifier->Evaluate({ { features, Value::CreateSequence(NDShape{ inputDim }, inputData[r], true, device) } }, outputs, device);
+        std::vector<std::vector<float>> sequences;
+        outputs[output]->CopyVariableValueTo(output, sequences);
+        expected[r] = sequences[0];
+    }
+
+    CNTK_ModelHandle model;
+    // The minibatch is evaluated as soon as all requests have arrived, the latency bound only guards against slow callers.
+    auto rc = CNTK_LoadBatchingModel(tempModelPath.c_str(), &cdevice, (uint32_t)numRequests, 10000000, &model);
+    BOOST_REQUIRE_EQUAL(rc.value, CNTK_SUCCESS);
+    if (_wunlink(tempModelPath.c_str()) != 0)
+        BOOST_ERROR("Error deleting temp model file 'batched.model'");
+
+    CNTK_Variable* argumentInfos;
+    uint32_t numArguments = 0;
+    rc = CNTK_GetModelArgumentsInfo(model, &argumentInfos, &numArguments);
+    BOOST_REQUIRE_EQUAL(rc.value, CNTK_SUCCESS);
+
+    CNTK_Variable* outputInfos;
+    uint32_t numOutputs = 0;
+    rc = CNTK_GetModelOutputsInfo(model, &outputInfos, &numOutputs);
+    BOOST_REQUIRE_EQUAL(rc.value, CNTK_SUCCESS);
+
+    // Concurrent requests share a minibatch, each caller gets its own sequence back.
+    std::vector<std::vector<float>> results(numRequests);
+    std::vector<std::vector<uint32_t>> resultShapes(numRequests);
+    std::vector<int32_t> statusCodes(numRequests);
+    std::vector<std::thread> callers;
+    for (size_t r = 0; r < numRequests; ++r)
+    {
+        callers.emplace_back([&, r]()
+        {
+            std::vector<uint32_t> dimensions{ (uint32_t)inputDim, (uint32_t)(r + 1) };
+            CNTK_Value input{ { dimensions.data(), (uint32_t)dimensions.size() }, inputData[r].data() };
+            bool sequenceFlags[]{ true };
+            CNTK_Value* outputValues = nullptr;
+            auto status = CNTK_EvaluateSequence(model, argumentInfos, &input, sequenceFlags, numArguments,
+                outputInfos, numOutputs, &outputValues);
+            statusCodes[r] = status.value;
+            if (status.value != CNTK_SUCCESS)
+                return;
+
+            resultShapes[r].assign(outputValues[0].shape.value, outputValues[0].shape.value + outputValues[0].shape.size);
+            results[r].assign(outputValues[0].data, outputValues[0].data + numOutputClasses * (r + 1));
+            for (uint32_t i = 0; i < numOutputs; i++)
+                CNTK_CleanValue(&outputValues[i]);
+            CNTK_ReleaseArray(outputValues);
+        });
+    }
+    for (auto& caller : callers)
+        caller.join();
+
+    for (size_t r = 0; r < numRequests; ++r)
+    {
+        BOOST_REQUIRE_EQUAL(statusCodes[r], CNTK_SUCCESS);
+        std::vector<uint32_t> expectedShape{ (uint32_t)numOutputClasses, (uint32_t)(r + 1), 1 };
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(resultShapes[r].begin(), resultShapes[r].end(), expectedShape.begin(), expectedShape.end());
+        RequireClose(expected[r], results[r], 0.00001f, 0.0001f);
+    }
+
+    // All requests are compatible, so they were evaluated by a single Forward.
+    BOOST_CHECK_EQUAL(static_cast<BatchingEvaluatorWrapper*>(static_cast<EvaluatorWrapper*>(model))->NumEvaluatedBatches(), 1u);
+
+    // Continuing a sequence is not possible, the recurrent state is not kept per caller.
+    {
+        std::vector<uint32_t> dimensions{ (uint32_t)inputDim, 1 };
+        CNTK_Value input{ { dimensions.data(), (uint32_t)dimensions.size() }, inputData[0].data() };
+        bool sequenceFlags[]{ false };
+        CNTK_Value* outputValues = nullptr;
+        rc = CNTK_EvaluateSequence(model, argumentInfos, &input, sequenceFlags, numArguments,
+            outputInfos, numOutputs, &outputValues);
+        BOOST_REQUIRE_NE(rc.value, CNTK_SUCCESS);
+    }
+
+    CNTK_ReleaseModel(model);
+
+    for (uint32_t i = 0; i < numOutputs; i++)
+        CNTK_CleanVariable(&outputInfos[i]);
+    CNTK_ReleaseArray(outputInfos);
+
+    for (uint32_t i = 0; i < numArguments; i++)
+        CNTK_CleanVariable(&argumentInfos[i]);
+    CNTK_ReleaseArray(argumentInfos);
+}
+
 BOOST_AUTO_TEST_CASE(TestParityCandCppLSTMModel)
 {
     CNTK_DeviceDescriptor* devices = nullptr;
@@ -758,6 +872,18 @@ BOOST_AUTO_TEST_CASE(TestParityCandCppLSTMModel)
     CNTK_ReleaseArray(devices);
 }
 
+BOOST_AUTO_TEST_CASE(TestParityBatchedCandCppLSTMModelInCPU)
+{
+    if (ShouldRunOnCpu())
+        ParityBatchedCandCppLSTMModel(DeviceDescriptor::CPUDevice(), CNTK_DeviceDescriptor{ CNTK_DeviceKind_CPU, 0 });
+}
+
+BOOST_AUTO_TEST_CASE(TestParityBatchedCandCppLSTMModelInGPU)
+{
+    if (ShouldRunOnGpu())
+        ParityBatchedCandCppLSTMModel(DeviceDescriptor::GPUDevice(0), CNTK_DeviceDescriptor{ CNTK_DeviceKind_GPU, 0 });
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }}
@@ -13,6 +13,7 @@
 #include <vector>
 #include <functional>
 #include <iostream>
+#include <fstream>
 
 using namespace CNTK;
 using namespace std;
@@ -168,6 +169,25 @@ void TestDictionarySerialization(size_t dictSize)
 
      if (originalDict != deserializedDict2)
         BOOST_ERROR("TestDictionarySerialization: original and deserialized dictionaries are not identical.");
+
+    if ((_wunlink(tempFilePath.c_str()) != 0) && (errno != ENOENT))
+       BOOST_ERROR("Error deleting temporary test file 'serialization.tmp'.");
+
+    originalDict.SaveWithRawTensors(tempFilePath);
+    Dictionary deserializedDict3 = Dictionary::Load(tempFilePath);
+
+    if (originalDict != deserializedDict3)
+        BOOST_ERROR("TestDictionarySerialization: original and deserialized (raw tensors) dictionaries are not identical.");
+
+    Dictionary deserializedDict4;
+    {
+        fstream stream;
+        OpenStream(stream, tempFilePath, true);
+        stream >> deserializedDict4;
+    }
+
+    if (originalDict != deserializedDict4)
+        BOOST_ERROR("TestDictionarySerialization: original and deserialized (raw tensors) dictionaries are not identical.");
 }
 
 template <typename ElementType>
@@ -422,6 +442,15 @@ void TestFunctionSaveAndLoad(const FunctionPtr& function, const DeviceDescriptor
     {
         BOOST_ERROR("TestFunctionSaveAndLoad: original and reloaded functions are not identical.");
     }
+
+    auto rawTensorsFile = L"TestFunctionSaveAndLoadRawTensors.out";
+    function->Save(rawTensorsFile, ModelFormat::CNTKv2RawTensors);
+    auto reloadedRawTensorsFunction = Function::Load(rawTensorsFile, device);
+
+    if (!AreEqual(function, reloadedRawTensorsFunction))
+    {
+        BOOST_ERROR("TestFunctionSaveAndLoad: original and reloaded (raw tensors) functions are not identical.");
+    }
 }
 
 void TestFunctionsForEquality(const DeviceDescriptor& device)
@@ -850,6 +879,56 @@ void TestCheckpointingWithStatefulNodes(const DeviceDescriptor& device)
     }
 }
 
+void TestBackgroundCheckpointing(const DeviceDescriptor& device)
+{
+    auto featureStreamName = L"features";
+    auto labelsStreamName = L"labels";
+
+    size_t inputDim = 784;
+    size_t numOutputClasses = 10;
+    auto features = InputVariable({ inputDim }, false /*isSparse*/, DataType::Float, featureStreamName);
+    auto labels = InputVariable({ numOutputClasses }, DataType::Float, labelsStreamName);
+    auto net = Dropout(BuildFFClassifierNet(features, numOutputClasses, device, 1), 0.5);
+
+    auto trainer = BuildTrainer(net, labels);
+
+    const size_t minibatchSize = 50;
+    const size_t epochSize = 150;
+    auto minibatchSource = TextFormatMinibatchSource(L"Train-28x28_cntk_text.txt", { { featureStreamName, inputDim }, { labelsStreamName, numOutputClasses } },  epochSize, false);
+    auto minibatchData = minibatchSource->GetNextMinibatch(minibatchSize, device);
+    auto featureStreamInfo = minibatchSource->StreamInfo(features);
+    auto labelStreamInfo = minibatchSource->StreamInfo(labels);
+
+    trainer->TrainMinibatch({ { features, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+
+    // Training continues while the checkpoints are written; they must hold the state at the time of the call.
+    vector<double> expectedLoss;
+    for (int i = 0; i < epochSize / minibatchSize; i++)
+    {
+        trainer->SaveCheckpointInBackground(L"background_checkpoint.model" + std::to_wstring(i));
+        trainer->TrainMinibatch({ { features, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+        expectedLoss.push_back(trainer->PreviousMinibatchLossAverage());
+    }
+    trainer->WaitForCheckpointWrites();
+
+    for (int i = 0; i < epochSize / minibatchSize; i++)
+    {
+        trainer->RestoreFromCheckpoint(L"background_checkpoint.model" + std::to_wstring(i));
+        trainer->TrainMinibatch({ { features, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+        double loss = trainer->PreviousMinibatchLossAverage();
+        FloatingPointCompare(loss, expectedLoss[i], "Post background checkpoint restoration training loss does not match expectation");
+    }
+
+    // A model replaced without its trainer state, as left by an interrupted checkpoint, is detected on restore.
+    {
+        std::ifstream from("background_checkpoint.model1", std::ios::binary);
+        std::ofstream to("background_checkpoint.model0", std::ios::binary | std::ios::trunc);
+        to << from.rdbuf();
+    }
+    VerifyException([&trainer]() {
+        trainer->RestoreFromCheckpoint(L"background_checkpoint.model0");
+    }, "Was able to restore a trainer state that does not belong to the model.");
+}
 
 void TestCheckpointingWithStatefulNodesAndExplicitSeeds(const DeviceDescriptor& device)
 {
@@ -1039,6 +1118,11 @@ BOOST_AUTO_TEST_CASE(CheckpointingWithStatefulNodesInCPU)
     TestCheckpointingWithStatefulNodes(DeviceDescriptor::CPUDevice());
 }
 
+BOOST_AUTO_TEST_CASE(BackgroundCheckpointingInCPU)
+{
+    TestBackgroundCheckpointing(DeviceDescriptor::CPUDevice());
+}
+
 BOOST_AUTO_TEST_CASE(LearnerSerializationInGPU)
 {
     if (ShouldRunOnGpu())
@@ -1100,6 +1184,12 @@ BOOST_AUTO_TEST_CASE(CheckpointingWithStatefulNodesInGPU)
 }
 
 
+BOOST_AUTO_TEST_CASE(BackgroundCheckpointingInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestBackgroundCheckpointing(DeviceDescriptor::GPUDevice(0));
+}
+
 BOOST_AUTO_TEST_CASE(CheckpointingWithStatefulNodesAndExplicitSeedsOnCPU)
 {
      TestCheckpointingWithStatefulNodesAndExplicitSeeds(DeviceDescriptor::CPUDevice());
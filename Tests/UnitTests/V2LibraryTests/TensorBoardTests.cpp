@@ -0,0 +1,323 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using namespace CNTK;
+using namespace CNTK::Internal;
+
+namespace CNTK { namespace Test {
+
+// The parts of a tensorflow.Event that the tests look at.
+struct EventRecord
+{
+    EventRecord() : m_step(0), m_hasFileVersion(false), m_simpleValue(0), m_hasHistogram(false), m_min(0), m_max(0), m_num(0) {}
+
+    uint64_t m_step;
+    bool m_hasFileVersion;
+    std::string m_tag;
+    float m_simpleValue;
+    bool m_hasHistogram;
+    double m_min, m_max, m_num;
+    std::vector<double> m_bucketLimits;
+    std::vector<double> m_buckets;
+};
+
+// Reads the protobuf wire format, which is all that is needed to decode the events without the generated classes.
+class WireReader
+{
+public:
+    WireReader(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+    bool AtEnd() const { return m_pos >= m_end; }
+
+    uint64_t ReadVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            BOOST_REQUIRE(m_pos < m_end && shift < 64);
+            uint8_t byte = static_cast<uint8_t>(*m_pos++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+    }
+
+    template <typename T>
+    T ReadFixed()
+    {
+        BOOST_REQUIRE(static_cast<size_t>(m_end - m_pos) >= sizeof(T));
+        T value;
+        memcpy(&value, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    WireReader ReadLengthDelimited()
+    {
+        size_t length = static_cast<size_t>(ReadVarint());
+        BOOST_REQUIRE(static_cast<size_t>(m_end - m_pos) >= length);
+        WireReader field(m_pos, m_pos + length);
+        m_pos += length;
+        return field;
+    }
+
+    std::string ReadString()
+    {
+        auto field = ReadLengthDelimited();
+        return std::string(field.m_pos, field.m_end);
+    }
+
+    void Skip(uint32_t wireType)
+    {
+        switch (wireType)
+        {
+        case 0: ReadVarint(); break;
+        case 1: ReadFixed<uint64_t>(); break;
+        case 2: ReadLengthDelimited(); break;
+        case 5: ReadFixed<uint32_t>(); break;
+        default: BOOST_FAIL("Unexpected protobuf wire type " << wireType);
+        }
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+};
+
+static std::vector<double> ReadPackedDoubles(WireReader field)
+{
+    std::vector<double> values;
+    while (!field.AtEnd())
+        values.push_back(field.ReadFixed<double>());
+    return values;
+}
+
+static void ParseHistogram(WireReader histogram, EventRecord& event)
+{
+    event.m_hasHistogram = true;
+    while (!histogram.AtEnd())
+    {
+        uint64_t key = histogram.ReadVarint();
+        uint32_t field = static_cast<uint32_t>(key >> 3), wireType = static_cast<uint32_t>(key & 7);
+        if (field == 1 && wireType == 1)
+            event.m_min = histogram.ReadFixed<double>();
+        else if (field == 2 && wireType == 1)
+            event.m_max = histogram.ReadFixed<double>();
+        else if (field == 3 && wireType == 1)
+            event.m_num = histogram.ReadFixed<double>();
+        else if (field == 6 && wireType == 2)
+            event.m_bucketLimits = ReadPackedDoubles(histogram.ReadLengthDelimited());
+        else if (field == 7 && wireType == 2)
+            event.m_buckets = ReadPackedDoubles(histogram.ReadLengthDelimited());
+        else
+            histogram.Skip(wireType);
+    }
+}
+
+static void ParseSummary(WireReader summary, EventRecord& event)
+{
+    while (!summary.AtEnd())
+    {
+        uint64_t key = summary.ReadVarint();
+        if ((key >> 3) != 1 || (key & 7) != 2)
+        {
+            summary.Skip(key & 7);
+            continue;
+        }
+
+        auto value = summary.ReadLengthDelimited();
+        while (!value.AtEnd())
+        {
+            uint64_t valueKey = value.ReadVarint();
+            uint32_t field = static_cast<uint32_t>(valueKey >> 3), wireType = static_cast<uint32_t>(valueKey & 7);
+            if (field == 1 && wireType == 2)
+                event.m_tag = value.ReadString();
+            else if (field == 2 && wireType == 5)
+                event.m_simpleValue = value.ReadFixed<float>();
+            else if (field == 5 && wireType == 2)
+                ParseHistogram(value.ReadLengthDelimited(), event);
+            else
+                value.Skip(wireType);
+        }
+    }
+}
+
+static EventRecord ParseEvent(const std::string& data)
+{
+    EventRecord event;
+    WireReader reader(data.data(), data.data() + data.size());
+    while (!reader.AtEnd())
+    {
+        uint64_t key = reader.ReadVarint();
+        uint32_t field = static_cast<uint32_t>(key >> 3), wireType = static_cast<uint32_t>(key & 7);
+        if (field == 2 && wireType == 0)
+            event.m_step = reader.ReadVarint();
+        else if (field == 3 && wireType == 2)
+        {
+            reader.ReadString();
+            event.m_hasFileVersion = true;
+        }
+        else if (field == 5 && wireType == 2)
+            ParseSummary(reader.ReadLengthDelimited(), event);
+        else
+            reader.Skip(wireType);
+    }
+    return event;
+}
+
+static uint32_t GetMaskedCrc(const char* data, size_t n)
+{
+    boost::crc_optimal<32, 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF, true, true> crc;
+    crc.process_bytes(data, n);
+    uint32_t value = crc();
+    return ((value >> 15) | (value << 17)) + 0xa282ead8ul;
+}
+
+// Reads the only event file in 'dir', checking the length and data checksums of each record.
+static std::vector<EventRecord> ReadEvents(const std::wstring& dir)
+{
+    std::vector<boost::filesystem::path> files;
+    for (boost::filesystem::directory_iterator it(dir), end; it != end; ++it)
+        files.push_back(it->path());
+    BOOST_REQUIRE_EQUAL(files.size(), 1u);
+
+    std::ifstream file(files[0].string(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<EventRecord> events;
+    const size_t headerSize = sizeof(uint64_t) + sizeof(uint32_t), footerSize = sizeof(uint32_t);
+    for (size_t pos = 0; pos < content.size();)
+    {
+        BOOST_REQUIRE_GE(content.size() - pos, headerSize);
+        uint64_t length;
+        uint32_t lengthCrc;
+        memcpy(&length, &content[pos], sizeof(length));
+        memcpy(&lengthCrc, &content[pos + sizeof(length)], sizeof(lengthCrc));
+        BOOST_CHECK_EQUAL(lengthCrc, GetMaskedCrc(&content[pos], sizeof(length)));
+        pos += headerSize;
+
+        BOOST_REQUIRE_GE(content.size() - pos, length + footerSize);
+        uint32_t dataCrc;
+        memcpy(&dataCrc, &content[pos + length], sizeof(dataCrc));
+        BOOST_CHECK_EQUAL(dataCrc, GetMaskedCrc(&content[pos], length));
+        events.push_back(ParseEvent(content.substr(pos, length)));
+        pos += length + footerSize;
+    }
+    return events;
+}
+
+static std::wstring EmptyDirectory(const std::wstring& dir)
+{
+    boost::filesystem::remove_all(dir);
+    return dir;
+}
+
+BOOST_AUTO_TEST_SUITE(TensorBoardSuite)
+
+BOOST_AUTO_TEST_CASE(BackgroundWriterKeepsSampledStepsAndDrainsOnClose)
+{
+    auto dir = EmptyDirectory(L"TensorBoardTests_Sampling");
+    const size_t numSteps = 3000, interval = 3;
+    {
+        TensorBoardFileWriter writer(dir, FunctionPtr());
+        writer.WriteInBackground(numSteps);
+        writer.SetStepSamplingInterval(interval);
+        for (size_t step = 0; step < numSteps; step++)
+            writer.WriteValue(L"loss", static_cast<float>(step) / 2, step);
+        // no Flush(): Close() writes what is queued
+        BOOST_CHECK(writer.Close());
+        BOOST_CHECK_EQUAL(writer.NumDroppedRecords(), 0u);
+    }
+
+    auto events = ReadEvents(dir);
+    BOOST_REQUIRE_EQUAL(events.size(), 1 + numSteps / interval);
+    BOOST_CHECK(events[0].m_hasFileVersion);
+    for (size_t i = 1; i < events.size(); i++)
+    {
+        size_t step = (i - 1) * interval;
+        BOOST_CHECK_EQUAL(events[i].m_step, step);
+        BOOST_CHECK_EQUAL(events[i].m_tag, "loss");
+        BOOST_CHECK_EQUAL(events[i].m_simpleValue, static_cast<float>(step) / 2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BackgroundWriterHistograms)
+{
+    auto dir = EmptyDirectory(L"TensorBoardTests_Histograms");
+    std::mt19937 rng(0);
+    std::normal_distribution<float> dist(1, 3);
+    std::vector<float> floatValues(1000);
+    for (auto& v : floatValues)
+        v = dist(rng);
+    std::vector<double> doubleValues(floatValues.begin(), floatValues.begin() + 100);
+    std::vector<float> constantValues(10, 2.5f);
+    {
+        TensorBoardFileWriter writer(dir, FunctionPtr());
+        writer.WriteInBackground();
+        writer.WriteHistogram(L"float", MakeSharedObject<NDArrayView>(NDShape({ 10, 100 }), floatValues), 1);
+        writer.WriteHistogram(L"double", MakeSharedObject<NDArrayView>(NDShape({ 100 }), doubleValues), 2);
+        writer.WriteHistogram(L"constant", MakeSharedObject<NDArrayView>(NDShape({ 10 }), constantValues), 3);
+        BOOST_CHECK(writer.Close());
+    }
+
+    auto events = ReadEvents(dir);
+    BOOST_REQUIRE_EQUAL(events.size(), 4u);
+    auto checkHistogram = [](const EventRecord& event, const std::string& tag, uint64_t step, double min, double max, size_t count)
+    {
+        BOOST_CHECK_EQUAL(event.m_tag, tag);
+        BOOST_CHECK_EQUAL(event.m_step, step);
+        BOOST_REQUIRE(event.m_hasHistogram);
+        BOOST_CHECK_EQUAL(event.m_min, min);
+        BOOST_CHECK_EQUAL(event.m_max, max);
+        BOOST_CHECK_EQUAL(event.m_num, static_cast<double>(count));
+        BOOST_REQUIRE_EQUAL(event.m_bucketLimits.size(), event.m_buckets.size());
+        BOOST_CHECK_EQUAL(event.m_bucketLimits.back(), max);
+        double numInBuckets = 0;
+        for (auto bucket : event.m_buckets)
+            numInBuckets += bucket;
+        BOOST_CHECK_EQUAL(numInBuckets, event.m_num);
+    };
+    auto floatMinMax = std::minmax_element(floatValues.begin(), floatValues.end());
+    auto doubleMinMax = std::minmax_element(doubleValues.begin(), doubleValues.end());
+    checkHistogram(events[1], "float", 1, *floatMinMax.first, *floatMinMax.second, floatValues.size());
+    checkHistogram(events[2], "double", 2, *doubleMinMax.first, *doubleMinMax.second, doubleValues.size());
+    checkHistogram(events[3], "constant", 3, 2.5, 2.5, constantValues.size());
+    BOOST_CHECK_EQUAL(events[3].m_buckets.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(BackgroundWriterDropsRecordsWhenQueueIsFull)
+{
+    auto dir = EmptyDirectory(L"TensorBoardTests_Dropping");
+    const size_t numRecords = 100000;
+    size_t numDropped;
+    {
+        TensorBoardFileWriter writer(dir, FunctionPtr());
+        writer.WriteInBackground(1);
+        for (size_t step = 0; step < numRecords; step++)
+            writer.WriteValue(L"loss", 1.0f, step);
+        BOOST_CHECK(writer.Close());
+        numDropped = writer.NumDroppedRecords();
+    }
+
+    // The caller posts far faster than a queue of one record is written.
+    BOOST_CHECK_GT(numDropped, 0u);
+    auto events = ReadEvents(dir);
+    BOOST_CHECK_EQUAL(events.size() - 1 + numDropped, numRecords);
+    for (size_t i = 2; i < events.size(); i++)
+        BOOST_CHECK_LT(events[i - 1].m_step, events[i].m_step);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+
+using namespace CNTK;
+
+namespace CNTK { namespace Test {
+
+static const size_t c_inputDim = 2;
+static const size_t c_numOutputClasses = 2;
+static const size_t c_numTrainingSamples = 300;
+
+struct MinibatchRecord
+{
+    size_t m_samplesSeenBefore;
+    size_t m_numSamples;
+    double m_loss;
+};
+
+struct CrossValidationRecord
+{
+    size_t m_index;
+    double m_averageError;
+    size_t m_numSamples;
+    size_t m_numMinibatches;
+};
+
+// Records what the trainer trains on and what cross validation reports. The minibatch size changes during training.
+class RecordingTrainingSession : public TrainingSession
+{
+public:
+    RecordingTrainingSession(const TrainerPtr& trainer, const MinibatchSourcePtr& trainingSource,
+                             const std::unordered_map<Variable, StreamInformation>& inputVarToStream, size_t maxNumTrainingSamples,
+                             const CheckpointConfig& checkpointing, const CrossValidationConfig& crossValidation)
+        : TrainingSession(trainer, trainingSource, MinibatchSizeSchedule(1), inputVarToStream, maxNumTrainingSamples,
+                          0, DataUnit::Sample, checkpointing, crossValidation, { nullptr })
+    {
+    }
+
+    virtual size_t GetMinibatchSize() override
+    {
+        return Trainer()->TotalNumberOfSamplesSeen() < 100 ? 25 : 40;
+    }
+
+    virtual void OnMinibatchStart() override
+    {
+        m_samplesSeenBefore = Trainer()->TotalNumberOfSamplesSeen();
+    }
+
+    virtual bool OnMinibatchEnd() override
+    {
+        m_minibatches.push_back({ m_samplesSeenBefore, Trainer()->PreviousMinibatchSampleCount(), Trainer()->PreviousMinibatchLossAverage() });
+        return true;
+    }
+
+    virtual bool OnCrossValidationEnd(size_t validationIndex, double averageError, size_t numberOfSamples, size_t numberOfMinibatches) override
+    {
+        m_crossValidations.push_back({ validationIndex, averageError, numberOfSamples, numberOfMinibatches });
+        return true;
+    }
+
+    size_t m_samplesSeenBefore;
+    std::vector<MinibatchRecord> m_minibatches;
+    std::vector<CrossValidationRecord> m_crossValidations;
+};
+
+struct SessionResult
+{
+    std::vector<MinibatchRecord> m_minibatches;
+    std::vector<CrossValidationRecord> m_crossValidations;
+    std::vector<float> m_parameters;
+};
+
+// Trains a linear classifier from the same initial parameters, with a checkpoint every 60 samples
+// and a cross validation every 80 samples.
+SessionResult RunTrainingSession(size_t prefetchDepth, size_t maxNumTrainingSamples, const std::wstring& checkpointFile, bool restore, const DeviceDescriptor& device)
+{
+    auto features = InputVariable({ c_inputDim }, DataType::Float, L"features");
+    auto labels = InputVariable({ c_numOutputClasses }, DataType::Float, L"labels");
+    auto weights = Parameter(NDArrayView::RandomUniform<float>({ c_numOutputClasses, c_inputDim }, -0.5, 0.5, 1, device), L"weights");
+    auto bias = Parameter({ c_numOutputClasses }, DataType::Float, 0.0, device, L"bias");
+    auto classifierOutput = Plus(bias, Times(weights, features), L"classifierOutput");
+    auto trainingLoss = CrossEntropyWithSoftmax(classifierOutput, labels, L"lossFunction");
+    auto prediction = ClassificationError(classifierOutput, labels, L"classificationError");
+    auto trainer = CreateTrainer(classifierOutput, trainingLoss, prediction, { SGDLearner(classifierOutput->Parameters(), LearningRateSchedule(0.05, 1)) });
+
+    auto trainingSource = TextFormatMinibatchSource(L"SimpleDataTrain_cntk_text.txt", { { L"features", c_inputDim }, { L"labels", c_numOutputClasses } }, MinibatchSource::InfinitelyRepeat, false);
+    auto cvSource = TextFormatMinibatchSource(L"SimpleDataTest_cntk_text.txt", { { L"features", c_inputDim }, { L"labels", c_numOutputClasses } }, MinibatchSource::FullDataSweep, false);
+
+    RecordingTrainingSession session(trainer, trainingSource,
+        { { features, trainingSource->StreamInfo(L"features") }, { labels, trainingSource->StreamInfo(L"labels") } },
+        maxNumTrainingSamples,
+        CheckpointConfig(checkpointFile, 60, DataUnit::Sample, restore),
+        CrossValidationConfig(cvSource, MinibatchSizeSchedule(50), 80, DataUnit::Sample, 200,
+            { { features, cvSource->StreamInfo(L"features") }, { labels, cvSource->StreamInfo(L"labels") } }));
+    session.SetMinibatchPrefetchDepth(prefetchDepth);
+    session.Train(device);
+
+    SessionResult result{ session.m_minibatches, session.m_crossValidations, {} };
+    for (const auto& parameter : { weights, bias })
+    {
+        auto value = parameter.Value()->DeepClone(DeviceDescriptor::CPUDevice());
+        result.m_parameters.insert(result.m_parameters.end(), value->DataBuffer<float>(), value->DataBuffer<float>() + value->Shape().TotalSize());
+    }
+    return result;
+}
+
+void CheckSameMinibatches(const std::vector<MinibatchRecord>& actual, const std::vector<MinibatchRecord>& expected)
+{
+    // The loss of a minibatch depends on its data, so equal losses at equal sample counts mean equal minibatches.
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        BOOST_CHECK_EQUAL(actual[i].m_samplesSeenBefore, expected[i].m_samplesSeenBefore);
+        BOOST_CHECK_EQUAL(actual[i].m_numSamples, expected[i].m_numSamples);
+        FloatingPointCompare(actual[i].m_loss, expected[i].m_loss, "Minibatch loss with prefetching does not match expectation");
+    }
+}
+
+void TestMinibatchPrefetching(const DeviceDescriptor& device)
+{
+    auto expected = RunTrainingSession(0, c_numTrainingSamples, L"prefetch_test_reference.model", false, device);
+    BOOST_REQUIRE(!expected.m_minibatches.empty());
+    BOOST_REQUIRE(!expected.m_crossValidations.empty());
+    // the schedule changes the minibatch size from 25 to 40 samples at 100 samples
+    BOOST_CHECK_EQUAL(expected.m_minibatches.front().m_numSamples, 25u);
+    BOOST_CHECK_EQUAL(expected.m_minibatches.back().m_numSamples, 40u);
+
+    for (size_t depth : { 1, 3 })
+    {
+        auto actual = RunTrainingSession(depth, c_numTrainingSamples, L"prefetch_test.model", false, device);
+        CheckSameMinibatches(actual.m_minibatches, expected.m_minibatches);
+        BOOST_REQUIRE_EQUAL(actual.m_crossValidations.size(), expected.m_crossValidations.size());
+        for (size_t i = 0; i < expected.m_crossValidations.size(); i++)
+        {
+            BOOST_CHECK_EQUAL(actual.m_crossValidations[i].m_index, expected.m_crossValidations[i].m_index);
+            BOOST_CHECK_EQUAL(actual.m_crossValidations[i].m_numSamples, expected.m_crossValidations[i].m_numSamples);
+            BOOST_CHECK_EQUAL(actual.m_crossValidations[i].m_numMinibatches, expected.m_crossValidations[i].m_numMinibatches);
+            FloatingPointCompare(actual.m_crossValidations[i].m_averageError, expected.m_crossValidations[i].m_averageError, "Cross validation error with prefetching does not match expectation");
+        }
+        FloatingPointVectorCompare(actual.m_parameters, expected.m_parameters, "Parameters after training with prefetching do not match expectation");
+    }
+
+    // Stop after 140 samples, which leaves a checkpoint, and continue from it in a new session.
+    auto first = RunTrainingSession(2, 140, L"prefetch_test_restore.model", false, device);
+    BOOST_REQUIRE(!first.m_minibatches.empty());
+    auto restored = RunTrainingSession(2, c_numTrainingSamples, L"prefetch_test_restore.model", true, device);
+    BOOST_REQUIRE(!restored.m_minibatches.empty());
+    size_t restoredSamples = restored.m_minibatches.front().m_samplesSeenBefore;
+    BOOST_CHECK_EQUAL(restoredSamples, first.m_minibatches.back().m_samplesSeenBefore + first.m_minibatches.back().m_numSamples);
+    std::vector<MinibatchRecord> expectedAfterRestore;
+    for (const auto& minibatch : expected.m_minibatches)
+    {
+        if (minibatch.m_samplesSeenBefore >= restoredSamples)
+            expectedAfterRestore.push_back(minibatch);
+    }
+    CheckSameMinibatches(restored.m_minibatches, expectedAfterRestore);
+    FloatingPointVectorCompare(restored.m_parameters, expected.m_parameters, "Parameters after restoring with prefetching do not match expectation");
+}
+
+BOOST_AUTO_TEST_SUITE(TrainingSessionSuite)
+
+BOOST_AUTO_TEST_CASE(MinibatchPrefetchingInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestMinibatchPrefetching(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(MinibatchPrefetchingInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestMinibatchPrefetching(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
@@ -44,6 +44,12 @@ class ModelFormat(Enum):
     subset of CNTK functionalities.
     '''
 
+    CNTKv2RawTensors = cntk_py.ModelFormat_CNTKv2RawTensors
+    '''
+    CNTK version 2 format with parameter values stored as raw bytes outside of the protobuf
+    message. Not limited to 2GB, and faster to load. Such models can also be loaded as CNTKv2.
+    '''
+
 @unique
 class CloneMethod(Enum):
     '''
@@ -1600,7 +1606,7 @@ class Function(cntk_py.Function):
                 pass
 
         if is_buffer:
-            if format != ModelFormat.CNTKv2:
+            if format not in (ModelFormat.CNTKv2, ModelFormat.CNTKv2RawTensors):
                 raise ValueError('Loading from buffer only supported for CNTKv2 format.')
             return cntk_py.Function.load_from_buffer(model, device)
 